@@ -39,6 +39,11 @@ ISourceFormatter::~ISourceFormatter()
 {
 }
 
+bool ISourceFormatter::canFormatConcurrently() const
+{
+    return false;
+}
+
 SourceFormatterStyle::SourceFormatterStyle()
 {
 }
@@ -173,6 +173,14 @@ class KDEVPLATFORMINTERFACES_EXPORT ISourceFormatter
 											   const QString& leftContext = QString(),
 											   const QString& rightContext = QString() ) const = 0;
 
+		/**
+		 * \return Whether formatSourceWithStyle() may be called without context from several threads at once.
+		 *
+		 * Formatting many files at once then runs in a thread pool instead of the main thread.
+		 * The default implementation returns false.
+		 */
+		virtual bool canFormatConcurrently() const;
+
 		/** \return A map of predefined styles (a key and a caption for each type)
 		*/
 		virtual QVector<SourceFormatterStyle> predefinedStyles() const = 0;
@@ -26,3 +26,13 @@ ITestSuite::~ITestSuite()
 
 }
 
+bool ITestSuite::runsSerially() const
+{
+    return false;
+}
+
+QStringList ITestSuite::resourceLocks() const
+{
+    return QStringList();
+}
+
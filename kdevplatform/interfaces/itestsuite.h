@@ -22,9 +22,10 @@
 
 #include "interfacesexport.h"
 
+#include <QStringList>
+
 class KJob;
 class QString;
-class QStringList;
 
 namespace KDevelop {
 
@@ -112,6 +113,22 @@ public:
      * @param testCase the test case
      **/
     virtual IndexedDeclaration caseDeclaration(const QString& testCase) const = 0;
+
+    /**
+     * Whether this suite must not run at the same time as any other suite,
+     * e.g. because it needs the whole machine.
+     *
+     * The default implementation returns false.
+     **/
+    virtual bool runsSerially() const;
+
+    /**
+     * The names of resources this suite uses exclusively while it runs.
+     * Suites sharing one of these resources are never run at the same time.
+     *
+     * The default implementation returns an empty list.
+     **/
+    virtual QStringList resourceLocks() const;
 };
 
 }
@@ -50,6 +50,7 @@
 #include <debug.h>
 
 #include "parsejob.h"
+#include "../duchain/duchain.h"
 
 using namespace KDevelop;
 
@@ -228,6 +229,12 @@ public:
         return bestRunningPriority;
     }
 
+    /// The number of threads for parsing, taking the temporary limit into account
+    int activeThreads() const
+    {
+        return m_threadLimit > 0 ? qMin(m_threadLimit, m_threads) : m_threads;
+    }
+
     IndexedString nextDocumentToParse() const
     {
         // Before starting a new job, first wait for all higher-priority ones to finish.
@@ -240,7 +247,7 @@ public:
             if (priority > m_neededPriority)
                 break; //The priority is not good enough to be processed right now
 
-            if (m_parseJobs.count() >= m_threads && priority > BackgroundParser::NormalPriority && !specialParseJob) {
+            if (m_parseJobs.count() >= activeThreads() && priority > BackgroundParser::NormalPriority && !specialParseJob) {
                 break; //The additional parsing thread is reserved for higher priority parsing
             }
 
@@ -279,8 +286,8 @@ public:
             return;
 
         //Only create parse-jobs for up to thread-count * 2 documents, so we don't fill the memory unnecessarily
-        if (m_parseJobs.count() >= m_threads + 1
-            || (m_parseJobs.count() >= m_threads && !separateThreadForHighPriority)) {
+        if (m_parseJobs.count() >= activeThreads() + 1
+            || (m_parseJobs.count() >= activeThreads() && !separateThreadForHighPriority)) {
             return;
         }
 
@@ -324,7 +331,7 @@ public:
             }
 
             if (decorator) {
-                if (m_parseJobs.count() == m_threads + 1 && !specialParseJob)
+                if (m_parseJobs.count() == activeThreads() + 1 && !specialParseJob)
                     specialParseJob = decorator; //This parse-job is allocated into the reserved thread
 
                 m_parseJobs.insert(url, decorator);
@@ -428,6 +435,12 @@ public:
             m_parser->setThreadCount(BACKWARDS_COMPATIBLE_ENTRY("Number of Threads", QThread::idealThreadCount()));
         }
 
+        // in MiB, 0 means the cleanup unloads everything that is not referenced
+        const qint64 memoryBudget = qEnvironmentVariableIsSet("KDEV_DUCHAIN_MEMORY_BUDGET_MB")
+                                    ? qEnvironmentVariableIntValue("KDEV_DUCHAIN_MEMORY_BUDGET_MB")
+                                    : config.readEntry("DUChain Memory Budget", 0);
+        DUChain::self()->setMemoryBudget(memoryBudget * 1024 * 1024);
+
         resume();
 
         if (BACKWARDS_COMPATIBLE_ENTRY("Enabled", true)) {
@@ -478,6 +491,8 @@ public:
     QTimer m_timer;
     int m_delay = 500;
     int m_threads = 1;
+    /// Temporary limit of m_threads, 0 if there is none
+    int m_threadLimit = 0;
 
     bool m_shuttingDown;
 
@@ -836,7 +851,7 @@ void BackgroundParser::setThreadCount(int threadCount)
 
     if (d->m_threads != threadCount) {
         d->m_threads = threadCount;
-        d->m_weaver.setMaximumNumberOfThreads(d->m_threads + 1); //1 Additional thread for high-priority parsing
+        d->m_weaver.setMaximumNumberOfThreads(d->activeThreads() + 1); //1 Additional thread for high-priority parsing
     }
 }
 
@@ -847,6 +862,31 @@ int BackgroundParser::threadCount() const
     return d->m_threads;
 }
 
+void BackgroundParser::setThreadLimit(int limit)
+{
+    Q_D(BackgroundParser);
+
+    int threads;
+    {
+        QMutexLocker lock(&d->m_mutex);
+        if (d->m_threadLimit == limit) {
+            return;
+        }
+        d->m_threadLimit = limit;
+        threads = d->activeThreads();
+        d->startTimerThreadSafe(d->m_delay);
+    }
+    d->m_weaver.setMaximumNumberOfThreads(threads + 1); //1 Additional thread for high-priority parsing
+}
+
+int BackgroundParser::threadLimit() const
+{
+    Q_D(const BackgroundParser);
+
+    QMutexLocker lock(&d->m_mutex);
+    return d->m_threadLimit;
+}
+
 void BackgroundParser::setDelay(int milliseconds)
 {
     Q_D(BackgroundParser);
@@ -91,6 +91,18 @@ public:
      */
     int threadCount() const;
 
+    /**
+     * Temporarily limit the number of threads used for parsing to @p limit, without changing threadCount().
+     *
+     * The additional thread reserved for high-priority parsing is not affected. 0 removes the limit.
+     */
+    void setThreadLimit(int limit);
+
+    /**
+     * Return the limit set with setThreadLimit(), 0 if there is none.
+     */
+    int threadLimit() const;
+
     /**
      * Set the delay in milliseconds before the background parser starts parsing.
      */
@@ -29,15 +29,128 @@
 #include <interfaces/icompletionsettings.h>
 
 #include <language/backgroundparser/backgroundparser.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
+#include <language/interfaces/ilanguagesupport.h>
 
 #include <KLocalizedString>
 
 #include <QApplication>
+#include <QFutureWatcher>
 #include <QPointer>
 #include <QSet>
+#include <QtConcurrentRun>
 
 using namespace KDevelop;
 
+namespace {
+/// @see ParseProjectJob::upToDateFiles
+QSet<IndexedString> findUpToDateFiles(const QSet<IndexedString>& files, TopDUContext::Features features,
+                                      const ParseProjectJob::ParsingEnvironments& environments,
+                                      const QAtomicInt& aborted)
+{
+    // don't block DUChain writers for too long
+    const int batchSize = 1000;
+
+    QVector<IndexedString> batch;
+    batch.reserve(batchSize);
+    QVector<ModificationRevisionSet> revisionSets;
+    QSet<uint> seenRevisionSets;
+    QSet<IndexedString> dependencies;
+    QSet<IndexedString> candidates;
+
+    // first collect everything that could have changed, so the files can be stat'ed all at once
+    auto collect = [&]() {
+        DUChainReadLocker lock;
+        for (const auto& file : qAsConst(batch)) {
+            const auto environmentFiles = DUChain::self()->allEnvironmentFiles(file);
+            if (environmentFiles.isEmpty()) {
+                continue;
+            }
+            bool usable = true;
+            const bool hasEnvironment = environments.contains(file);
+            for (const auto& environmentFile : environmentFiles) {
+                // Without the environment the parse job would use, e.g. the current include paths and defines,
+                // we can't tell whether such a file is up to date. It is still prefetched for its parse job.
+                if (!environmentFile->featuresSatisfied(features)
+                    || (!hasEnvironment && environmentFile->needsUpdateDependsOnEnvironment())) {
+                    usable = false;
+                }
+                const auto& revisions = environmentFile->allModificationRevisions();
+                if (!seenRevisionSets.contains(revisions.index())) {
+                    seenRevisionSets.insert(revisions.index());
+                    revisionSets.append(revisions);
+                }
+            }
+            if (usable) {
+                candidates.insert(file);
+            }
+        }
+        batch.clear();
+    };
+
+    for (const auto& file : files) {
+        batch.append(file);
+        if (batch.size() == batchSize) {
+            collect();
+            if (aborted.loadAcquire()) {
+                return {};
+            }
+        }
+    }
+    collect();
+
+    for (const auto& revisions : qAsConst(revisionSets)) {
+        const auto revisionFiles = revisions.files();
+        for (const auto& file : revisionFiles) {
+            dependencies.insert(file);
+        }
+    }
+    if (aborted.loadAcquire()) {
+        return {};
+    }
+
+    ModificationRevision::prefetchModificationTimes(dependencies.values().toVector());
+
+    // now the actual checks are answered from the modification-time cache
+    QSet<IndexedString> ret;
+    int checked = 0;
+    DUChainReadLocker lock;
+    for (const auto& file : qAsConst(candidates)) {
+        if (++checked % batchSize == 0) {
+            lock.unlock();
+            if (aborted.loadAcquire()) {
+                return {};
+            }
+            lock.lock();
+        }
+        // same check as in ParseJob::isUpdateRequired, for the first file of each language
+        QSet<IndexedString> checkedLanguages;
+        bool upToDate = true;
+        const ParsingEnvironment* fileEnvironment = environments.value(file).data();
+        const auto environmentFiles = DUChain::self()->allEnvironmentFiles(file);
+        for (const auto& environmentFile : environmentFiles) {
+            if (checkedLanguages.contains(environmentFile->language())) {
+                continue;
+            }
+            checkedLanguages.insert(environmentFile->language());
+            const ParsingEnvironment* environment =
+                fileEnvironment && environmentFile->matchEnvironment(fileEnvironment) ? fileEnvironment : nullptr;
+            if ((!environment && environmentFile->needsUpdateDependsOnEnvironment())
+                || environmentFile->needsUpdate(environment) || !environmentFile->featuresSatisfied(features)) {
+                upToDate = false;
+                break;
+            }
+        }
+        if (upToDate && !environmentFiles.isEmpty()) {
+            ret.insert(file);
+        }
+    }
+    return ret;
+}
+}
+
 class KDevelop::ParseProjectJobPrivate
 {
 public:
@@ -53,6 +166,10 @@ public:
     bool forceAll;
     KDevelop::IProject* project;
     QSet<IndexedString> filesToParse;
+    TopDUContext::Features processingLevel = TopDUContext::Empty;
+
+    QFutureWatcher<QSet<IndexedString>> upToDateCheck;
+    QAtomicInt abortUpToDateCheck;
 };
 
 bool ParseProjectJob::doKill()
@@ -64,6 +181,11 @@ bool ParseProjectJob::doKill()
 
 ParseProjectJob::~ParseProjectJob()
 {
+    Q_D(ParseProjectJob);
+
+    d->abortUpToDateCheck.storeRelease(1);
+    d->upToDateCheck.waitForFinished();
+
     ICore::self()->languageController()->backgroundParser()->revertAllRequests(this);
 
     if (ICore::self()->runController()->currentJobs().contains(this))
@@ -76,13 +198,19 @@ ParseProjectJob::ParseProjectJob(IProject* project, bool forceUpdate, bool force
     Q_D(ParseProjectJob);
 
     connect(project, &IProject::destroyed, this, &ParseProjectJob::deleteNow);
+    connect(&d->upToDateCheck, &QFutureWatcher<QSet<IndexedString>>::finished,
+            this, &ParseProjectJob::upToDateCheckFinished);
 
     if (forceAll || ICore::self()->projectController()->parseAllProjectSources()) {
         d->filesToParse = project->fileSet();
     } else {
         // In case we don't want to parse the whole project, still add all currently open files that belong to the project to the background-parser
+        // Restored documents which are not loaded into the editor yet get parsed once they are
         const auto documents = ICore::self()->documentController()->openDocuments();
         for (auto* document : documents) {
+            if (!document->textDocument()) {
+                continue;
+            }
             const auto path = IndexedString(document->url());
             if (project->fileSet().contains(path)) {
                 d->filesToParse.insert(path);
@@ -114,10 +242,61 @@ void ParseProjectJob::updateReady(const IndexedString& url, const ReferencedTopD
     if (d->updated % ((d->filesToParse.size() / 100) + 1) == 0)
         updateProgress();
 
-    if (d->updated >= d->filesToParse.size())
+    if (d->updated >= d->filesToParse.size() && !d->upToDateCheck.isRunning())
         deleteLater();
 }
 
+QSet<IndexedString> ParseProjectJob::upToDateFiles(const QSet<IndexedString>& files, TopDUContext::Features features,
+                                                   const ParsingEnvironments& environments)
+{
+    const QAtomicInt aborted(0);
+    return findUpToDateFiles(files, features, environments, aborted);
+}
+
+bool ParseProjectJob::createParsingEnvironments(QHash<IndexedString, QPair<ILanguageSupport*, QSharedPointer<ParsingEnvironment>>>* environments)
+{
+    Q_D(ParseProjectJob);
+
+    auto* languageController = ICore::self()->languageController();
+    const int processAfter = 1000;
+    int processed = 0;
+    auto crashGuard = QPointer<ParseProjectJob> {this};
+    const auto files = d->filesToParse;
+    for (const IndexedString& url : files) {
+        const auto languages = languageController->languagesForUrl(url.toUrl());
+        for (ILanguageSupport* language : languages) {
+            if (auto* environment = language->createParsingEnvironment(url)) {
+                environments->insert(url, qMakePair(language, QSharedPointer<ParsingEnvironment>(environment)));
+                break;
+            }
+        }
+        ++processed;
+        if (processed == processAfter) {
+            QApplication::processEvents();
+            if (!crashGuard) {
+                return false;
+            }
+            processed = 0;
+        }
+    }
+    return true;
+}
+
+void ParseProjectJob::upToDateCheckFinished()
+{
+    Q_D(ParseProjectJob);
+
+    const auto upToDate = d->upToDateCheck.result();
+    qCDebug(LANGUAGE) << "skipping" << upToDate.size() << "of" << d->filesToParse.size()
+                      << "project files which are up to date";
+    d->filesToParse -= upToDate;
+    if (d->filesToParse.isEmpty()) {
+        deleteLater();
+        return;
+    }
+    addFilesToParse();
+}
+
 void ParseProjectJob::start()
 {
     Q_D(ParseProjectJob);
@@ -145,35 +324,74 @@ void ParseProjectJob::start()
         }
         processingLevel = ( TopDUContext::Features )(TopDUContext::ForceUpdate | processingLevel);
     }
+    d->processingLevel = processingLevel;
 
     if (auto currentDocument = ICore::self()->documentController()->activeDocument()) {
         const auto path = IndexedString(currentDocument->url());
         auto fileIt = d->filesToParse.find(path);
         if (fileIt != d->filesToParse.end()) {
+            // not notifying this job, which might be done before and would revert the request
             ICore::self()->languageController()->backgroundParser()->addDocument(path,
-                                                                                 TopDUContext::AllDeclarationsContextsAndUses, BackgroundParser::BestPriority,
-                                                                                 this);
+                                                                                 TopDUContext::AllDeclarationsContextsAndUses, BackgroundParser::BestPriority);
             d->filesToParse.erase(fileIt);
         }
     }
 
     // Add all currently open files that belong to the project to the background-parser, so that they'll be parsed first of all
+    // Restored documents which are not loaded into the editor yet are requested once they are, don't let them
+    // delay the files the user actually looks at
     const auto documents = ICore::self()->documentController()->openDocuments();
     for (auto* document : documents) {
+        if (!document->textDocument()) {
+            continue;
+        }
         const auto path = IndexedString(document->url());
         auto fileIt = d->filesToParse.find(path);
         if (fileIt != d->filesToParse.end()) {
             ICore::self()->languageController()->backgroundParser()->addDocument(path,
-                                                                                 TopDUContext::AllDeclarationsContextsAndUses, 10,
-                                                                                 this);
+                                                                                 TopDUContext::AllDeclarationsContextsAndUses, 10);
             d->filesToParse.erase(fileIt);
         }
     }
 
-    if (!d->forceAll && !ICore::self()->projectController()->parseAllProjectSources()) {
+    // the open documents are parsed independently of this job
+    if (d->filesToParse.isEmpty() || (!d->forceAll && !ICore::self()->projectController()->parseAllProjectSources())) {
+        deleteLater();
         return;
     }
 
+    if (!d->forceUpdate) {
+        // when re-opening a project most files didn't change since they were parsed the last time,
+        // find those in bulk instead of letting a parse job check each of them separately
+        QHash<IndexedString, QPair<ILanguageSupport*, QSharedPointer<ParsingEnvironment>>> environments;
+        if (!createParsingEnvironments(&environments)) {
+            return;
+        }
+        const auto files = d->filesToParse;
+        const auto* aborted = &d->abortUpToDateCheck;
+        d->upToDateCheck.setFuture(QtConcurrent::run([files, processingLevel, environments, aborted]() {
+            // add what the parse jobs would determine in the background
+            ParsingEnvironments completed;
+            completed.reserve(environments.size());
+            for (auto it = environments.constBegin(), end = environments.constEnd(); it != end; ++it) {
+                if (aborted->loadAcquire()) {
+                    return QSet<IndexedString>();
+                }
+                it->first->completeParsingEnvironment(it->second.data());
+                completed.insert(it.key(), it->second);
+            }
+            return findUpToDateFiles(files, processingLevel, completed, *aborted);
+        }));
+        return;
+    }
+
+    addFilesToParse();
+}
+
+void ParseProjectJob::addFilesToParse()
+{
+    Q_D(ParseProjectJob);
+
     // prevent UI-lockup by processing events after some files
     // esp. noticeable when dealing with huge projects
     const int processAfter = 1000;
@@ -181,7 +399,7 @@ void ParseProjectJob::start()
     // guard against reentrancy issues, see also bug 345480
     auto crashGuard = QPointer<ParseProjectJob> {this};
     for (const IndexedString& url : qAsConst(d->filesToParse)) {
-        ICore::self()->languageController()->backgroundParser()->addDocument(url, processingLevel,
+        ICore::self()->languageController()->backgroundParser()->addDocument(url, d->processingLevel,
                                                                              BackgroundParser::InitialParsePriority,
                                                                              this);
         ++processed;
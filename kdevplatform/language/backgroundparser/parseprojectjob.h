@@ -21,11 +21,18 @@
 
 #include <serialization/indexedstring.h>
 #include <language/languageexport.h>
+#include <language/duchain/topducontext.h>
 
 #include <KJob>
 
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+
 namespace KDevelop {
 class ReferencedTopDUContext;
+class ILanguageSupport;
+class ParsingEnvironment;
 class IProject;
 class ParseProjectJobPrivate;
 
@@ -48,12 +55,27 @@ public:
     void start() override;
     bool doKill() override;
 
+    using ParsingEnvironments = QHash<IndexedString, QSharedPointer<const ParsingEnvironment>>;
+
+    ///@return the files out of @p files which don't need to be parsed again for @p features,
+    ///        because neither they nor anything they import changed since they were parsed last.
+    ///Files whose update check also depends on the parsing environment, like include paths and
+    ///defines, are compared with their entry in @p environments, see ILanguageSupport::createParsingEnvironment().
+    ///Without an entry they are never returned, their parse jobs have to decide.
+    ///The duchain must not be locked.
+    static QSet<IndexedString> upToDateFiles(const QSet<IndexedString>& files, TopDUContext::Features features,
+                                             const ParsingEnvironments& environments = {});
+
 private Q_SLOTS:
     void deleteNow();
     void updateReady(const KDevelop::IndexedString& url, const KDevelop::ReferencedTopDUContext& topContext);
 
 private:
     void updateProgress();
+    void upToDateCheckFinished();
+    void addFilesToParse();
+    /// @return false when this job got deleted meanwhile
+    bool createParsingEnvironments(QHash<IndexedString, QPair<ILanguageSupport*, QSharedPointer<ParsingEnvironment>>>* environments);
 
 private:
     const QScopedPointer<class ParseProjectJobPrivate> d_ptr;
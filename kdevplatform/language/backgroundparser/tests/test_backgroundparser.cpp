@@ -27,6 +27,7 @@
 #include <QTemporaryFile>
 #include <QApplication>
 #include <QSemaphore>
+#include <QTemporaryDir>
 
 #include <KTextEditor/Editor>
 #include <KTextEditor/View>
@@ -37,7 +38,9 @@
 
 #include <language/duchain/duchain.h>
 #include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
 #include <language/backgroundparser/backgroundparser.h>
+#include <language/backgroundparser/parseprojectjob.h>
 
 #include <interfaces/ilanguagecontroller.h>
 
@@ -453,3 +456,103 @@ void TestBackgroundparser::testSuspendResume()
     parser->resume();
     QVERIFY(m_jobPlan.runJobs(100));
 }
+
+namespace {
+/// The flags a file was parsed with, like include paths and defines
+class FlagsEnvironment : public ParsingEnvironment
+{
+public:
+    explicit FlagsEnvironment(const QString& flags)
+        : flags(flags)
+    {}
+
+    const QString flags;
+};
+
+/// A file whose update check also compares the flags, which only the environment of the next parse job knows
+class EnvironmentDependentFile : public ParsingEnvironmentFile
+{
+public:
+    EnvironmentDependentFile(const IndexedString& url, const QString& flags)
+        : ParsingEnvironmentFile(url)
+        , m_flags(flags)
+    {}
+
+    bool needsUpdate(const ParsingEnvironment* environment = nullptr) const override
+    {
+        if (environment && static_cast<const FlagsEnvironment*>(environment)->flags != m_flags) {
+            return true;
+        }
+        return ParsingEnvironmentFile::needsUpdate(environment);
+    }
+
+    bool needsUpdateDependsOnEnvironment() const override
+    {
+        return true;
+    }
+
+    bool matchEnvironment(const ParsingEnvironment* environment) const override
+    {
+        return dynamic_cast<const FlagsEnvironment*>(environment);
+    }
+
+private:
+    QString m_flags;
+};
+
+IndexedString writeFile(const QTemporaryDir& dir, const QString& name)
+{
+    QFile file(dir.filePath(name));
+    file.open(QIODevice::WriteOnly);
+    file.write("text\n");
+    return IndexedString(file.fileName());
+}
+
+void addParsedFile(const IndexedString& url, ParsingEnvironmentFile* file, const ModificationRevision& revision)
+{
+    DUChainWriteLocker lock;
+    file->addModificationRevision(url, revision);
+    auto* top = new TopDUContext(url, {0, 0, 1, 0}, file);
+    top->setFeatures(TopDUContext::VisibleDeclarationsAndContexts);
+    DUChain::self()->addDocumentChain(top);
+}
+}
+
+void TestBackgroundparser::testUpToDateFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const auto upToDate = writeFile(dir, QStringLiteral("uptodate.txt"));
+    addParsedFile(upToDate, new ParsingEnvironmentFile(upToDate), ModificationRevision::revisionForFile(upToDate));
+
+    const auto modified = writeFile(dir, QStringLiteral("modified.txt"));
+    addParsedFile(modified, new ParsingEnvironmentFile(modified), ModificationRevision(QDateTime::fromSecsSinceEpoch(1)));
+
+    const auto flagsChanged = writeFile(dir, QStringLiteral("flagschanged.txt"));
+    addParsedFile(flagsChanged, new EnvironmentDependentFile(flagsChanged, QStringLiteral("-DA")),
+                  ModificationRevision::revisionForFile(flagsChanged));
+
+    const auto sameFlags = writeFile(dir, QStringLiteral("sameflags.txt"));
+    addParsedFile(sameFlags, new EnvironmentDependentFile(sameFlags, QStringLiteral("-DA")),
+                  ModificationRevision::revisionForFile(sameFlags));
+
+    const auto notParsed = writeFile(dir, QStringLiteral("notparsed.txt"));
+
+    const QSet<IndexedString> files{upToDate, modified, flagsChanged, sameFlags, notParsed};
+    ParseProjectJob::ParsingEnvironments environments;
+    environments.insert(flagsChanged, QSharedPointer<const ParsingEnvironment>(new FlagsEnvironment(QStringLiteral("-DB"))));
+    environments.insert(sameFlags, QSharedPointer<const ParsingEnvironment>(new FlagsEnvironment(QStringLiteral("-DA"))));
+    QCOMPARE(ParseProjectJob::upToDateFiles(files, TopDUContext::VisibleDeclarationsAndContexts, environments),
+             (QSet<IndexedString>{upToDate, sameFlags}));
+    // without the environments the files depending on them can't be checked
+    QCOMPARE(ParseProjectJob::upToDateFiles(files, TopDUContext::VisibleDeclarationsAndContexts),
+             QSet<IndexedString>{upToDate});
+    // more features than were parsed
+    QVERIFY(ParseProjectJob::upToDateFiles(files, TopDUContext::AllDeclarationsContextsAndUses, environments).isEmpty());
+
+    DUChainWriteLocker lock;
+    for (const auto& url : {upToDate, modified, flagsChanged, sameFlags}) {
+        DUChain::self()->removeDocumentChain(DUChain::self()->chainForDocument(url));
+    }
+}
@@ -111,6 +111,7 @@ private Q_SLOTS:
 
     void testNoDeadlockInJobCreation();
     void testSuspendResume();
+    void testUpToDateFiles();
 
     void benchmark();
 
@@ -21,37 +21,113 @@
 
 #include "allclassesfolder.h"
 
+#include "../duchain/declaration.h"
+#include "../duchain/duchain.h"
+#include "../duchain/duchainlock.h"
+#include "../duchain/persistentsymboltable.h"
+#include "../duchain/topducontext.h"
+
 #include "../../interfaces/icore.h"
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
 
 #include <KLocalizedString>
 
+#include <QTimer>
+
+#include <algorithm>
+
 using namespace KDevelop;
 using namespace ClassModelNodes;
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
-AllClassesFolder::AllClassesFolder(NodesModelInterface* a_model)
-    : DocumentClassesFolder(i18n("All projects classes"), a_model)
+/// A namespace folder which is populated from the class index once it gets expanded.
+class ClassModelNodes::IndexedNamespaceFolderNode
+    : public DynamicFolderNode
+{
+public:
+    IndexedNamespaceFolderNode(const IndexedQualifiedIdentifier& a_identifier, AllClassesFolder* a_folder,
+                               NodesModelInterface* a_model);
+    ~IndexedNamespaceFolderNode() override;
+
+    /// Returns the qualified identifier for this node
+    const IndexedQualifiedIdentifier& identifier() const { return m_identifier; }
+
+public: // Node overrides
+    bool getIcon(QIcon& a_resultIcon) override;
+    int score() const override { return 101; }
+    bool hasChildren() const override;
+    void populateNode() override;
+
+private:
+    /// The namespace identifier.
+    IndexedQualifiedIdentifier m_identifier;
+    AllClassesFolder* m_folder;
+};
+
+IndexedNamespaceFolderNode::IndexedNamespaceFolderNode(const IndexedQualifiedIdentifier& a_identifier,
+                                                       AllClassesFolder* a_folder, NodesModelInterface* a_model)
+    : DynamicFolderNode(a_identifier.identifier().last().toString(), a_model)
+    , m_identifier(a_identifier)
+    , m_folder(a_folder)
 {
+    m_folder->m_namespaceNodes.insert(m_identifier, this);
 }
 
-void AllClassesFolder::nodeCleared()
+IndexedNamespaceFolderNode::~IndexedNamespaceFolderNode()
 {
-    DocumentClassesFolder::nodeCleared();
+    const auto it = m_folder->m_namespaceNodes.find(m_identifier);
+    if (it != m_folder->m_namespaceNodes.end() && *it == this)
+        m_folder->m_namespaceNodes.erase(it);
+}
 
-    disconnect(
-        ICore::self()->projectController(), &IProjectController::projectOpened, this, &AllClassesFolder::projectOpened);
-    disconnect(
-        ICore::self()->projectController(), &IProjectController::projectClosing, this,
-        &AllClassesFolder::projectClosing);
+bool IndexedNamespaceFolderNode::getIcon(QIcon& a_resultIcon)
+{
+    a_resultIcon = QIcon::fromTheme(QStringLiteral("namespace"));
+    return true;
 }
 
-void AllClassesFolder::populateNode()
+bool IndexedNamespaceFolderNode::hasChildren() const
 {
-    DocumentClassesFolder::populateNode();
+    // The index knows without creating the child nodes.
+    if (!isPopulated())
+        return m_folder->namespaceHasChildren(m_identifier);
+
+    return !m_children.empty();
+}
+
+void IndexedNamespaceFolderNode::populateNode()
+{
+    m_folder->populateNamespace(this, m_identifier);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+AllClassesFolder::AllClassesFolder(NodesModelInterface* a_model)
+    : DynamicFolderNode(i18n("All projects classes"), a_model)
+    , m_updateTimer(new QTimer(this))
+{
+    // this is the required delay.
+    m_updateTimer->setInterval(2000);
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, &QTimer::timeout, this, &AllClassesFolder::updateChangedFiles);
+}
+
+AllClassesFolder::~AllClassesFolder()
+{
+    // The namespace nodes unregister themselves, so they have to go while we're still alive.
+    clear();
+}
+
+void AllClassesFolder::ensureIndexed()
+{
+    if (m_indexed)
+        return;
+
+    m_indexed = true;
 
     // Get notification for future project addition / removal.
     connect(
@@ -60,31 +136,278 @@ void AllClassesFolder::populateNode()
         ICore::self()->projectController(), &IProjectController::projectClosing, this,
         &AllClassesFolder::projectClosing);
 
-    // Parse each existing project file
+    // Keep the index up to date as files get parsed, also while the folder is collapsed.
+    connect(DUChain::self(), &DUChain::updateReady, this, &AllClassesFolder::updateReady);
+
     const auto projects = ICore::self()->projectController()->projects();
     for (IProject* project : projects) {
-        projectOpened(project);
+        const auto files = project->fileSet();
+        for (const IndexedString& file : files) {
+            m_index.updateFile(file);
+        }
+    }
+
+    indexChanged();
+}
+
+void AllClassesFolder::populateNode()
+{
+    ensureIndexed();
+
+    populateNamespace(this, IndexedQualifiedIdentifier());
+}
+
+void AllClassesFolder::populateNamespace(Node* a_node, const IndexedQualifiedIdentifier& a_namespace)
+{
+    const auto namespaces = m_index.namespaces(a_namespace);
+    for (const IndexedQualifiedIdentifier& id : namespaces) {
+        if (!isNamespaceFiltered(id) && namespaceHasChildren(id))
+            a_node->addNode(new IndexedNamespaceFolderNode(id, this, m_model));
+    }
+
+    const auto classes = m_index.classes(a_namespace);
+    if (classes.isEmpty())
+        return;
+
+    DUChainReadLocker readLock(DUChain::lock());
+    for (const IndexedQualifiedIdentifier& id : classes) {
+        if (isClassFiltered(id))
+            continue;
+
+        if (ClassNode* node = createClassNode(id))
+            a_node->addNode(node);
+    }
+}
+
+bool AllClassesFolder::syncNamespace(const IndexedQualifiedIdentifier& a_namespace)
+{
+    DynamicNode* node = this;
+    if (!a_namespace.isEmpty())
+        node = m_namespaceNodes.value(a_namespace);
+
+    // Not displayed or never expanded, will be populated from the index when needed.
+    if (node == nullptr || !node->isPopulated())
+        return false;
+
+    ClassIndex::IdentifierSet namespaces;
+    const auto indexedNamespaces = m_index.namespaces(a_namespace);
+    for (const IndexedQualifiedIdentifier& id : indexedNamespaces) {
+        if (!isNamespaceFiltered(id) && namespaceHasChildren(id))
+            namespaces.insert(id);
+    }
+
+    ClassIndex::IdentifierSet classes;
+    const auto indexedClasses = m_index.classes(a_namespace);
+    for (const IndexedQualifiedIdentifier& id : indexedClasses) {
+        if (!isClassFiltered(id))
+            classes.insert(id);
+    }
+
+    bool changed = false;
+
+    // Remove what's gone, what's left in the sets afterwards is new.
+    const auto children = node->children();
+    for (Node* child : children) {
+        bool keep = true;
+        if (auto* namespaceNode = dynamic_cast<IndexedNamespaceFolderNode*>(child))
+            keep = namespaces.remove(namespaceNode->identifier());
+        else if (auto* classNode = dynamic_cast<ClassNode*>(child))
+            keep = classes.remove(classNode->identifier());
+
+        if (!keep) {
+            child->removeSelf();
+            changed = true;
+        }
+    }
+
+    bool added = false;
+    for (const IndexedQualifiedIdentifier& id : qAsConst(namespaces)) {
+        node->addNode(new IndexedNamespaceFolderNode(id, this, m_model));
+        added = true;
+    }
+
+    if (!classes.isEmpty()) {
+        DUChainReadLocker readLock(DUChain::lock());
+        for (const IndexedQualifiedIdentifier& id : qAsConst(classes)) {
+            if (ClassNode* classNode = createClassNode(id)) {
+                node->addNode(classNode);
+                added = true;
+            }
+        }
+    }
+
+    if (added)
+        node->recursiveSort();
+
+    return changed || added;
+}
+
+bool AllClassesFolder::namespaceHasChildren(const IndexedQualifiedIdentifier& a_namespace) const
+{
+    const auto classes = m_index.classes(a_namespace);
+    for (const IndexedQualifiedIdentifier& id : classes) {
+        if (!isClassFiltered(id))
+            return true;
+    }
+
+    // Namespaces without any class are not displayed.
+    const auto namespaces = m_index.namespaces(a_namespace);
+    for (const IndexedQualifiedIdentifier& id : namespaces) {
+        if (!isNamespaceFiltered(id) && namespaceHasChildren(id))
+            return true;
+    }
+
+    return false;
+}
+
+ClassNode* AllClassesFolder::createClassNode(const IndexedQualifiedIdentifier& a_id)
+{
+    const auto files = m_index.files(a_id);
+
+    uint count = 0;
+    const IndexedDeclaration* declarations;
+    PersistentSymbolTable::self().declarations(a_id, count, declarations);
+    for (uint i = 0; i < count; ++i) {
+        if (!files.contains(declarations[i].indexedTopContext().url()))
+            continue;
+
+        if (Declaration* decl = declarations[i].declaration())
+            return new ClassNode(decl, m_model);
+    }
+
+    return nullptr;
+}
+
+ClassNode* AllClassesFolder::findClassNode(const IndexedQualifiedIdentifier& a_id)
+{
+    // Make sure that the classes node is populated, otherwise
+    // the lookup will not work.
+    performPopulateNode();
+
+    const QualifiedIdentifier qualifiedIdentifier = a_id.identifier();
+
+    // Ignore zero length identifiers.
+    if (qualifiedIdentifier.count() == 0)
+        return nullptr;
+
+    // Expose the namespaces leading to the class.
+    DynamicNode* parentNode = this;
+    int idLen = 1;
+    for (; idLen < qualifiedIdentifier.count(); ++idLen) {
+        const IndexedQualifiedIdentifier namespaceId(qualifiedIdentifier.mid(0, idLen));
+        if (!m_index.isNamespace(namespaceId))
+            break;
+
+        // No node if the namespace is filtered.
+        IndexedNamespaceFolderNode* namespaceNode = m_namespaceNodes.value(namespaceId);
+        if (namespaceNode == nullptr)
+            return nullptr;
+
+        namespaceNode->performPopulateNode();
+        parentNode = namespaceNode;
+    }
+
+    ClassNode* closestNode = nullptr;
+    const IndexedQualifiedIdentifier classId(qualifiedIdentifier.mid(0, idLen));
+    for (Node* child : parentNode->children()) {
+        auto* classNode = dynamic_cast<ClassNode*>(child);
+        if (classNode && classNode->identifier() == classId) {
+            closestNode = classNode;
+            break;
+        }
+    }
+
+    // Continue with the nested classes.
+    while (closestNode && (idLen < qualifiedIdentifier.count())) {
+        ++idLen;
+        closestNode = closestNode->findSubClass(qualifiedIdentifier.mid(0, idLen));
+    }
+
+    return closestNode;
+}
+
+void AllClassesFolder::applyChanges(const ClassIndex::IdentifierSet& a_changedNamespaces)
+{
+    if (a_changedNamespaces.isEmpty())
+        return;
+
+    indexChanged();
+
+    // Whether a namespace is displayed depends on its contents,
+    // so the parent namespaces might need an update as well.
+    ClassIndex::IdentifierSet namespaces;
+    for (const IndexedQualifiedIdentifier& id : a_changedNamespaces) {
+        QualifiedIdentifier namespaceId = id.identifier();
+        while (namespaceId.count() > 0) {
+            namespaces.insert(namespaceId);
+            namespaceId = namespaceId.left(-1);
+        }
+    }
+    namespaces.insert(IndexedQualifiedIdentifier());
+
+    for (const IndexedQualifiedIdentifier& id : qAsConst(namespaces)) {
+        syncNamespace(id);
     }
 }
 
 void AllClassesFolder::projectClosing(KDevelop::IProject* project)
 {
+    ClassIndex::IdentifierSet changed;
+
     // Run over all the files in the project.
     const auto files = project->fileSet();
     for (const IndexedString& file : files) {
-        closeDocument(file);
+        changed += m_index.removeFile(file);
+        m_updatedFiles.remove(file);
     }
+
+    applyChanges(changed);
 }
 
 void AllClassesFolder::projectOpened(KDevelop::IProject* project)
 {
+    ClassIndex::IdentifierSet changed;
+
     // Run over all the files in the project.
     const auto files = project->fileSet();
     for (const IndexedString& file : files) {
-        parseDocument(file);
+        changed += m_index.updateFile(file);
+    }
+
+    applyChanges(changed);
+}
+
+void AllClassesFolder::updateReady(const IndexedString& a_file, const ReferencedTopDUContext& a_topContext)
+{
+    Q_UNUSED(a_topContext);
+
+    if (!m_index.containsFile(a_file)) {
+        const auto projects = ICore::self()->projectController()->projects();
+        const bool isProjectFile = std::any_of(projects.begin(), projects.end(), [&a_file](IProject* project) {
+            return project->inProject(a_file);
+        });
+        if (!isProjectFile)
+            return;
+    }
+
+    m_updatedFiles.insert(a_file);
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void AllClassesFolder::updateChangedFiles()
+{
+    ClassIndex::IdentifierSet changed;
+
+    // re-read changed documents.
+    for (const IndexedString& file : qAsConst(m_updatedFiles)) {
+        changed += m_index.updateFile(file);
     }
 
-    recursiveSort();
+    // Processed all files.
+    m_updatedFiles.clear();
+
+    applyChanges(changed);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -98,29 +421,11 @@ FilteredAllClassesFolder::FilteredAllClassesFolder(NodesModelInterface* a_model)
 void FilteredAllClassesFolder::updateFilterString(const QString& a_newFilterString)
 {
     m_filterString = a_newFilterString;
+    updateMatches();
 
     if (isPopulated()) {
-#if 1 // Choose speed over correctness.
-        // Close the node and re-open it should be quicker than reload each document
-        // and remove individual nodes (at the cost of loosing the current selection).
+        // Only the namespaces leading to matching classes get populated again.
         performPopulateNode(true);
-#else
-        bool hadChanges = false;
-
-        // Reload the documents.
-        foreach (const IndexedString& file, getAllOpenDocuments())
-            hadChanges |= updateDocument(file);
-
-        // Sort if we've updated documents.
-        if (hadChanges)
-            recursiveSort();
-        else
-        {
-            // If nothing changed, the title changed so mark the node as updated.
-            m_model->nodesLayoutAboutToBeChanged(this);
-            m_model->nodesLayoutChanged(this);
-        }
-#endif
     } else
     {
         // Displayed name changed only...
@@ -129,7 +434,40 @@ void FilteredAllClassesFolder::updateFilterString(const QString& a_newFilterStri
     }
 }
 
-bool FilteredAllClassesFolder::isClassFiltered(const KDevelop::QualifiedIdentifier& a_id)
+void FilteredAllClassesFolder::updateMatches()
+{
+    m_matchingClasses.clear();
+    m_matchingNamespaces.clear();
+
+    if (m_filterString.isEmpty())
+        return;
+
+    // The index gives us the matches without looking up the declaration of every class.
+    const auto matches = classIndex().classesContaining(m_filterString);
+    for (const IndexedQualifiedIdentifier& id : matches) {
+        m_matchingClasses.insert(id);
+
+        IndexedQualifiedIdentifier parent = ClassIndex::parentIdentifier(id.identifier());
+        while (!parent.isEmpty() && classIndex().isNamespace(parent)) {
+            if (m_matchingNamespaces.contains(parent))
+                break;
+            m_matchingNamespaces.insert(parent);
+            parent = ClassIndex::parentIdentifier(parent.identifier());
+        }
+    }
+}
+
+void FilteredAllClassesFolder::indexChanged()
+{
+    updateMatches();
+}
+
+bool FilteredAllClassesFolder::isClassFiltered(const KDevelop::IndexedQualifiedIdentifier& a_id) const
+{
+    return !m_filterString.isEmpty() && !m_matchingClasses.contains(a_id);
+}
+
+bool FilteredAllClassesFolder::isNamespaceFiltered(const KDevelop::IndexedQualifiedIdentifier& a_id) const
 {
-    return !a_id.last().toString().contains(m_filterString, Qt::CaseInsensitive);
+    return !m_filterString.isEmpty() && !m_matchingNamespaces.contains(a_id);
 }
@@ -22,31 +22,99 @@
 #ifndef KDEVPLATFORM_ALLCLASSESFOLDER_H
 #define KDEVPLATFORM_ALLCLASSESFOLDER_H
 
-#include "documentclassesfolder.h"
+#include "classmodelnode.h"
+#include "classindex.h"
+
+class QTimer;
 
 namespace KDevelop {
 class IProject;
+class ReferencedTopDUContext;
 }
 
 namespace ClassModelNodes {
+class IndexedNamespaceFolderNode;
+
 /// Special folder.
-/// It displays all the classes in the projects by using the IProject
+/// It displays all the classes in the projects by using the IProject.
+/// The classes and namespaces are kept in a @ref ClassIndex which is updated as files
+/// get parsed, nodes are only created for the namespaces that get expanded.
 class AllClassesFolder
-    : public DocumentClassesFolder
+    : public QObject
+    , public DynamicFolderNode
 {
     Q_OBJECT
 
 public:
     explicit AllClassesFolder(NodesModelInterface* a_model);
+    ~AllClassesFolder() override;
+
+public: // Operations
+    /// Find a class node by its id, populating the namespaces leading to it.
+    /// @return the node pointer or 0 if non was found.
+    ClassNode* findClassNode(const KDevelop::IndexedQualifiedIdentifier& a_id);
 
 public: // Node overrides
-    void nodeCleared() override;
     void populateNode() override;
+    bool hasChildren() const override { return true; }
+
+protected: // Overridables
+    /// Override this to filter the displayed classes.
+    virtual bool isClassFiltered(const KDevelop::IndexedQualifiedIdentifier&) const { return false; }
+
+    /// Override this to hide namespaces, e.g. those without any displayed class.
+    virtual bool isNamespaceFiltered(const KDevelop::IndexedQualifiedIdentifier&) const { return false; }
+
+    /// Called after the index was updated, before the displayed nodes are.
+    virtual void indexChanged() {}
+
+protected:
+    /// The index of all classes in the open projects.
+    const ClassIndex& classIndex() const { return m_index; }
+
+    /// Build the index if that didn't happen yet.
+    void ensureIndexed();
 
 private Q_SLOTS:
     // Project watching
     void projectOpened(KDevelop::IProject* project);
     void projectClosing(KDevelop::IProject* project);
+
+    // Files update.
+    void updateReady(const KDevelop::IndexedString& a_file, const KDevelop::ReferencedTopDUContext& a_topContext);
+    void updateChangedFiles();
+
+private:
+    friend class IndexedNamespaceFolderNode;
+
+    /// Add the displayed children of @p a_namespace to @p a_node.
+    void populateNamespace(Node* a_node, const KDevelop::IndexedQualifiedIdentifier& a_namespace);
+
+    /// Bring the children of the populated node of @p a_namespace in line with the index.
+    /// @return true if something was added or removed.
+    bool syncNamespace(const KDevelop::IndexedQualifiedIdentifier& a_namespace);
+
+    /// Return true if @p a_namespace has any displayed child.
+    bool namespaceHasChildren(const KDevelop::IndexedQualifiedIdentifier& a_namespace) const;
+
+    /// Create the node for the class @p a_id, 0 if its declaration isn't available.
+    /// @note DU CHAIN MUST BE LOCKED FOR READ
+    ClassNode* createClassNode(const KDevelop::IndexedQualifiedIdentifier& a_id);
+
+    /// Update the displayed nodes after the contents of @p a_changedNamespaces changed in the index.
+    void applyChanges(const ClassIndex::IdentifierSet& a_changedNamespaces);
+
+    ClassIndex m_index;
+    bool m_indexed = false;
+
+    /// The namespace folders which currently exist, registered by the nodes themselves.
+    QHash<KDevelop::IndexedQualifiedIdentifier, IndexedNamespaceFolderNode*> m_namespaceNodes;
+
+    /// List of updated files we check this list when update timer expires.
+    QSet<KDevelop::IndexedString> m_updatedFiles;
+
+    /// Timer for batch updates.
+    QTimer* m_updateTimer;
 };
 
 /// Contains a filter for the all classes folder.
@@ -62,12 +130,21 @@ public: // Operations.
     /// Call this to update the classes filter string.
     void updateFilterString(const QString& a_newFilterString);
 
-private: // DocumentClassesFolder overrides
-    bool isClassFiltered(const KDevelop::QualifiedIdentifier& a_id) override;
+private: // AllClassesFolder overrides
+    bool isClassFiltered(const KDevelop::IndexedQualifiedIdentifier& a_id) const override;
+    bool isNamespaceFiltered(const KDevelop::IndexedQualifiedIdentifier& a_id) const override;
+    void indexChanged() override;
 
 private:
-    /// We'll use this string to display only classes that match this string.
+    /// Look up the classes matching the filter in the index.
+    void updateMatches();
+
+    /// We'll use this string to display only classes whose name contains it.
     QString m_filterString;
+
+    /// The classes matching the filter and the namespaces leading to them.
+    ClassIndex::IdentifierSet m_matchingClasses;
+    ClassIndex::IdentifierSet m_matchingNamespaces;
 };
 } // namespace ClassModelNodes
 
@@ -0,0 +1,260 @@
+/*
+ * KDevelop Class Browser
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "classindex.h"
+
+#include "../duchain/codemodel.h"
+#include "../duchain/declaration.h"
+#include "../duchain/duchain.h"
+#include "../duchain/duchainlock.h"
+#include "../duchain/persistentsymboltable.h"
+
+using namespace KDevelop;
+using namespace ClassModelNodes;
+
+namespace {
+QString nameKey(const IndexedQualifiedIdentifier& a_id)
+{
+    return a_id.identifier().last().toString().toLower();
+}
+
+/// Insert @p a_id and all its parents into @p a_namespaces.
+void insertNamespacePath(ClassIndex::IdentifierSet& a_namespaces, QualifiedIdentifier a_id)
+{
+    while (a_id.count() > 0) {
+        a_namespaces.insert(a_id);
+        a_id = a_id.left(-1);
+    }
+}
+}
+
+IndexedQualifiedIdentifier ClassIndex::parentIdentifier(const QualifiedIdentifier& a_id)
+{
+    if (a_id.count() > 1)
+        return IndexedQualifiedIdentifier(a_id.left(-1));
+    return IndexedQualifiedIdentifier();
+}
+
+ClassIndex::IdentifierSet ClassIndex::updateFile(const IndexedString& a_file)
+{
+    uint codeModelItemCount = 0;
+    const CodeModelItem* codeModelItems;
+    CodeModel::self().items(a_file, codeModelItemCount, codeModelItems);
+
+    FileEntry entry;
+    for (uint codeModelItemIndex = 0; codeModelItemIndex < codeModelItemCount; ++codeModelItemIndex) {
+        const CodeModelItem& item = codeModelItems[codeModelItemIndex];
+
+        // Don't insert unknown or forward declarations into the class browser
+        if (item.kind == CodeModelItem::Unknown || (item.kind & CodeModelItem::ForwardDeclaration))
+            continue;
+
+        const QualifiedIdentifier id = item.id.identifier();
+        if (id.count() == 0)
+            continue;
+
+        if (item.kind & CodeModelItem::Namespace) {
+            insertNamespacePath(entry.namespaces, id);
+        } else if (item.kind & CodeModelItem::Class) {
+            // Ignore empty unnamed classes.
+            if (id.last().toString().isEmpty())
+                continue;
+
+            entry.classes.insert(item.id);
+        }
+    }
+
+    // A class might still be declared in a namespace which isn't declared in this file,
+    // otherwise we assume the parent is a class which shows it once expanded.
+    QVector<IndexedQualifiedIdentifier> unknownParents;
+    for (const IndexedQualifiedIdentifier& classId : qAsConst(entry.classes)) {
+        const QualifiedIdentifier id = classId.identifier();
+        if (id.count() < 2)
+            continue;
+
+        const IndexedQualifiedIdentifier parent = parentIdentifier(id);
+        if (entry.namespaces.contains(parent))
+            continue;
+
+        // Keep a namespace declared by another file alive as long as this file has classes in it.
+        if (m_namespaceFiles.contains(parent))
+            insertNamespacePath(entry.namespaces, parent.identifier());
+        else
+            unknownParents.append(parent);
+    }
+    if (!unknownParents.isEmpty()) {
+        DUChainReadLocker readLock(DUChain::lock());
+        for (const IndexedQualifiedIdentifier& parent : qAsConst(unknownParents)) {
+            if (isExternalNamespace(parent))
+                insertNamespacePath(entry.namespaces, parent.identifier());
+        }
+    }
+
+    IdentifierSet changed;
+    const auto oldEntry = m_files.constFind(a_file);
+    if (oldEntry != m_files.constEnd()) {
+        if (*oldEntry == entry)
+            return changed;
+        removeEntry(a_file, *oldEntry, changed);
+    }
+    addEntry(a_file, entry, changed);
+    m_files.insert(a_file, entry);
+
+    return changed;
+}
+
+ClassIndex::IdentifierSet ClassIndex::removeFile(const IndexedString& a_file)
+{
+    IdentifierSet changed;
+    const auto entry = m_files.constFind(a_file);
+    if (entry != m_files.constEnd()) {
+        removeEntry(a_file, *entry, changed);
+        m_files.erase(entry);
+    }
+    return changed;
+}
+
+void ClassIndex::clear()
+{
+    m_files.clear();
+    m_namespaceFiles.clear();
+    m_classFiles.clear();
+    m_childNamespaces.clear();
+    m_childClasses.clear();
+    m_classesByName.clear();
+    m_externalNamespaces.clear();
+}
+
+bool ClassIndex::isNamespace(const IndexedQualifiedIdentifier& a_id) const
+{
+    return m_namespaceFiles.contains(a_id);
+}
+
+ClassIndex::IdentifierSet ClassIndex::namespaces(const IndexedQualifiedIdentifier& a_parent) const
+{
+    return m_childNamespaces.value(a_parent);
+}
+
+ClassIndex::IdentifierSet ClassIndex::classes(const IndexedQualifiedIdentifier& a_parent) const
+{
+    return m_childClasses.value(a_parent);
+}
+
+QSet<IndexedString> ClassIndex::files(const IndexedQualifiedIdentifier& a_id) const
+{
+    return m_classFiles.value(a_id);
+}
+
+QVector<IndexedQualifiedIdentifier> ClassIndex::classesContaining(const QString& a_filter) const
+{
+    const QString key = a_filter.toLower();
+
+    // Only the names are compared, that is cheap compared to creating the nodes
+    QVector<IndexedQualifiedIdentifier> result;
+    for (auto it = m_classesByName.constBegin(); it != m_classesByName.constEnd(); ++it) {
+        if (it.key().contains(key))
+            result.append(it.value());
+    }
+    return result;
+}
+
+bool ClassIndex::isExternalNamespace(const IndexedQualifiedIdentifier& a_id)
+{
+    uint declsCount = 0;
+    const IndexedDeclaration* decls;
+    PersistentSymbolTable::self().declarations(a_id, declsCount, decls);
+    const IndexedDeclaration firstDecl = declsCount ? decls[0] : IndexedDeclaration();
+
+    // Resolving the declarations may load top-contexts, so only do it again when they changed
+    const auto cached = m_externalNamespaces.constFind(a_id);
+    if (cached != m_externalNamespaces.constEnd() && cached->declarationCount == declsCount
+        && cached->firstDeclaration == firstDecl)
+        return cached->isNamespace;
+
+    bool isNamespace = false;
+    for (uint i = 0; i < declsCount; ++i) {
+        // Look for the first valid declaration.
+        if (Declaration* decl = decls[i].declaration()) {
+            isNamespace = decl->kind() == Declaration::Namespace;
+            break;
+        }
+    }
+
+    m_externalNamespaces.insert(a_id, {declsCount, firstDecl, isNamespace});
+    return isNamespace;
+}
+
+void ClassIndex::addEntry(const IndexedString& a_file, const FileEntry& a_entry, IdentifierSet& a_changed)
+{
+    for (const IndexedQualifiedIdentifier& id : a_entry.namespaces) {
+        if (m_namespaceFiles[id]++ == 0) {
+            const IndexedQualifiedIdentifier parent = parentIdentifier(id.identifier());
+            m_childNamespaces[parent].insert(id);
+            a_changed.insert(parent);
+        }
+    }
+
+    for (const IndexedQualifiedIdentifier& id : a_entry.classes) {
+        auto& files = m_classFiles[id];
+        if (files.isEmpty()) {
+            const IndexedQualifiedIdentifier parent = parentIdentifier(id.identifier());
+            m_childClasses[parent].insert(id);
+            m_classesByName.insert(nameKey(id), id);
+            a_changed.insert(parent);
+        }
+        files.insert(a_file);
+    }
+}
+
+void ClassIndex::removeEntry(const IndexedString& a_file, const FileEntry& a_entry, IdentifierSet& a_changed)
+{
+    auto removeChild = [&a_changed](QHash<IndexedQualifiedIdentifier, IdentifierSet>& a_children,
+                                    const IndexedQualifiedIdentifier& a_id) {
+        const IndexedQualifiedIdentifier parent = parentIdentifier(a_id.identifier());
+        auto it = a_children.find(parent);
+        if (it != a_children.end()) {
+            it->remove(a_id);
+            if (it->isEmpty())
+                a_children.erase(it);
+        }
+        a_changed.insert(parent);
+    };
+
+    for (const IndexedQualifiedIdentifier& id : a_entry.namespaces) {
+        auto it = m_namespaceFiles.find(id);
+        if (it != m_namespaceFiles.end() && --(*it) == 0) {
+            m_namespaceFiles.erase(it);
+            removeChild(m_childNamespaces, id);
+        }
+    }
+
+    for (const IndexedQualifiedIdentifier& id : a_entry.classes) {
+        auto it = m_classFiles.find(id);
+        if (it == m_classFiles.end())
+            continue;
+        it->remove(a_file);
+        if (it->isEmpty()) {
+            m_classFiles.erase(it);
+            m_classesByName.remove(nameKey(id), id);
+            removeChild(m_childClasses, id);
+        }
+    }
+}
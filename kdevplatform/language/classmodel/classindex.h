@@ -0,0 +1,127 @@
+/*
+ * KDevelop Class Browser
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_CLASSINDEX_H
+#define KDEVPLATFORM_CLASSINDEX_H
+
+#include "../duchain/identifier.h"
+#include "../duchain/indexeddeclaration.h"
+
+#include <language/languageexport.h>
+#include <serialization/indexedstring.h>
+
+#include <QHash>
+#include <QMultiMap>
+#include <QSet>
+#include <QVector>
+
+namespace ClassModelNodes {
+/// Namespace and class index of a set of files, read from the persistent code model.
+///
+/// The index answers "what is declared directly in this namespace" and "which classes
+/// contain this name" without walking all the files, so the class browser only
+/// has to create nodes for what is actually visible.
+/// The global namespace is represented by an empty identifier.
+class KDEVPLATFORMLANGUAGE_EXPORT ClassIndex
+{
+public:
+    using IdentifierSet = QSet<KDevelop::IndexedQualifiedIdentifier>;
+
+    /// (Re-)read the code model items of @p a_file.
+    /// @return the namespaces whose direct children changed.
+    IdentifierSet updateFile(const KDevelop::IndexedString& a_file);
+
+    /// Forget everything declared in @p a_file.
+    /// @return the namespaces whose direct children changed.
+    IdentifierSet removeFile(const KDevelop::IndexedString& a_file);
+
+    /// Forget everything.
+    void clear();
+
+    /// Return true if @p a_file was added by updateFile().
+    bool containsFile(const KDevelop::IndexedString& a_file) const { return m_files.contains(a_file); }
+
+    /// Return true if @p a_id is a namespace declared (or implied) by the indexed files.
+    bool isNamespace(const KDevelop::IndexedQualifiedIdentifier& a_id) const;
+
+    /// Return the namespaces declared directly within @p a_parent.
+    IdentifierSet namespaces(const KDevelop::IndexedQualifiedIdentifier& a_parent) const;
+
+    /// Return the classes declared directly within @p a_parent.
+    IdentifierSet classes(const KDevelop::IndexedQualifiedIdentifier& a_parent) const;
+
+    /// Return the indexed files declaring the class @p a_id.
+    QSet<KDevelop::IndexedString> files(const KDevelop::IndexedQualifiedIdentifier& a_id) const;
+
+    /// Return the classes whose unqualified name contains @p a_filter, ignoring case.
+    QVector<KDevelop::IndexedQualifiedIdentifier> classesContaining(const QString& a_filter) const;
+
+    /// Return the parent of @p a_id, the empty identifier for top level items.
+    static KDevelop::IndexedQualifiedIdentifier parentIdentifier(const KDevelop::QualifiedIdentifier& a_id);
+
+private:
+    struct FileEntry
+    {
+        /// Declared namespaces including all their parent namespaces.
+        IdentifierSet namespaces;
+        IdentifierSet classes;
+
+        bool operator==(const FileEntry& a_other) const
+        {
+            return namespaces == a_other.namespaces && classes == a_other.classes;
+        }
+    };
+
+    struct ExternalNamespace
+    {
+        /// The declarations of the symbol table the result was computed from.
+        uint declarationCount;
+        KDevelop::IndexedDeclaration firstDeclaration;
+        bool isNamespace;
+    };
+
+    /// Return true if the persistent symbol table knows @p a_id as a namespace.
+    /// @note DU CHAIN MUST BE LOCKED FOR READ
+    bool isExternalNamespace(const KDevelop::IndexedQualifiedIdentifier& a_id);
+
+    void addEntry(const KDevelop::IndexedString& a_file, const FileEntry& a_entry, IdentifierSet& a_changed);
+    void removeEntry(const KDevelop::IndexedString& a_file, const FileEntry& a_entry, IdentifierSet& a_changed);
+
+    QHash<KDevelop::IndexedString, FileEntry> m_files;
+
+    /// Number of files declaring each namespace.
+    QHash<KDevelop::IndexedQualifiedIdentifier, int> m_namespaceFiles;
+    /// Files declaring each class.
+    QHash<KDevelop::IndexedQualifiedIdentifier, QSet<KDevelop::IndexedString>> m_classFiles;
+
+    QHash<KDevelop::IndexedQualifiedIdentifier, IdentifierSet> m_childNamespaces;
+    QHash<KDevelop::IndexedQualifiedIdentifier, IdentifierSet> m_childClasses;
+
+    /// By the lower case unqualified class name, for the filter.
+    QMultiMap<QString, KDevelop::IndexedQualifiedIdentifier> m_classesByName;
+
+    /// Parents of classes which aren't declared as namespace by any indexed file,
+    /// resolved through the persistent symbol table as long as their declarations don't change.
+    QHash<KDevelop::IndexedQualifiedIdentifier, ExternalNamespace> m_externalNamespaces;
+};
+} // namespace ClassModelNodes
+
+#endif // KDEVPLATFORM_CLASSINDEX_H
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+
+#include <language/classmodel/classindex.h>
+#include <language/duchain/codemodel.h>
+#include <language/duchain/declaration.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/persistentsymboltable.h>
+#include <language/duchain/topducontext.h>
+
+using namespace KDevelop;
+using namespace ClassModelNodes;
+
+namespace {
+IndexedQualifiedIdentifier id(const QString& a_id)
+{
+    return IndexedQualifiedIdentifier(QualifiedIdentifier(a_id));
+}
+
+ClassIndex::IdentifierSet ids(const QStringList& a_ids)
+{
+    ClassIndex::IdentifierSet ret;
+    for (const QString& item : a_ids) {
+        ret.insert(id(item));
+    }
+    return ret;
+}
+
+void addItem(const IndexedString& a_file, const QString& a_id, CodeModelItem::Kind a_kind)
+{
+    CodeModel::self().addItem(a_file, id(a_id), a_kind);
+}
+}
+
+class TestClassIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testNamespaces();
+    void testUpdateAndRemove();
+    void testClassesContaining();
+    void testExternalNamespace();
+};
+
+void TestClassIndex::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    DUChain::self()->disablePersistentStorage();
+}
+
+void TestClassIndex::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void TestClassIndex::testNamespaces()
+{
+    const IndexedString file(QStringLiteral("/test/namespaces.h"));
+    addItem(file, QStringLiteral("outer::inner"), CodeModelItem::Namespace);
+    addItem(file, QStringLiteral("outer::inner::Foo"), CodeModelItem::Class);
+    addItem(file, QStringLiteral("Bar"), CodeModelItem::Class);
+    addItem(file, QStringLiteral("Forward"), static_cast<CodeModelItem::Kind>(CodeModelItem::Class | CodeModelItem::ForwardDeclaration));
+    addItem(file, QStringLiteral("function"), CodeModelItem::Function);
+
+    ClassIndex index;
+    const auto changed = index.updateFile(file);
+    QVERIFY(index.containsFile(file));
+    QVERIFY(changed.contains(IndexedQualifiedIdentifier()));
+
+    // the parent namespaces are implied
+    QVERIFY(index.isNamespace(id(QStringLiteral("outer"))));
+    QVERIFY(index.isNamespace(id(QStringLiteral("outer::inner"))));
+    QCOMPARE(index.namespaces(IndexedQualifiedIdentifier()), ids({QStringLiteral("outer")}));
+    QCOMPARE(index.namespaces(id(QStringLiteral("outer"))), ids({QStringLiteral("outer::inner")}));
+
+    // forward declarations and functions are no classes
+    QCOMPARE(index.classes(IndexedQualifiedIdentifier()), ids({QStringLiteral("Bar")}));
+    QCOMPARE(index.classes(id(QStringLiteral("outer::inner"))), ids({QStringLiteral("outer::inner::Foo")}));
+    QCOMPARE(index.files(id(QStringLiteral("Bar"))), QSet<IndexedString>{file});
+}
+
+void TestClassIndex::testUpdateAndRemove()
+{
+    const IndexedString first(QStringLiteral("/test/first.h"));
+    const IndexedString second(QStringLiteral("/test/second.h"));
+    addItem(first, QStringLiteral("ns"), CodeModelItem::Namespace);
+    addItem(first, QStringLiteral("ns::A"), CodeModelItem::Class);
+    addItem(second, QStringLiteral("ns"), CodeModelItem::Namespace);
+    addItem(second, QStringLiteral("ns::A"), CodeModelItem::Class);
+    addItem(second, QStringLiteral("ns::B"), CodeModelItem::Class);
+
+    ClassIndex index;
+    index.updateFile(first);
+    index.updateFile(second);
+    QCOMPARE(index.classes(id(QStringLiteral("ns"))), ids({QStringLiteral("ns::A"), QStringLiteral("ns::B")}));
+    QCOMPARE(index.files(id(QStringLiteral("ns::A"))), (QSet<IndexedString>{first, second}));
+
+    // updating without changes doesn't report anything
+    QVERIFY(index.updateFile(first).isEmpty());
+
+    CodeModel::self().removeItem(second, id(QStringLiteral("ns::B")));
+    QCOMPARE(index.updateFile(second), ids({QStringLiteral("ns")}));
+    QCOMPARE(index.classes(id(QStringLiteral("ns"))), ids({QStringLiteral("ns::A")}));
+
+    // the namespace stays while another file declares it
+    index.removeFile(second);
+    QVERIFY(!index.containsFile(second));
+    QVERIFY(index.isNamespace(id(QStringLiteral("ns"))));
+    QCOMPARE(index.files(id(QStringLiteral("ns::A"))), QSet<IndexedString>{first});
+
+    const auto changed = index.removeFile(first);
+    QVERIFY(changed.contains(IndexedQualifiedIdentifier()));
+    QVERIFY(!index.isNamespace(id(QStringLiteral("ns"))));
+    QVERIFY(index.namespaces(IndexedQualifiedIdentifier()).isEmpty());
+    QVERIFY(index.files(id(QStringLiteral("ns::A"))).isEmpty());
+}
+
+void TestClassIndex::testClassesContaining()
+{
+    const IndexedString file(QStringLiteral("/test/filter.h"));
+    addItem(file, QStringLiteral("ns"), CodeModelItem::Namespace);
+    addItem(file, QStringLiteral("ns::ProjectModel"), CodeModelItem::Class);
+    addItem(file, QStringLiteral("ModelTest"), CodeModelItem::Class);
+    addItem(file, QStringLiteral("Other"), CodeModelItem::Class);
+
+    ClassIndex index;
+    index.updateFile(file);
+
+    // like the project filter, any part of the unqualified name matches, ignoring case
+    QCOMPARE(index.classesContaining(QStringLiteral("model")),
+             (QVector<IndexedQualifiedIdentifier>{id(QStringLiteral("ModelTest")), id(QStringLiteral("ns::ProjectModel"))}));
+    QVERIFY(index.classesContaining(QStringLiteral("ns")).isEmpty());
+    QCOMPARE(index.classesContaining(QString()).size(), 3);
+}
+
+void TestClassIndex::testExternalNamespace()
+{
+    const IndexedString file(QStringLiteral("/test/external.h"));
+    addItem(file, QStringLiteral("ext::Foo"), CodeModelItem::Class);
+
+    ClassIndex index;
+    index.updateFile(file);
+    // without a declaration, the parent is assumed to be a class
+    QVERIFY(!index.isNamespace(id(QStringLiteral("ext"))));
+
+    // the namespace gets declared in a file which isn't indexed
+    const IndexedString otherUrl(QStringLiteral("/test/other.h"));
+    ReferencedTopDUContext top;
+    IndexedDeclaration namespaceDeclaration;
+    {
+        DUChainWriteLocker lock;
+        top = new TopDUContext(otherUrl, {0, 0, 10, 0});
+        DUChain::self()->addDocumentChain(top);
+        auto* declaration = new Declaration({0, 10, 0, 13}, top);
+        declaration->setIdentifier(Identifier(QStringLiteral("ext")));
+        declaration->setKind(Declaration::Namespace);
+        namespaceDeclaration = IndexedDeclaration(declaration);
+        PersistentSymbolTable::self().addDeclaration(id(QStringLiteral("ext")), namespaceDeclaration);
+    }
+
+    QCOMPARE(index.updateFile(file), (ClassIndex::IdentifierSet{IndexedQualifiedIdentifier(), id(QStringLiteral("ext"))}));
+    QVERIFY(index.isNamespace(id(QStringLiteral("ext"))));
+    QCOMPARE(index.classes(id(QStringLiteral("ext"))), ids({QStringLiteral("ext::Foo")}));
+
+    DUChainWriteLocker lock;
+    PersistentSymbolTable::self().removeDeclaration(id(QStringLiteral("ext")), namespaceDeclaration);
+    DUChain::self()->removeDocumentChain(top);
+}
+
+QTEST_GUILESS_MAIN(TestClassIndex)
+
+#include "test_classindex.moc"
@@ -124,7 +124,7 @@ QString NormalDeclarationCompletionItem::shortenedTypeString(const KDevelop::Dec
                                                              int desiredTypeLength) const
 {
     Q_UNUSED(desiredTypeLength);
-    return decl->abstractType()->toString();
+    return decl->indexedType().constAbstractType()->toString();
 }
 
 void NormalDeclarationCompletionItem::executed(KTextEditor::View* view, const KTextEditor::Range& word)
@@ -150,7 +150,7 @@ QVariant NormalDeclarationCompletionItem::data(const QModelIndex& index, int rol
         if (index.column() == CodeCompletionModel::Name) {
             return declarationName();
         } else if (index.column() == CodeCompletionModel::Postfix) {
-            if (FunctionType::Ptr functionType = m_declaration->type<FunctionType>()) {
+            if (const auto functionType = m_declaration->indexedType().constType<FunctionType>()) {
                 // Retrieve const/volatile string
                 return functionType->AbstractType::toString();
             }
@@ -364,6 +364,10 @@ DocumentChangeSet BasicRefactoring::renameCollectedDeclarations(KDevelop::BasicR
 
     ///We have to ignore failed changes for now, since uses of a constructor or of operator() may be created on "(" parens
     changes.setReplacementPolicy(DocumentChangeSet::IgnoreFailedChange);
+    // renaming may touch a huge number of files, which don't need to be loaded into the editor for that,
+    // and a replaced identifier never needs to be formatted
+    changes.setFileAccessPolicy(DocumentChangeSet::BulkFileAccess);
+    changes.setFormatPolicy(DocumentChangeSet::NoAutoFormat);
 
     if (!apply) {
         return changes;
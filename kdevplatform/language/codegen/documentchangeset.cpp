@@ -23,8 +23,12 @@
 
 #include <algorithm>
 
-#include <QStringList>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QMimeDatabase>
+#include <QSaveFile>
+#include <QStringList>
+#include <QtConcurrentMap>
 
 #include <KLocalizedString>
 
@@ -53,6 +57,17 @@ namespace KDevelop {
 using ChangesList = QList<DocumentChangePointer>;
 using ChangesHash = QHash<IndexedString, ChangesList>;
 
+///A file changed directly on disk with DocumentChangeSet::BulkFileAccess
+struct BulkFile
+{
+    IndexedString file;
+    ChangesList sortedChanges;
+    QString oldText;
+    QString newText;
+    DocumentChangeSet::ChangeResult result = DocumentChangeSet::ChangeResult::successfulResult();
+    bool written = false;
+};
+
 class DocumentChangeSetPrivate
 {
 public:
@@ -60,6 +75,7 @@ public:
     DocumentChangeSet::FormatPolicy formatPolicy;
     DocumentChangeSet::DUChainUpdateHandling updatePolicy;
     DocumentChangeSet::ActivationPolicy activationPolicy;
+    DocumentChangeSet::FileAccessPolicy fileAccessPolicy;
 
     ChangesHash changes;
     QHash<IndexedString, IndexedString> documentsRename;
@@ -69,8 +85,12 @@ public:
                                                    const ChangesList& sortedChangesList);
     DocumentChangeSet::ChangeResult generateNewText(const IndexedString& file,
                                                     ChangesList& sortedChanges,
-                                                    const CodeRepresentation* repr,
-                                                    QString& output);
+                                                    const QString& text,
+                                                    ISourceFormatter* formatter,
+                                                    QString& output) const;
+    ISourceFormatter* formatterForFile(const IndexedString& file) const;
+    bool canChangeDirectly(const IndexedString& file) const;
+    void generateBulkTexts(QVector<BulkFile>& bulkFiles) const;
     DocumentChangeSet::ChangeResult removeDuplicates(const IndexedString& file,
                                                      ChangesList& filteredChanges);
     void formatChanges();
@@ -127,6 +147,37 @@ static QString printRange(const KTextEditor::Range& r)
                  r.start().line(), r.start().column(),
                  r.end().line(), r.end().column());
 }
+
+// same encoding as used by the code representation for files on disk
+bool readFile(const IndexedString& file, QString* text)
+{
+    QFile input(file.toUrl().toLocalFile());
+    if (!input.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = input.size();
+    if (size == 0) {
+        text->clear();
+        return true;
+    }
+    if (uchar* data = input.map(0, size)) {
+        *text = QString::fromLocal8Bit(reinterpret_cast<const char*>(data), size);
+        input.unmap(data);
+    } else {
+        *text = QString::fromLocal8Bit(input.readAll());
+    }
+    return true;
+}
+
+bool writeFile(const IndexedString& file, const QString& text)
+{
+    QSaveFile output(file.toUrl().toLocalFile());
+    if (!output.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    output.write(text.toLocal8Bit());
+    return output.commit();
+}
 }
 
 DocumentChangeSet::DocumentChangeSet()
@@ -138,6 +189,7 @@ DocumentChangeSet::DocumentChangeSet()
     d->formatPolicy = AutoFormatChanges;
     d->updatePolicy = SimpleUpdate;
     d->activationPolicy = DoNotActivate;
+    d->fileAccessPolicy = UseCodeRepresentations;
 }
 
 DocumentChangeSet::DocumentChangeSet(const DocumentChangeSet& rhs)
@@ -210,6 +262,13 @@ void DocumentChangeSet::setActivationPolicy(DocumentChangeSet::ActivationPolicy
     d->activationPolicy = policy;
 }
 
+void DocumentChangeSet::setFileAccessPolicy(DocumentChangeSet::FileAccessPolicy policy)
+{
+    Q_D(DocumentChangeSet);
+
+    d->fileAccessPolicy = policy;
+}
+
 DocumentChangeSet::ChangeResult DocumentChangeSet::applyAllChanges()
 {
     Q_D(DocumentChangeSet);
@@ -285,9 +344,26 @@ DocumentChangeSet::ChangeResult DocumentChangeSet::applyAllChanges()
     ChangesHash filteredSortedChanges;
     ChangeResult result = ChangeResult::successfulResult();
 
-    const QList<IndexedString> files(d->changes.keys());
+    QElapsedTimer timer;
+    timer.start();
+
+    const QList<IndexedString> allFilesToChange(d->changes.keys());
+    QList<IndexedString> files;
+    QVector<BulkFile> bulkFiles;
+    for (const IndexedString& file : allFilesToChange) {
+        if (d->fileAccessPolicy == BulkFileAccess && d->canChangeDirectly(file)) {
+            BulkFile bulkFile;
+            bulkFile.file = file;
+            result = d->removeDuplicates(file, bulkFile.sortedChanges);
+            if (!result)
+                return result;
+            bulkFiles.append(bulkFile);
+        } else {
+            files << file;
+        }
+    }
 
-    for (const IndexedString& file : files) {
+    for (const IndexedString& file : qAsConst(files)) {
         CodeRepresentation::Ptr repr = createCodeRepresentation(file);
         if (!repr) {
             return ChangeResult(QStringLiteral("Could not create a Representation for %1").arg(file.str()));
@@ -303,33 +379,73 @@ DocumentChangeSet::ChangeResult DocumentChangeSet::applyAllChanges()
         }
 
         {
-            result = d->generateNewText(file, sortedChangesList, repr.data(), newTexts[file]);
+            result = d->generateNewText(file, sortedChangesList, repr->text(), d->formatterForFile(file), newTexts[file]);
             if (!result)
                 return result;
         }
     }
 
+    d->generateBulkTexts(bulkFiles);
+    for (const BulkFile& bulkFile : qAsConst(bulkFiles)) {
+        if (!bulkFile.result)
+            return bulkFile.result;
+    }
+
+    const qint64 generateTime = timer.restart();
+
     QMap<IndexedString, QString> oldTexts;
 
+    auto revertAll = [&]() {
+        for (auto it = oldTexts.constBegin(), end = oldTexts.constEnd(); it != end; ++it) {
+            const IndexedString& revertFile = it.key();
+            const QString& oldText = it.value();
+            codeRepresentations[revertFile]->setText(oldText);
+        }
+        QtConcurrent::blockingMap(bulkFiles, [](BulkFile& bulkFile) {
+            if (bulkFile.written && bulkFile.newText != bulkFile.oldText) {
+                writeFile(bulkFile.file, bulkFile.oldText);
+            }
+        });
+    };
+
     //Apply the changes to the files
-    for (const IndexedString& file : files) {
+    for (const IndexedString& file : qAsConst(files)) {
         oldTexts[file] = codeRepresentations[file]->text();
 
         result = d->replaceOldText(codeRepresentations[file].data(), newTexts[file], filteredSortedChanges[file]);
         if (!result && d->replacePolicy == StopOnFailedChange) {
             //Revert all files
-            for (auto it = oldTexts.constBegin(), end = oldTexts.constEnd(); it != end; ++it) {
-                const IndexedString& revertFile = it.key();
-                const QString& oldText = it.value();
-                codeRepresentations[revertFile]->setText(oldText);
-            }
-
+            revertAll();
             return result;
         }
     }
 
+    QtConcurrent::blockingMap(bulkFiles, [](BulkFile& bulkFile) {
+        bulkFile.written = bulkFile.newText == bulkFile.oldText || writeFile(bulkFile.file, bulkFile.newText);
+    });
+    for (const BulkFile& bulkFile : qAsConst(bulkFiles)) {
+        if (bulkFile.written)
+            continue;
+
+        const QString warningString = i18n("Could not replace text in the document: %1", bulkFile.file.str());
+        if (d->replacePolicy == StopOnFailedChange) {
+            revertAll();
+            return ChangeResult(warningString);
+        }
+        if (d->replacePolicy == WarnOnFailedChange) {
+            qCWarning(LANGUAGE) << warningString;
+        }
+        result = ChangeResult(warningString);
+    }
+
+    const qint64 writeTime = timer.restart();
+
     d->updateFiles();
 
+    qCDebug(LANGUAGE) << "changed" << allFilesToChange.size() << "files," << bulkFiles.size() << "of them directly:"
+                      << "generating the new text took" << generateTime << "ms, writing" << writeTime
+                      << "ms, scheduling updates" << timer.elapsed() << "ms";
+
     if (d->activationPolicy == Activate) {
         for (const IndexedString& file : files) {
             ICore::self()->documentController()->openDocument(file.toUrl());
@@ -391,20 +507,50 @@ DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::replaceOldText(CodeRep
     return DocumentChangeSet::ChangeResult::successfulResult();
 }
 
+ISourceFormatter* DocumentChangeSetPrivate::formatterForFile(const IndexedString& file) const
+{
+    auto core = ICore::self();
+    if (!core || formatPolicy == DocumentChangeSet::NoAutoFormat) {
+        return nullptr;
+    }
+    const QUrl url = file.toUrl();
+    return core->sourceFormatterController()->formatterForUrl(url, QMimeDatabase().mimeTypeForUrl(url));
+}
+
+bool DocumentChangeSetPrivate::canChangeDirectly(const IndexedString& file) const
+{
+    const QUrl url = file.toUrl();
+    return url.isLocalFile() && !artificialCodeRepresentationExists(file)
+           && !ICore::self()->documentController()->documentForUrl(url)
+           && !formatterForFile(file);
+}
+
+void DocumentChangeSetPrivate::generateBulkTexts(QVector<BulkFile>& bulkFiles) const
+{
+    QtConcurrent::blockingMap(bulkFiles, [this](BulkFile& bulkFile) {
+        if (!readFile(bulkFile.file, &bulkFile.oldText)) {
+            bulkFile.result = DocumentChangeSet::ChangeResult(i18n("Could not read the document: %1",
+                                                                   bulkFile.file.str()));
+            return;
+        }
+        // no formatter, see canChangeDirectly(), so this is safe to be called from multiple threads
+        bulkFile.result = generateNewText(bulkFile.file, bulkFile.sortedChanges, bulkFile.oldText, nullptr,
+                                          bulkFile.newText);
+    });
+}
+
 DocumentChangeSet::ChangeResult DocumentChangeSetPrivate::generateNewText(const IndexedString& file,
                                                                           ChangesList& sortedChanges,
-                                                                          const CodeRepresentation* repr,
-                                                                          QString& output)
+                                                                          const QString& text,
+                                                                          ISourceFormatter* formatter,
+                                                                          QString& output) const
 {
     //Create the actual new modified file
-    QStringList textLines = repr->text().split(QLatin1Char('\n'));
+    QStringList textLines = text.split(QLatin1Char('\n'));
 
     QUrl url = file.toUrl();
 
-    QMimeType mime = QMimeDatabase().mimeTypeForUrl(url);
-
-    auto core = ICore::self();
-    ISourceFormatter* formatter = core ? core->sourceFormatterController()->formatterForUrl(file.toUrl(), mime) : nullptr;
+    const QMimeType mime = formatter ? QMimeDatabase().mimeTypeForUrl(url) : QMimeType();
 
     QVector<int> removedLines;
 
@@ -594,14 +740,19 @@ void DocumentChangeSetPrivate::updateFiles()
 
         // If there are currently open documents that now need an update, update them too
         const auto documents = ICore::self()->languageController()->backgroundParser()->managedDocuments();
-        for (const IndexedString& doc : documents) {
+        QVector<IndexedString> outdatedDocuments;
+        {
             DUChainReadLocker lock(DUChain::lock());
-            TopDUContext* top = DUChainUtils::standardContextForUrl(doc.toUrl(), true);
-            if ((top && top->parsingEnvironmentFile() && top->parsingEnvironmentFile()->needsUpdate()) || !top) {
-                lock.unlock();
-                ICore::self()->languageController()->backgroundParser()->addDocument(doc);
+            for (const IndexedString& doc : documents) {
+                TopDUContext* top = DUChainUtils::standardContextForUrl(doc.toUrl(), true);
+                if ((top && top->parsingEnvironmentFile() && top->parsingEnvironmentFile()->needsUpdate()) || !top) {
+                    outdatedDocuments << doc;
+                }
             }
         }
+        for (const IndexedString& doc : qAsConst(outdatedDocuments)) {
+            ICore::self()->languageController()->backgroundParser()->addDocument(doc);
+        }
 
         // Eventually update _all_ affected files
         const auto files = changes.keys();
@@ -145,6 +145,15 @@ private:
     ///@param policy Whether the affected documents should be activated when the change is applied
     void setActivationPolicy(ActivationPolicy policy);
 
+    enum FileAccessPolicy {
+        UseCodeRepresentations, ///All documents are changed one after the other through their code representation (default)
+        BulkFileAccess ///Files that are not open in an editor and need no formatting are read, changed and atomically
+                       ///written directly on disk in parallel. Use this for changes affecting a large number of files.
+    };
+
+    ///@param policy How the affected files should be accessed
+    void setFileAccessPolicy(FileAccessPolicy policy);
+
     /// Apply all the changes registered in this changeset to the actual files
     ChangeResult applyAllChanges();
 
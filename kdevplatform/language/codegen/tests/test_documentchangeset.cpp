@@ -72,3 +72,34 @@ void TestDocumentchangeset::testReplaceSameLine()
     QVERIFY(result);
 }
 
+void TestDocumentchangeset::testBulkFileAccess()
+{
+    TestFile first(QStringLiteral("int foo;\nint bar = foo;\n"), QStringLiteral("cpp"));
+    TestFile second(QStringLiteral("void f() {\n    foo = 1;\n}\n"), QStringLiteral("cpp"));
+
+    DocumentChangeSet changes;
+    changes.setFileAccessPolicy(DocumentChangeSet::BulkFileAccess);
+    changes.setFormatPolicy(DocumentChangeSet::NoAutoFormat);
+    changes.addChange(DocumentChange(first.url(), KTextEditor::Range(0, 4, 0, 7),
+                                     QStringLiteral("foo"), QStringLiteral("foobar")));
+    changes.addChange(DocumentChange(first.url(), KTextEditor::Range(1, 10, 1, 13),
+                                     QStringLiteral("foo"), QStringLiteral("foobar")));
+    changes.addChange(DocumentChange(second.url(), KTextEditor::Range(1, 4, 1, 7),
+                                     QStringLiteral("foo"), QStringLiteral("foobar")));
+
+    DocumentChangeSet::ChangeResult result = changes.applyAllChanges();
+    QVERIFY2(result, qPrintable(result.m_failureReason));
+    QCOMPARE(first.fileContents(), QStringLiteral("int foobar;\nint bar = foobar;\n"));
+    QCOMPARE(second.fileContents(), QStringLiteral("void f() {\n    foobar = 1;\n}\n"));
+
+    // a mismatching change stops everything, nothing is written
+    DocumentChangeSet failing;
+    failing.setFileAccessPolicy(DocumentChangeSet::BulkFileAccess);
+    failing.setFormatPolicy(DocumentChangeSet::NoAutoFormat);
+    failing.addChange(DocumentChange(first.url(), KTextEditor::Range(0, 4, 0, 10),
+                                     QStringLiteral("foobar"), QStringLiteral("baz")));
+    failing.addChange(DocumentChange(second.url(), KTextEditor::Range(0, 0, 0, 4),
+                                     QStringLiteral("int "), QStringLiteral("long ")));
+    QVERIFY(!failing.applyAllChanges());
+    QCOMPARE(first.fileContents(), QStringLiteral("int foobar;\nint bar = foobar;\n"));
+}
@@ -32,6 +32,7 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void testReplaceSameLine();
+    void testBulkFileAccess();
 };
 
 #endif // TESTDOCUMENTCHANGESET_H
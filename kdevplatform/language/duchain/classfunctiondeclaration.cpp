@@ -92,18 +92,19 @@ bool ClassFunctionDeclaration::isFunctionDeclaration() const
 
 QString ClassFunctionDeclaration::toString() const
 {
-    if (!abstractType())
+    const AbstractType::ConstPtr type = indexedType().constAbstractType();
+    if (!type)
         return ClassMemberDeclaration::toString();
 
-    TypePtr<FunctionType> function = type<FunctionType>();
+    const auto function = type.cast<const FunctionType>();
     if (function) {
         return QStringLiteral("%1 %2 %3").arg(function->partToString(FunctionType::SignatureReturn),
                                               identifier().toString(),
                                               function->partToString(FunctionType::SignatureArguments));
     } else {
-        QString type = abstractType() ? abstractType()->toString() : QStringLiteral("<notype>");
-        qCDebug(LANGUAGE) << "A function has a bad type attached:" << type;
-        return i18n("invalid member-function %1 type %2", identifier().toString(), type);
+        const QString typeString = type->toString();
+        qCDebug(LANGUAGE) << "A function has a bad type attached:" << typeString;
+        return i18n("invalid member-function %1 type %2", identifier().toString(), typeString);
     }
 }
 
@@ -207,8 +208,8 @@ bool ClassFunctionDeclaration::isDestructor() const
 
 uint ClassFunctionDeclaration::additionalIdentity() const
 {
-    if (abstractType())
-        return abstractType()->hash();
+    if (const AbstractType::ConstPtr type = indexedType().constAbstractType())
+        return type->hash();
     else
         return 0;
 }
@@ -465,7 +465,8 @@ bool Declaration::operator ==(const Declaration& other) const
 
 QString Declaration::toString() const
 {
-    return QStringLiteral("%3 %4").arg(abstractType() ? abstractType()->toString() : QStringLiteral(
+    const AbstractType::ConstPtr type = indexedType().constAbstractType();
+    return QStringLiteral("%3 %4").arg(type ? type->toString() : QStringLiteral(
                                            "<notype>"), identifier().toString());
 }
 
@@ -60,6 +60,9 @@
 #include "serialization/itemrepository.h"
 #include "waitforupdate.h"
 #include "importers.h"
+#include "types/typerepository.h"
+
+#include <algorithm>
 
 #if HAVE_MALLOC_TRIM
 #include "malloc.h"
@@ -76,6 +79,9 @@ const int SOFT_CLEANUP_STEPS = 1;
 // seconds to wait before trying to cleanup the DUChain
 const uint cleanupEverySeconds = 200;
 
+// seconds to wait before checking whether the loaded top-contexts exceed the memory budget
+const uint memoryCheckEverySeconds = 10;
+
 ///Approximate maximum count of top-contexts that are checked during final cleanup
 const uint maxFinalCleanupCheckContexts = 2000;
 const uint minimumFinalCleanupCheckContextsPercentage = 10; //Check at least n% of all top-contexts during cleanup
@@ -89,6 +95,9 @@ bool DUChain::m_deleted = false;
 ///This lock should be locked only for very short times
 QMutex DUChain::chainsByIndexLock;
 std::vector<TopDUContext*> DUChain::chainsByIndex;
+std::vector<quint64> DUChain::lastAccessByIndex;
+quint64 DUChain::accessClock = 0;
+quint64 DUChain::chainHits = 0;
 
 //This thing is not actually used, but it's needed for compiling
 DEFINE_LIST_MEMBER_HASH(EnvironmentInformationListItem, items, uint)
@@ -328,6 +337,13 @@ private:
                     m_data->doMoreCleanup(SOFT_CLEANUP_STEPS, TryLock);
                 });
             timer.start(cleanupEverySeconds * 1000);
+
+            QTimer memoryTimer;
+            connect(&memoryTimer, &QTimer::timeout, &memoryTimer, [this]() {
+                    Q_ASSERT(QThread::currentThread() == this);
+                    m_data->checkMemoryBudget();
+                });
+            memoryTimer.start(memoryCheckEverySeconds * 1000);
             exec();
         }
         DUChainPrivate* m_data;
@@ -462,6 +478,139 @@ public:
         DUChain::chainsByIndex[index] = nullptr;
     }
 
+    ///Whether @p context is referenced, or imported by a referenced top-context
+    bool isReferenced(TopDUContext* context)
+    {
+        QMutexLocker l(&m_referenceCountsMutex);
+        for (auto it = m_referenceCounts.constBegin(), end = m_referenceCounts.constEnd(); it != end; ++it) {
+            auto* referenced = it.key();
+            if (referenced == context || referenced->imports(context, CursorInRevision()))
+                return true;
+        }
+
+        return false;
+    }
+
+    ///Estimated memory used by all loaded top-contexts
+    ///The duchain must be locked
+    qint64 loadedMemoryUsage()
+    {
+        QMutexLocker l(&m_chainsMutex);
+
+        qint64 ret = 0;
+        for (TopDUContext* top : qAsConst(m_chainsByUrl)) {
+            ret += top->m_dynamicData->memoryUsage();
+        }
+
+        return ret;
+    }
+
+    ///Reduces @p contexts to the least recently used ones that need to be unloaded to get within @p budget.
+    ///A context is only selected together with all its loaded importers, so unloading the selection
+    ///never leaves a loaded context with unloaded imports.
+    ///@p contexts must contain all loaded top-contexts, the duchain must be write-locked
+    void selectContextsOverBudget(QSet<TopDUContext*>& contexts, qint64 budget)
+    {
+        QHash<TopDUContext*, qint64> sizes;
+        sizes.reserve(contexts.size());
+        qint64 total = 0;
+        for (TopDUContext* top : qAsConst(contexts)) {
+            const qint64 size = top->m_dynamicData->memoryUsage();
+            sizes.insert(top, size);
+            total += size;
+        }
+
+        if (total <= budget) {
+            contexts.clear();
+            return;
+        }
+
+        QVector<QPair<quint64, TopDUContext*>> candidates;
+        candidates.reserve(contexts.size());
+        QSet<TopDUContext*> pinned;
+        {
+            QMutexLocker lock(&DUChain::chainsByIndexLock);
+            for (TopDUContext* top : qAsConst(contexts)) {
+                candidates.append(qMakePair(DUChain::lastAccessByIndex[top->ownIndex()], top));
+            }
+        }
+        for (TopDUContext* top : qAsConst(contexts)) {
+            if (isReferenced(top))
+                pinned.insert(top);
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+
+        QSet<TopDUContext*> selected;
+        for (const auto& candidate : qAsConst(candidates)) {
+            if (total <= budget)
+                break;
+
+            TopDUContext* top = candidate.second;
+            if (selected.contains(top) || pinned.contains(top))
+                continue;
+
+            // collect the context together with everything that imports it
+            QSet<TopDUContext*> closure;
+            QVector<TopDUContext*> queue{top};
+            bool isPinned = false;
+            while (!queue.isEmpty() && !isPinned) {
+                TopDUContext* current = queue.takeLast();
+                if (closure.contains(current) || selected.contains(current))
+                    continue;
+                if (pinned.contains(current) || !sizes.contains(current)) {
+                    isPinned = true;
+                    break;
+                }
+                closure.insert(current);
+                const auto importers = current->loadedImporters();
+                for (DUContext* importer : importers) {
+                    queue.append(importer->topContext());
+                }
+            }
+
+            if (isPinned)
+                continue;
+
+            for (TopDUContext* unload : qAsConst(closure)) {
+                total -= sizes[unload];
+                selected.insert(unload);
+            }
+        }
+
+        contexts = selected;
+    }
+
+    ///Starts a cleanup as soon as the loaded top-contexts exceed the memory budget
+    ///Called regularly by the cleanup thread
+    void checkMemoryBudget()
+    {
+        if (m_cleanupDisabled || m_destroyed)
+            return;
+
+        qint64 usage;
+        {
+            DUChainReadLocker lock(instance->lock());
+            usage = loadedMemoryUsage();
+        }
+
+        qint64 budget;
+        qint64 lastCleanup;
+        {
+            QMutexLocker l(&m_chainsMutex);
+            m_loadedBytes = usage;
+            budget = m_memoryBudget;
+            lastCleanup = m_lastBudgetCleanupBytes;
+        }
+
+        // Don't try again and again when the cleanup could not get below the budget,
+        // because everything left is referenced
+        if (budget > 0 && usage > budget && usage > lastCleanup + budget / 10) {
+            qCDebug(LANGUAGE) << "loaded top-contexts exceed the memory budget:" << usage << "of" << budget << "bytes";
+            doMoreCleanup(SOFT_CLEANUP_STEPS, TryLock);
+        }
+    }
+
     ///Must be locked before accessing content of this class.
     ///Should be released during expensive disk-operations and such.
     QMutex m_chainsMutex;
@@ -478,6 +627,18 @@ public:
     QMutex m_referenceCountsMutex;
     QHash<TopDUContext*, uint> m_referenceCounts;
 
+    //Memory budget and statistics, protected by m_chainsMutex
+    qint64 m_memoryBudget = 0;
+    qint64 m_loadedBytes = 0;
+    //Memory usage left after the last cleanup, to not retry a cleanup that can't get below the budget
+    qint64 m_lastBudgetCleanupBytes = 0;
+    quint64 m_loads = 0;
+    quint64 m_reloads = 0;
+    quint64 m_unloads = 0;
+    //Indices of the top-contexts unloaded by the cleanup, to count reloads
+    //Removed again when the top-context is reloaded or deleted
+    QSet<uint> m_unloadedIndices;
+
     Definitions m_definitions;
     Uses m_uses;
     QSet<uint> m_loading;
@@ -652,6 +813,11 @@ public:
 
             l.relock();
             m_loading.remove(index);
+            if (chain) {
+                ++m_loads;
+                if (m_unloadedIndices.remove(index))
+                    ++m_reloads;
+            }
         }
     }
 
@@ -835,6 +1001,15 @@ public:
         }
 
         //Unload all top-contexts that don't have a reference-count and that are not imported by a referenced one
+        //With a memory budget, only the least recently used ones that don't fit into it
+
+        qint64 budget;
+        {
+            QMutexLocker l(&m_chainsMutex);
+            budget = m_memoryBudget;
+        }
+        if (budget > 0)
+            selectContextsOverBudget(workOnContexts, budget);
 
         QSet<IndexedString> unloadedNames;
         bool unloadedOne = true;
@@ -853,25 +1028,13 @@ unloadContexts:
 
             const auto currentWorkOnContexts = workOnContexts;
             for (TopDUContext * unload : currentWorkOnContexts) {
-                bool hasReference = false;
-
-                {
-                    QMutexLocker l(&m_referenceCountsMutex);
-                    //Test if the context is imported by a referenced one
-                    for (auto it = m_referenceCounts.constBegin(), end = m_referenceCounts.constEnd(); it != end;
-                         ++it) {
-                        auto* context = it.key();
-                        if (context == unload || context->imports(unload, CursorInRevision())) {
-                            workOnContexts.remove(unload);
-                            hasReference = true;
-                        }
-                    }
+                //Test if the context is imported by a referenced one
+                if (isReferenced(unload)) {
+                    workOnContexts.remove(unload);
+                    continue; //This context is referenced
                 }
 
-                if (!hasReference)
-                    ++hadUnloadable; //We have found a context that is not referenced
-                else
-                    continue; //This context is referenced
+                ++hadUnloadable; //We have found a context that is not referenced
 
                 bool isImportedByLoaded = !unload->loadedImporters().isEmpty();
 
@@ -884,7 +1047,13 @@ unloadContexts:
                 //If nothing has changed, it is only a low-cost call.
                 unload->m_dynamicData->store();
                 Q_ASSERT(!unload->d_func()->m_dynamic);
+                const uint unloadIndex = unload->ownIndex();
                 removeDocumentChainFromMemory(unload);
+                {
+                    QMutexLocker l(&m_chainsMutex);
+                    m_unloadedIndices.insert(unloadIndex);
+                    ++m_unloads;
+                }
                 workOnContexts.remove(unload);
                 unloadedOne = true;
 
@@ -969,9 +1138,15 @@ unloadContexts:
         if (lockFlag != NoLock) {
             globalItemRepositoryRegistry().unlockForWriting();
 
+            const qint64 usage = loadedMemoryUsage();
+            QMutexLocker l(&m_chainsMutex);
+            m_loadedBytes = usage;
+            m_lastBudgetCleanupBytes = usage;
+
             const auto elapsedMS = startTime.msecsTo(QTime::currentTime());
             qCDebug(LANGUAGE) << "time spent doing cleanup:" << elapsedMS << "ms - top-contexts still open:" <<
-                m_chainsByUrl.size() << "- retries" << retries;
+                m_chainsByUrl.size() << "- retries" << retries << "- estimated memory:" << usage << "bytes" <<
+                "- loads:" << m_loads << "reloads:" << m_reloads << "unloads:" << m_unloads;
         }
 
         for (QReadWriteLock* lock : qAsConst(locked)) {
@@ -1315,6 +1490,8 @@ void DUChain::removeDocumentChain(TopDUContext* context)
 
     QMutexLocker lock(&sdDUChainPrivate->m_chainsMutex);
     sdDUChainPrivate->m_availableTopContextIndices.push_back(indexed.index());
+    //The index will be reused by a new top-context, which is no reload
+    sdDUChainPrivate->m_unloadedIndices.remove(indexed.index());
 }
 
 void DUChain::addDocumentChain(TopDUContext* chain)
@@ -1328,10 +1505,13 @@ void DUChain::addDocumentChain(TopDUContext* chain)
 
     {
         QMutexLocker lock(&DUChain::chainsByIndexLock);
-        if (DUChain::chainsByIndex.size() <= chain->ownIndex())
+        if (DUChain::chainsByIndex.size() <= chain->ownIndex()) {
             DUChain::chainsByIndex.resize(chain->ownIndex() + 100, nullptr);
+            DUChain::lastAccessByIndex.resize(chain->ownIndex() + 100, 0);
+        }
 
         DUChain::chainsByIndex[chain->ownIndex()] = chain;
+        DUChain::lastAccessByIndex[chain->ownIndex()] = ++DUChain::accessClock;
     }
     {
         Q_ASSERT(DUChain::chainsByIndex[chain->ownIndex()]);
@@ -1708,6 +1888,9 @@ static void finalCleanup()
     DUChainWriteLocker writeLock(DUChain::lock());
     qCDebug(LANGUAGE) << "doing final cleanup";
 
+    // The cleanup may remove types which are still referenced by shared instances
+    TypeRepository::clearSharedTypes();
+
     int cleaned = 0;
     while ((cleaned = globalItemRepositoryRegistry().finalCleanup())) {
         qCDebug(LANGUAGE) << "cleaned" << cleaned << "B";
@@ -1868,6 +2051,38 @@ void DUChain::disablePersistentStorage(bool disable)
     sdDUChainPrivate->m_cleanupDisabled = disable;
 }
 
+DUChain::MemoryStatistics DUChain::memoryStatistics() const
+{
+    MemoryStatistics ret;
+    {
+        QMutexLocker l(&sdDUChainPrivate->m_chainsMutex);
+        ret.loadedContexts = sdDUChainPrivate->m_chainsByUrl.size();
+        ret.loadedBytes = sdDUChainPrivate->m_loadedBytes;
+        ret.memoryBudget = sdDUChainPrivate->m_memoryBudget;
+        ret.loads = sdDUChainPrivate->m_loads;
+        ret.reloads = sdDUChainPrivate->m_reloads;
+        ret.unloads = sdDUChainPrivate->m_unloads;
+    }
+    {
+        QMutexLocker lock(&chainsByIndexLock);
+        ret.hits = chainHits;
+    }
+    return ret;
+}
+
+void DUChain::setMemoryBudget(qint64 bytes)
+{
+    QMutexLocker l(&sdDUChainPrivate->m_chainsMutex);
+    sdDUChainPrivate->m_memoryBudget = qMax<qint64>(0, bytes);
+    sdDUChainPrivate->m_lastBudgetCleanupBytes = 0;
+}
+
+qint64 DUChain::memoryBudget() const
+{
+    QMutexLocker l(&sdDUChainPrivate->m_chainsMutex);
+    return sdDUChainPrivate->m_memoryBudget;
+}
+
 void DUChain::storeToDisk()
 {
     bool wasDisabled = sdDUChainPrivate->m_cleanupDisabled;
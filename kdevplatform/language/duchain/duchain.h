@@ -184,8 +184,12 @@ public:
 
             if (chainsByIndex.size() > index) {
                 TopDUContext* top = chainsByIndex[index];
-                if (top)
+                if (top) {
+                    // remember the access for the least-recently-used unloading
+                    lastAccessByIndex[index] = ++accessClock;
+                    ++chainHits;
                     return top;
+                }
             }
         }
 
@@ -249,6 +253,40 @@ public:
     ///Call this from within tests.
     void disablePersistentStorage(bool disable = true);
 
+    /// Statistics about the top-contexts held in memory, for monitoring
+    struct MemoryStatistics
+    {
+        /// Number of top-contexts loaded in memory
+        int loadedContexts = 0;
+        /// Estimated memory used by the loaded top-contexts, updated periodically by the cleanup thread
+        qint64 loadedBytes = 0;
+        /// The configured budget, 0 if there is none
+        qint64 memoryBudget = 0;
+        /// Lookups through chainForIndex() that found the top-context in memory
+        quint64 hits = 0;
+        /// Top-contexts that had to be loaded from disk
+        quint64 loads = 0;
+        /// Loads of top-contexts that had been unloaded by the cleanup before
+        quint64 reloads = 0;
+        /// Top-contexts unloaded by the cleanup
+        quint64 unloads = 0;
+    };
+
+    MemoryStatistics memoryStatistics() const;
+
+    /**
+     * Limits the memory used by loaded top-contexts to roughly @p bytes, 0 disables the limit.
+     *
+     * Without a budget, the periodic cleanup unloads all top-contexts which are not referenced.
+     * With a budget, unreferenced top-contexts stay loaded as long as the budget allows and
+     * the least recently used ones are unloaded first. The cleanup thread checks the budget
+     * regularly and starts a cleanup on its own as soon as it is exceeded.
+     *
+     * Top-contexts of open documents, referenced ones and their imports are never unloaded.
+     */
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+
     ///Stores the whole duchain and all its repositories in the current state to disk
     ///The duchain must not be locked in any way
     void storeToDisk();
@@ -300,6 +338,10 @@ private:
     static bool m_deleted;
     static std::vector<TopDUContext*> chainsByIndex;
     static QMutex chainsByIndexLock;
+    // protected by chainsByIndexLock as well
+    static std::vector<quint64> lastAccessByIndex;
+    static quint64 accessClock;
+    static quint64 chainHits;
 
     /// Increases the reference-count for the given top-context. The result: It will not be unloaded.
     /// Do this to prevent KDevelop from unloading a top-context that you plan to use. Don't forget calling unReferenceToContext again,
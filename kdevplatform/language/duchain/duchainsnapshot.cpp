@@ -0,0 +1,143 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "duchainsnapshot.h"
+
+#include <QHash>
+
+#include "duchain.h"
+#include "duchainlock.h"
+#include "ducontext.h"
+#include "use.h"
+
+namespace KDevelop {
+class DUChainSnapshotPrivate
+{
+public:
+    QVector<DUChainSnapshot::File> files;
+};
+
+namespace {
+/// Copies one file, the duchain must be read-locked
+struct FileCopier
+{
+    DUChainSnapshot::File& file;
+    const TopDUContext* top;
+    DUChainSnapshot::Contents contents;
+    /// Positions of the copied declarations, to find the parent of the declarations in their internal contexts
+    QHash<const Declaration*, int> positions;
+
+    void copyContext(const DUContext* context, int parent)
+    {
+        if (contents & DUChainSnapshot::Declarations) {
+            const auto declarations = context->localDeclarations();
+            for (const Declaration* declaration : declarations) {
+                positions.insert(declaration, file.declarations.size());
+                file.declarations.append({
+                    IndexedDeclaration(declaration),
+                    declaration->id(),
+                    declaration->qualifiedIdentifier().toString(),
+                    declaration->range(),
+                    declaration->kind(),
+                    declaration->isDefinition(),
+                    declaration->isForwardDeclaration(),
+                    parent
+                });
+            }
+        }
+
+        if (contents & DUChainSnapshot::Uses) {
+            const Use* uses = context->uses();
+            const int usesCount = context->usesCount();
+            for (int i = 0; i < usesCount; ++i) {
+                const Declaration* used = top->usedDeclarationForIndex(uses[i].m_declarationIndex);
+                file.uses.append({used ? used->id() : DeclarationId(), uses[i].m_range});
+            }
+        }
+
+        const auto childContexts = context->childContexts();
+        for (const DUContext* child : childContexts) {
+            const Declaration* owner = child->owner();
+            copyContext(child, owner ? positions.value(owner, parent) : parent);
+        }
+    }
+};
+}
+
+DUChainSnapshot::DUChainSnapshot()
+    : d(new DUChainSnapshotPrivate)
+{
+}
+
+DUChainSnapshot::~DUChainSnapshot() = default;
+
+DUChainSnapshot::DUChainSnapshot(const DUChainSnapshot& rhs) = default;
+
+DUChainSnapshot& DUChainSnapshot::operator=(const DUChainSnapshot& rhs) = default;
+
+DUChainSnapshot DUChainSnapshot::create(const QVector<ReferencedTopDUContext>& topContexts, Contents contents)
+{
+    auto* data = new DUChainSnapshotPrivate;
+    data->files.reserve(topContexts.size());
+
+    for (const ReferencedTopDUContext& top : topContexts) {
+        if (!top) {
+            continue;
+        }
+
+        // lock for each file only, so parse jobs waiting for the write lock get their turn in between
+        DUChainReadLocker lock;
+
+        File file;
+        file.url = top->url();
+        file.topContext = top;
+        FileCopier copier{file, top.data(), contents, {}};
+        copier.copyContext(top.data(), -1);
+        data->files.append(file);
+    }
+
+    DUChainSnapshot snapshot;
+    snapshot.d = QSharedPointer<const DUChainSnapshotPrivate>(data);
+    return snapshot;
+}
+
+bool DUChainSnapshot::isEmpty() const
+{
+    return d->files.isEmpty();
+}
+
+const QVector<DUChainSnapshot::File>& DUChainSnapshot::files() const
+{
+    return d->files;
+}
+
+QVector<QPair<IndexedString, DUChainSnapshot::UseEntry>> DUChainSnapshot::usesOf(const DeclarationId& id) const
+{
+    QVector<QPair<IndexedString, UseEntry>> ret;
+    for (const File& file : d->files) {
+        for (const UseEntry& use : file.uses) {
+            if (use.declaration == id) {
+                ret.append(qMakePair(file.url, use));
+            }
+        }
+    }
+    return ret;
+}
+}
@@ -0,0 +1,131 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_DUCHAINSNAPSHOT_H
+#define KDEVPLATFORM_DUCHAINSNAPSHOT_H
+
+#include <QSharedPointer>
+#include <QVector>
+
+#include <language/languageexport.h>
+#include <language/editor/rangeinrevision.h>
+#include <language/duchain/declaration.h>
+#include <language/duchain/declarationid.h>
+#include <language/duchain/indexeddeclaration.h>
+#include <language/duchain/topducontext.h>
+#include <serialization/indexedstring.h>
+
+namespace KDevelop {
+class DUChainSnapshotPrivate;
+
+/**
+ * A read-only copy of the declarations and uses of a set of top-contexts.
+ *
+ * Tools which go through many files, like quick open, the class browser or find uses,
+ * would otherwise lock the duchain again and again, competing with the parse jobs
+ * which need the write lock. A snapshot is created with one short read lock per file,
+ * after that it can be traversed from any number of threads at once without locking
+ * the duchain, e.g. with QtConcurrent over files().
+ *
+ * The entries are plain values, no duchain object is referenced by pointer. The top-contexts
+ * are kept loaded while the snapshot exists, so the IndexedDeclaration of an entry can
+ * be resolved quickly, which of course needs the duchain lock again.
+ *
+ * The ranges are copied as they were parsed. Mapping them to the current revision of an open
+ * document needs the foreground lock, do that on the foreground thread with File::topContext,
+ * e.g. through DUChainBase::transformFromLocalRevision().
+ *
+ * Each file is copied consistently, but a file might get updated while another one is
+ * copied. The snapshot does not change afterwards, compare File::topContext with
+ * DUChain::chainForDocument() or listen to DUChain::updateReady() to find outdated files.
+ *
+ * Copies are cheap and share the data.
+ */
+class KDEVPLATFORMLANGUAGE_EXPORT DUChainSnapshot
+{
+public:
+    struct DeclarationEntry
+    {
+        IndexedDeclaration declaration;
+        DeclarationId id;
+        QString qualifiedIdentifier;
+        /// In the revision the file was parsed in
+        RangeInRevision range;
+        Declaration::Kind kind;
+        bool isDefinition;
+        bool isForwardDeclaration;
+        /// Position of the declaration which opened the context of this one in the file, or -1
+        int parent;
+    };
+
+    struct UseEntry
+    {
+        /// The used declaration, invalid if it could not be found
+        DeclarationId declaration;
+        /// In the revision the file was parsed in
+        RangeInRevision range;
+    };
+
+    struct File
+    {
+        IndexedString url;
+        ReferencedTopDUContext topContext;
+        /// In the order in which they appear in the contexts, parents first
+        QVector<DeclarationEntry> declarations;
+        QVector<UseEntry> uses;
+    };
+
+    enum Content {
+        Declarations = 1,
+        Uses = 2,
+        All = Declarations | Uses
+    };
+    Q_DECLARE_FLAGS(Contents, Content)
+
+    /// An empty snapshot
+    DUChainSnapshot();
+    ~DUChainSnapshot();
+    DUChainSnapshot(const DUChainSnapshot& rhs);
+    DUChainSnapshot& operator=(const DUChainSnapshot& rhs);
+
+    /**
+     * Copy the @p contents of @p topContexts, null contexts are skipped.
+     *
+     * The duchain is read-locked once per file. Call this without holding the lock, so parse jobs
+     * can update files in between.
+     */
+    static DUChainSnapshot create(const QVector<ReferencedTopDUContext>& topContexts, Contents contents = All);
+
+    bool isEmpty() const;
+
+    /// The copied files, in the order of the top-contexts passed to create()
+    const QVector<File>& files() const;
+
+    /// @return the uses of the declaration with @p id in all files, with the url of their file
+    QVector<QPair<IndexedString, UseEntry>> usesOf(const DeclarationId& id) const;
+
+private:
+    QSharedPointer<const DUChainSnapshotPrivate> d;
+};
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KDevelop::DUChainSnapshot::Contents)
+
+#endif // KDEVPLATFORM_DUCHAINSNAPSHOT_H
@@ -76,11 +76,11 @@ void FunctionDeclaration::setAbstractType(AbstractType::Ptr type)
 
 QString FunctionDeclaration::toString() const
 {
-    AbstractType::Ptr type = abstractType();
+    const AbstractType::ConstPtr type = indexedType().constAbstractType();
     if (!type)
         return Declaration::toString();
 
-    TypePtr<FunctionType> function = type.cast<FunctionType>();
+    const auto function = type.cast<const FunctionType>();
     if (function) {
         return QStringLiteral("%1 %2 %3").arg(function->partToString(FunctionType::SignatureReturn),
                                               identifier().toString(),
@@ -92,8 +92,8 @@ QString FunctionDeclaration::toString() const
 
 uint FunctionDeclaration::additionalIdentity() const
 {
-    if (abstractType())
-        return abstractType()->hash();
+    if (const AbstractType::ConstPtr type = indexedType().constAbstractType())
+        return type->hash();
     else
         return 0;
 }
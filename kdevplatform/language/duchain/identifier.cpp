@@ -341,6 +341,70 @@ static QualifiedIdentifierRepository& qualifiedidentifierRepository()
     return repo;
 }
 
+#ifndef TEST_REFERENCE_COUNTING
+// Copying indexed identifiers within reference-counted memory is very frequent while the DUChain
+// is stored, so the reference-count changes are buffered instead of locking the repository each time.
+static ReferenceCountBuffer& identifierReferenceCounts()
+{
+    static ReferenceCountBuffer buffer(identifierRepository()->mutex(), [](uint index, int delta) {
+        identifierRepository()->dynamicItemFromIndexSimple(index)->m_refCount += delta;
+    });
+    return buffer;
+}
+
+static ReferenceCountBuffer& qualifiedIdentifierReferenceCounts()
+{
+    static ReferenceCountBuffer buffer(qualifiedidentifierRepository()->mutex(), [](uint index, int delta) {
+        qualifiedidentifierRepository()->dynamicItemFromIndexSimple(index)->m_refCount += delta;
+    });
+    return buffer;
+}
+#endif
+
+static void increaseIdentifierReference(ReferenceCountManager* manager, uint index)
+{
+#ifdef TEST_REFERENCE_COUNTING
+    QMutexLocker lock(identifierRepository()->mutex());
+    manager->increase(identifierRepository()->dynamicItemFromIndexSimple(index)->m_refCount, index);
+#else
+    Q_UNUSED(manager);
+    identifierReferenceCounts().increase(index);
+#endif
+}
+
+static void decreaseIdentifierReference(ReferenceCountManager* manager, uint index)
+{
+#ifdef TEST_REFERENCE_COUNTING
+    QMutexLocker lock(identifierRepository()->mutex());
+    manager->decrease(identifierRepository()->dynamicItemFromIndexSimple(index)->m_refCount, index);
+#else
+    Q_UNUSED(manager);
+    identifierReferenceCounts().decrease(index);
+#endif
+}
+
+static void increaseQualifiedIdentifierReference(ReferenceCountManager* manager, uint index)
+{
+#ifdef TEST_REFERENCE_COUNTING
+    QMutexLocker lock(qualifiedidentifierRepository()->mutex());
+    manager->increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(index)->m_refCount, index);
+#else
+    Q_UNUSED(manager);
+    qualifiedIdentifierReferenceCounts().increase(index);
+#endif
+}
+
+static void decreaseQualifiedIdentifierReference(ReferenceCountManager* manager, uint index)
+{
+#ifdef TEST_REFERENCE_COUNTING
+    QMutexLocker lock(qualifiedidentifierRepository()->mutex());
+    manager->decrease(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(index)->m_refCount, index);
+#else
+    Q_UNUSED(manager);
+    qualifiedIdentifierReferenceCounts().decrease(index);
+#endif
+}
+
 static uint emptyConstantQualifiedIdentifierPrivateIndex()
 {
     static const uint index = qualifiedidentifierRepository()->index(DynamicQualifiedIdentifierPrivate());
@@ -1288,8 +1352,7 @@ IndexedIdentifier::IndexedIdentifier()
     : m_index(emptyConstantIdentifierPrivateIndex())
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        increase(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseIdentifierReference(this, m_index);
     }
 }
 
@@ -1297,8 +1360,7 @@ IndexedIdentifier::IndexedIdentifier(const Identifier& id)
     : m_index(id.index())
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        increase(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseIdentifierReference(this, m_index);
     }
 }
 
@@ -1306,8 +1368,7 @@ IndexedIdentifier::IndexedIdentifier(const IndexedIdentifier& rhs)
     : m_index(rhs.m_index)
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        increase(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseIdentifierReference(this, m_index);
     }
 }
 
@@ -1320,23 +1381,20 @@ IndexedIdentifier::IndexedIdentifier(IndexedIdentifier&& rhs) Q_DECL_NOEXCEPT
 IndexedIdentifier::~IndexedIdentifier()
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        decrease(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseIdentifierReference(this, m_index);
     }
 }
 
 IndexedIdentifier& IndexedIdentifier::operator=(const Identifier& id)
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        decrease(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseIdentifierReference(this, m_index);
     }
 
     m_index = id.index();
 
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        increase(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseIdentifierReference(this, m_index);
     }
     return *this;
 }
@@ -1344,25 +1402,22 @@ IndexedIdentifier& IndexedIdentifier::operator=(const Identifier& id)
 IndexedIdentifier& IndexedIdentifier::operator=(IndexedIdentifier&& rhs) Q_DECL_NOEXCEPT
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "decreasing"; )
 
-        decrease(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseIdentifierReference(this, m_index);
     } else if (shouldDoDUChainReferenceCounting(&rhs)) {
-        QMutexLocker lock(identifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "decreasing"; )
 
-        decrease(identifierRepository()->dynamicItemFromIndexSimple(rhs.m_index)->m_refCount, rhs.m_index);
+        decreaseIdentifierReference(this, rhs.m_index);
     }
 
     m_index = rhs.m_index;
     rhs.m_index = emptyConstantIdentifierPrivateIndex();
 
     if (shouldDoDUChainReferenceCounting(this) && !(shouldDoDUChainReferenceCounting(&rhs))) {
-        QMutexLocker lock(identifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "increasing"; )
 
-        increase(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseIdentifierReference(this, m_index);
     }
 
     return *this;
@@ -1371,15 +1426,13 @@ IndexedIdentifier& IndexedIdentifier::operator=(IndexedIdentifier&& rhs) Q_DECL_
 IndexedIdentifier& IndexedIdentifier::operator=(const IndexedIdentifier& id)
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        decrease(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseIdentifierReference(this, m_index);
     }
 
     m_index = id.m_index;
 
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(identifierRepository()->mutex());
-        increase(identifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseIdentifierReference(this, m_index);
     }
     return *this;
 }
@@ -1440,8 +1493,7 @@ IndexedQualifiedIdentifier::IndexedQualifiedIdentifier()
         ifDebug(qCDebug(LANGUAGE) << "increasing"; )
 
         //qCDebug(LANGUAGE) << "(" << ++cnt << ")" << this << identifier().toString() << "inc" << index;
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
-        increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseQualifiedIdentifierReference(this, m_index);
     }
 }
 
@@ -1452,8 +1504,7 @@ IndexedQualifiedIdentifier::IndexedQualifiedIdentifier(const QualifiedIdentifier
 
     if (shouldDoDUChainReferenceCounting(this)) {
         ifDebug(qCDebug(LANGUAGE) << "increasing"; )
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
-        increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseQualifiedIdentifierReference(this, m_index);
     }
 }
 
@@ -1465,8 +1516,7 @@ IndexedQualifiedIdentifier::IndexedQualifiedIdentifier(const IndexedQualifiedIde
     if (shouldDoDUChainReferenceCounting(this)) {
         ifDebug(qCDebug(LANGUAGE) << "increasing"; )
 
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
-        increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseQualifiedIdentifierReference(this, m_index);
     }
 }
 
@@ -1481,15 +1531,13 @@ IndexedQualifiedIdentifier& IndexedQualifiedIdentifier::operator=(const Qualifie
     ifDebug(qCDebug(LANGUAGE) << "(" << ++cnt << ")" << identifier().toString() << m_index; )
 
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
-
         ifDebug(qCDebug(LANGUAGE) << "decreasing"; )
-        decrease(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseQualifiedIdentifierReference(this, m_index);
 
         m_index = id.index();
 
         ifDebug(qCDebug(LANGUAGE) << m_index << "increasing"; )
-        increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseQualifiedIdentifierReference(this, m_index);
     } else {
         m_index = id.index();
     }
@@ -1502,15 +1550,14 @@ IndexedQualifiedIdentifier& IndexedQualifiedIdentifier::operator=(const IndexedQ
     ifDebug(qCDebug(LANGUAGE) << "(" << ++cnt << ")" << identifier().toString() << m_index; )
 
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "decreasing"; )
 
-        decrease(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseQualifiedIdentifierReference(this, m_index);
 
         m_index = rhs.m_index;
 
         ifDebug(qCDebug(LANGUAGE) << m_index << "increasing"; )
-        increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseQualifiedIdentifierReference(this, m_index);
     } else {
         m_index = rhs.m_index;
     }
@@ -1521,25 +1568,22 @@ IndexedQualifiedIdentifier& IndexedQualifiedIdentifier::operator=(const IndexedQ
 IndexedQualifiedIdentifier& IndexedQualifiedIdentifier::operator=(IndexedQualifiedIdentifier&& rhs) Q_DECL_NOEXCEPT
 {
     if (shouldDoDUChainReferenceCounting(this)) {
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "decreasing"; )
 
-        decrease(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseQualifiedIdentifierReference(this, m_index);
     } else if (shouldDoDUChainReferenceCounting(&rhs)) {
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "decreasing"; )
 
-        decrease(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(rhs.m_index)->m_refCount, rhs.m_index);
+        decreaseQualifiedIdentifierReference(this, rhs.m_index);
     }
 
     m_index = rhs.m_index;
     rhs.m_index = emptyConstantQualifiedIdentifierPrivateIndex();
 
     if (shouldDoDUChainReferenceCounting(this) && !(shouldDoDUChainReferenceCounting(&rhs))) {
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
         ifDebug(qCDebug(LANGUAGE) << "increasing"; )
 
-        increase(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        increaseQualifiedIdentifierReference(this, m_index);
     }
 
     return *this;
@@ -1550,8 +1594,7 @@ IndexedQualifiedIdentifier::~IndexedQualifiedIdentifier()
     ifDebug(qCDebug(LANGUAGE) << "(" << ++cnt << ")" << identifier().toString() << index; )
     if (shouldDoDUChainReferenceCounting(this)) {
         ifDebug(qCDebug(LANGUAGE) << index << "decreasing"; )
-        QMutexLocker lock(qualifiedidentifierRepository()->mutex());
-        decrease(qualifiedidentifierRepository()->dynamicItemFromIndexSimple(m_index)->m_refCount, m_index);
+        decreaseQualifiedIdentifierReference(this, m_index);
     }
 }
 
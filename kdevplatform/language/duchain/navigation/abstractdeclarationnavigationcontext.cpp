@@ -36,6 +36,9 @@
 #include "../types/typeutils.h"
 #include "../types/typesystem.h"
 #include "../persistentsymboltable.h"
+#include "../parsingenvironment.h"
+#include "../topducontext.h"
+#include "../../editor/modificationrevision.h"
 #include <debug.h>
 #include <interfaces/icore.h>
 #include <interfaces/idocumentationcontroller.h>
@@ -44,6 +47,20 @@
 #include <duchain/classdeclaration.h>
 
 namespace KDevelop {
+namespace {
+/// Identifies the content of @p top as it was parsed, together with its imports,
+/// and the current revision of the document, which moves the shown positions
+QString contentRevision(const TopDUContext* top)
+{
+    const ParsingEnvironmentFilePointer file = top->parsingEnvironmentFile();
+    return QStringLiteral("%1/%2/%3/%4")
+           .arg(top->ownIndex())
+           .arg(file ? file->modificationRevision().toString() : QString())
+           .arg(file ? file->allModificationRevisions().index() : 0)
+           .arg(ModificationRevision::revisionForFile(top->url()).toString());
+}
+}
+
 class AbstractDeclarationNavigationContextPrivate
 {
 public:
@@ -66,6 +83,26 @@ AbstractDeclarationNavigationContext::AbstractDeclarationNavigationContext(const
     auto* definition = dynamic_cast<FunctionDefinition*>(d->m_declaration.data());
     if (definition && definition->declaration())
         d->m_declaration = DeclarationPointer(definition->declaration());
+
+    // The content only changes with the files of the declaration, its definition and the viewing context
+    if (d->m_declaration && !previousContext) {
+        const IndexedDeclaration indexed(d->m_declaration.data());
+        QString key = QStringLiteral("%1:%2:%3")
+                      .arg(indexed.topContextIndex())
+                      .arg(indexed.localIndex())
+                      .arg(contentRevision(d->m_declaration->topContext()));
+        if (const FunctionDefinition* definition = FunctionDefinition::definition(d->m_declaration.data())) {
+            const IndexedDeclaration indexedDefinition(definition);
+            key += QStringLiteral(":%1:%2:%3")
+                   .arg(indexedDefinition.topContextIndex())
+                   .arg(indexedDefinition.localIndex())
+                   .arg(contentRevision(definition->topContext()));
+        }
+        if (const TopDUContext* top = this->topContext().data()) {
+            key += QLatin1Char(':') + contentRevision(top);
+        }
+        setContentCacheKey(key);
+    }
 }
 
 AbstractDeclarationNavigationContext::~AbstractDeclarationNavigationContext()
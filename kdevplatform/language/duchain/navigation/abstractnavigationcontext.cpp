@@ -57,6 +57,7 @@ public:
     TopDUContextPointer m_topContext;
 
     QString m_currentText; //Here the text is built
+    QString m_contentCacheKey;
 };
 
 void AbstractNavigationContext::setTopContext(const TopDUContextPointer& context)
@@ -159,6 +160,12 @@ void AbstractNavigationContext::executeLink(const QString& link)
 {
     Q_D(AbstractNavigationContext);
 
+    //Make sure the links are valid, the widget may have shown cached content
+    if (d->m_linkCount == -1) {
+        DUChainReadLocker lock;
+        html();
+    }
+
     const auto actionIt = d->m_links.constFind(link);
     if (actionIt == d->m_links.constEnd())
         return;
@@ -457,6 +464,12 @@ NavigationContextPointer AbstractNavigationContext::accept()
 {
     Q_D(AbstractNavigationContext);
 
+    //Make sure the links are valid, the widget may have shown cached content
+    if (d->m_linkCount == -1) {
+        DUChainReadLocker lock;
+        html();
+    }
+
     if (d->m_selectedLink >= 0 &&  d->m_selectedLink < d->m_linkCount) {
         NavigationAction action = d->m_intLinks[d->m_selectedLink];
         return execute(action);
@@ -478,6 +491,12 @@ NavigationContextPointer AbstractNavigationContext::acceptLink(const QString& li
 {
     Q_D(AbstractNavigationContext);
 
+    //Make sure the links are valid, the widget may have shown cached content
+    if (d->m_linkCount == -1) {
+        DUChainReadLocker lock;
+        html();
+    }
+
     const auto actionIt = d->m_links.constFind(link);
     if (actionIt == d->m_links.constEnd()) {
         qCDebug(LANGUAGE) << "Executed unregistered link " << link;
@@ -542,6 +561,25 @@ bool AbstractNavigationContext::alreadyComputed() const
     return !d->m_currentText.isEmpty();
 }
 
+QString AbstractNavigationContext::contentCacheKey() const
+{
+    Q_D(const AbstractNavigationContext);
+
+    // Once html() was called or the context was navigated, the content depends on the navigation state
+    const bool initialState = d->m_linkCount == -1 && d->m_selectedLink == 0 && d->m_currentPositionLine == 0;
+    if (d->m_contentCacheKey.isEmpty() || !initialState)
+        return QString();
+
+    return QLatin1String(metaObject()->className()) + QLatin1Char(':') + d->m_contentCacheKey;
+}
+
+void AbstractNavigationContext::setContentCacheKey(const QString& key)
+{
+    Q_D(AbstractNavigationContext);
+
+    d->m_contentCacheKey = key;
+}
+
 bool AbstractNavigationContext::isWidgetMaximized() const
 {
     return true;
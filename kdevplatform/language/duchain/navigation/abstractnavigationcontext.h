@@ -99,6 +99,11 @@ public:
     ///After clear() was called, this returns false again.
     bool alreadyComputed() const;
 
+    ///Returns a key identifying the html() this context produces before it is navigated,
+    ///or an empty string if the content can't be reused from a cache.
+    ///The DUChain does not need to be locked.
+    QString contentCacheKey() const;
+
     TopDUContextPointer topContext() const;
     void setTopContext(const TopDUContextPointer& context);
 
@@ -140,6 +145,9 @@ protected:
     //Clears the computed html and links
     void clear();
 
+    ///Sets the key for contentCacheKey(). It must cover everything html() depends on, apart from the type of the context.
+    void setContentCacheKey(const QString& key);
+
     ///Creates and registers a link to the given declaration, labeled by the given name
     virtual void makeLink(const QString& name, const DeclarationPointer& declaration,
                           NavigationAction::Type actionType);
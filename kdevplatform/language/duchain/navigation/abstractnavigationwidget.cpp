@@ -22,6 +22,7 @@
 #include <QApplication>
 #include <QVBoxLayout>
 #include <QMetaObject>
+#include <QCache>
 #include <QScrollBar>
 #include <QTextBrowser>
 
@@ -33,6 +34,20 @@
 namespace {
 const int maxNavigationWidgetWidth = 580;
 const int maxNavigationWidgetHeight = 400;
+
+struct CachedContent
+{
+    QString html;
+    int linkCount;
+};
+
+/// Rendered html of navigation contexts in their initial state, by NavigationContext::contentCacheKey().
+/// Only used from the UI thread.
+QCache<QString, CachedContent>& contentCache()
+{
+    static QCache<QString, CachedContent> cache(200);
+    return cache;
+}
 }
 
 namespace KDevelop {
@@ -194,9 +209,21 @@ void AbstractNavigationWidget::update()
     Q_ASSERT(d->m_context);
 
     QString html;
-    {
-        DUChainReadLocker lock;
-        html = d->m_context->html();
+    int linkCount;
+    // Showing the same declaration again doesn't need the DUChain lock as long as it wasn't changed
+    const QString cacheKey = d->m_context->contentCacheKey();
+    if (auto* cached = cacheKey.isEmpty() ? nullptr : contentCache().object(cacheKey)) {
+        html = cached->html;
+        linkCount = cached->linkCount;
+    } else {
+        {
+            DUChainReadLocker lock;
+            html = d->m_context->html();
+        }
+        linkCount = d->m_context->linkCount();
+        if (!cacheKey.isEmpty() && !html.isEmpty()) {
+            contentCache().insert(cacheKey, new CachedContent{html, linkCount});
+        }
     }
 
     if (!html.isEmpty()) {
@@ -205,7 +232,7 @@ void AbstractNavigationWidget::update()
         if (!(d->m_hints & EmbeddableWidget)) {
             // TODO: Only show that the first time, or the first few times this context is shown?
             html += QStringLiteral("<p><small>");
-            if (d->m_context->linkCount() > 0) {
+            if (linkCount > 0) {
                 html +=
                     i18n("(Hold <em>Alt</em> to show. Navigate via arrow keys, activate by pressing <em>Enter</em>)");
             } else {
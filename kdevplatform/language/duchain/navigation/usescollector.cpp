@@ -25,6 +25,7 @@
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/idocumentcontroller.h>
 #include <language/duchain/duchainutils.h>
+#include <language/duchain/uses.h>
 #include <language/duchain/types/indexedtype.h>
 #include <language/duchain/classfunctiondeclaration.h>
 #include <backgroundparser/parsejob.h>
@@ -38,6 +39,8 @@
 #include <sublime/message.h>
 #include <KLocalizedString>
 
+#include <QtConcurrentMap>
+
 using namespace KDevelop;
 
 ///@todo make this language-neutral
@@ -51,6 +54,38 @@ static Identifier destructorForName(const Identifier& name)
 
 ///@todo Only collect uses within currently loaded projects
 
+///Whether the file already contains all uses and is up-to-date, so its uses are listed in the uses index
+static bool containsCurrentUses(const ParsingEnvironmentFile* file)
+{
+    return file && !file->isProxyContext() && !file->needsUpdate()
+           && file->featuresSatisfied(TopDUContext::AllDeclarationsContextsAndUses);
+}
+
+///Loads a top-context and checks whether it uses any of the declarations, used from worker threads
+struct UsesScanner
+{
+    using result_type = ReferencedTopDUContext;
+
+    ReferencedTopDUContext operator()(const IndexedTopDUContext& indexed) const
+    {
+        DUChainReadLocker lock;
+        TopDUContext* top = indexed.data();
+        if (!top)
+            return {};
+        if (declarationTopContexts.contains(indexed))
+            return ReferencedTopDUContext(top);
+        for (const IndexedDeclaration& indexedDeclaration : declarations) {
+            Declaration* declaration = indexedDeclaration.data();
+            if (declaration && DUChainUtils::contextHasUse(top, declaration))
+                return ReferencedTopDUContext(top);
+        }
+        return {};
+    }
+
+    QList<IndexedDeclaration> declarations;
+    QSet<IndexedTopDUContext> declarationTopContexts;
+};
+
 template <class ImportanceChecker>
 void collectImporters(ImportanceChecker& checker, ParsingEnvironmentFile* current,
                       QSet<ParsingEnvironmentFile*>& visited, QSet<ParsingEnvironmentFile*>& collected)
@@ -121,7 +156,7 @@ QList<IndexedDeclaration> UsesCollector::declarations()
 
 bool UsesCollector::isReady() const
 {
-    return m_waitForUpdate.size() == m_updateReady.size();
+    return m_waitForUpdate.size() == m_updateReady.size() && m_indexScanned == m_indexCandidates;
 }
 
 bool UsesCollector::shouldRespectFile(const IndexedString& document)
@@ -231,6 +266,34 @@ void UsesCollector::startCollecting()
             candidateTopContexts << d.indexedTopContext().data();
         }
 
+        ///Step 5: Find the up-to-date top-contexts that use one of the declarations through the uses index.
+        ///Those don't need to go through the background parser, they are scanned in parallel instead.
+        QVector<IndexedTopDUContext> indexCandidates;
+        {
+            QSet<IndexedTopDUContext> candidates;
+            if (m_processDeclarations)
+                candidates = m_declarationTopContexts;
+            for (const IndexedDeclaration d : qAsConst(m_declarations)) {
+                Declaration* declaration = d.data();
+                if (!declaration)
+                    continue;
+                const DeclarationId id = declaration->id();
+                KDevVarLengthArray<IndexedTopDUContext> useContexts = DUChain::uses()->uses(id);
+                if (!id.isDirect()) {
+                    KDevVarLengthArray<IndexedTopDUContext> directUseContexts = DUChain::uses()->uses(declaration->id(true));
+                    useContexts.append(directUseContexts.data(), directUseContexts.size());
+                }
+                for (const IndexedTopDUContext useContext : qAsConst(useContexts))
+                    candidates.insert(useContext);
+            }
+
+            for (const IndexedTopDUContext& candidate : qAsConst(candidates)) {
+                ParsingEnvironmentFilePointer file = DUChain::self()->environmentFileForDocument(candidate);
+                if (containsCurrentUses(file.data()) && shouldRespectFile(file->url()))
+                    indexCandidates << candidate;
+            }
+        }
+
         ImportanceChecker checker(*this);
 
         QSet<ParsingEnvironmentFile*> visited;
@@ -264,6 +327,16 @@ void UsesCollector::startCollecting()
         if (checker(file))
             collected.insert(file);
 
+        {
+            // up-to-date files with all uses are covered by the uses index already
+            for (auto it = collected.begin(); it != collected.end();) {
+                if (containsCurrentUses(*it))
+                    it = collected.erase(it);
+                else
+                    ++it;
+            }
+        }
+
         {
             QSet<ParsingEnvironmentFile*> filteredCollected;
             QMap<IndexedString, bool> grepCache;
@@ -303,8 +376,16 @@ void UsesCollector::startCollecting()
             rootFiles.insert(importer->url());
         }
 
-        emit maximumProgressSignal(rootFiles.size());
-        maximumProgress(rootFiles.size());
+        m_indexCandidates = indexCandidates.size();
+        emit maximumProgressSignal(rootFiles.size() + m_indexCandidates);
+        maximumProgress(rootFiles.size() + m_indexCandidates);
+
+        qCDebug(LANGUAGE) << "scanning" << indexCandidates.size() << "up-to-date top-contexts from the uses index";
+        UsesScanner scanner;
+        scanner.declarations = m_declarations;
+        if (m_processDeclarations)
+            scanner.declarationTopContexts = m_declarationTopContexts;
+        m_indexScan.setFuture(QtConcurrent::mapped(indexCandidates, scanner));
 
         //If we used the AllDeclarationsContextsAndUsesRecursive flag here, we would compute way too much. This way we only
         //set the minimum-features selectively on the files we really require them on.
@@ -337,15 +418,22 @@ void UsesCollector::maximumProgress(uint max)
 }
 
 UsesCollector::UsesCollector(IndexedDeclaration declaration) : m_declaration(declaration)
+    , m_indexCandidates(0)
+    , m_indexScanned(0)
     , m_collectOverloads(true)
     , m_collectDefinitions(true)
     , m_collectConstructors(false)
     , m_processDeclarations(true)
 {
+    connect(&m_indexScan, &QFutureWatcher<ReferencedTopDUContext>::resultsReadyAt,
+            this, &UsesCollector::indexScanResultsReady);
 }
 
 UsesCollector::~UsesCollector()
 {
+    m_indexScan.cancel();
+    m_indexScan.waitForFinished();
+
     ICore::self()->languageController()->backgroundParser()->revertAllRequests(this);
 
     const auto currentFeaturesManipulated = m_staticFeaturesManipulated;
@@ -360,6 +448,38 @@ void UsesCollector::progress(uint processed, uint total)
     Q_UNUSED(total);
 }
 
+void UsesCollector::reportProgress()
+{
+    const uint processed = m_updateReady.size() + m_indexScanned;
+    const uint total = m_waitForUpdate.size() + m_indexCandidates;
+    emit progressSignal(processed, total);
+    progress(processed, total);
+}
+
+void UsesCollector::indexScanResultsReady(int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        ++m_indexScanned;
+
+        const ReferencedTopDUContext topContext = m_indexScan.resultAt(i);
+        if (!topContext)
+            continue;
+
+        IndexedString url;
+        {
+            DUChainReadLocker lock;
+            url = topContext->url();
+        }
+        if (!m_processed.contains(url)) {
+            m_processed.insert(url);
+            emit processUsesSignal(topContext);
+            processUses(topContext);
+        }
+    }
+
+    reportProgress();
+}
+
 void UsesCollector::updateReady(const KDevelop::IndexedString& url, KDevelop::ReferencedTopDUContext topContext)
 {
     DUChainReadLocker lock(DUChain::lock());
@@ -393,8 +513,7 @@ void UsesCollector::updateReady(const KDevelop::IndexedString& url, KDevelop::Re
         m_updateReady << url;
         m_checked.clear();
 
-        emit progressSignal(m_updateReady.size(), m_waitForUpdate.size());
-        progress(m_updateReady.size(), m_waitForUpdate.size());
+        reportProgress();
     }
 
     if (!topContext || !topContext->parsingEnvironmentFile()) {
@@ -19,6 +19,7 @@
 #ifndef KDEVPLATFORM_USESCOLLECTOR_H
 #define KDEVPLATFORM_USESCOLLECTOR_H
 
+#include <QFutureWatcher>
 #include <QObject>
 #include <QSet>
 #include <language/duchain/topducontext.h>
@@ -30,6 +31,8 @@ class IndexedDeclaration;
 ///The most important part is that this also updates the duchain if it's not up-to-date or doesn't contain
 ///the required features. The virtual function processUses(..) is called with each up-to-date top-context found
 ///that contains uses of the declaration.
+///Top-contexts that are already up-to-date and listed in the uses index are loaded and scanned in parallel
+///worker threads and reported as they are found, only the remaining files go through the background parser.
 class KDEVPLATFORMLANGUAGE_EXPORT UsesCollector
     : public QObject
 {
@@ -94,8 +97,11 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void updateReady(const KDevelop::IndexedString& url, KDevelop::ReferencedTopDUContext topContext);
+    void indexScanResultsReady(int begin, int end);
 
 private:
+    void reportProgress();
+
     ///Called with every top-context that can contain uses of the declaration, or if setProcessDeclarations(false)
     ///has not been called also with all contexts that contain declarations used as base for the search.
     ///Override this to do your custom processing. You do not need to recurse into imports, that's done for you.
@@ -125,6 +131,11 @@ private:
     QList<IndexedDeclaration> m_declarations;
     QSet<IndexedTopDUContext> m_declarationTopContexts;
 
+    ///Scans the up-to-date top-contexts from the uses index, yields the ones that contain uses
+    QFutureWatcher<ReferencedTopDUContext> m_indexScan;
+    uint m_indexCandidates;
+    uint m_indexScanned;
+
     bool m_collectOverloads;
     bool m_collectDefinitions;
     bool m_collectConstructors;
@@ -693,6 +693,7 @@ void UsesWidget::UsesWidgetCollector::maximumProgress(uint max)
         m_widget->m_progressBar->setMaximum(max);
         m_widget->m_progressBar->setMinimum(0);
         m_widget->m_progressBar->setValue(0);
+        m_widget->m_progressTimer.start();
     } else {
         qCWarning(LANGUAGE) << "maximumProgress called twice";
     }
@@ -709,6 +710,13 @@ void UsesWidget::UsesWidgetCollector::progress(uint processed, uint total)
     if (m_widget->m_progressBar) {
         m_widget->m_progressBar->setValue(processed);
 
+        if (processed > 0 && processed < total) {
+            const qint64 remaining = m_widget->m_progressTimer.elapsed() * (total - processed) / processed / 1000;
+            m_widget->m_progressBar->setFormat(i18ncp("@info:progress %p is the percentage, keep it",
+                                                      "%p% (about 1 second left)",
+                                                      "%p% (about %1 seconds left)", static_cast<int>(remaining)));
+        }
+
         if (processed == total) {
             m_widget->setUpdatesEnabled(false);
             delete m_widget->m_progressBar;
@@ -19,6 +19,7 @@
 #ifndef KDEVPLATFORM_USESWIDGET_H
 #define KDEVPLATFORM_USESWIDGET_H
 
+#include <QElapsedTimer>
 #include <QWidget>
 #include <QScrollArea>
 #include <QSharedPointer>
@@ -184,6 +185,8 @@ private:
     QLabel* m_headerLine;
     QSharedPointer<UsesWidgetCollector> m_collector;
     QProgressBar* m_progressBar;
+    ///Measures the search, to estimate the remaining time
+    QElapsedTimer m_progressTimer;
 
 public Q_SLOTS:
     void headerLinkActivated(const QString& linkName);
@@ -90,6 +90,11 @@ bool ParsingEnvironmentFile::needsUpdate(const ParsingEnvironment* /*environment
     return d_func()->m_allModificationRevisions.needsUpdate();
 }
 
+bool ParsingEnvironmentFile::needsUpdateDependsOnEnvironment() const
+{
+    return false;
+}
+
 bool ParsingEnvironmentFile::matchEnvironment(const ParsingEnvironment* /*environment*/) const
 {
     ENSURE_READ_LOCKED
@@ -145,6 +145,10 @@ public:
     ///stored with addModificationRevision(..).
     virtual bool needsUpdate(const ParsingEnvironment* environment = nullptr) const;
 
+    ///Should return true if needsUpdate() also compares the given environment, e.g. include paths and defines,
+    ///so calling it without an environment may miss a required update. The default-implementation returns false.
+    virtual bool needsUpdateDependsOnEnvironment() const;
+
     /**
      * A language-specific flag used by C++ to mark one context as a proxy of another.
      * If this flag is set on a context, the first imported context should be used for any computations
@@ -0,0 +1,149 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "bench_referencecounting.h"
+
+#include <language/duchain/identifier.h>
+#include <language/duchain/types/integraltype.h>
+#include <language/duchain/types/indexedtype.h>
+#include <serialization/indexedstring.h>
+#include <serialization/referencecounting.h>
+
+#include <tests/testcore.h>
+#include <tests/autotestshell.h>
+
+#include <QFuture>
+#include <QThreadPool>
+#include <QVector>
+#include <QTest>
+#include <QtConcurrentRun>
+
+using namespace KDevelop;
+
+namespace {
+const int itemsPerThread = 1000;
+const int roundsPerThread = 100;
+
+/// Copy @p item into reference counted memory and destroy the copies again, like the
+/// DUChain does when it stores and discards data.
+template<typename T>
+void copyAndDestroy(const T& item)
+{
+    QVector<quint64> storage((sizeof(T) * itemsPerThread + sizeof(quint64) - 1) / sizeof(quint64));
+    auto* items = reinterpret_cast<T*>(storage.data());
+
+    enableDUChainReferenceCounting(storage.data(), storage.size() * sizeof(quint64));
+    for (int round = 0; round < roundsPerThread; ++round) {
+        for (int i = 0; i < itemsPerThread; ++i) {
+            new (items + i) T(item);
+        }
+        for (int i = 0; i < itemsPerThread; ++i) {
+            items[i].~T();
+        }
+    }
+    disableDUChainReferenceCounting(storage.data());
+}
+
+template<typename T>
+void runThreads(const T& item)
+{
+    QFETCH(int, threads);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    QBENCHMARK {
+        QVector<QFuture<void>> futures;
+        futures.reserve(threads);
+        for (int i = 0; i < threads; ++i) {
+            futures.append(QtConcurrent::run(&pool, copyAndDestroy<T>, item));
+        }
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+        // include applying the buffered changes to the repositories
+        ReferenceCountBuffer::flushAll();
+    }
+}
+}
+
+QTEST_GUILESS_MAIN(BenchReferenceCounting)
+
+void BenchReferenceCounting::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+}
+
+void BenchReferenceCounting::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void BenchReferenceCounting::feedData()
+{
+    QTest::addColumn<int>("threads");
+
+    const QVector<int> threadCounts{1, 2, 4, 8};
+    for (int threads : threadCounts) {
+        QTest::newRow(qPrintable(QStringLiteral("threads-%1").arg(threads))) << threads;
+    }
+}
+
+void BenchReferenceCounting::indexedString()
+{
+    runThreads(IndexedString(QStringLiteral("bench_referencecounting")));
+}
+
+void BenchReferenceCounting::indexedString_data()
+{
+    feedData();
+}
+
+void BenchReferenceCounting::indexedIdentifier()
+{
+    runThreads(IndexedIdentifier(Identifier(QStringLiteral("benchIdentifier"))));
+}
+
+void BenchReferenceCounting::indexedIdentifier_data()
+{
+    feedData();
+}
+
+void BenchReferenceCounting::indexedQualifiedIdentifier()
+{
+    runThreads(IndexedQualifiedIdentifier(QualifiedIdentifier(QStringLiteral("bench::qualified::identifier"))));
+}
+
+void BenchReferenceCounting::indexedQualifiedIdentifier_data()
+{
+    feedData();
+}
+
+void BenchReferenceCounting::indexedType()
+{
+    AbstractType::Ptr type(new IntegralType(IntegralType::TypeInt));
+    runThreads(type->indexed());
+}
+
+void BenchReferenceCounting::indexedType_data()
+{
+    feedData();
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_BENCH_REFERENCECOUNTING_H
+#define KDEVPLATFORM_BENCH_REFERENCECOUNTING_H
+
+#include <QObject>
+
+class BenchReferenceCounting
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    void feedData();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void indexedString();
+    void indexedString_data();
+    void indexedIdentifier();
+    void indexedIdentifier_data();
+    void indexedQualifiedIdentifier();
+    void indexedQualifiedIdentifier_data();
+    void indexedType();
+    void indexedType_data();
+};
+
+#endif // KDEVPLATFORM_BENCH_REFERENCECOUNTING_H
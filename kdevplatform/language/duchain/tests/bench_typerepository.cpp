@@ -0,0 +1,139 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "bench_typerepository.h"
+
+#include <language/duchain/declaration.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/topducontext.h>
+#include <language/duchain/types/functiontype.h>
+#include <language/duchain/types/integraltype.h>
+#include <language/duchain/types/pointertype.h>
+#include <language/duchain/types/typerepository.h>
+#include <serialization/indexedstring.h>
+
+#include <tests/testcore.h>
+#include <tests/autotestshell.h>
+
+#include <QTest>
+
+using namespace KDevelop;
+
+namespace {
+const int declarationCount = 10000;
+
+/// Some distinct types, used by many declarations like in real code.
+QVector<AbstractType::Ptr> typePool()
+{
+    QVector<AbstractType::Ptr> ret;
+    const QVector<uint> dataTypes{IntegralType::TypeInt, IntegralType::TypeChar, IntegralType::TypeBoolean,
+                                  IntegralType::TypeDouble, IntegralType::TypeVoid};
+    for (uint dataType : dataTypes) {
+        AbstractType::Ptr integral(new IntegralType(dataType));
+        ret.append(integral);
+
+        AbstractType::Ptr constIntegral(new IntegralType(dataType));
+        constIntegral->setModifiers(AbstractType::ConstModifier);
+        ret.append(constIntegral);
+
+        PointerType::Ptr pointer(new PointerType);
+        pointer->setBaseType(constIntegral);
+        ret.append(pointer);
+
+        FunctionType::Ptr function(new FunctionType);
+        function->setReturnType(integral);
+        function->addArgument(pointer);
+        ret.append(function);
+    }
+    return ret;
+}
+}
+
+QTEST_GUILESS_MAIN(BenchTypeRepository)
+
+void BenchTypeRepository::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    const QVector<AbstractType::Ptr> types = typePool();
+
+    DUChainWriteLocker lock;
+    m_context = new TopDUContext(IndexedString(QStringLiteral("/bench_typerepository.cpp")),
+                                 RangeInRevision(0, 0, declarationCount, 0));
+    DUChain::self()->addDocumentChain(m_context);
+    for (int i = 0; i < declarationCount; ++i) {
+        auto* declaration = new Declaration(RangeInRevision(i, 0, i, 1), m_context);
+        declaration->setIdentifier(Identifier(QStringLiteral("declaration%1").arg(i)));
+        declaration->setAbstractType(types.at(i % types.size()));
+    }
+}
+
+void BenchTypeRepository::cleanupTestCase()
+{
+    {
+        DUChainWriteLocker lock;
+        DUChain::self()->removeDocumentChain(m_context);
+        m_context = nullptr;
+    }
+
+    TestCore::shutdown();
+}
+
+void BenchTypeRepository::typeToString()
+{
+    QFETCH(bool, shared);
+
+    DUChainReadLocker lock;
+    const auto declarations = m_context->localDeclarations();
+    const auto before = TypeRepository::sharedTypeStatistics();
+
+    int length = 0;
+    if (shared) {
+        QBENCHMARK {
+            for (const Declaration* declaration : declarations) {
+                length += declaration->indexedType().constAbstractType()->toString().size();
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const Declaration* declaration : declarations) {
+                length += declaration->abstractType()->toString().size();
+            }
+        }
+    }
+    QVERIFY(length > 0);
+
+    const auto after = TypeRepository::sharedTypeStatistics();
+    qDebug() << "types created:" << after.created - before.created << "creations avoided:" << after.reused -
+        before.reused;
+    if (shared) {
+        QVERIFY(after.reused - before.reused > after.created - before.created);
+    }
+}
+
+void BenchTypeRepository::typeToString_data()
+{
+    QTest::addColumn<bool>("shared");
+
+    QTest::newRow("typeForIndex") << false;
+    QTest::newRow("sharedTypeForIndex") << true;
+}
@@ -40,6 +40,7 @@
 #include <language/duchain/duchainregister.h>
 #include <language/duchain/problem.h>
 #include <language/duchain/parsingenvironment.h>
+#include <language/duchain/duchainsnapshot.h>
 
 #include <language/codegen/coderepresentation.h>
 
@@ -49,6 +50,7 @@
 // #include <typeinfo>
 #include <set>
 #include <algorithm>
+#include <limits>
 #include <iterator> // needed for std::insert_iterator on windows
 #include <QThread>
 
@@ -842,6 +844,80 @@ void TestDUChain::testProblemSerialization()
     QVERIFY(parent->diagnostics().isEmpty());
 }
 
+void TestDUChain::testMemoryBudget()
+{
+    DUChain::self()->disablePersistentStorage(false);
+    // start with only the referenced top-contexts of other tests loaded
+    DUChain::self()->setMemoryBudget(0);
+    DUChain::self()->storeToDisk();
+
+    QVector<IndexedTopDUContext> tops;
+    {
+        DUChainWriteLocker lock;
+        for (int i = 0; i < 4; ++i) {
+            const IndexedString url(QStringLiteral("/test/budget%1.cpp").arg(i));
+            auto top = new TopDUContext(url, {0, 0, 100, 0}, new ParsingEnvironmentFile(url));
+            DUChain::self()->addDocumentChain(top);
+            for (int j = 0; j < 50; ++j) {
+                auto* declaration = new Declaration({j, 0, j, 1}, top);
+                declaration->setIdentifier(Identifier(QStringLiteral("decl%1").arg(j)));
+            }
+            tops.append(top->indexed());
+        }
+    }
+
+    // nothing is unloaded while everything fits
+    DUChain::self()->setMemoryBudget(std::numeric_limits<qint64>::max());
+    DUChain::self()->storeToDisk();
+    for (const auto& top : qAsConst(tops)) {
+        QVERIFY(top.isLoaded());
+    }
+
+    // the least recently used one is 1, then 0
+    {
+        DUChainReadLocker lock;
+        for (int i : {1, 0, 3, 2}) {
+            QVERIFY(DUChain::self()->chainForIndex(tops[i].index()));
+        }
+    }
+
+    const auto before = DUChain::self()->memoryStatistics();
+    DUChain::self()->setMemoryBudget(before.loadedBytes - 1);
+    DUChain::self()->storeToDisk();
+    const auto afterFirst = DUChain::self()->memoryStatistics();
+    QVERIFY(!tops[1].isLoaded());
+    QVERIFY(tops[0].isLoaded());
+    QVERIFY(tops[2].isLoaded());
+    QVERIFY(tops[3].isLoaded());
+    QCOMPARE(afterFirst.unloads, before.unloads + 1);
+    QVERIFY(afterFirst.loadedBytes <= afterFirst.memoryBudget);
+
+    DUChain::self()->setMemoryBudget(afterFirst.loadedBytes - 1);
+    DUChain::self()->storeToDisk();
+    QVERIFY(!tops[0].isLoaded());
+    QVERIFY(tops[2].isLoaded());
+    QVERIFY(tops[3].isLoaded());
+    QVERIFY(DUChain::self()->memoryStatistics().loadedBytes <= DUChain::self()->memoryBudget());
+
+    // loading an unloaded one again counts as reload
+    {
+        DUChainWriteLocker lock;
+        QVERIFY(DUChain::self()->chainForIndex(tops[1].index()));
+        QCOMPARE(DUChain::self()->memoryStatistics().reloads, afterFirst.reloads + 1);
+    }
+
+    DUChain::self()->setMemoryBudget(0);
+    {
+        DUChainWriteLocker lock;
+        for (const auto& top : qAsConst(tops)) {
+            if (TopDUContext* context = top.data()) {
+                DUChain::self()->removeDocumentChain(context);
+            }
+        }
+    }
+    DUChain::self()->disablePersistentStorage(true);
+}
+
 void TestDUChain::testIdentifiers()
 {
     QualifiedIdentifier aj(QStringLiteral("::Area::jump"));
@@ -913,6 +989,55 @@ void TestDUChain::testIdentifiers()
     ///@todo create a big randomized test for the identifier repository(check that indices are the same)
 }
 
+void TestDUChain::testSnapshot()
+{
+    const IndexedString url(QStringLiteral("/tmp/snapshot.cpp"));
+    ReferencedTopDUContext top;
+    DeclarationId classId;
+    {
+        DUChainWriteLocker lock;
+        top = new TopDUContext(url, {0, 0, 10, 0});
+        DUChain::self()->addDocumentChain(top);
+
+        auto* classDecl = new Declaration({0, 6, 0, 9}, top);
+        classDecl->setIdentifier(Identifier(QStringLiteral("Foo")));
+        classDecl->setKind(Declaration::Type);
+        auto* classContext = new DUContext({0, 10, 2, 0}, top);
+        classContext->setLocalScopeIdentifier(QualifiedIdentifier(QStringLiteral("Foo")));
+        classDecl->setInternalContext(classContext);
+        auto* member = new Declaration({1, 4, 1, 7}, classContext);
+        member->setIdentifier(Identifier(QStringLiteral("bar")));
+
+        top->createUse(top->indexForUsedDeclaration(classDecl), {3, 0, 3, 3});
+        classId = classDecl->id();
+    }
+
+    const auto snapshot = DUChainSnapshot::create({top, ReferencedTopDUContext()});
+    QCOMPARE(snapshot.files().size(), 1);
+    const auto declarationsOnly = DUChainSnapshot::create({top}, DUChainSnapshot::Declarations);
+    QVERIFY(declarationsOnly.files().first().uses.isEmpty());
+
+    // reading the snapshot doesn't need the duchain lock, so it works even while the chain is written
+    DUChainWriteLocker lock;
+    const DUChainSnapshot::File& file = snapshot.files().first();
+    QCOMPARE(file.url, url);
+    QCOMPARE(file.topContext, top);
+    QCOMPARE(file.declarations.size(), 2);
+    QCOMPARE(file.declarations[0].qualifiedIdentifier, QStringLiteral("Foo"));
+    QCOMPARE(file.declarations[0].kind, Declaration::Type);
+    QCOMPARE(file.declarations[0].parent, -1);
+    QCOMPARE(file.declarations[1].qualifiedIdentifier, QStringLiteral("Foo::bar"));
+    QCOMPARE(file.declarations[1].parent, 0);
+
+    const auto uses = snapshot.usesOf(classId);
+    QCOMPARE(uses.size(), 1);
+    QCOMPARE(uses.first().first, url);
+    QCOMPARE(uses.first().second.range, RangeInRevision(3, 0, 3, 3));
+    QCOMPARE(file.declarations[1].range, RangeInRevision(1, 4, 1, 7));
+
+    DUChain::self()->removeDocumentChain(top);
+}
+
 #if 0
 
 ///NOTE: the "unit tests" below are not automated, they - so far - require
@@ -46,7 +46,9 @@ private Q_SLOTS:
     void testLockForRead();
     void testLockForReadWrite();
     void testProblemSerialization();
+    void testMemoryBudget();
     void testIdentifiers();
+    void testSnapshot();
     ///NOTE: these are not "automated"!
 //     void testImportCache();
 
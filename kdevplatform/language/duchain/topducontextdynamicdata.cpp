@@ -633,6 +633,23 @@ bool TopDUContextDynamicData::isOnDisk() const
     return m_onDisk;
 }
 
+qint64 TopDUContextDynamicData::memoryUsage() const
+{
+    qint64 ret = m_mappedDataSize;
+    for (const ArrayWithPosition& array : qAsConst(m_data)) {
+        ret += array.array.size();
+    }
+
+    for (const ArrayWithPosition& array : qAsConst(m_topContextData)) {
+        ret += array.array.size();
+    }
+
+    // Not every slot is loaded, but counting them would need a walk over all of them
+    ret += m_contexts.items.size() * qint64(sizeof(DUContext));
+    ret += m_declarations.items.size() * qint64(sizeof(Declaration));
+    return ret;
+}
+
 void TopDUContextDynamicData::deleteOnDisk()
 {
     if (!isOnDisk())
@@ -87,6 +87,10 @@ public:
     ///Whether this top-context is on disk(Either has been loaded, or has been stored)
     bool isOnDisk() const;
 
+    ///Rough estimate of the memory held by this top-context in bytes: its data arrays, the mapped file
+    ///and the contained contexts and declarations. Needs the duchain to be locked.
+    qint64 memoryUsage() const;
+
     ///Loads the top-context from disk, or returns zero on failure. The top-context will not be registered anywhere, and will have no ParsingEnvironmentFile assigned.
     ///Also loads all imported contexts. The Declarations/Contexts will be correctly initialized, and put into the symbol tables if needed.
     static TopDUContext* load(uint topContextIndex);
@@ -89,6 +89,8 @@ class KDEVPLATFORMLANGUAGE_EXPORT AbstractType
 {
 public:
     using Ptr = TypePtr<AbstractType>;
+    /// A pointer to a type which must not be modified, e.g. because it is shared, see TypeRepository::sharedTypeForIndex().
+    using ConstPtr = TypePtr<const AbstractType>;
 
     /**
      * An enumeration of common modifiers for data types.
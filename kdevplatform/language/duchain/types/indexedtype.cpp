@@ -66,4 +66,11 @@ AbstractType::Ptr IndexedType::abstractType() const
         return AbstractType::Ptr();
     return TypeRepository::typeForIndex(m_index);
 }
+
+AbstractType::ConstPtr IndexedType::constAbstractType() const
+{
+    if (!m_index)
+        return AbstractType::ConstPtr();
+    return TypeRepository::sharedTypeForIndex(m_index);
+}
 }
@@ -60,6 +60,22 @@ public:
     template <class T>
     TypePtr<T> type() const { return TypePtr<T>::dynamicCast(abstractType()); }
 
+    /**
+     * Access the type without creating a new instance, see TypeRepository::sharedTypeForIndex().
+     * Prefer this over abstractType() when the type is only read.
+     *
+     * \returns the shared type pointer, or null if this index is invalid.
+     */
+    AbstractType::ConstPtr constAbstractType() const;
+
+    /**
+     * Access the shared type, dynamically casted to the type you provide.
+     *
+     * \returns the shared type pointer, or null if this index is invalid.
+     */
+    template <class T>
+    TypePtr<const T> constType() const { return TypePtr<const T>::dynamicCast(constAbstractType()); }
+
     /// Determine if the type is valid. \returns true if valid, otherwise false.
     bool isValid() const
     {
@@ -18,6 +18,7 @@
 
 #include "typerepository.h"
 
+#include <QCache>
 #include <QMutex>
 #include <QMutexLocker>
 
@@ -114,6 +115,30 @@ AbstractRepositoryManager* typeRepositoryManager()
     return &typeRepository();
 }
 
+namespace {
+/// Maximum number of type instances kept by TypeRepository::sharedTypeForIndex().
+const int sharedTypeCacheSize = 10000;
+
+struct SharedTypeCache
+{
+    SharedTypeCache()
+    {
+        // the cached types point into the repository, so make sure it is destroyed after them
+        typeRepository();
+    }
+
+    QMutex mutex;
+    QCache<uint, AbstractType::ConstPtr> types{sharedTypeCacheSize};
+    TypeRepository::SharedTypeStatistics statistics;
+};
+
+SharedTypeCache& sharedTypeCache()
+{
+    static SharedTypeCache cache;
+    return cache;
+}
+}
+
 uint TypeRepository::indexForType(const AbstractType::Ptr& input)
 {
     if (!input)
@@ -144,10 +169,69 @@ AbstractType::Ptr TypeRepository::typeForIndex(uint index)
                                                                                          index))));
 }
 
+AbstractType::ConstPtr TypeRepository::sharedTypeForIndex(uint index)
+{
+    if (index == 0)
+        return AbstractType::ConstPtr();
+
+    SharedTypeCache& cache = sharedTypeCache();
+    {
+        QMutexLocker lock(&cache.mutex);
+        if (const AbstractType::ConstPtr* type = cache.types.object(index)) {
+            ++cache.statistics.reused;
+            return *type;
+        }
+    }
+
+    // Create the type without blocking the other lookups, this locks the repository
+    AbstractType::ConstPtr type(typeForIndex(index).data());
+    if (!type)
+        return type;
+
+    QMutexLocker lock(&cache.mutex);
+    if (const AbstractType::ConstPtr* cached = cache.types.object(index)) {
+        // Another thread was faster, share its instance
+        ++cache.statistics.reused;
+        return *cached;
+    }
+    ++cache.statistics.created;
+    cache.types.insert(index, new AbstractType::ConstPtr(type));
+    return type;
+}
+
+TypeRepository::SharedTypeStatistics TypeRepository::sharedTypeStatistics()
+{
+    SharedTypeCache& cache = sharedTypeCache();
+    QMutexLocker lock(&cache.mutex);
+    return cache.statistics;
+}
+
+void TypeRepository::clearSharedTypes()
+{
+    SharedTypeCache& cache = sharedTypeCache();
+    QMutexLocker lock(&cache.mutex);
+    cache.types.clear();
+}
+
+#ifndef TEST_REFERENCE_COUNTING
+// Types are referenced from all over the stored DUChain data, buffer the reference-count
+// changes instead of locking the repository for each of them
+static ReferenceCountBuffer& typeReferenceCounts()
+{
+    static ReferenceCountBuffer buffer(typeRepository()->mutex(), [](uint index, int delta) {
+        AbstractTypeData* data = typeRepository()->dynamicItemFromIndexSimple(index);
+        Q_ASSERT(data);
+        data->refCount += delta;
+    });
+    return buffer;
+}
+#endif
+
 void TypeRepository::increaseReferenceCount(uint index, ReferenceCountManager* manager)
 {
     if (!index)
         return;
+#ifdef TEST_REFERENCE_COUNTING
     QMutexLocker lock(typeRepository()->mutex());
     AbstractTypeData* data = typeRepository()->dynamicItemFromIndexSimple(index);
     Q_ASSERT(data);
@@ -155,12 +239,17 @@ void TypeRepository::increaseReferenceCount(uint index, ReferenceCountManager* m
         manager->increase(data->refCount, index);
     else
         ++data->refCount;
+#else
+    Q_UNUSED(manager);
+    typeReferenceCounts().increase(index);
+#endif
 }
 
 void TypeRepository::decreaseReferenceCount(uint index, ReferenceCountManager* manager)
 {
     if (!index)
         return;
+#ifdef TEST_REFERENCE_COUNTING
     QMutexLocker lock(typeRepository()->mutex());
     AbstractTypeData* data = typeRepository()->dynamicItemFromIndexSimple(index);
     Q_ASSERT(data);
@@ -169,5 +258,9 @@ void TypeRepository::decreaseReferenceCount(uint index, ReferenceCountManager* m
         manager->decrease(data->refCount, index);
     else
         --data->refCount;
+#else
+    Q_UNUSED(manager);
+    typeReferenceCounts().decrease(index);
+#endif
 }
 }
@@ -20,16 +20,37 @@
 #define KDEVPLATFORM_TYPEREPOSITORY_H
 
 #include <language/duchain/types/abstracttype.h>
+#include <language/languageexport.h>
 
 namespace KDevelop {
 struct ReferenceCountManager;
 class AbstractRepositoryManager;
 
-class TypeRepository
+class KDEVPLATFORMLANGUAGE_EXPORT TypeRepository
 {
 public:
+    struct SharedTypeStatistics
+    {
+        /// Number of type instances created by sharedTypeForIndex().
+        quint64 created = 0;
+        /// Number of calls to sharedTypeForIndex() which returned an existing instance.
+        quint64 reused = 0;
+    };
+
     static uint indexForType(const AbstractType::Ptr& input);
+    /// Creates a new instance of the type with the given @p index, which the caller may modify.
     static AbstractType::Ptr typeForIndex(uint index);
+    /**
+     * Returns an instance of the type with the given @p index, shared with all other callers.
+     *
+     * A bounded number of recently used instances is kept, so reading the same type over and
+     * over doesn't create a new instance each time. The instance must not be modified, use
+     * typeForIndex() or AbstractType::clone() to get a copy that can be changed.
+     */
+    static AbstractType::ConstPtr sharedTypeForIndex(uint index);
+    static SharedTypeStatistics sharedTypeStatistics();
+    /// Drops all shared type instances, must be called before types are removed from the repository.
+    static void clearSharedTypes();
     static void increaseReferenceCount(uint index);
     static void decreaseReferenceCount(uint index);
     static void increaseReferenceCount(uint index, ReferenceCountManager* manager);
@@ -20,6 +20,7 @@
 
 #include <QString>
 #include <QFileInfo>
+#include <QtConcurrentMap>
 
 #include <serialization/indexedstring.h>
 #include "modificationrevisionset.h"
@@ -86,6 +87,33 @@ void ModificationRevision::clearModificationCache(const IndexedString& fileName)
     fileModificationCache().remove(fileName);
 }
 
+void ModificationRevision::prefetchModificationTimes(const QVector<IndexedString>& fileNames)
+{
+    const auto currentTime = QDateTime::currentDateTime();
+
+    QVector<QPair<IndexedString, QDateTime>> missing;
+    {
+        QMutexLocker lock(&fileModificationTimeCacheMutex);
+        for (const auto& fileName : fileNames) {
+            auto it = fileModificationCache().constFind(fileName);
+            if (it == fileModificationCache().constEnd()
+                || it.value().m_readTime.secsTo(currentTime) >= cacheModificationTimesForSeconds) {
+                missing.append({fileName, QDateTime()});
+            }
+        }
+    }
+
+    // stat'ing is what takes the time, do it without holding the lock
+    QtConcurrent::blockingMap(missing, [](QPair<IndexedString, QDateTime>& file) {
+        file.second = QFileInfo(file.first.str()).lastModified();
+    });
+
+    QMutexLocker lock(&fileModificationTimeCacheMutex);
+    for (const auto& file : qAsConst(missing)) {
+        fileModificationCache().insert(file.first, {currentTime, file.second});
+    }
+}
+
 ModificationRevision ModificationRevision::revisionForFile(const IndexedString& url)
 {
     QMutexLocker lock(&fileModificationTimeCacheMutex);
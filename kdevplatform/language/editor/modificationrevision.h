@@ -20,6 +20,7 @@
 #define KDEVPLATFORM_MODIFICATIONREVISION_H
 
 #include <QDateTime>
+#include <QVector>
 #include <language/languageexport.h>
 #include "../backgroundparser/documentchangetracker.h"
 
@@ -53,6 +54,10 @@ public:
     ///Otherwise, the on-disk modification-times are re-used for a specific amount of time
     static void clearModificationCache(const IndexedString& fileName);
 
+    ///Reads the on-disk modification-times of all given files that are not cached yet, in parallel.
+    ///Use this before checking many files for updates, so the checks don't need to stat files one by one.
+    static void prefetchModificationTimes(const QVector<IndexedString>& fileNames);
+
     ///The default-revision is 0, because that is the kate moving-revision for cleanly opened documents
     explicit ModificationRevision(const QDateTime& modTime = QDateTime(), int revision_ = 0);
 
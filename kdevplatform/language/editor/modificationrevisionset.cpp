@@ -221,6 +221,24 @@ bool ModificationRevisionSet::removeModificationRevision(const IndexedString& ur
     return m_index != oldModificationTimes.setIndex();
 }
 
+QVector<IndexedString> ModificationRevisionSet::files() const
+{
+    QMutexLocker lock(&modificationRevisionSetMutex);
+
+    QVector<IndexedString> ret;
+    if (!m_index)
+        return ret;
+
+    Utils::Set set = Utils::Set(m_index, &FileModificationSetRepositoryRepresenter::repository());
+    ret.reserve(set.count());
+    Utils::Set::Iterator it = set.iterator();
+    while (it) {
+        ret.append(fileModificationPairRepository().itemFromIndex(*it)->file);
+        ++it;
+    }
+    return ret;
+}
+
 // const QMap<IndexedString, KDevelop::ModificationRevision> ModificationRevisionSet::allModificationTimes() const {
 //   QMap<IndexedString, KDevelop::ModificationRevision> ret;
 //   Utils::Set::Iterator it = m_allModificationTimes.iterator();
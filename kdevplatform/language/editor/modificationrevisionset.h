@@ -51,6 +51,9 @@ public:
 
     bool needsUpdate() const;
 
+    ///Returns the files whose modification-revisions are contained in this set
+    QVector<IndexedString> files() const;
+
     QString toString() const;
 
     bool operator!=(const ModificationRevisionSet& rhs) const
@@ -115,4 +115,13 @@ int ILanguageSupport::suggestedReparseDelayForChange(KTextEditor::Document* doc,
         });
     return (isWhitespace && !joinedWord) ? NoUpdateRequired : DefaultDelay;
 }
+
+ParsingEnvironment* ILanguageSupport::createParsingEnvironment(const IndexedString& /*url*/)
+{
+    return nullptr;
+}
+
+void ILanguageSupport::completeParsingEnvironment(ParsingEnvironment* /*environment*/) const
+{
+}
 }
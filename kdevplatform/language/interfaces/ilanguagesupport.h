@@ -40,6 +40,7 @@ namespace KDevelop {
 class BasicRefactoring;
 class IndexedString;
 class ParseJob;
+class ParsingEnvironment;
 class TopDUContext;
 class ICodeHighlighting;
 class ICreateClassHelper;
@@ -163,6 +164,26 @@ public:
     virtual int suggestedReparseDelayForChange(KTextEditor::Document* doc, const KTextEditor::Range& changedRange,
                                                const QString& changedText, bool removal) const;
 
+    /**
+     * Create the parsing environment a parse job for @p url would check existing top-contexts with,
+     * see ParsingEnvironmentFile::needsUpdate(). This allows checking many files at once without
+     * creating a parse job for each of them, e.g. when a project is opened again.
+     *
+     * Called on the foreground thread, the caller takes ownership. The parts of the environment which
+     * the parse job only determines in the background are added by completeParsingEnvironment().
+     *
+     * The default implementation returns nullptr, for languages without a parsing environment.
+     */
+    virtual ParsingEnvironment* createParsingEnvironment(const IndexedString& url);
+
+    /**
+     * Add the parts of @p environment, created by createParsingEnvironment(), which the parse job
+     * determines in the background. Called from a background thread.
+     *
+     * The default implementation does nothing.
+     */
+    virtual void completeParsingEnvironment(ParsingEnvironment* environment) const;
+
 private:
     const QScopedPointer<class ILanguageSupportPrivate> d_ptr;
     Q_DECLARE_PRIVATE(ILanguageSupport)
@@ -184,6 +184,13 @@ QAbstractItemModel * KDevelop::OutputJob::model() const
     return d->outputModel;
 }
 
+int OutputJob::standardToolView() const
+{
+    Q_D(const OutputJob);
+
+    return d->standardToolView;
+}
+
 void KDevelop::OutputJob::setStandardToolView(IOutputView::StandardToolView standard)
 {
     Q_D(OutputJob);
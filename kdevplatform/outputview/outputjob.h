@@ -56,6 +56,9 @@ public:
     /// Set the \a title for this job's output tab.  If not set, will default to the job's objectName().
     void setTitle(const QString& title);
 
+    /// @return the IOutputView::StandardToolView the output is shown in, or -1 if it has its own tool view.
+    int standardToolView() const;
+
 protected:
     void setStandardToolView(IOutputView::StandardToolView standard);
     void setToolTitle(const QString& title);
@@ -39,6 +39,7 @@
 
 #include <QDir>
 #include <QIcon>
+#include <QTimer>
 
 #include <array>
 
@@ -48,7 +49,13 @@ using namespace KDevelop;
 
 ProjectChangesModel::ProjectChangesModel(QObject* parent)
     : VcsFileChangesModel(parent)
+    , m_pendingTimer(new QTimer(this))
 {
+    // saving all documents or adding many items at once must not spawn one status request per file
+    m_pendingTimer->setSingleShot(true);
+    m_pendingTimer->setInterval(100);
+    connect(m_pendingTimer, &QTimer::timeout, this, &ProjectChangesModel::reloadPending);
+
     const auto projects = ICore::self()->projectController()->projects();
     for (IProject* p : projects) {
         addProject(p);
@@ -101,6 +108,8 @@ void ProjectChangesModel::addProject(IProject* p)
 
 void ProjectChangesModel::removeProject(IProject* p)
 {
+    m_pendingUrls.remove(p);
+
     QStandardItem* it=projectItem(p);
     if (!it) {
         // when the project is closed before it was fully populated, we won't ever see a
@@ -224,7 +233,7 @@ void ProjectChangesModel::itemsAdded(const QModelIndex& parent, int start, int e
     }
         
     if(!urls.isEmpty())
-        changes(project, urls, KDevelop::IBasicVersionControl::NonRecursive);
+        scheduleChanges(project, urls);
 }
 
 void ProjectChangesModel::reload(const QList<IProject*>& projects)
@@ -240,8 +249,30 @@ void ProjectChangesModel::reload(const QList<QUrl>& urls)
         IProject* project=ICore::self()->projectController()->findProjectForUrl(url);
         
         if (project) {
-            // FIXME: merge multiple urls of the same project
-            changes(project, {url}, KDevelop::IBasicVersionControl::NonRecursive);
+            scheduleChanges(project, {url});
+        }
+    }
+}
+
+void ProjectChangesModel::scheduleChanges(IProject* project, const QList<QUrl>& urls)
+{
+    auto& pending = m_pendingUrls[project];
+    for (const QUrl& url : urls) {
+        pending.insert(url);
+    }
+    m_pendingTimer->start();
+}
+
+void ProjectChangesModel::reloadPending()
+{
+    const auto pendingUrls = m_pendingUrls;
+    m_pendingUrls.clear();
+    // keep the command lines of the version control tools within reasonable limits
+    const int maxUrlsPerRequest = 100;
+    for (auto it = pendingUrls.constBegin(), end = pendingUrls.constEnd(); it != end; ++it) {
+        const QList<QUrl> urls = it.value().values();
+        for (int i = 0; i < urls.size(); i += maxUrlsPerRequest) {
+            changes(it.key(), urls.mid(i, maxUrlsPerRequest), KDevelop::IBasicVersionControl::NonRecursive);
         }
     }
 }
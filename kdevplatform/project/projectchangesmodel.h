@@ -25,7 +25,11 @@
 
 #include "projectexport.h"
 
+#include <QHash>
+#include <QSet>
+
 class KJob;
+class QTimer;
 namespace KDevelop {
 class IProject;
 class IDocument;
@@ -59,6 +63,12 @@ class KDEVPLATFORMPROJECT_EXPORT ProjectChangesModel : public VcsFileChangesMode
 
     private:
         QStandardItem* projectItem(KDevelop::IProject* p) const;
+        void scheduleChanges(KDevelop::IProject* project, const QList<QUrl>& urls);
+        void reloadPending();
+
+        /// non-recursive status requests which are merged into one request per project
+        QHash<KDevelop::IProject*, QSet<QUrl>> m_pendingUrls;
+        QTimer* m_pendingTimer;
 };
 
 }
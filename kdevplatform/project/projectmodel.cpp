@@ -104,13 +104,24 @@ public:
     IProject* project = nullptr;
     ProjectBaseItem* parent = nullptr;
     QList<ProjectBaseItem*> children;
+    /// The name of the item, null if it is the last segment of m_path
     QString text;
+    /// Empty if pathFromParent is set
     Path m_path;
-    QString iconName;
     int row = -1;
     uint m_pathIndex = 0;
-    ProjectBaseItem::ProjectItemType type;
     Qt::ItemFlags flags;
+    /// Set if the path is the one of the parent folder plus text, to not store a Path for every file
+    bool pathFromParent = false;
+
+    /// Store the path of @p item in m_path, e.g. before it gets another parent.
+    void storePath(const ProjectBaseItem* item)
+    {
+        if (pathFromParent) {
+            m_path = item->path();
+            pathFromParent = false;
+        }
+    }
 
     ProjectBaseItem::RenameStatus renameBaseItem(ProjectBaseItem* item, const QString& newName)
     {
@@ -217,6 +228,7 @@ ProjectBaseItem* ProjectBaseItem::takeRow(int row)
         model()->beginRemoveRows(index(), row, row);
     }
     ProjectBaseItem* olditem = d->children.takeAt( row );
+    olditem->d_func()->storePath(olditem);
     olditem->d_func()->parent = nullptr;
     olditem->d_func()->row = -1;
     olditem->setModel( nullptr );
@@ -324,8 +336,10 @@ QString ProjectBaseItem::text() const
     Q_D(const ProjectBaseItem);
     if( project() && !parent() ) {
         return project()->name();
-    } else {
+    } else if (!d->text.isNull()) {
         return d->text;
+    } else {
+        return d->m_path.lastPathSegment();
     }
 }
 
@@ -362,6 +376,8 @@ void ProjectBaseItem::setText( const QString& text )
 {
     Q_ASSERT(!text.isEmpty() || !parent());
     Q_D(ProjectBaseItem);
+    // the path stays the same
+    d->storePath(this);
     d->text = text;
     if( d->model ) {
         QModelIndex idx = index();
@@ -412,6 +428,12 @@ bool ProjectBaseItem::lessThan( const KDevelop::ProjectBaseItem* item ) const
 
 bool ProjectBaseItem::pathLessThan(ProjectBaseItem* item1, ProjectBaseItem* item2)
 {
+    // files of the same folder only differ in their name, don't build their paths
+    const auto* d1 = item1->d_func();
+    const auto* d2 = item2->d_func();
+    if (d1->pathFromParent && d2->pathFromParent && d1->parent == d2->parent) {
+        return d1->text.compare(d2->text) < 0;
+    }
     return item1->path() < item2->path();
 }
 
@@ -451,7 +473,14 @@ void ProjectBaseItem::appendRow( ProjectBaseItem* item )
 Path ProjectBaseItem::path() const
 {
     Q_D(const ProjectBaseItem);
-    return d->m_path;
+    if (!d->pathFromParent) {
+        return d->m_path;
+    }
+    if (d->parent) {
+        return Path(d->parent->path(), d->text);
+    }
+    // only happens while the children of an item are deleted
+    return Path(IndexedString::fromIndex(d->m_pathIndex).str());
 }
 
 IndexedString ProjectBaseItem::indexedPath() const
@@ -472,9 +501,27 @@ void ProjectBaseItem::setPath( const Path& path)
         model()->d_func()->pathLookupTable.remove(d->m_pathIndex, this);
     }
 
-    d->m_path = path;
+    // the files in this folder derive their path from it, they keep the old one until they
+    // get their own setPath() call, such that they are still found by it, e.g. in the file set
+    for (ProjectBaseItem* child : qAsConst(d->children)) {
+        child->d_func()->storePath(child);
+    }
+
     d->m_pathIndex = indexForPath(path);
-    setText( path.lastPathSegment() );
+    // files are the bulk of the items, those in a folder don't need a Path of their own
+    if (file() && d->parent && d->parent->folder() && d->parent->path().isDirectParentOf(path)) {
+        d->pathFromParent = true;
+        d->m_path = Path();
+        d->text = path.lastPathSegment();
+    } else {
+        d->pathFromParent = false;
+        d->m_path = path;
+        d->text = QString();
+    }
+    if (d->model) {
+        const QModelIndex idx = index();
+        emit d->model->dataChanged(idx, idx);
+    }
 
     if (model() && d->m_pathIndex) {
         model()->d_func()->pathLookupTable.insert(d->m_pathIndex, this);
@@ -727,6 +774,8 @@ QString ProjectFileItem::fileName() const
 // Maximum length of a string to still consider it as a file extension which we cache
 // This has to be a slow value, so that we don't fill our file extension cache with crap
 static const int maximumCacheExtensionLength = 3;
+// Maximum number of file names without such an extension whose icon we cache, e.g. Makefile or libfoo.so.1
+static const int maximumCacheFileNames = 10000;
 
 bool isNumeric(const QStringRef& str)
 {
@@ -742,7 +791,7 @@ bool isNumeric(const QStringRef& str)
 class IconNameCache
 {
 public:
-    QString iconNameForPath(const Path& path, const QString& fileName)
+    QString iconNameForFile(const QString& fileName)
     {
         // find icon name based on file extension, if possible
         QString extension;
@@ -750,7 +799,7 @@ public:
         if( extensionStart != -1 && fileName.length() - extensionStart - 1 <= maximumCacheExtensionLength ) {
             QStringRef extRef = fileName.midRef(extensionStart + 1);
             if( isNumeric(extRef) ) {
-                // don't cache numeric extensions
+                // don't cache numeric extensions, e.g. of libfoo.so.1, but the whole file name
                 extRef.clear();
             }
             if( !extRef.isEmpty() ) {
@@ -762,8 +811,16 @@ public:
                 }
             }
         }
+        if (extension.isEmpty()) {
+            // the mime type lookup by name is expensive and happens on every repaint
+            QMutexLocker lock(&mutex);
+            const auto it = fileNameToIcon.constFind(fileName);
+            if (it != fileNameToIcon.constEnd()) {
+                return *it;
+            }
+        }
 
-        QMimeType mime = QMimeDatabase().mimeTypeForFile(path.lastPathSegment(), QMimeDatabase::MatchExtension); // no I/O
+        QMimeType mime = QMimeDatabase().mimeTypeForFile(fileName, QMimeDatabase::MatchExtension); // no I/O
         QMutexLocker lock(&mutex);
         QHash< QString, QString >::const_iterator it = mimeToIcon.constFind(mime.name());
         QString iconName;
@@ -778,31 +835,32 @@ public:
         }
         if ( !extension.isEmpty() ) {
             fileExtensionToIcon.insert(extension, iconName);
+        } else if (fileNameToIcon.size() < maximumCacheFileNames) {
+            fileNameToIcon.insert(fileName, iconName);
         }
         return iconName;
     }
     QMutex mutex;
     QHash<QString, QString> mimeToIcon;
     QHash<QString, QString> fileExtensionToIcon;
+    QHash<QString, QString> fileNameToIcon;
 };
 
 Q_GLOBAL_STATIC(IconNameCache, s_cache)
 
 QString ProjectFileItem::iconName() const
 {
-    // think of d_ptr->iconName as mutable, possible since d_ptr is not const
-    if (d_ptr->iconName.isEmpty()) {
-        // lazy load implementation of icon lookup
-        d_ptr->iconName = s_cache->iconNameForPath( d_ptr->m_path, d_ptr->text );
-        // we should always get *some* icon name back
-        Q_ASSERT(!d_ptr->iconName.isEmpty());
-    }
-    return d_ptr->iconName;
+    // not stored per item, the cache makes the lookup cheap enough
+    const QString iconName = s_cache->iconNameForFile(fileName());
+    // we should always get *some* icon name back
+    Q_ASSERT(!iconName.isEmpty());
+    return iconName;
 }
 
 void ProjectFileItem::setPath( const Path& path )
 {
-    if (path == d_ptr->m_path) {
+    // path() might already return the new path, if it is taken from the renamed parent folder
+    if (d_ptr->m_pathIndex && indexForPath(path) == d_ptr->m_pathIndex) {
         return;
     }
 
@@ -817,9 +875,6 @@ void ProjectFileItem::setPath( const Path& path )
         // add to fileset with new path
         project()->addToFileSet( this );
     }
-
-    // invalidate icon name for future lazy-loaded updated
-    d_ptr->iconName.clear();
 }
 
 int ProjectFileItem::type() const
@@ -845,8 +900,11 @@ QString ProjectTargetItem::iconName() const
 
 void ProjectTargetItem::setPath( const Path& path )
 {
-    // don't call base class, it calls setText with the new path's filename
+    // don't call base class, it changes the text to the new path's filename
     // which we do not want for target items
+    if (d_ptr->text.isNull()) {
+        d_ptr->text = text();
+    }
     d_ptr->m_path = path;
 }
 
@@ -20,12 +20,76 @@
 #include "projectproxymodel.h"
 #include <project/projectmodel.h>
 
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+namespace {
+/// Delay before searching again after the model changed, so e.g. a project import triggers one search
+const int refilterDelay = 200;
+/// Number of items searched between checks whether the search is still needed
+const int cancelCheckInterval = 1024;
+}
+
+struct ProjectProxyModel::FilterEntry
+{
+    /// Only used as key, never dereferenced outside of the UI thread
+    const KDevelop::ProjectBaseItem* item;
+    QString text;
+    /// Position of the parent entry, which always comes first, or -1
+    int parent;
+};
+
+struct ProjectProxyModel::FilterResult
+{
+    int generation = 0;
+    QString pattern;
+    QSharedPointer<const FilterEntries> entries;
+    /// Positions of the entries whose text contains pattern
+    QVector<int> matches;
+    /// The matching items and all their parents
+    QSet<const KDevelop::ProjectBaseItem*> acceptedItems;
+};
+
 ProjectProxyModel::ProjectProxyModel(QObject * parent)
     : QSortFilterProxyModel(parent)
     , m_showTargets(true)
+    , m_filterGeneration(new QAtomicInt(0))
+    , m_filterWatcher(new QFutureWatcher<FilterResult>(this))
+    , m_refilterTimer(new QTimer(this))
 {
     setDynamicSortFilter(true);
     sort(0); //initiate sorting regardless of the view
+
+    connect(m_filterWatcher, &QFutureWatcher<FilterResult>::finished, this, &ProjectProxyModel::filteringFinished);
+
+    m_refilterTimer->setSingleShot(true);
+    m_refilterTimer->setInterval(refilterDelay);
+    connect(m_refilterTimer, &QTimer::timeout, this, &ProjectProxyModel::startFiltering);
+}
+
+ProjectProxyModel::~ProjectProxyModel()
+{
+    // let a running search stop early, it only holds shared copies of its data
+    m_filterGeneration->ref();
+}
+
+void ProjectProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+    if (this->sourceModel()) {
+        disconnect(this->sourceModel(), nullptr, this, nullptr);
+    }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &ProjectProxyModel::sourceChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &ProjectProxyModel::sourceChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &ProjectProxyModel::sourceChanged);
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &ProjectProxyModel::sourceDataChanged);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &ProjectProxyModel::sourceChanged);
+    }
+    sourceChanged();
 }
 
 KDevelop::ProjectModel * ProjectProxyModel::projectModel() const
@@ -49,20 +113,198 @@ void ProjectProxyModel::showTargets(bool visible)
     }
 }
 
+QString ProjectProxyModel::filterString() const
+{
+    return m_filterString;
+}
+
+void ProjectProxyModel::setFilterString(const QString& filter)
+{
+    if (filter == m_filterString) {
+        return;
+    }
+    m_filterString = filter;
+    startFiltering();
+}
+
+void ProjectProxyModel::sourceChanged()
+{
+    m_filterEntries.reset();
+    m_filterEntryPositions.clear();
+    m_lastResult.reset();
+    if (!m_filterString.isEmpty()) {
+        m_refilterTimer->start();
+    }
+}
+
+void ProjectProxyModel::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (!m_filterEntries || !projectModel()) {
+        return;
+    }
+
+    // only the texts are searched, so e.g. icon updates don't need a new search,
+    // and renamed items are patched into a copy, the old entries might still be searched
+    QSharedPointer<FilterEntries> patched;
+    const QModelIndex parent = topLeft.parent();
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const auto* item = projectModel()->itemFromIndex(sourceModel()->index(row, 0, parent));
+        const auto it = m_filterEntryPositions.constFind(item);
+        if (it == m_filterEntryPositions.constEnd()) {
+            continue;
+        }
+        const FilterEntries& entries = patched ? *patched : *m_filterEntries;
+        if (entries.at(*it).text == item->text()) {
+            continue;
+        }
+        if (!patched) {
+            patched.reset(new FilterEntries(*m_filterEntries));
+        }
+        (*patched)[*it].text = item->text();
+    }
+
+    if (!patched) {
+        return;
+    }
+    // the last result can't be narrowed down anymore, the patched items might match now
+    m_filterEntries = patched;
+    if (!m_filterString.isEmpty()) {
+        m_refilterTimer->start();
+    }
+}
+
+void ProjectProxyModel::addFilterEntries(FilterEntries& entries, FilterEntryPositions& positions,
+                                         KDevelop::ProjectBaseItem* item, int parent)
+{
+    const int position = entries.size();
+    entries.append({item, item->text(), parent});
+    positions.insert(item, position);
+    const auto children = item->children();
+    for (KDevelop::ProjectBaseItem* child : children) {
+        addFilterEntries(entries, positions, child, position);
+    }
+}
+
+void ProjectProxyModel::startFiltering()
+{
+    m_refilterTimer->stop();
+    const int generation = m_filterGeneration->fetchAndAddOrdered(1) + 1;
+
+    if (m_filterString.isEmpty()) {
+        m_acceptedItems.clear();
+        m_lastResult.reset();
+        if (m_filterActive) {
+            m_filterActive = false;
+            invalidateFilter();
+        }
+        return;
+    }
+
+    if (!m_filterEntries && projectModel()) {
+        // reading the texts is cheap compared to matching them, but has to happen in the UI thread
+        auto* entries = new FilterEntries;
+        m_filterEntryPositions.clear();
+        const auto topItems = projectModel()->topItems();
+        for (KDevelop::ProjectBaseItem* item : topItems) {
+            addFilterEntries(*entries, m_filterEntryPositions, item, -1);
+        }
+        m_filterEntries = QSharedPointer<const FilterEntries>(entries);
+    }
+
+    // every item which contains the new pattern also contained the previous one
+    QSharedPointer<const FilterResult> previous;
+    if (m_lastResult && m_lastResult->entries == m_filterEntries
+        && m_filterString.contains(m_lastResult->pattern, Qt::CaseInsensitive)) {
+        previous = m_lastResult;
+    }
+
+    const auto entries = m_filterEntries;
+    const auto pattern = m_filterString;
+    const auto generationCounter = m_filterGeneration;
+    m_filterWatcher->setFuture(QtConcurrent::run([entries, pattern, previous, generationCounter, generation]() {
+        return filterEntries(entries, pattern, previous, generationCounter, generation);
+    }));
+}
+
+ProjectProxyModel::FilterResult ProjectProxyModel::filterEntries(const QSharedPointer<const FilterEntries>& entries,
+                                                                 const QString& pattern,
+                                                                 const QSharedPointer<const FilterResult>& previous,
+                                                                 const QSharedPointer<QAtomicInt>& generationCounter,
+                                                                 int generation)
+{
+    FilterResult result;
+    result.generation = generation;
+    result.pattern = pattern;
+    result.entries = entries;
+    if (!entries) {
+        return result;
+    }
+
+    auto check = [&](int position) {
+        if (entries->at(position).text.contains(pattern, Qt::CaseInsensitive)) {
+            result.matches.append(position);
+        }
+    };
+    if (previous) {
+        for (int position : previous->matches) {
+            check(position);
+        }
+    } else {
+        for (int position = 0; position < entries->size(); ++position) {
+            if (position % cancelCheckInterval == 0 && generationCounter->load() != generation) {
+                // outdated, the result is dropped anyways
+                return result;
+            }
+            check(position);
+        }
+    }
+
+    for (int position : qAsConst(result.matches)) {
+        // stop at the first parent which was already added for an earlier match
+        while (position != -1) {
+            const FilterEntry& entry = entries->at(position);
+            if (result.acceptedItems.contains(entry.item)) {
+                break;
+            }
+            result.acceptedItems.insert(entry.item);
+            position = entry.parent;
+        }
+    }
+    return result;
+}
+
+void ProjectProxyModel::filteringFinished()
+{
+    const FilterResult result = m_filterWatcher->result();
+    if (result.generation != m_filterGeneration->load()) {
+        return;
+    }
+
+    m_acceptedItems = result.acceptedItems;
+    m_lastResult = QSharedPointer<const FilterResult>(new FilterResult(result));
+    m_filterActive = true;
+    // apply the whole result at once
+    invalidateFilter();
+}
+
 bool ProjectProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
-    if (m_showTargets) {
+    if (m_showTargets && !m_filterActive) {
         return true;
     }
-    else {
-        // Get the base item for the associated parent and row.
-        QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-        auto *item = projectModel()->itemFromIndex(index);
-        // If it's a target, return false, otherwise true.
-        return item->type() != KDevelop::ProjectBaseItem::Target
-            && item->type() != KDevelop::ProjectBaseItem::LibraryTarget
-            && item->type() != KDevelop::ProjectBaseItem::ExecutableTarget;
+
+    // Get the base item for the associated parent and row.
+    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    auto *item = projectModel()->itemFromIndex(index);
+
+    if (!m_showTargets
+        && (item->type() == KDevelop::ProjectBaseItem::Target
+            || item->type() == KDevelop::ProjectBaseItem::LibraryTarget
+            || item->type() == KDevelop::ProjectBaseItem::ExecutableTarget)) {
+        return false;
     }
+
+    return !m_filterActive || m_acceptedItems.contains(item);
 }
 
 QModelIndex ProjectProxyModel::proxyIndexFromItem(KDevelop::ProjectBaseItem* item) const
@@ -20,9 +20,15 @@
 #ifndef KDEVPLATFORM_PROJECTPROXYMODEL_H
 #define KDEVPLATFORM_PROJECTPROXYMODEL_H
 
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
 #include <QSortFilterProxyModel>
 #include "projectexport.h"
 
+class QTimer;
+template <typename T> class QFutureWatcher;
+
 namespace KDevelop {
     class ProjectModel;
     class ProjectBaseItem;
@@ -33,6 +39,7 @@ class KDEVPLATFORMPROJECT_EXPORT ProjectProxyModel : public QSortFilterProxyMode
     Q_OBJECT
     public:
         explicit ProjectProxyModel(QObject *parent);
+        ~ProjectProxyModel() override;
         bool lessThan (const QModelIndex & left, const QModelIndex & right) const override;
 
         QModelIndex proxyIndexFromItem(KDevelop::ProjectBaseItem* item) const;
@@ -40,13 +47,56 @@ class KDEVPLATFORMPROJECT_EXPORT ProjectProxyModel : public QSortFilterProxyMode
 
         void showTargets(bool visible);
 
+        /**
+         * Only show the items whose text contains @p filter, and their parents.
+         *
+         * The matching items are searched in a worker thread, the view is updated once
+         * the result is there. When @p filter extends the previous filter, only the items
+         * which matched before are checked again. An empty @p filter shows all items.
+         */
+        void setFilterString(const QString& filter);
+        QString filterString() const;
+
+        void setSourceModel(QAbstractItemModel* sourceModel) override;
+
     protected:
         bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
     private:
+        struct FilterEntry;
+        struct FilterResult;
+        using FilterEntries = QVector<FilterEntry>;
+        using FilterEntryPositions = QHash<const KDevelop::ProjectBaseItem*, int>;
+
         KDevelop::ProjectModel* projectModel() const;
+        void sourceChanged();
+        void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+        void startFiltering();
+        void filteringFinished();
+        static void addFilterEntries(FilterEntries& entries, FilterEntryPositions& positions,
+                                     KDevelop::ProjectBaseItem* item, int parent);
+        static FilterResult filterEntries(const QSharedPointer<const FilterEntries>& entries, const QString& pattern,
+                                          const QSharedPointer<const FilterResult>& previous,
+                                          const QSharedPointer<QAtomicInt>& generationCounter, int generation);
+
         bool m_showTargets;
 
+        QString m_filterString;
+        /// Whether m_acceptedItems is applied, might be for an older filter string while a new one is searched
+        bool m_filterActive = false;
+        QSet<const KDevelop::ProjectBaseItem*> m_acceptedItems;
+        /// The texts of all items, null after rows were added, removed or moved
+        QSharedPointer<const FilterEntries> m_filterEntries;
+        /// Position of each item in m_filterEntries, to patch the entries of changed items
+        FilterEntryPositions m_filterEntryPositions;
+        /// The last applied result, to narrow it down when the filter string gets extended
+        QSharedPointer<const FilterResult> m_lastResult;
+        /// Incremented for each search, so searches for outdated filter strings stop early
+        QSharedPointer<QAtomicInt> m_filterGeneration;
+        QFutureWatcher<FilterResult>* m_filterWatcher;
+        /// Collects model changes before searching again
+        QTimer* m_refilterTimer;
+
 };
 
 #endif
@@ -33,6 +33,10 @@
 #include <tests/autotestshell.h>
 #include <tests/testplugincontroller.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 // Knobs to increase/decrease the amount of items being generated
 #define SMALL_DEPTH 2
 #define SMALL_WIDTH 10
@@ -47,18 +51,63 @@ using KDevelop::ProjectBaseItem;
 using KDevelop::ProjectFileItem;
 using KDevelop::Path;
 
-void generateChilds( ProjectBaseItem* parent, int count, int depth )
+// Returns the number of generated items
+int generateChilds( ProjectBaseItem* parent, int count, int depth )
 {
+    int items = 0;
     for( int i = 0; i < 10; i++ ) {
         if( depth > 0 ) {
             auto* item = new ProjectFolderItem( QStringLiteral( "f%1" ).arg( i ), parent );
-            generateChilds( item, count, depth - 1 );
+            items += 1 + generateChilds( item, count, depth - 1 );
         } else {
             new ProjectFileItem( QStringLiteral( "f%1" ).arg( i ), parent );
+            ++items;
         }
     }
+    return items;
 }
 
+// Returns the number of bytes currently allocated on the heap, or -1 if unknown
+qint64 allocatedBytes()
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    return mallinfo2().uordblks;
+#else
+    return static_cast<uint>(mallinfo().uordblks);
+#endif
+#else
+    return -1;
+#endif
+}
+
+// Measures the time and the memory needed to build a tree of items
+class TreeBuildMeasurement
+{
+public:
+    TreeBuildMeasurement()
+        : bytesBefore(allocatedBytes())
+    {
+        timer.start();
+    }
+
+    void report(const char* name, int items) const
+    {
+        const qint64 elapsed = timer.elapsed();
+        const qint64 bytesAfter = allocatedBytes();
+        if (bytesBefore < 0 || bytesAfter < 0 || items == 0) {
+            qDebug() << name << elapsed << "ms for" << items << "items";
+            return;
+        }
+        qDebug() << name << elapsed << "ms for" << items << "items,"
+                 << (bytesAfter - bytesBefore) / items << "bytes per item";
+    }
+
+private:
+    QElapsedTimer timer;
+    const qint64 bytesBefore;
+};
+
 ProjectModelPerformanceTest::ProjectModelPerformanceTest(QWidget* parent )
     : QWidget(parent)
 {
@@ -102,15 +151,16 @@ void ProjectModelPerformanceTest::init()
     model = new KDevelop::ProjectModel( this );
 
     qDebug() << "create model" << timer.elapsed();
-    timer.start();
 
+    const TreeBuildMeasurement measurement;
+    int items = 0;
     for( int i = 0; i < INIT_WIDTH; i++ ) {
         auto* item = new ProjectFolderItem( nullptr, Path( QUrl::fromLocalFile( QStringLiteral( "/f%1" ).arg( i ) ) ) );
-        generateChilds( item, INIT_WIDTH, INIT_DEPTH );
+        items += 1 + generateChilds( item, INIT_WIDTH, INIT_DEPTH );
         model->appendRow( item );
     }
 
-    qDebug() << "init model" << timer.elapsed();
+    measurement.report("init model", items);
     timer.start();
 
     view->setModel( model );
@@ -127,14 +177,14 @@ ProjectModelPerformanceTest::~ProjectModelPerformanceTest()
 
 void ProjectModelPerformanceTest::addBigTree()
 {
-    QElapsedTimer timer;
-    timer.start();
+    const TreeBuildMeasurement measurement;
+    int items = 0;
     for( int i = 0; i < BIG_WIDTH; i++ ) {
         auto* item = new ProjectFolderItem( nullptr, Path( QUrl::fromLocalFile( QStringLiteral( "/f%1" ).arg( i ) ) ) );
-        generateChilds( item, BIG_WIDTH, BIG_DEPTH );
+        items += 1 + generateChilds( item, BIG_WIDTH, BIG_DEPTH );
         model->appendRow( item );
     }
-    qDebug() << "addBigTree" << timer.elapsed();
+    measurement.report("addBigTree", items);
 }
 
 void ProjectModelPerformanceTest::addBigTreeDelayed()
@@ -182,14 +232,14 @@ void ProjectModelPerformanceTest::addItemDelayed()
 
 void ProjectModelPerformanceTest::addSmallTree()
 {
-    QElapsedTimer timer;
-    timer.start();
+    const TreeBuildMeasurement measurement;
+    int items = 0;
     for( int i = 0; i < SMALL_WIDTH; i++ ) {
         auto* item = new ProjectFolderItem( nullptr, Path(QUrl::fromLocalFile( QStringLiteral( "/f%1" ).arg( i ) )) );
-        generateChilds( item, SMALL_WIDTH, SMALL_DEPTH );
+        items += 1 + generateChilds( item, SMALL_WIDTH, SMALL_DEPTH );
         model->appendRow( item );
     }
-    qDebug() << "addSmallTree" << timer.elapsed();
+    measurement.report("addSmallTree", items);
 }
 
 int main( int argc, char** argv )
@@ -501,6 +501,60 @@ void TestProjectModel::testItemsForPath()
     model->clear();
 }
 
+void TestProjectModel::testFilePathFollowsFolder()
+{
+    const Path folderPath(QDir::tempPath() + "/folder");
+    auto* folder = new ProjectFolderItem(nullptr, folderPath);
+    auto* file = new ProjectFileItem(nullptr, Path(folderPath, QStringLiteral("file.cpp")), folder);
+    model->appendRow(folder);
+
+    QCOMPARE(file->path(), Path(folderPath, QStringLiteral("file.cpp")));
+    QCOMPARE(file->text(), QStringLiteral("file.cpp"));
+
+    const Path renamedPath(QDir::tempPath() + "/renamed");
+    folder->setPath(renamedPath);
+    QCOMPARE(file->path(), Path(renamedPath, QStringLiteral("file.cpp")));
+    QCOMPARE(file->indexedPath(), IndexedString(Path(renamedPath, QStringLiteral("file.cpp")).pathOrUrl()));
+    QCOMPARE(model->itemsForPath(file->indexedPath()), QList<ProjectBaseItem*>() << file);
+
+    // the path is kept when the file is taken out of the folder
+    QScopedPointer<ProjectBaseItem> taken(folder->takeRow(file->row()));
+    QCOMPARE(taken->path(), Path(renamedPath, QStringLiteral("file.cpp")));
+    QCOMPARE(taken->text(), QStringLiteral("file.cpp"));
+
+    model->clear();
+
+    // listeners of the file set get the old path on removal, also for files in sub folders
+    QScopedPointer<TestProject> project(new TestProject());
+    ProjectFolderItem* rootItem = project->projectItem();
+    const Path projectPath = rootItem->path();
+    const Path oldFolderPath(projectPath, QStringLiteral("folder"));
+    auto* projectFolder = new ProjectFolderItem(project.data(), oldFolderPath, rootItem);
+    auto* subFolder = new ProjectFolderItem(project.data(), Path(oldFolderPath, QStringLiteral("sub")), projectFolder);
+    new ProjectFileItem(project.data(), Path(oldFolderPath, QStringLiteral("a.cpp")), projectFolder);
+    new ProjectFileItem(project.data(), Path(subFolder->path(), QStringLiteral("b.cpp")), subFolder);
+
+    QStringList removed;
+    QStringList added;
+    connect(project.data(), &IProject::fileRemovedFromSet, this, [&removed](ProjectFileItem* item) {
+        removed << item->path().pathOrUrl();
+    });
+    connect(project.data(), &IProject::fileAddedToSet, this, [&added](ProjectFileItem* item) {
+        added << item->path().pathOrUrl();
+    });
+
+    const Path newFolderPath(projectPath, QStringLiteral("renamed"));
+    projectFolder->setPath(newFolderPath);
+    removed.sort();
+    added.sort();
+    QCOMPARE(removed, (QStringList{Path(oldFolderPath, QStringLiteral("a.cpp")).pathOrUrl(),
+                                   Path(oldFolderPath, QStringLiteral("sub/b.cpp")).pathOrUrl()}));
+    QCOMPARE(added, (QStringList{Path(newFolderPath, QStringLiteral("a.cpp")).pathOrUrl(),
+                                 Path(newFolderPath, QStringLiteral("sub/b.cpp")).pathOrUrl()}));
+    QCOMPARE(project->fileSet(), (QSet<IndexedString>{IndexedString(Path(newFolderPath, QStringLiteral("a.cpp")).pathOrUrl()),
+                                                       IndexedString(Path(newFolderPath, QStringLiteral("sub/b.cpp")).pathOrUrl())}));
+}
+
 void TestProjectModel::testItemsForPath_data()
 {
     QTest::addColumn<Path>("path");
@@ -544,6 +598,44 @@ void TestProjectModel::testProjectProxyModel()
     model->clear();
 }
 
+void TestProjectModel::testProjectProxyModelFilter()
+{
+    auto* root = new ProjectFolderItem(nullptr, Path(QUrl::fromLocalFile(QDir::tempPath())));
+    auto* sub = new ProjectFolderItem(QStringLiteral("sub"), root);
+    new ProjectFileItem(QStringLiteral("foo.cpp"), sub);
+    new ProjectFileItem(QStringLiteral("foobar.cpp"), root);
+    auto* bar = new ProjectFileItem(QStringLiteral("bar.cpp"), root);
+    model->appendRow(root);
+
+    const QModelIndex proxyRoot = proxy->mapFromSource(root->index());
+    QCOMPARE(proxy->rowCount(proxyRoot), 3);
+
+    // the parents of matching items are shown too
+    proxy->setFilterString(QStringLiteral("FOO"));
+    QTRY_COMPARE(proxy->rowCount(proxyRoot), 2);
+    QCOMPARE(proxy->rowCount(proxy->mapFromSource(sub->index())), 1);
+
+    // extended pattern, only the previous matches are searched
+    proxy->setFilterString(QStringLiteral("foob"));
+    QTRY_COMPARE(proxy->rowCount(proxyRoot), 1);
+    QCOMPARE(proxy->index(0, 0, proxyRoot).data().toString(), QStringLiteral("foobar.cpp"));
+
+    // items added later are found once the model changed
+    new ProjectFileItem(QStringLiteral("foobaz.cpp"), root);
+    QTRY_COMPARE(proxy->rowCount(proxyRoot), 2);
+
+    // renamed items are found with their new text
+    bar->setText(QStringLiteral("foobx.cpp"));
+    QTRY_COMPARE(proxy->rowCount(proxyRoot), 3);
+    bar->setText(QStringLiteral("bar.cpp"));
+    QTRY_COMPARE(proxy->rowCount(proxyRoot), 2);
+
+    proxy->setFilterString(QString());
+    QCOMPARE(proxy->rowCount(proxyRoot), 4);
+
+    model->clear();
+}
+
 void TestProjectModel::testProjectFileSet()
 {
     QScopedPointer<TestProject> project(new TestProject());
@@ -47,9 +47,11 @@ private Q_SLOTS:
     void testChangeWithProxyModel();
     void testWithProject();
     void testTakeRow();
+    void testFilePathFollowsFolder();
     void testItemsForPath();
     void testItemsForPath_data();
     void testProjectProxyModel();
+    void testProjectProxyModelFilter();
     void testProjectFileSet();
     void testProjectFileIcon();
 private:
@@ -22,6 +22,10 @@
 
 #include "referencecounting.h"
 
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+
 using namespace KDevelop;
 
 namespace {
@@ -55,11 +59,6 @@ inline void increase(uint& val)
     ++val;
 }
 
-inline void decrease(uint& val)
-{
-    --val;
-}
-
 struct IndexedStringRepositoryItemRequest
 {
     //The text is supposed to be utf8 encoded
@@ -191,14 +190,135 @@ auto editRepo(EditAction action)->decltype(action(globalIndexedStringRepository(
     return action(repo);
 }
 
+ReferenceCountBuffer& referenceCounts()
+{
+    static ReferenceCountBuffer buffer(globalIndexedStringRepository()->mutex(), [](uint index, int delta) {
+        globalIndexedStringRepository()->dynamicItemFromIndexSimple(index)->refCount += delta;
+    });
+    return buffer;
+}
+
+/// Number of bits of the index hash which select the shard of the DecodedStringCache.
+const uint decodedStringShardBits = 4;
+/// Number of bits of the index hash which select the slot within a shard.
+const uint decodedStringSlotBits = 10;
+
+/**
+ * Bounded cache of the strings and urls decoded from the repository.
+ *
+ * Converting the same strings over and over, e.g. the file names shown by the project model
+ * or quick open, then doesn't need to lock the global repository each time. The cache is
+ * direct mapped: each index has exactly one slot, a new entry replaces whatever was there.
+ * The slots are split into independently locked shards so concurrent lookups rarely block.
+ */
+class DecodedStringCache
+{
+public:
+    QString string(uint index)
+    {
+        Shard& shard = shardForIndex(index);
+        Entry& entry = shard.entries[slotForIndex(index)];
+        {
+            QMutexLocker lock(&shard.mutex);
+            if (entry.index == index) {
+                return entry.string;
+            }
+        }
+
+        const int generation = m_generation.loadAcquire();
+        const QString string = readRepo([index](const IndexedStringRepository* repo) {
+            return stringFromItem(repo->itemFromIndex(index));
+        });
+
+        QMutexLocker lock(&shard.mutex);
+        if (generation == m_generation.loadAcquire()) {
+            entry.index = index;
+            entry.string = string;
+            entry.url.clear();
+        }
+        return string;
+    }
+
+    QUrl url(uint index)
+    {
+        Shard& shard = shardForIndex(index);
+        Entry& entry = shard.entries[slotForIndex(index)];
+        {
+            QMutexLocker lock(&shard.mutex);
+            if (entry.index == index && !entry.url.isEmpty()) {
+                return entry.url;
+            }
+        }
+
+        const int generation = m_generation.loadAcquire();
+        const QUrl url = QUrl::fromUserInput(string(index));
+
+        QMutexLocker lock(&shard.mutex);
+        if (entry.index == index && generation == m_generation.loadAcquire()) {
+            entry.url = url;
+        }
+        return url;
+    }
+
+    void clear()
+    {
+        m_generation.ref();
+        for (Shard& shard : m_shards) {
+            QMutexLocker lock(&shard.mutex);
+            for (Entry& entry : shard.entries) {
+                entry = {};
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        uint index = 0;
+        QString string;
+        QUrl url;
+    };
+
+    struct Shard
+    {
+        QMutex mutex;
+        Entry entries[1 << decodedStringSlotBits];
+    };
+
+    static uint hashIndex(uint index)
+    {
+        // the low bits of an index are the position within its bucket, mix in the bucket number
+        return index * 2654435769u;
+    }
+
+    Shard& shardForIndex(uint index)
+    {
+        return m_shards[hashIndex(index) >> (32 - decodedStringShardBits)];
+    }
+
+    static uint slotForIndex(uint index)
+    {
+        return (hashIndex(index) >> (32 - decodedStringShardBits - decodedStringSlotBits))
+               & ((1 << decodedStringSlotBits) - 1);
+    }
+
+    Shard m_shards[1 << decodedStringShardBits];
+    // Incremented by clear(), so lookups which raced with it don't store stale strings
+    QAtomicInt m_generation;
+};
+
+DecodedStringCache& decodedStrings()
+{
+    static DecodedStringCache cache;
+    return cache;
+}
+
 inline void ref(IndexedString* string)
 {
     const uint index = string->index();
     if (index && !isSingleCharIndex(index)) {
         if (shouldDoDUChainReferenceCounting(string)) {
-            editRepo([index](IndexedStringRepository* repo) {
-                    increase(repo->dynamicItemFromIndexSimple(index)->refCount);
-                });
+            referenceCounts().increase(index);
         }
     }
 }
@@ -208,9 +328,7 @@ inline void deref(IndexedString* string)
     const uint index = string->index();
     if (index && !isSingleCharIndex(index)) {
         if (shouldDoDUChainReferenceCounting(string)) {
-            editRepo([index](IndexedStringRepository* repo) {
-                    decrease(repo->dynamicItemFromIndexSimple(index)->refCount);
-                });
+            referenceCounts().decrease(index);
         }
     }
 }
@@ -300,7 +418,7 @@ QUrl IndexedString::toUrl() const
     if (isEmpty()) {
         return {};
     }
-    QUrl ret = QUrl::fromUserInput(str());
+    QUrl ret = isSingleCharIndex(m_index) ? QUrl::fromUserInput(str()) : decodedStrings().url(m_index);
     Q_ASSERT(!ret.isRelative());
     return ret;
 }
@@ -312,10 +430,7 @@ QString IndexedString::str() const
     } else if (isSingleCharIndex(m_index)) {
         return QString(QLatin1Char(indexToChar(m_index)));
     } else {
-        const uint index = m_index;
-        return readRepo([index](const IndexedStringRepository* repo) {
-            return stringFromItem(repo->itemFromIndex(index));
-        });
+        return decodedStrings().string(m_index);
     }
 }
 
@@ -401,6 +516,11 @@ uint IndexedString::indexForString(const QString& str, uint hash)
     return indexForString(array.constBegin(), array.size(), hash);
 }
 
+void IndexedString::clearStringCache()
+{
+    decodedStrings().clear();
+}
+
 QDebug operator<<(QDebug s, const IndexedString& string)
 {
     s.nospace() << string.str();
@@ -124,7 +124,7 @@ public:
      * Re-construct a QUrl from this indexed string, the result can be used with the
      * QUrl-using constructor.
      *
-     * @note This is expensive.
+     * @note This is expensive the first time, recently converted urls are cached.
      */
     QUrl toUrl() const;
 
@@ -163,7 +163,8 @@ public:
     const char* c_str() const;
 
     /**
-     * Convenience function, avoid using it, it's relatively expensive
+     * Convenience function, avoid using it, it's relatively expensive the first time.
+     * Recently decoded strings are cached, so repeated calls don't lock the repository.
      */
     QString str() const;
 
@@ -243,6 +244,13 @@ public:
     static uint indexForString(const char* str, unsigned short length, uint hash = 0);
     static uint indexForString(const QString& str, uint hash = 0);
 
+    /**
+     * Drops the cached results of str() and toUrl().
+     *
+     * @internal Called by the ItemRepositoryRegistry before strings get removed from the repository.
+     */
+    static void clearStringCache();
+
 private:
     explicit IndexedString(bool);
     uint m_index = 0;
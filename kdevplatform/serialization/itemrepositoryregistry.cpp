@@ -29,6 +29,8 @@
 #include <util/shellutils.h>
 
 #include "abstractitemrepository.h"
+#include "indexedstring.h"
+#include "referencecounting.h"
 #include "debug.h"
 
 using namespace KDevelop;
@@ -266,6 +268,8 @@ void ItemRepositoryRegistry::unRegisterRepository(AbstractItemRepository* reposi
 {
     Q_D(ItemRepositoryRegistry);
 
+    ReferenceCountBuffer::flushAll();
+
     QMutexLocker lock(&d->m_mutex);
     Q_ASSERT(d->m_repositories.contains(repository));
     repository->close();
@@ -336,6 +340,9 @@ void ItemRepositoryRegistry::store()
 {
     Q_D(ItemRepositoryRegistry);
 
+    // The buffered reference-counts are stored with the items
+    ReferenceCountBuffer::flushAll();
+
     QMutexLocker lock(&d->m_mutex);
     for (auto it = d->m_repositories.constBegin(), end = d->m_repositories.constEnd(); it != end; ++it) {
         it.key()->store();
@@ -380,6 +387,11 @@ int ItemRepositoryRegistry::finalCleanup()
 {
     Q_D(ItemRepositoryRegistry);
 
+    // Items without references are removed, so all references must be counted
+    ReferenceCountBuffer::flushAll();
+    // The indices of removed strings may be reused for other strings
+    IndexedString::clearStringCache();
+
     QMutexLocker lock(&d->m_mutex);
     int changed = false;
     for (auto it = d->m_repositories.constBegin(), end = d->m_repositories.constEnd(); it != end; ++it) {
@@ -23,6 +23,9 @@
 #include <QMutex>
 #include <QMap>
 #include <QAtomicInt>
+#include <QHash>
+#include <QThread>
+#include <QVector>
 #include "serialization/itemrepository.h"
 
 namespace KDevelop {
@@ -279,3 +282,121 @@ void initReferenceCounting()
 }
 }
 #endif
+
+namespace {
+const int referenceCountShardBits = 4;
+///Number of independently locked parts of each ReferenceCountBuffer
+const int referenceCountShards = 1 << referenceCountShardBits;
+///Number of distinct items a shard collects changes for before they are applied
+const int referenceCountBatchSize = 1024;
+
+int shardForCurrentThread()
+{
+    // Fibonacci hashing, thread ids are aligned addresses on most platforms
+    const auto id = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    return static_cast<int>((id * Q_UINT64_C(11400714819323198485)) >> (64 - referenceCountShardBits));
+}
+
+QMutex& referenceCountBuffersMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QVector<KDevelop::ReferenceCountBuffer*>& referenceCountBuffers()
+{
+    static QVector<KDevelop::ReferenceCountBuffer*> buffers;
+    return buffers;
+}
+}
+
+namespace KDevelop {
+class ReferenceCountBufferPrivate
+{
+public:
+    struct Shard
+    {
+        QMutex mutex;
+        QHash<uint, int> deltas;
+    };
+
+    ReferenceCountBufferPrivate(QMutex* repositoryMutex, ReferenceCountBuffer::ApplyFunction apply)
+        : m_repositoryMutex(repositoryMutex)
+        , m_apply(apply)
+    {
+    }
+
+    ///The shard must not be locked, so no other lock is ever taken while holding a shard
+    void apply(const QHash<uint, int>& deltas)
+    {
+        QMutexLocker lock(m_repositoryMutex);
+        for (auto it = deltas.constBegin(), end = deltas.constEnd(); it != end; ++it) {
+            if (it.value()) {
+                m_apply(it.key(), it.value());
+            }
+        }
+    }
+
+    QMutex* const m_repositoryMutex;
+    const ReferenceCountBuffer::ApplyFunction m_apply;
+    Shard m_shards[referenceCountShards];
+};
+
+ReferenceCountBuffer::ReferenceCountBuffer(QMutex* repositoryMutex, ApplyFunction apply)
+    : d_ptr(new ReferenceCountBufferPrivate(repositoryMutex, apply))
+{
+    QMutexLocker lock(&referenceCountBuffersMutex());
+    referenceCountBuffers().append(this);
+}
+
+ReferenceCountBuffer::~ReferenceCountBuffer()
+{
+    QMutexLocker lock(&referenceCountBuffersMutex());
+    referenceCountBuffers().removeOne(this);
+}
+
+void ReferenceCountBuffer::change(uint index, int delta)
+{
+    Q_D(ReferenceCountBuffer);
+
+    auto& shard = d->m_shards[shardForCurrentThread()];
+    QHash<uint, int> batch;
+    {
+        QMutexLocker lock(&shard.mutex);
+        shard.deltas[index] += delta;
+        if (shard.deltas.size() < referenceCountBatchSize) {
+            return;
+        }
+        batch.swap(shard.deltas);
+    }
+    d->apply(batch);
+}
+
+void ReferenceCountBuffer::flush()
+{
+    Q_D(ReferenceCountBuffer);
+
+    for (auto& shard : d->m_shards) {
+        QHash<uint, int> batch;
+        {
+            QMutexLocker lock(&shard.mutex);
+            batch.swap(shard.deltas);
+        }
+        if (!batch.isEmpty()) {
+            d->apply(batch);
+        }
+    }
+}
+
+void ReferenceCountBuffer::flushAll()
+{
+    QVector<ReferenceCountBuffer*> buffers;
+    {
+        QMutexLocker lock(&referenceCountBuffersMutex());
+        buffers = referenceCountBuffers();
+    }
+    for (ReferenceCountBuffer* buffer : qAsConst(buffers)) {
+        buffer->flush();
+    }
+}
+}
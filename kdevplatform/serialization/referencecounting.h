@@ -26,6 +26,7 @@
 #include <QMap>
 #include <QPair>
 #include <QMutexLocker>
+#include <QScopedPointer>
 
 //When this is enabled, the duchain unloading is disabled as well, and you should start
 //with a cleared ~/.kdevduchain
@@ -127,6 +128,52 @@ struct ReferenceCountManager
     uint m_id;
     #endif
 };
+
+class ReferenceCountBufferPrivate;
+
+///Collects changes to the reference-counts of the items of one repository, and applies them in batches.
+///
+///Copying or destroying indexed items within reference-counted memory only records the change here,
+///instead of locking the repository for each of them. The changes are spread over several independently
+///locked shards by thread, so parallel threads rarely wait for each other. The repository is locked once
+///per batch, when a shard collected enough changes or when flush() is called.
+///
+///The reference-counts are only needed when the repositories are stored or cleaned up, so the
+///ItemRepositoryRegistry flushes all buffers before doing that.
+class KDEVPLATFORMSERIALIZATION_EXPORT ReferenceCountBuffer
+{
+public:
+    ///Adds @p delta to the reference-count of the item with index @p index.
+    ///Called with the repository mutex locked.
+    using ApplyFunction = void (*)(uint index, int delta);
+
+    ///@param repositoryMutex The mutex of the repository, locked while changes are applied
+    ReferenceCountBuffer(QMutex* repositoryMutex, ApplyFunction apply);
+    ///Pending changes are dropped, the repository may already be gone
+    ~ReferenceCountBuffer();
+
+    inline void increase(uint index)
+    {
+        change(index, 1);
+    }
+    inline void decrease(uint index)
+    {
+        change(index, -1);
+    }
+
+    ///Apply the changes collected by all threads
+    void flush();
+
+    ///Apply the changes collected by all existing buffers
+    static void flushAll();
+
+private:
+    void change(uint index, int delta);
+
+    const QScopedPointer<ReferenceCountBufferPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(ReferenceCountBuffer)
+    Q_DISABLE_COPY(ReferenceCountBuffer)
+};
 }
 
 #endif
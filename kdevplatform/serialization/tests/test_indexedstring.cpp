@@ -137,6 +137,36 @@ void TestIndexedString::bench_kurl()
     }
 }
 
+// like the file names of a project, which get converted again and again
+static QVector<uint> setupRepeatedTest()
+{
+    QVector<uint> indices = setupTest();
+    indices.resize(5000);
+    return indices;
+}
+
+void TestIndexedString::bench_qstringRepeated()
+{
+    const QVector<uint> indices = setupRepeatedTest();
+    QBENCHMARK {
+        for (uint index : indices) {
+            IndexedString str = IndexedString::fromIndex(index);
+            str.str();
+        }
+    }
+}
+
+void TestIndexedString::bench_kurlRepeated()
+{
+    const QVector<uint> indices = setupRepeatedTest();
+    QBENCHMARK {
+        for (uint index : indices) {
+            IndexedString str = IndexedString::fromIndex(index);
+            str.toUrl();
+        }
+    }
+}
+
 void TestIndexedString::bench_qhashQString()
 {
     const QVector<QString> data = generateData();
@@ -249,3 +279,19 @@ void TestIndexedString::testCString()
     QCOMPARE(str.index(), 0u);
     QVERIFY(str.isEmpty());
 }
+
+void TestIndexedString::testStringCache()
+{
+    const QString string = QStringLiteral("/foo/testStringCache");
+    const IndexedString indexed(string);
+
+    // the second calls are served from the cache
+    QCOMPARE(indexed.str(), string);
+    QCOMPARE(indexed.str(), string);
+    QCOMPARE(indexed.toUrl(), QUrl::fromLocalFile(string));
+    QCOMPARE(indexed.toUrl(), QUrl::fromLocalFile(string));
+
+    IndexedString::clearStringCache();
+    QCOMPARE(indexed.toUrl(), QUrl::fromLocalFile(string));
+    QCOMPARE(indexed.str(), string);
+}
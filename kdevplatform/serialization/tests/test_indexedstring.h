@@ -41,6 +41,8 @@ private Q_SLOTS:
     void bench_length();
     void bench_qstring();
     void bench_kurl();
+    void bench_qstringRepeated();
+    void bench_kurlRepeated();
     void bench_qhashQString();
     void bench_qhashIndexedString();
     void bench_hashString();
@@ -51,6 +53,7 @@ private Q_SLOTS:
     void test_data();
 
     void testCString();
+    void testStringCache();
 
 private:
     QString m_repositoryPath = QDir::tempPath() + QStringLiteral("/test_indexedstring");
@@ -0,0 +1,226 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "backgroundparsergovernor.h"
+
+#include <QFile>
+#include <QThread>
+
+#include <KJob>
+#include <KLocalizedString>
+
+#include <interfaces/iruncontroller.h>
+#include <language/backgroundparser/backgroundparser.h>
+#include <outputview/outputjob.h>
+#include <project/builderjob.h>
+
+#include "debug.h"
+
+using namespace KDevelop;
+
+namespace {
+/// Interval of the periodic checks of the system load, in milliseconds
+const int checkInterval = 5000;
+
+/// CPU pressure in percent above which the system counts as overloaded, and below which it stops being so
+const double pressureEnterThreshold = 50;
+const double pressureLeaveThreshold = 20;
+
+/// Load average per CPU above which the system counts as overloaded, and below which it stops being so
+const double loadEnterThreshold = 1.5;
+const double loadLeaveThreshold = 1.0;
+}
+
+BackgroundParserGovernor::BackgroundParserGovernor(BackgroundParser* parser, IRunController* runController,
+                                                   QObject* parent)
+    : QObject(parent)
+    , m_parser(parser)
+{
+    connect(runController, &IRunController::jobRegistered, this, &BackgroundParserGovernor::jobRegistered);
+    connect(runController, &IRunController::jobUnregistered, this, &BackgroundParserGovernor::jobUnregistered);
+
+    const auto jobs = runController->currentJobs();
+    for (KJob* job : jobs) {
+        if (isBuildJob(job)) {
+            m_buildJobs.insert(job);
+        }
+    }
+
+    m_timer.setInterval(checkInterval);
+    connect(&m_timer, &QTimer::timeout, this, &BackgroundParserGovernor::update);
+    m_timer.start();
+
+    update();
+}
+
+BackgroundParserGovernor::~BackgroundParserGovernor()
+{
+}
+
+QString BackgroundParserGovernor::statusName() const
+{
+    return i18n("Background Parser Load");
+}
+
+BackgroundParserGovernor::Level BackgroundParserGovernor::level() const
+{
+    return m_level;
+}
+
+bool BackgroundParserGovernor::isBuildJob(KJob* job)
+{
+    if (qobject_cast<BuilderJob*>(job)) {
+        return true;
+    }
+
+    // make, ninja, cmake etc. jobs started without a BuilderJob
+    auto* outputJob = qobject_cast<OutputJob*>(job);
+    return outputJob && outputJob->standardToolView() == IOutputView::BuildView;
+}
+
+double BackgroundParserGovernor::parseCpuPressure(const QByteArray& contents)
+{
+    // some avg10=1.23 avg60=0.50 avg300=0.10 total=123456
+    const auto lines = contents.split('\n');
+    for (const QByteArray& line : lines) {
+        if (!line.startsWith("some ")) {
+            continue;
+        }
+        const auto fields = line.split(' ');
+        for (const QByteArray& field : fields) {
+            if (field.startsWith("avg10=")) {
+                bool ok = false;
+                const double pressure = field.mid(6).toDouble(&ok);
+                return ok ? pressure : -1;
+            }
+        }
+    }
+    return -1;
+}
+
+double BackgroundParserGovernor::parseLoadAverage(const QByteArray& contents)
+{
+    // 0.52 0.58 0.59 1/467 12345
+    bool ok = false;
+    const double load = contents.left(contents.indexOf(' ')).toDouble(&ok);
+    return ok ? load : -1;
+}
+
+bool BackgroundParserGovernor::isOverloaded(bool wasOverloaded, double cpuPressure, double loadPerCpu)
+{
+    if (cpuPressure >= 0) {
+        return cpuPressure > (wasOverloaded ? pressureLeaveThreshold : pressureEnterThreshold);
+    }
+    if (loadPerCpu >= 0) {
+        return loadPerCpu > (wasOverloaded ? loadLeaveThreshold : loadEnterThreshold);
+    }
+    return false;
+}
+
+BackgroundParserGovernor::Level BackgroundParserGovernor::decide(int buildJobs, bool overloaded)
+{
+    if (buildJobs > 0) {
+        return overloaded ? Minimal : Reduced;
+    }
+    return overloaded ? Reduced : Unthrottled;
+}
+
+int BackgroundParserGovernor::threadLimit(Level level, int threadCount)
+{
+    switch (level) {
+    case Unthrottled:
+        return 0;
+    case Reduced:
+        return qMax(1, threadCount / 2);
+    case Minimal:
+        return 1;
+    }
+    Q_UNREACHABLE();
+}
+
+void BackgroundParserGovernor::update()
+{
+    if (!m_parser) {
+        return;
+    }
+
+    // CPU pressure is more precise, but only available since Linux 4.20
+    double cpuPressure = -1;
+    QFile pressureFile(QStringLiteral("/proc/pressure/cpu"));
+    if (pressureFile.open(QIODevice::ReadOnly)) {
+        cpuPressure = parseCpuPressure(pressureFile.readAll());
+    }
+
+    double loadPerCpu = -1;
+    if (cpuPressure < 0) {
+        QFile loadFile(QStringLiteral("/proc/loadavg"));
+        if (loadFile.open(QIODevice::ReadOnly)) {
+            const double load = parseLoadAverage(loadFile.readAll());
+            if (load >= 0) {
+                loadPerCpu = load / qMax(1, QThread::idealThreadCount());
+            }
+        }
+    }
+
+    m_overloaded = isOverloaded(m_overloaded, cpuPressure, loadPerCpu);
+    apply(decide(m_buildJobs.size(), m_overloaded), cpuPressure, loadPerCpu);
+}
+
+void BackgroundParserGovernor::apply(Level level, double cpuPressure, double loadPerCpu)
+{
+    // also applied if the level didn't change, in case the configured thread count did
+    const int limit = threadLimit(level, m_parser->threadCount());
+    m_parser->setThreadLimit(limit);
+
+    if (level == m_level) {
+        return;
+    }
+    m_level = level;
+
+    qCDebug(SHELL) << "background parser governor: changed to level" << level << "with thread limit" << limit
+                   << "- build jobs:" << m_buildJobs.size() << "CPU pressure:" << cpuPressure
+                   << "load per CPU:" << loadPerCpu;
+
+    if (level == Unthrottled) {
+        emit clearMessage(this);
+    } else if (!m_buildJobs.isEmpty()) {
+        emit showMessage(this, i18np("Building, parsing with one thread in the background",
+                                     "Building, parsing with %1 threads in the background", limit));
+    } else {
+        emit showMessage(this, i18np("System busy, parsing with one thread in the background",
+                                     "System busy, parsing with %1 threads in the background", limit));
+    }
+}
+
+void BackgroundParserGovernor::jobRegistered(KJob* job)
+{
+    if (isBuildJob(job)) {
+        m_buildJobs.insert(job);
+        update();
+    }
+}
+
+void BackgroundParserGovernor::jobUnregistered(KJob* job)
+{
+    if (m_buildJobs.remove(job)) {
+        update();
+    }
+}
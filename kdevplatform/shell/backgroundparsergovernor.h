@@ -0,0 +1,127 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_BACKGROUNDPARSERGOVERNOR_H
+#define KDEVPLATFORM_BACKGROUNDPARSERGOVERNOR_H
+
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+
+#include <interfaces/istatus.h>
+
+#include "shellexport.h"
+
+class KJob;
+
+namespace KDevelop
+{
+class BackgroundParser;
+class IRunController;
+
+/**
+ * Throttles the background parser while builds or other processes keep the CPUs busy.
+ *
+ * The governor watches the build jobs registered with the run controller, and the CPU pressure
+ * (or, where that is not available, the load average) of the system. While the machine is busy,
+ * the background parser uses fewer threads, so parsing and builds don't slow each other down.
+ * The thread reserved for parsing opened documents is not affected.
+ * Once the builds finished and the load went down again, the configured thread count is restored.
+ *
+ * Every decision is shown in the status bar and logged.
+ */
+class KDEVPLATFORMSHELL_EXPORT BackgroundParserGovernor : public QObject, public IStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(KDevelop::IStatus)
+
+public:
+    enum Level {
+        /// Parse with the configured thread count
+        Unthrottled,
+        /// Parse with half the configured thread count
+        Reduced,
+        /// Parse with a single thread
+        Minimal
+    };
+
+    BackgroundParserGovernor(BackgroundParser* parser, IRunController* runController, QObject* parent = nullptr);
+    ~BackgroundParserGovernor() override;
+
+    QString statusName() const override;
+
+    /// The current decision
+    Level level() const;
+
+    /// Re-evaluate the situation now instead of waiting for the next periodic check.
+    void update();
+
+    /// @return true if @p job runs a build, whose processes compete with the parser for the CPUs
+    static bool isBuildJob(KJob* job);
+
+    /**
+     * @return the share of time in percent in which tasks waited for a CPU during the last 10 seconds,
+     * parsed from the contents of /proc/pressure/cpu, or -1 if @p contents can't be parsed
+     */
+    static double parseCpuPressure(const QByteArray& contents);
+
+    /// @return the load average of the last minute parsed from the contents of /proc/loadavg, or -1
+    static double parseLoadAverage(const QByteArray& contents);
+
+    /**
+     * @return whether the system is overloaded
+     *
+     * @param wasOverloaded The previous result, the thresholds to leave the overloaded state are lower
+     *                      than those to enter it, so the decision doesn't flip back and forth.
+     * @param cpuPressure The result of parseCpuPressure(), or -1 if not available.
+     * @param loadPerCpu The load average divided by the number of CPUs, or a negative value if not available.
+     */
+    static bool isOverloaded(bool wasOverloaded, double cpuPressure, double loadPerCpu);
+
+    /// Decide how much to throttle the parser while @p buildJobs build jobs are running.
+    static Level decide(int buildJobs, bool overloaded);
+
+    /// @return the thread limit for the background parser at @p level, if @p threadCount threads are configured
+    static int threadLimit(Level level, int threadCount);
+
+Q_SIGNALS: // KDevelop::IStatus API
+    void clearMessage(KDevelop::IStatus*) override;
+    void showMessage(KDevelop::IStatus*, const QString& message, int timeout = 0) override;
+    void hideProgress(KDevelop::IStatus*) override;
+    void showProgress(KDevelop::IStatus*, int minimum, int maximum, int value) override;
+    void showErrorMessage(const QString&, int) override;
+
+private:
+    void jobRegistered(KJob* job);
+    void jobUnregistered(KJob* job);
+    void apply(Level level, double cpuPressure, double loadPerCpu);
+
+    QPointer<BackgroundParser> m_parser;
+    QSet<KJob*> m_buildJobs;
+    Level m_level = Unthrottled;
+    bool m_overloaded = false;
+    QTimer m_timer;
+};
+
+}
+
+#endif
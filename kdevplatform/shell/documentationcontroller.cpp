@@ -128,6 +128,12 @@ DocumentationController::DocumentationController(Core* core)
     // and thus also gets treated like the ones registered from plugins
     // cmp. comment about tool views in CorePrivate::initialize
     core->uiController()->addToolView(i18nc("@title:window", "Documentation"), m_factory);
+
+    connect(core->pluginController(), &IPluginController::pluginLoaded, this, [this](IPlugin* plugin) {
+        if (plugin->extension<IDocumentationProvider>() || plugin->extension<IDocumentationProviderProvider>()) {
+            emit providersChanged();
+        }
+    });
 }
 
 DocumentationController::~DocumentationController()
@@ -208,26 +214,20 @@ IDocumentation::Ptr DocumentationController::documentation(const QUrl& url) cons
 
 QList< IDocumentationProvider* > DocumentationController::documentationProviders() const
 {
-    const QList<IPlugin*> plugins = ICore::self()->pluginController()->allPluginsForExtension(QStringLiteral("org.kdevelop.IDocumentationProvider"));
-    const QList<IPlugin*> pluginsProvider = ICore::self()->pluginController()->allPluginsForExtension(QStringLiteral("org.kdevelop.IDocumentationProviderProvider"));
+    // only the loaded plugins, the documentation plugins are loaded after startup, see providersChanged()
+    const QList<IPlugin*> plugins = ICore::self()->pluginController()->loadedPlugins();
 
     QList<IDocumentationProvider*> ret;
-    for (IPlugin* p : pluginsProvider) {
-        auto *docProvider=p->extension<IDocumentationProviderProvider>();
-        if (!docProvider) {
-            qCWarning(SHELL) << "plugin" << p << "does not implement ProviderProvider extension, rerun kbuildsycoca5";
-            continue;
+    for (IPlugin* p : plugins) {
+        if (auto* docProvider = p->extension<IDocumentationProviderProvider>()) {
+            ret.append(docProvider->providers());
         }
-        ret.append(docProvider->providers());
     }
 
     for (IPlugin* p : plugins) {
-        auto *doc=p->extension<IDocumentationProvider>();
-        if (!doc) {
-            qCWarning(SHELL) << "plugin" << p << "does not implement Provider extension, rerun kbuildsycoca5";
-            continue;
+        if (auto* doc = p->extension<IDocumentationProvider>()) {
+            ret.append(doc);
         }
-        ret.append(doc);
     }
 
     return ret;
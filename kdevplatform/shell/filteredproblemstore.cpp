@@ -27,6 +27,8 @@
 
 #include <KLocalizedString>
 
+#include <QHash>
+
 using namespace KDevelop;
 
 namespace
@@ -43,6 +45,35 @@ void addDiagnostics(ProblemStoreNode *node, const QVector<IProblem::Ptr> &diagno
     }
 }
 
+/// Creates a problem node including its diagnostics
+ProblemStoreNode* createProblemNode(ProblemStoreNode *parent, const IProblem::Ptr &problem)
+{
+    auto *node = new ProblemNode(parent, problem);
+    addDiagnostics(node, problem->diagnostics());
+    return node;
+}
+
+/// Tells if the problems and their diagnostics look the same, e.g. a problem which was recreated by reparsing an unchanged document
+bool isSameProblem(const IProblem::Ptr &a, const IProblem::Ptr &b)
+{
+    if (a->severity() != b->severity()
+        || !(a->finalLocation() == b->finalLocation())
+        || a->description() != b->description()
+        || a->explanation() != b->explanation()
+        || a->sourceString() != b->sourceString())
+        return false;
+
+    const auto aDiagnostics = a->diagnostics();
+    const auto bDiagnostics = b->diagnostics();
+    if (aDiagnostics.size() != bDiagnostics.size())
+        return false;
+    for (int i = 0; i < aDiagnostics.size(); ++i) {
+        if (!isSameProblem(aDiagnostics[i], bDiagnostics[i]))
+            return false;
+    }
+    return true;
+}
+
 /**
  * @brief Base class for grouping strategy classes
  *
@@ -51,8 +82,9 @@ void addDiagnostics(ProblemStoreNode *node, const QVector<IProblem::Ptr> &diagno
 class GroupingStrategy
 {
 public:
-    explicit GroupingStrategy( ProblemStoreNode *root )
-        : m_rootNode(root)
+    GroupingStrategy(ProblemStore *store, ProblemStoreNode *root)
+        : m_store(store)
+        , m_rootNode(root)
         , m_groupedRootNode(new ProblemStoreNode())
     {
     }
@@ -63,6 +95,9 @@ public:
     /// Add a problem to the appropriate group
     virtual void addProblem(const IProblem::Ptr &problem) = 0;
 
+    /// Replace the problems located in @p document, announcing the changed nodes
+    virtual void updateProblems(const IndexedString &document, const QVector<IProblem::Ptr> &problems) = 0;
+
     /// Find the specified noe
     const ProblemStoreNode* findNode(int row, ProblemStoreNode *parent = nullptr) const
     {
@@ -88,6 +123,116 @@ public:
     }
 
 protected:
+    /// Appends nodes for @p problems to @p parent
+    void appendProblems(ProblemStoreNode *parent, const QVector<IProblem::Ptr> &problems)
+    {
+        if (problems.isEmpty())
+            return;
+
+        const int first = parent->count();
+        emit m_store->beginInsertNodes(parent, first, first + problems.size() - 1);
+        for (const IProblem::Ptr& problem : problems) {
+            parent->addChild(createProblemNode(parent, problem));
+        }
+        emit m_store->endInsertNodes();
+    }
+
+    /// Announces that the children @p first to @p last of @p parent show new problems
+    void changeNodes(ProblemStoreNode *parent, int first, int last)
+    {
+        emit m_store->nodesChanged(parent, first, last);
+    }
+
+    /// Assigns @p problem to a kept @p node and its diagnostics to the sub-nodes, which show the same diagnostics
+    void reassignProblem(ProblemNode *node, const IProblem::Ptr &problem)
+    {
+        node->setProblem(problem);
+
+        const auto diagnostics = problem->diagnostics();
+        const auto& children = node->children();
+        Q_ASSERT(children.size() == diagnostics.size());
+        for (int i = 0; i < children.size(); ++i) {
+            reassignProblem(static_cast<ProblemNode*>(children[i]), diagnostics[i]);
+        }
+        if (!children.isEmpty())
+            changeNodes(node, 0, children.size() - 1);
+    }
+
+    /// Removes the children @p first to @p last of @p parent
+    void removeNodes(ProblemStoreNode *parent, int first, int last)
+    {
+        emit m_store->beginRemoveNodes(parent, first, last);
+        parent->removeChildren(first, last - first + 1);
+        emit m_store->endRemoveNodes();
+    }
+
+    /**
+     * Replaces the children of @p parent which show problems located in @p document.
+     *
+     * Nodes of problems which look the same as before are kept and only get the new problem
+     * assigned, such that a reparse which doesn't change the problems doesn't change the tree.
+     */
+    void updateChildren(ProblemStoreNode *parent, const IndexedString &document, const QVector<IProblem::Ptr> &problems)
+    {
+        QMultiHash<QString, int> problemIndexes;
+        for (int i = 0; i < problems.size(); ++i) {
+            problemIndexes.insert(problems[i]->description(), i);
+        }
+        QVector<bool> isShown(problems.size(), false);
+
+        const auto& children = parent->children();
+        QVector<bool> isStale(children.size(), false);
+        QVector<bool> isKept(children.size(), false);
+        for (int row = 0; row < children.size(); ++row) {
+            const IProblem::Ptr oldProblem = children[row]->problem();
+            if (!oldProblem || oldProblem->finalLocation().document != document)
+                continue;
+
+            isStale[row] = true;
+            for (auto it = problemIndexes.find(oldProblem->description()); it != problemIndexes.end() && it.key() == oldProblem->description(); ++it) {
+                if (!isShown[*it] && isSameProblem(oldProblem, problems[*it])) {
+                    isShown[*it] = true;
+                    isStale[row] = false;
+                    isKept[row] = true;
+                    reassignProblem(static_cast<ProblemNode*>(children[row]), problems[*it]);
+                    break;
+                }
+            }
+        }
+
+        // the kept rows reference the new problems now, announce them before any row moves
+        for (int row = 0; row < isKept.size(); ++row) {
+            if (!isKept[row])
+                continue;
+            const int first = row;
+            while (row + 1 < isKept.size() && isKept[row + 1])
+                ++row;
+            changeNodes(parent, first, row);
+        }
+
+        // remove from the back, such that the rows of the remaining runs stay valid
+        int row = isStale.size() - 1;
+        while (row >= 0) {
+            if (!isStale[row]) {
+                --row;
+                continue;
+            }
+            const int last = row;
+            while (row > 0 && isStale[row - 1])
+                --row;
+            removeNodes(parent, row, last);
+            --row;
+        }
+
+        QVector<IProblem::Ptr> newProblems;
+        for (int i = 0; i < problems.size(); ++i) {
+            if (!isShown[i])
+                newProblems += problems[i];
+        }
+        appendProblems(parent, newProblems);
+    }
+
+    ProblemStore* const m_store;
     ProblemStoreNode* const m_rootNode;
     QScopedPointer<ProblemStoreNode> m_groupedRootNode;
 };
@@ -98,8 +243,8 @@ protected:
 class NoGroupingStrategy final : public GroupingStrategy
 {
 public:
-    explicit NoGroupingStrategy(ProblemStoreNode *root)
-        : GroupingStrategy(root)
+    NoGroupingStrategy(ProblemStore *store, ProblemStoreNode *root)
+        : GroupingStrategy(store, root)
     {
     }
 
@@ -111,6 +256,11 @@ public:
 
     }
 
+    void updateProblems(const IndexedString &document, const QVector<IProblem::Ptr> &problems) override
+    {
+        updateChildren(m_groupedRootNode.data(), document, problems);
+    }
+
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -119,8 +269,8 @@ public:
 class PathGroupingStrategy final : public GroupingStrategy
 {
 public:
-    explicit PathGroupingStrategy(ProblemStoreNode *root)
-        : GroupingStrategy(root)
+    PathGroupingStrategy(ProblemStore *store, ProblemStoreNode *root)
+        : GroupingStrategy(store, root)
     {
     }
 
@@ -146,6 +296,34 @@ public:
         parent->addChild(node);
     }
 
+    void updateProblems(const IndexedString &document, const QVector<IProblem::Ptr> &problems) override
+    {
+        const QString path = document.str();
+        const auto childrenNodes = m_groupedRootNode->children();
+        auto it = std::find_if(childrenNodes.begin(), childrenNodes.end(), [&](ProblemStoreNode* node) {
+            return (node->label() == path);
+        });
+
+        if (it == childrenNodes.end()) {
+            if (problems.isEmpty())
+                return;
+
+            const int row = m_groupedRootNode->count();
+            emit m_store->beginInsertNodes(m_groupedRootNode.data(), row, row);
+            auto *parent = new LabelNode(m_groupedRootNode.data(), path);
+            for (const IProblem::Ptr& problem : problems) {
+                parent->addChild(createProblemNode(parent, problem));
+            }
+            m_groupedRootNode->addChild(parent);
+            emit m_store->endInsertNodes();
+        } else if (problems.isEmpty()) {
+            const int row = std::distance(childrenNodes.begin(), it);
+            removeNodes(m_groupedRootNode.data(), row, row);
+        } else {
+            updateChildren(*it, document, problems);
+        }
+    }
+
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -161,8 +339,8 @@ public:
         GroupHint           = 2
     };
 
-    explicit SeverityGroupingStrategy(ProblemStoreNode *root)
-        : GroupingStrategy(root)
+    SeverityGroupingStrategy(ProblemStore *store, ProblemStoreNode *root)
+        : GroupingStrategy(store, root)
     {
         /// Create the groups on construction, so there's no need to search for them on addition
         m_groupedRootNode->addChild(new LabelNode(m_groupedRootNode.data(), i18n("Error")));
@@ -186,6 +364,23 @@ public:
         parent->addChild(node);
     }
 
+    void updateProblems(const IndexedString &document, const QVector<IProblem::Ptr> &problems) override
+    {
+        QVector<IProblem::Ptr> groupProblems[3];
+        for (const IProblem::Ptr& problem : problems) {
+            switch (problem->severity()) {
+                case IProblem::Error: groupProblems[GroupError] += problem; break;
+                case IProblem::Warning: groupProblems[GroupWarning] += problem; break;
+                case IProblem::Hint: groupProblems[GroupHint] += problem; break;
+                default: break;
+            }
+        }
+
+        for (int group : {GroupError, GroupWarning, GroupHint}) {
+            updateChildren(m_groupedRootNode->child(group), document, groupProblems[group]);
+        }
+    }
+
     void clear() override
     {
         m_groupedRootNode->child(GroupError)->clear();
@@ -206,7 +401,7 @@ class FilteredProblemStorePrivate
 public:
     explicit FilteredProblemStorePrivate(FilteredProblemStore* q)
         : q(q)
-        , m_strategy(new NoGroupingStrategy(q->rootNode()))
+        , m_strategy(new NoGroupingStrategy(q, q->rootNode()))
         , m_grouping(NoGrouping)
     {
     }
@@ -239,6 +434,23 @@ void FilteredProblemStore::addProblem(const IProblem::Ptr &problem)
         d->m_strategy->addProblem(problem);
 }
 
+void FilteredProblemStore::updateProblems(const IndexedString& document, const QVector<IProblem::Ptr>& problems)
+{
+    Q_D(FilteredProblemStore);
+
+    if (!replaceProblems(document, problems))
+        return;
+
+    QVector<IProblem::Ptr> matchingProblems;
+    for (const IProblem::Ptr& problem : problems) {
+        if (d->match(problem))
+            matchingProblems += problem;
+    }
+    d->m_strategy->updateProblems(document, matchingProblems);
+
+    emit problemsChanged();
+}
+
 const ProblemStoreNode* FilteredProblemStore::findNode(int row, ProblemStoreNode *parent) const
 {
     Q_D(const FilteredProblemStore);
@@ -291,9 +503,9 @@ void FilteredProblemStore::setGrouping(int grouping)
     d->m_grouping = g;
 
     switch (g) {
-        case NoGrouping: d->m_strategy.reset(new NoGroupingStrategy(rootNode())); break;
-        case PathGrouping: d->m_strategy.reset(new PathGroupingStrategy(rootNode())); break;
-        case SeverityGrouping: d->m_strategy.reset(new SeverityGroupingStrategy(rootNode())); break;
+        case NoGrouping: d->m_strategy.reset(new NoGroupingStrategy(this, rootNode())); break;
+        case PathGrouping: d->m_strategy.reset(new PathGroupingStrategy(this, rootNode())); break;
+        case SeverityGrouping: d->m_strategy.reset(new SeverityGroupingStrategy(this, rootNode())); break;
     }
 
     rebuild();
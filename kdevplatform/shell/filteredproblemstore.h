@@ -84,6 +84,9 @@ public:
     /// Adds a problem, which is then filtered and also added to the filtered problem list if it matches the filters
     void addProblem(const IProblem::Ptr &problem) override;
 
+    /// Replaces the problems of a document, only the nodes which actually changed are removed or inserted
+    void updateProblems(const KDevelop::IndexedString& document, const QVector<IProblem::Ptr>& problems) override;
+
     /// Retrieves the specified node
     const ProblemStoreNode* findNode(int row, ProblemStoreNode *parent = nullptr) const override;
 
@@ -24,7 +24,14 @@ Boston, MA 02110-1301, USA.
 #include "plugincontroller.h"
 
 #include <QElapsedTimer>
+#include <QLibrary>
 #include <QMap>
+#include <QMutex>
+#include <QTextStream>
+#include <QTimer>
+#include <QtConcurrentMap>
+
+#include <algorithm>
 
 #include <KConfigGroup>
 #include <KLocalizedString>
@@ -69,6 +76,10 @@ inline QString KEY_Gui() { return QStringLiteral("GUI"); }
 inline QString KEY_AlwaysOn() { return QStringLiteral("AlwaysOn"); }
 inline QString KEY_UserSelectable() { return QStringLiteral("UserSelectable"); }
 
+/// KPlugin categories of global plugins which are not needed to show the first window,
+/// they are loaded once the event loop runs or when they are asked for, whatever happens first
+inline QStringList deferredCategories() { return {QStringLiteral("Documentation"), QStringLiteral("Analyzers")}; }
+
 bool isUserSelectable( const KPluginMetaData& info )
 {
     QString loadMode = info.value(KEY_LoadMode());
@@ -80,6 +91,11 @@ bool isGlobalPlugin( const KPluginMetaData& info )
     return info.value(KEY_Category()) == KEY_Global();
 }
 
+bool isDeferredPlugin( const KPluginMetaData& info )
+{
+    return deferredCategories().contains(info.category());
+}
+
 bool hasMandatoryProperties( const KPluginMetaData& info )
 {
     QString mode = info.value(KEY_Mode());
@@ -158,14 +174,128 @@ class PluginControllerPrivate
 public:
     explicit PluginControllerPrivate(Core *core)
         : core(core)
-    {}
+    {
+        startupTimer.start();
+    }
+
+    /// Where the time went while loading a plugin, all values in ms
+    struct TimelineEntry
+    {
+        /// resolving and loading the plugin library
+        qint64 loadDuration = 0;
+        /// creating the plugin instance
+        qint64 constructDuration = 0;
+        /// since the plugin controller was created
+        qint64 loadedAt = -1;
+        /// first time the plugin was asked for after it was loaded
+        qint64 firstUseAt = -1;
+        bool deferred = false;
+    };
+
+    /// Lookups and thus first uses also happen from background threads, e.g. via languagesForMimetype in parse jobs
+    void markUsed(const QString& pluginId) const
+    {
+        QMutexLocker lock(&mutex);
+        auto it = timeline.find(pluginId);
+        if (it != timeline.end() && it->firstUseAt < 0) {
+            it->firstUseAt = startupTimer.elapsed();
+        }
+    }
+
+    void markPreloaded(const QString& pluginId, qint64 loadDuration)
+    {
+        QMutexLocker lock(&mutex);
+        timeline[pluginId].loadDuration = loadDuration;
+    }
+
+    void markLoaded(const QString& pluginId, qint64 loadDuration, qint64 constructDuration)
+    {
+        QMutexLocker lock(&mutex);
+        auto& entry = timeline[pluginId];
+        entry.loadDuration += loadDuration;
+        entry.constructDuration = constructDuration;
+        entry.loadedAt = startupTimer.elapsed();
+    }
+
+    void markDeferred(const QString& pluginId)
+    {
+        QMutexLocker lock(&mutex);
+        timeline[pluginId].deferred = true;
+    }
+
+    void dumpTimeline() const
+    {
+        QMutexLocker lock(&mutex);
+        QVector<QPair<QString, TimelineEntry>> entries;
+        entries.reserve(timeline.size());
+        for (auto it = timeline.constBegin(), end = timeline.constEnd(); it != end; ++it) {
+            if (it->loadedAt >= 0) {
+                entries.append({it.key(), it.value()});
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const QPair<QString, TimelineEntry>& lhs, const QPair<QString, TimelineEntry>& rhs) {
+            return lhs.second.loadedAt < rhs.second.loadedAt;
+        });
+
+        QTextStream out(stderr);
+        out << "Plugin startup timeline (ms since start: plugin, library load, construction, first use)\n";
+        for (const auto& entry : qAsConst(entries)) {
+            out << qSetFieldWidth(6) << entry.second.loadedAt << qSetFieldWidth(0) << ": " << entry.first
+                << ", load " << entry.second.loadDuration << ", construct " << entry.second.constructDuration
+                << ", first use ";
+            if (entry.second.firstUseAt >= 0) {
+                out << entry.second.firstUseAt;
+            } else {
+                out << '-';
+            }
+            if (entry.second.deferred) {
+                out << " (deferred)";
+            }
+            out << '\n';
+        }
+    }
 
     QVector<KPluginMetaData> plugins;
 
+    QElapsedTimer startupTimer;
+    // updated on first use, which also happens via const lookups
+    mutable QHash<QString, TimelineEntry> timeline;
+    /// guards the timeline and loadedPlugins
+    mutable QMutex mutex;
+    /// global plugins which still need to be loaded after startup
+    QStringList deferredPlugins;
+    /// libraries loaded in parallel at startup, released again once their plugins are loaded
+    QVector<QLibrary*> preloadedLibraries;
+
     //map plugin infos to currently loaded plugins
     using InfoToPluginMap = QHash<KPluginMetaData, IPlugin*>;
+    // only changed on the main thread under the mutex, which may thus read it without the mutex,
+    // lookups from other threads, e.g. via languagesForMimetype in parse jobs, go through loadedPlugin()
     InfoToPluginMap loadedPlugins;
 
+    IPlugin* loadedPlugin(const KPluginMetaData& info) const
+    {
+        QMutexLocker lock(&mutex);
+        return loadedPlugins.value(info);
+    }
+
+    void insertLoadedPlugin(const KPluginMetaData& info, IPlugin* plugin)
+    {
+        QMutexLocker lock(&mutex);
+        loadedPlugins.insert(info, plugin);
+    }
+
+    void removeLoadedPlugin(IPlugin* plugin)
+    {
+        QMutexLocker lock(&mutex);
+        for (auto it = loadedPlugins.begin(); it != loadedPlugins.end(); ++it) {
+            if (it.value() == plugin) {
+                loadedPlugins.erase(it);
+                break;
+            }
+        }
+    }
+
     // The plugin manager's mode. The mode is StartingUp until loadAllPlugins()
     // has finished loading the plugins, after which it is set to Running.
     // ShuttingDown and DoneShutdown are used during shutdown by the
@@ -363,6 +493,7 @@ KPluginMetaData PluginController::pluginInfo( const IPlugin* plugin ) const
 {
     Q_D(const PluginController);
 
+    QMutexLocker lock(&d->mutex);
     return d->loadedPlugins.key(const_cast<IPlugin*>(plugin));
 }
 
@@ -448,20 +579,122 @@ void PluginController::initialize()
     // Synchronize so we're writing out to the file.
     grp.sync();
 
-    // load global plugins
+    // load global plugins, deferring those not needed for the first window when there is one
+    const bool deferPlugins = Core::self()->setupFlags() != Core::NoUi;
+    QStringList globalPlugins;
     for (const KPluginMetaData& pi : qAsConst(d->plugins)) {
         if (isGlobalPlugin(pi)) {
-            loadPluginInternal(pi.pluginId());
+            if (deferPlugins && isDeferredPlugin(pi)) {
+                d->deferredPlugins << pi.pluginId();
+            } else {
+                globalPlugins << pi.pluginId();
+            }
+        }
+    }
+
+    preloadLibraries(globalPlugins);
+
+    for (const QString& pluginId : qAsConst(globalPlugins)) {
+        loadPluginInternal(pluginId);
+    }
+
+    // the plugin loaders hold their own reference now, a library whose plugin
+    // could not be loaded gets unloaded again
+    for (QLibrary* library : qAsConst(d->preloadedLibraries)) {
+        library->unload();
+    }
+    qDeleteAll(d->preloadedLibraries);
+    d->preloadedLibraries.clear();
+
+    qCDebug(SHELL) << "Done loading plugins - took:" << timer.elapsed() << "ms," << d->deferredPlugins.size() << "plugins deferred";
+
+    if (d->deferredPlugins.isEmpty()) {
+        startupFinished();
+    } else {
+        QTimer::singleShot(0, this, &PluginController::loadNextDeferredPlugin);
+    }
+}
+
+void PluginController::preloadLibraries(const QStringList& pluginIds)
+{
+    Q_D(PluginController);
+
+    struct Library
+    {
+        QString pluginId;
+        QLibrary* library;
+        qint64 duration;
+    };
+
+    QVector<Library> libraries;
+    for (const QString& pluginId : pluginIds) {
+        const KPluginMetaData info = infoForPluginId(pluginId);
+        if (d->loadedPlugins.contains(info) || !d->isEnabled(info) || !hasMandatoryProperties(info)) {
+            continue;
+        }
+        if (info.value(KEY_Mode()) == KEY_Gui() && Core::self()->setupFlags() == Core::NoUi) {
+            continue;
         }
+        libraries.append({pluginId, new QLibrary(info.fileName()), 0});
     }
 
-    qCDebug(SHELL) << "Done loading plugins - took:" << timer.elapsed() << "ms";
+    // resolving symbols and running static initializers is what makes loading a library slow,
+    // do that in parallel, such that the plugin loader only needs to pick up the loaded library
+    QtConcurrent::blockingMap(libraries, [](Library& library) {
+        QElapsedTimer timer;
+        timer.start();
+        library.library->load();
+        library.duration = timer.elapsed();
+    });
+
+    for (const Library& library : qAsConst(libraries)) {
+        d->markPreloaded(library.pluginId, library.duration);
+        // keep the reference until the plugin loader took its own
+        d->preloadedLibraries.append(library.library);
+    }
+}
+
+void PluginController::loadNextDeferredPlugin()
+{
+    Q_D(PluginController);
+
+    if (d->cleanupMode != PluginControllerPrivate::Running) {
+        return;
+    }
+
+    // one plugin per event loop iteration, so the user interface stays responsive meanwhile
+    if (!d->deferredPlugins.isEmpty()) {
+        const QString pluginId = d->deferredPlugins.takeFirst();
+        if (!d->loadedPlugins.contains(infoForPluginId(pluginId))) {
+            d->markDeferred(pluginId);
+            loadPluginInternal(pluginId);
+        }
+    }
+
+    if (d->deferredPlugins.isEmpty()) {
+        startupFinished();
+    } else {
+        QTimer::singleShot(0, this, &PluginController::loadNextDeferredPlugin);
+    }
+}
+
+void PluginController::startupFinished()
+{
+    Q_D(PluginController);
+
+    qCDebug(SHELL) << "All startup plugins loaded after" << d->startupTimer.elapsed() << "ms";
+
+    // set KDEV_PLUGIN_TIMELINE to see where the time went while starting up
+    if (qEnvironmentVariableIsSet("KDEV_PLUGIN_TIMELINE")) {
+        d->dumpTimeline();
+    }
 }
 
 QList<IPlugin *> PluginController::loadedPlugins() const
 {
     Q_D(const PluginController);
 
+    QMutexLocker lock(&d->mutex);
     return d->loadedPlugins.values();
 }
 
@@ -495,15 +728,7 @@ bool PluginController::unloadPlugin(IPlugin* plugin, PluginDeletion deletion)
     //vanishes. For example project re-opening might try to reload the plugin
     //and then would get the "old" pointer which will be deleted in the next
     //event loop run and thus causing crashes.
-    for ( PluginControllerPrivate::InfoToPluginMap::Iterator it = d->loadedPlugins.begin();
-            it != d->loadedPlugins.end(); ++it )
-    {
-        if ( it.value() == plugin )
-        {
-            d->loadedPlugins.erase( it );
-            break;
-        }
-    }
+    d->removeLoadedPlugin(plugin);
 
     if (deletion == Later)
         plugin->deleteLater();
@@ -535,7 +760,7 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
         return nullptr;
     }
 
-    if ( IPlugin* plugin = d->loadedPlugins.value( info ) ) {
+    if ( IPlugin* plugin = d->loadedPlugin(info) ) {
         return plugin;
     }
 
@@ -592,8 +817,11 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
     loadOptionalDependencies( info );
 
     // now we can finally load the plugin itself
+    QElapsedTimer stepTimer;
+    stepTimer.start();
     KPluginLoader loader(info.fileName());
     auto factory = loader.factory();
+    const qint64 loadDuration = stepTimer.restart();
     if (!factory) {
         qCWarning(SHELL) << "Can't load plugin" << pluginId
                    << "because a factory to load the plugin could not be obtained:" << loader.errorString();
@@ -623,7 +851,8 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
     }
 
     // yay, it all worked - the plugin is loaded
-    d->loadedPlugins.insert(info, plugin);
+    d->markLoaded(pluginId, loadDuration, stepTimer.elapsed());
+    d->insertLoadedPlugin(info, plugin);
     group.writeEntry(info.pluginId() + KEY_Suffix_Enabled(), true); // do the same as KPluginInfo did
     group.sync();
     qCDebug(SHELL) << "Successfully loaded plugin" << pluginId << "from" << loader.fileName() << "- took:" << timer.elapsed() << "ms";
@@ -641,7 +870,11 @@ IPlugin* PluginController::plugin(const QString& pluginId) const
     if ( !info.isValid() )
         return nullptr;
 
-    return d->loadedPlugins.value( info );
+    IPlugin* plugin = d->loadedPlugin(info);
+    if (plugin) {
+        d->markUsed(pluginId);
+    }
+    return plugin;
 }
 
 bool PluginController::hasUnresolvedDependencies( const KPluginMetaData& info, QStringList& missing ) const
@@ -704,10 +937,13 @@ IPlugin *PluginController::pluginForExtension(const QString &extension, const QS
     d->foreachEnabledPlugin([this, &plugin] (const KPluginMetaData& info) -> bool {
         Q_D(PluginController);
 
-        plugin = d->loadedPlugins.value( info );
+        plugin = d->loadedPlugin(info);
         if( !plugin ) {
             plugin = loadPluginInternal( info.pluginId() );
         }
+        if (plugin) {
+            d->markUsed(info.pluginId());
+        }
         return !plugin;
     }, extension, constraints, pluginName);
 
@@ -723,11 +959,12 @@ QList<IPlugin*> PluginController::allPluginsForExtension(const QString &extensio
     d->foreachEnabledPlugin([this, &plugins] (const KPluginMetaData& info) -> bool {
         Q_D(PluginController);
 
-        IPlugin* plugin = d->loadedPlugins.value( info );
+        IPlugin* plugin = d->loadedPlugin(info);
         if( !plugin) {
             plugin = loadPluginInternal( info.pluginId() );
         }
         if (plugin && !plugins.contains(plugin)) {
+            d->markUsed(info.pluginId());
             plugins << plugin;
         }
         return true;
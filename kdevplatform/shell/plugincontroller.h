@@ -152,6 +152,20 @@ private:
      */
     IPlugin* loadPluginInternal( const QString &pluginId );
 
+    /**
+     * Load the libraries of the plugins identified by @p pluginIds in parallel,
+     * such that loadPluginInternal() finds them already resolved.
+     */
+    void preloadLibraries(const QStringList& pluginIds);
+
+    /**
+     * Load the next global plugin which was deferred during startup, one per event loop iteration.
+     */
+    void loadNextDeferredPlugin();
+
+    /// Called once all global plugins are loaded
+    void startupFinished();
+
     /**
      * Check whether the plugin identified by @p info has unresolved dependencies.
      *
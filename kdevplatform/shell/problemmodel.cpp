@@ -99,6 +99,11 @@ ProblemModel::ProblemModel(QObject * parent, ProblemStore *store)
 
     connect(d->m_problems.data(), &ProblemStore::beginRebuild, this, &ProblemModel::onBeginRebuild);
     connect(d->m_problems.data(), &ProblemStore::endRebuild, this, &ProblemModel::onEndRebuild);
+    connect(d->m_problems.data(), &ProblemStore::beginInsertNodes, this, &ProblemModel::onBeginInsertNodes);
+    connect(d->m_problems.data(), &ProblemStore::endInsertNodes, this, &ProblemModel::onEndInsertNodes);
+    connect(d->m_problems.data(), &ProblemStore::beginRemoveNodes, this, &ProblemModel::onBeginRemoveNodes);
+    connect(d->m_problems.data(), &ProblemStore::endRemoveNodes, this, &ProblemModel::onEndRemoveNodes);
+    connect(d->m_problems.data(), &ProblemStore::nodesChanged, this, &ProblemModel::onNodesChanged);
 
     connect(d->m_problems.data(), &ProblemStore::problemsChanged, this, &ProblemModel::problemsChanged);
 }
@@ -196,13 +201,17 @@ QModelIndex ProblemModel::parent(const QModelIndex& index) const
         return {};
     }
 
-    ProblemStoreNode *parent = node->parent();
-    if (!parent || parent->isRoot()) {
+    return indexForNode(node->parent());
+}
+
+QModelIndex ProblemModel::indexForNode(ProblemStoreNode* node) const
+{
+    if (!node || node->isRoot()) {
         return {};
     }
 
-    int idx = parent->index();
-    return createIndex(idx, 0, parent);
+    int idx = node->index();
+    return createIndex(idx, 0, node);
 }
 
 QModelIndex ProblemModel::index(int row, int column, const QModelIndex& parent) const
@@ -376,6 +385,32 @@ void ProblemModel::onEndRebuild()
     endResetModel();
 }
 
+void ProblemModel::onBeginInsertNodes(ProblemStoreNode* parent, int first, int last)
+{
+    beginInsertRows(indexForNode(parent), first, last);
+}
+
+void ProblemModel::onEndInsertNodes()
+{
+    endInsertRows();
+}
+
+void ProblemModel::onBeginRemoveNodes(ProblemStoreNode* parent, int first, int last)
+{
+    beginRemoveRows(indexForNode(parent), first, last);
+}
+
+void ProblemModel::onEndRemoveNodes()
+{
+    endRemoveRows();
+}
+
+void ProblemModel::onNodesChanged(ProblemStoreNode* parent, int first, int last)
+{
+    const QModelIndex parentIndex = indexForNode(parent);
+    emit dataChanged(index(first, 0, parentIndex), index(last, LastColumn - 1, parentIndex));
+}
+
 void ProblemModel::setShowImports(bool showImports)
 {
     Q_D(ProblemModel);
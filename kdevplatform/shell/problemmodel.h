@@ -32,6 +32,7 @@ namespace KDevelop {
     class IDocument;
 class IndexedString;
 class ProblemStore;
+class ProblemStoreNode;
 class ProblemModelPrivate;
 
 /**
@@ -210,10 +211,23 @@ private Q_SLOTS:
     /// Triggered once the problems have been rebuilt
     void onEndRebuild();
 
+    /// Triggered before single nodes are inserted into the problem tree
+    void onBeginInsertNodes(KDevelop::ProblemStoreNode* parent, int first, int last);
+    void onEndInsertNodes();
+
+    /// Triggered before single nodes are removed from the problem tree
+    void onBeginRemoveNodes(KDevelop::ProblemStoreNode* parent, int first, int last);
+    void onEndRemoveNodes();
+
+    /// Triggered when kept nodes of the problem tree show new problems
+    void onNodesChanged(KDevelop::ProblemStoreNode* parent, int first, int last);
+
 protected:
     ProblemStore *store() const;
 
 private:
+    QModelIndex indexForNode(ProblemStoreNode* node) const;
+
     const QScopedPointer<class ProblemModelPrivate> d_ptr;
     Q_DECLARE_PRIVATE(ProblemModel)
 };
@@ -106,6 +106,60 @@ void ProblemStore::setProblems(const QVector<IProblem::Ptr> &problems)
     }
 }
 
+void ProblemStore::updateProblems(const KDevelop::IndexedString& document, const QVector<IProblem::Ptr>& problems)
+{
+    emit beginRebuild();
+    const bool changed = replaceProblems(document, problems);
+    emit endRebuild();
+
+    if (changed) {
+        emit problemsChanged();
+    }
+}
+
+bool ProblemStore::replaceProblems(const KDevelop::IndexedString& document, const QVector<IProblem::Ptr>& problems)
+{
+    Q_D(ProblemStore);
+
+    QVector<IProblem::Ptr> oldProblems;
+    QVector<IProblem::Ptr> allProblems;
+    allProblems.reserve(d->m_allProblems.size() + problems.size());
+    for (const IProblem::Ptr& problem : qAsConst(d->m_allProblems)) {
+        if (problem->finalLocation().document == document)
+            oldProblems += problem;
+        else
+            allProblems += problem;
+    }
+
+    if (oldProblems == problems)
+        return false;
+
+    allProblems += problems;
+    d->m_allProblems = allProblems;
+
+    // the root node holds the problems in the same order as m_allProblems,
+    // the problems of a document are usually adjacent, so remove them run-wise
+    const auto& children = d->m_rootNode->children();
+    int row = children.size() - 1;
+    while (row >= 0) {
+        if (children[row]->problem()->finalLocation().document != document) {
+            --row;
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && children[row - 1]->problem()->finalLocation().document == document)
+            --row;
+        d->m_rootNode->removeChildren(row, last - row + 1);
+        --row;
+    }
+
+    for (const IProblem::Ptr& problem : problems) {
+        d->m_rootNode->addChild(new ProblemNode(d->m_rootNode, problem));
+    }
+
+    return true;
+}
+
 QVector<IProblem::Ptr> ProblemStore::problems(const KDevelop::IndexedString& document) const
 {
     Q_D(const ProblemStore);
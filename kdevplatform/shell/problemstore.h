@@ -80,6 +80,10 @@ public:
     /// Clears the current problems, and adds new ones from a list
     virtual void setProblems(const QVector<IProblem::Ptr> &problems);
 
+    /// Replaces the problems located in @p document with @p problems, keeping all other problems.
+    /// The base class announces a rebuild, subclasses which maintain their own node tree must reimplement it.
+    virtual void updateProblems(const KDevelop::IndexedString& document, const QVector<IProblem::Ptr>& problems);
+
     /// Retrieve problems for selected document
     QVector<IProblem::Ptr> problems(const KDevelop::IndexedString& document) const;
 
@@ -144,6 +148,21 @@ Q_SIGNALS:
     /// Emitted once the problemlist has been rebuilt
     void endRebuild();
 
+    /// Emitted before the nodes @p first to @p last are inserted below @p parent by updateProblems()
+    void beginInsertNodes(KDevelop::ProblemStoreNode* parent, int first, int last);
+
+    /// Emitted once the nodes have been inserted
+    void endInsertNodes();
+
+    /// Emitted before the nodes @p first to @p last are removed from @p parent by updateProblems()
+    void beginRemoveNodes(KDevelop::ProblemStoreNode* parent, int first, int last);
+
+    /// Emitted once the nodes have been removed
+    void endRemoveNodes();
+
+    /// Emitted when the nodes @p first to @p last below @p parent were kept by updateProblems() but show new problems
+    void nodesChanged(KDevelop::ProblemStoreNode* parent, int first, int last);
+
 private Q_SLOTS:
     /// Triggered when the watched document set changes. E.g.:document closed, new one added, etc
     virtual void onDocumentSetChanged();
@@ -151,6 +170,10 @@ private Q_SLOTS:
 protected:
     ProblemStoreNode* rootNode() const;
 
+    /// Replaces the stored problems located in @p document without rebuilding anything.
+    /// Returns false when @p problems are the ones stored already.
+    bool replaceProblems(const KDevelop::IndexedString& document, const QVector<IProblem::Ptr>& problems);
+
 private:
     const QScopedPointer<class ProblemStorePrivate> d_ptr;
     Q_DECLARE_PRIVATE(ProblemStore)
@@ -118,6 +118,15 @@ public:
         child->setParent(this);
     }
 
+    /// Removes and deletes @p count children nodes starting at @p row
+    void removeChildren(int row, int count)
+    {
+        for (int i = row; i < row + count; ++i) {
+            delete m_children[i];
+        }
+        m_children.remove(row, count);
+    }
+
     /// Returns the label of this node, if there's one
     virtual QString label() const{
         return QString();
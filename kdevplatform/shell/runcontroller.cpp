@@ -34,12 +34,14 @@ Boston, MA 02110-1301, USA.
 #include <interfaces/idocumentcontroller.h>
 #include <interfaces/ilauncher.h>
 #include <interfaces/ilaunchmode.h>
+#include <interfaces/ilanguagecontroller.h>
 #include <interfaces/launchconfigurationtype.h>
 #include <outputview/outputjob.h>
 #include <project/projectmodel.h>
 #include <sublime/message.h>
 
 #include "core.h"
+#include "backgroundparsergovernor.h"
 #include "uicontroller.h"
 #include "projectcontroller.h"
 #include "mainwindow.h"
@@ -142,6 +144,7 @@ public:
     ExecuteMode* executeMode;
     ProfileMode* profileMode;
     UnityLauncher* unityLauncher;
+    BackgroundParserGovernor* parserGovernor;
 
     bool hasLaunchConfigType( const QString& typeId )
     {
@@ -322,6 +325,7 @@ RunController::RunController(QObject *parent)
     d->executeMode = nullptr;
     d->debugMode = nullptr;
     d->profileMode = nullptr;
+    d->parserGovernor = nullptr;
 
     d->unityLauncher = new UnityLauncher(this);
     d->unityLauncher->setLauncherId(KAboutData::applicationData().desktopFileName());
@@ -386,10 +390,14 @@ void RunController::initialize()
     connect(Core::self()->projectController(), &IProjectController::projectConfigurationChanged,
              this, &RunController::slotRefreshProject);
 
+    // throttle the background parser while builds are running
+    d->parserGovernor = new BackgroundParserGovernor(Core::self()->languageController()->backgroundParser(), this, this);
+
     if( (Core::self()->setupFlags() & Core::NoUi) == 0 )
     {
         // Only do this in GUI mode
         d->updateCurrentLaunchAction();
+        Core::self()->uiController()->registerStatus(d->parserGovernor);
     }
 }
 
@@ -23,6 +23,7 @@
 
 #include <interfaces/ilanguagecontroller.h>
 #include <language/backgroundparser/backgroundparser.h>
+#include <language/duchain/duchain.h>
 
 #include "../core.h"
 
@@ -51,6 +52,7 @@ void BGPreferences::reset()
     preferencesDialog->kcfg_delay->setValue(config.readEntry("Delay", 500));
     preferencesDialog->kcfg_threads->setValue(config.readEntry("Number of Threads", QThread::idealThreadCount()));
     preferencesDialog->kcfg_enable->setChecked(config.readEntry("Enabled", true));
+    preferencesDialog->kcfg_duchainMemoryBudget->setValue(config.readEntry("DUChain Memory Budget", 0));
 }
 
 BGPreferences::~BGPreferences( )
@@ -69,11 +71,13 @@ void BGPreferences::apply()
 
     Core::self()->languageController()->backgroundParser()->setDelay( preferencesDialog->kcfg_delay->value() );
     Core::self()->languageController()->backgroundParser()->setThreadCount( preferencesDialog->kcfg_threads->value() );
+    DUChain::self()->setMemoryBudget(qint64(preferencesDialog->kcfg_duchainMemoryBudget->value()) * 1024 * 1024);
 
     KConfigGroup config(ICore::self()->activeSession()->config(), "Background Parser");
     config.writeEntry("Enabled", preferencesDialog->kcfg_enable->isChecked());
     config.writeEntry("Delay", preferencesDialog->kcfg_delay->value());
     config.writeEntry("Number of Threads", preferencesDialog->kcfg_threads->value());
+    config.writeEntry("DUChain Memory Budget", preferencesDialog->kcfg_duchainMemoryBudget->value());
 }
 
 QString BGPreferences::name() const
@@ -27,8 +27,12 @@
 
 #include <debug.h>
 
+#include <QFile>
+#include <QFutureWatcher>
+#include <QSaveFile>
 #include <QMimeDatabase>
 #include <QTextStream>
+#include <QtConcurrentRun>
 
 #include <KIO/StoredTransferJob>
 #include <KLocalizedString>
@@ -41,12 +45,13 @@
 
 using namespace KDevelop;
 
-
 SourceFormatterJob::SourceFormatterJob(SourceFormatterController* sourceFormatterController)
     : KJob(sourceFormatterController)
     , m_sourceFormatterController(sourceFormatterController)
     , m_workState(WorkIdle)
     , m_fileIndex(0)
+    , m_doneCount(0)
+    , m_pendingCount(0)
 {
     setCapabilities(Killable);
     // set name for job listing
@@ -59,6 +64,14 @@ SourceFormatterJob::SourceFormatterJob(SourceFormatterController* sourceFormatte
     });
 }
 
+SourceFormatterJob::~SourceFormatterJob()
+{
+    // the running tasks access m_cancelled
+    m_cancelled.store(1);
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
+
 QString SourceFormatterJob::statusName() const
 {
     return i18n("Reformat Files");
@@ -71,6 +84,7 @@ void SourceFormatterJob::doWork()
         case WorkIdle:
             m_workState = WorkFormat;
             m_fileIndex = 0;
+            m_doneCount = 0;
             emit showProgress(this, 0, 0, 0);
             emit showMessage(this, i18np("Reformatting one file",
                                          "Reformatting %1 files",
@@ -80,15 +94,17 @@ void SourceFormatterJob::doWork()
             break;
         case WorkFormat:
             if (m_fileIndex < m_fileList.length()) {
-                emit showProgress(this, 0, m_fileList.length(), m_fileIndex);
                 formatFile(m_fileList[m_fileIndex]);
 
                 // trigger formatting of next file
                 ++m_fileIndex;
-                QMetaObject::invokeMethod(this, "doWork", Qt::QueuedConnection);
+                if (m_fileIndex < m_fileList.length()) {
+                    QMetaObject::invokeMethod(this, "doWork", Qt::QueuedConnection);
+                } else {
+                    finishIfDone();
+                }
             } else {
-                m_workState = WorkIdle;
-                emitResult();
+                finishIfDone();
             }
             break;
         case WorkCancelled:
@@ -109,6 +125,8 @@ void SourceFormatterJob::start()
 bool SourceFormatterJob::doKill()
 {
     m_workState = WorkCancelled;
+    m_cancelled.store(1);
+    m_threadPool.clear();
     return true;
 }
 
@@ -117,40 +135,168 @@ void SourceFormatterJob::setFiles(const QList<QUrl>& fileList)
     m_fileList = fileList;
 }
 
+QString SourceFormatterJob::decodeFileContents(const QByteArray& data)
+{
+    // TODO: really fromLocal8Bit/toLocal8Bit? no encoding detection? added in b8062f736a2bf2eec098af531a7fda6ebcdc7cde
+    return QString::fromLocal8Bit(data);
+}
+
+QByteArray SourceFormatterJob::encodeFileContents(const QString& text)
+{
+    return text.toLocal8Bit();
+}
+
+SourceFormatterFileResult SourceFormatterJob::formatLocalFile(const QUrl& url, const QMimeType& mime,
+                                                              const ISourceFormatter* formatter,
+                                                              const SourceFormatterStyle& style,
+                                                              const QAtomicInt* cancelled)
+{
+    SourceFormatterFileResult result;
+    result.url = url;
+    result.mime = mime;
+
+    if (cancelled && cancelled->load()) {
+        return result;
+    }
+
+    QFile file(url.toLocalFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.errorString = i18n("Could not open %1 for reading: %2", url.toDisplayString(QUrl::PreferLocalFile),
+                                  file.errorString());
+        return result;
+    }
+
+    result.originalText = decodeFileContents(file.readAll());
+    result.formattedText = formatter->formatSourceWithStyle(style, result.originalText, url, mime);
+    return result;
+}
+
+bool SourceFormatterJob::writeLocalFileIfChanged(const QString& path, const QString& originalText,
+                                                 const QString& text, QString* errorString)
+{
+    if (text == originalText) {
+        qCDebug(SHELL) << "File " << path << "is formatted already";
+        return true;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(encodeFileContents(text)) == -1 || !file.commit()) {
+        *errorString = i18n("Could not write %1: %2", path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
 void SourceFormatterJob::formatFile(const QUrl& url)
 {
     // check mimetype
     QMimeType mime = QMimeDatabase().mimeTypeForUrl(url);
     qCDebug(SHELL) << "Checking file " << url << " of mime type " << mime.name();
     auto formatter = m_sourceFormatterController->formatterForUrl(url, mime);
-    if (!formatter) // unsupported mime type
+    if (!formatter) { // unsupported mime type
+        fileDone();
         return;
+    }
 
     // if the file is opened in the editor, format the text in the editor without saving it
     auto doc = ICore::self()->documentController()->documentForUrl(url);
     if (doc) {
         qCDebug(SHELL) << "Processing file " << url << "opened in editor";
         m_sourceFormatterController->formatDocument(doc, formatter, mime);
+        fileDone();
+        return;
+    }
+
+    if (!url.isLocalFile() || !formatter->canFormatConcurrently()) {
+        formatFileInUiThread(url, formatter, mime);
+        fileDone();
         return;
     }
 
+    qCDebug(SHELL) << "Processing file " << url << "in the thread pool";
+    // the style is read from the configuration, which is only safe in the UI thread
+    const auto style = m_sourceFormatterController->styleForUrl(url, mime);
+
+    auto watcher = new QFutureWatcher<SourceFormatterFileResult>(this);
+    connect(watcher, &QFutureWatcher<SourceFormatterFileResult>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        --m_pendingCount;
+        if (m_workState == WorkCancelled) {
+            return;
+        }
+        fileFormatted(watcher->result());
+        fileDone();
+        finishIfDone();
+    });
+    ++m_pendingCount;
+    watcher->setFuture(QtConcurrent::run(&m_threadPool, &SourceFormatterJob::formatLocalFile, url, mime,
+                                         static_cast<const ISourceFormatter*>(formatter), style,
+                                         static_cast<const QAtomicInt*>(&m_cancelled)));
+}
+
+void SourceFormatterJob::formatFileInUiThread(const QUrl& url, ISourceFormatter* formatter, const QMimeType& mime)
+{
     qCDebug(SHELL) << "Processing file " << url;
     auto getJob = KIO::storedGet(url);
     // TODO: make also async and use start() and integrate using setError and setErrorString.
     if (getJob->exec()) {
-        // TODO: really fromLocal8Bit/toLocal8Bit? no encoding detection? added in b8062f736a2bf2eec098af531a7fda6ebcdc7cde
-        QString text = QString::fromLocal8Bit(getJob->data());
-        text = formatter->formatSource(text, url, mime);
-        text = m_sourceFormatterController->addModelineForCurrentLang(text, url, mime);
-
-        auto putJob = KIO::storedPut(text.toLocal8Bit(), url, -1, KIO::Overwrite);
-        // see getJob
-        if (!putJob->exec()) {
-            auto* message = new Sublime::Message(putJob->errorString(), Sublime::Message::Error);
-            ICore::self()->uiController()->postMessage(message);
-        }
+        SourceFormatterFileResult result;
+        result.url = url;
+        result.mime = mime;
+        result.originalText = decodeFileContents(getJob->data());
+        result.formattedText = formatter->formatSource(result.originalText, url, mime);
+        fileFormatted(result);
     } else {
         auto* message = new Sublime::Message(getJob->errorString(), Sublime::Message::Error);
         ICore::self()->uiController()->postMessage(message);
     }
 }
+
+void SourceFormatterJob::fileFormatted(const SourceFormatterFileResult& result)
+{
+    if (!result.errorString.isEmpty()) {
+        auto* message = new Sublime::Message(result.errorString, Sublime::Message::Error);
+        ICore::self()->uiController()->postMessage(message);
+        return;
+    }
+
+    const QString text = m_sourceFormatterController->addModelineForCurrentLang(result.formattedText, result.url, result.mime);
+
+    if (result.url.isLocalFile()) {
+        QString errorString;
+        if (!writeLocalFileIfChanged(result.url.toLocalFile(), result.originalText, text, &errorString)) {
+            auto* message = new Sublime::Message(errorString, Sublime::Message::Error);
+            ICore::self()->uiController()->postMessage(message);
+        }
+        return;
+    }
+
+    if (text == result.originalText) {
+        qCDebug(SHELL) << "File " << result.url << "is formatted already";
+        return;
+    }
+
+    auto putJob = KIO::storedPut(encodeFileContents(text), result.url, -1, KIO::Overwrite);
+    // see getJob
+    if (!putJob->exec()) {
+        auto* message = new Sublime::Message(putJob->errorString(), Sublime::Message::Error);
+        ICore::self()->uiController()->postMessage(message);
+    }
+}
+
+void SourceFormatterJob::fileDone()
+{
+    ++m_doneCount;
+    emit showProgress(this, 0, m_fileList.length(), m_doneCount);
+}
+
+void SourceFormatterJob::finishIfDone()
+{
+    // the last file formatted in the thread pool might only finish after all files were started
+    if (m_workState != WorkFormat || m_fileIndex < m_fileList.length() || m_pendingCount > 0) {
+        return;
+    }
+
+    m_workState = WorkIdle;
+    emitResult();
+}
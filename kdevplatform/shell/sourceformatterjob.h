@@ -22,26 +22,49 @@
 #ifndef KDEVPLATFORM_SOURCEFORMATTERJOB_H
 #define KDEVPLATFORM_SOURCEFORMATTERJOB_H
 
+#include <QAtomicInt>
 #include <QList>
+#include <QMimeType>
+#include <QThreadPool>
 #include <QUrl>
 
 #include <KJob>
 
 #include <interfaces/istatus.h>
 
+#include "shellexport.h"
 
 namespace KDevelop
 {
+class ISourceFormatter;
 class SourceFormatterController;
+class SourceFormatterStyle;
 
+struct SourceFormatterFileResult
+{
+    QUrl url;
+    QMimeType mime;
+    QString originalText;
+    QString formattedText;
+    /// Set if the file could not be read.
+    QString errorString;
+};
 
-class SourceFormatterJob : public KJob, public IStatus
+/**
+ * Reformats a list of files.
+ *
+ * Files which are not opened in the editor and whose formatter supports it are read, formatted
+ * and compared in a thread pool, so many files are formatted at once without blocking the UI.
+ * Files are only written if formatting changed their contents.
+ */
+class KDEVPLATFORMSHELL_EXPORT SourceFormatterJob : public KJob, public IStatus
 {
     Q_OBJECT
     Q_INTERFACES( KDevelop::IStatus )
 
 public:
     explicit SourceFormatterJob(SourceFormatterController* sourceFormatterController);
+    ~SourceFormatterJob() override;
 
 public: // KJob API
     void start() override;
@@ -52,6 +75,31 @@ public: // KDevelop::IStatus API
 public:
     void setFiles(const QList<QUrl>& fileList);
 
+    /**
+     * Read and format the local file @p url, safe to call from the thread pool
+     * if @p formatter can format concurrently.
+     *
+     * @param cancelled If set, nothing is done.
+     */
+    static SourceFormatterFileResult formatLocalFile(const QUrl& url, const QMimeType& mime,
+                                                     const ISourceFormatter* formatter,
+                                                     const SourceFormatterStyle& style, const QAtomicInt* cancelled);
+
+    /**
+     * Write @p text to the local file @p path, unless it equals @p originalText.
+     *
+     * The file is replaced atomically, so it is never left truncated.
+     *
+     * @return false if writing failed, with the reason in @p errorString
+     */
+    static bool writeLocalFileIfChanged(const QString& path, const QString& originalText, const QString& text,
+                                        QString* errorString);
+
+    /// Decode the contents of a file read for formatting.
+    static QString decodeFileContents(const QByteArray& data);
+    /// Encode formatted text, the opposite of decodeFileContents().
+    static QByteArray encodeFileContents(const QString& text);
+
 protected: // KJob API
     bool doKill() override;
 
@@ -66,6 +114,10 @@ private:
     Q_INVOKABLE void doWork();
 
     void formatFile(const QUrl& url);
+    void formatFileInUiThread(const QUrl& url, ISourceFormatter* formatter, const QMimeType& mime);
+    void fileFormatted(const SourceFormatterFileResult& result);
+    void fileDone();
+    void finishIfDone();
 
 private:
     SourceFormatterController* const m_sourceFormatterController;
@@ -78,6 +130,14 @@ private:
 
     QList<QUrl> m_fileList;
     int m_fileIndex;
+    /// Number of files formatted (or skipped) so far.
+    int m_doneCount;
+    /// Number of files handed to the thread pool which are not done yet.
+    int m_pendingCount;
+
+    /// Set when the job is killed, so files which were not started yet are skipped.
+    QAtomicInt m_cancelled;
+    QThreadPool m_threadPool;
 };
 
 }
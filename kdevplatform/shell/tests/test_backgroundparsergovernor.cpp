@@ -0,0 +1,152 @@
+/*
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+#include <shell/backgroundparsergovernor.h>
+
+using namespace KDevelop;
+
+using Level = BackgroundParserGovernor::Level;
+Q_DECLARE_METATYPE(Level)
+
+class TestBackgroundParserGovernor : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testParseCpuPressure_data();
+    void testParseCpuPressure();
+    void testParseLoadAverage_data();
+    void testParseLoadAverage();
+    void testIsOverloaded_data();
+    void testIsOverloaded();
+    void testDecide_data();
+    void testDecide();
+    void testBuildDoesNotLowerThreshold();
+    void testThreadLimit();
+};
+
+void TestBackgroundParserGovernor::testParseCpuPressure_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+    QTest::addColumn<double>("pressure");
+
+    QTest::newRow("some") << QByteArray("some avg10=12.50 avg60=3.10 avg300=0.80 total=123456\n") << 12.5;
+    QTest::newRow("some-full")
+        << QByteArray("some avg10=0.25 avg60=0.10 avg300=0.00 total=42\nfull avg10=80.00 avg60=0.00 avg300=0.00 total=0\n")
+        << 0.25;
+    QTest::newRow("empty") << QByteArray() << -1.0;
+    QTest::newRow("garbage") << QByteArray("some avg10=abc\n") << -1.0;
+}
+
+void TestBackgroundParserGovernor::testParseCpuPressure()
+{
+    QFETCH(QByteArray, contents);
+    QFETCH(double, pressure);
+
+    QCOMPARE(BackgroundParserGovernor::parseCpuPressure(contents), pressure);
+}
+
+void TestBackgroundParserGovernor::testParseLoadAverage_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+    QTest::addColumn<double>("load");
+
+    QTest::newRow("loadavg") << QByteArray("3.52 2.58 1.59 5/467 12345\n") << 3.52;
+    QTest::newRow("empty") << QByteArray() << -1.0;
+}
+
+void TestBackgroundParserGovernor::testParseLoadAverage()
+{
+    QFETCH(QByteArray, contents);
+    QFETCH(double, load);
+
+    QCOMPARE(BackgroundParserGovernor::parseLoadAverage(contents), load);
+}
+
+void TestBackgroundParserGovernor::testIsOverloaded_data()
+{
+    QTest::addColumn<bool>("wasOverloaded");
+    QTest::addColumn<double>("cpuPressure");
+    QTest::addColumn<double>("loadPerCpu");
+    QTest::addColumn<bool>("overloaded");
+
+    QTest::newRow("idle") << false << 5.0 << -1.0 << false;
+    QTest::newRow("no-measurements") << false << -1.0 << -1.0 << false;
+    QTest::newRow("busy") << false << 70.0 << -1.0 << true;
+    QTest::newRow("busy-load") << false << -1.0 << 2.0 << true;
+    // below the threshold to enter, but above the one to leave
+    QTest::newRow("stays-busy") << true << 30.0 << -1.0 << true;
+    QTest::newRow("not-yet-busy") << false << 30.0 << -1.0 << false;
+    QTest::newRow("calmed-down") << true << 10.0 << -1.0 << false;
+    QTest::newRow("stays-busy-load") << true << -1.0 << 1.2 << true;
+    QTest::newRow("not-yet-busy-load") << false << -1.0 << 1.2 << false;
+}
+
+void TestBackgroundParserGovernor::testIsOverloaded()
+{
+    QFETCH(bool, wasOverloaded);
+    QFETCH(double, cpuPressure);
+    QFETCH(double, loadPerCpu);
+    QFETCH(bool, overloaded);
+
+    QCOMPARE(BackgroundParserGovernor::isOverloaded(wasOverloaded, cpuPressure, loadPerCpu), overloaded);
+}
+
+void TestBackgroundParserGovernor::testDecide_data()
+{
+    QTest::addColumn<int>("buildJobs");
+    QTest::addColumn<bool>("overloaded");
+    QTest::addColumn<Level>("expected");
+
+    QTest::newRow("idle") << 0 << false << BackgroundParserGovernor::Unthrottled;
+    QTest::newRow("busy") << 0 << true << BackgroundParserGovernor::Reduced;
+    QTest::newRow("build") << 1 << false << BackgroundParserGovernor::Reduced;
+    QTest::newRow("build-overloaded") << 2 << true << BackgroundParserGovernor::Minimal;
+}
+
+void TestBackgroundParserGovernor::testDecide()
+{
+    QFETCH(int, buildJobs);
+    QFETCH(bool, overloaded);
+    QFETCH(Level, expected);
+
+    QCOMPARE(BackgroundParserGovernor::decide(buildJobs, overloaded), expected);
+}
+
+void TestBackgroundParserGovernor::testBuildDoesNotLowerThreshold()
+{
+    // a running build alone keeps the parser reduced, moderate pressure caused by it must not
+    // count as overloaded just because the parser is already throttled
+    const bool overloaded = BackgroundParserGovernor::isOverloaded(false, 30.0, -1.0);
+    QVERIFY(!overloaded);
+    QCOMPARE(BackgroundParserGovernor::decide(1, overloaded), BackgroundParserGovernor::Reduced);
+}
+
+void TestBackgroundParserGovernor::testThreadLimit()
+{
+    QCOMPARE(BackgroundParserGovernor::threadLimit(BackgroundParserGovernor::Unthrottled, 8), 0);
+    QCOMPARE(BackgroundParserGovernor::threadLimit(BackgroundParserGovernor::Reduced, 8), 4);
+    QCOMPARE(BackgroundParserGovernor::threadLimit(BackgroundParserGovernor::Reduced, 1), 1);
+    QCOMPARE(BackgroundParserGovernor::threadLimit(BackgroundParserGovernor::Minimal, 8), 1);
+}
+
+QTEST_GUILESS_MAIN(TestBackgroundParserGovernor)
+
+#include "test_backgroundparsergovernor.moc"
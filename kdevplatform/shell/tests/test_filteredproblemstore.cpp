@@ -44,6 +44,8 @@ const int HintFilterProblemCount = ErrorCount + WarningCount + HintCount;
 
 using namespace KDevelop;
 
+Q_DECLARE_METATYPE(KDevelop::ProblemStoreNode*)
+
 class TestFilteredProblemStore : public QObject
 {
     Q_OBJECT
@@ -59,6 +61,9 @@ private Q_SLOTS:
     void testPathGrouping();
     void testSeverityGrouping();
 
+    void testUpdateProblems();
+    void testUpdateDiagnostics();
+
 private:
     // Severity grouping testing
     bool checkCounts(int error, int warning, int hint);
@@ -87,6 +92,8 @@ void TestFilteredProblemStore::initTestCase()
     AutoTestShell::init();
     TestCore::initialize(Core::NoUi);
 
+    qRegisterMetaType<KDevelop::ProblemStoreNode*>();
+
     m_store.reset(new FilteredProblemStore());
 
     generateProblems();
@@ -568,6 +575,153 @@ void TestFilteredProblemStore::testSeverityGrouping()
     QVERIFY(checkDiagnodes(m_store->findNode(0)->child(0), m_diagnosticTestProblem));
 }
 
+void TestFilteredProblemStore::testUpdateProblems()
+{
+    m_store->clear();
+    m_store->setGrouping(NoGrouping);
+    m_store->setProblems(m_problems);
+    QCOMPARE(m_store->count(), ProblemsCount);
+
+    const IndexedString document = m_problems[1]->finalLocation().document;
+
+    // a reparse creates new, but equal problem instances
+    IProblem::Ptr same(new DetectedProblem());
+    same->setDescription(m_problems[1]->description());
+    same->setSeverity(m_problems[1]->severity());
+    same->setFinalLocation(m_problems[1]->finalLocation());
+
+    IProblem::Ptr added(new DetectedProblem());
+    added->setDescription(QStringLiteral("PROBLEM2B"));
+    added->setSeverity(IProblem::Warning);
+    added->setFinalLocation(m_problems[1]->finalLocation());
+
+    QSignalSpy beginRebuildSpy(m_store.data(), &FilteredProblemStore::beginRebuild);
+    QSignalSpy insertSpy(m_store.data(), &FilteredProblemStore::beginInsertNodes);
+    QSignalSpy removeSpy(m_store.data(), &FilteredProblemStore::beginRemoveNodes);
+    QSignalSpy problemsChangedSpy(m_store.data(), &FilteredProblemStore::problemsChanged);
+
+    // the unchanged problem keeps its node, only the new one gets inserted
+    m_store->updateProblems(document, {same, added});
+    QCOMPARE(beginRebuildSpy.count(), 0);
+    QCOMPARE(removeSpy.count(), 0);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy.at(0).at(1).toInt(), ProblemsCount);
+    QCOMPARE(insertSpy.at(0).at(2).toInt(), ProblemsCount);
+    QCOMPARE(problemsChangedSpy.count(), 1);
+    QCOMPARE(m_store->count(), ProblemsCount + 1);
+    QCOMPARE(m_store->findNode(1)->problem(), same);
+    QVERIFY(checkNodeDescription(m_store->findNode(ProblemsCount), added->description()));
+    QCOMPARE(m_store->problems(document).size(), 2);
+
+    // the same problems again don't change anything
+    insertSpy.clear();
+    problemsChangedSpy.clear();
+    m_store->updateProblems(document, {same, added});
+    QCOMPARE(insertSpy.count(), 0);
+    QCOMPARE(removeSpy.count(), 0);
+    QCOMPARE(problemsChangedSpy.count(), 0);
+
+    // removing all problems of the document removes both, non-adjacent nodes
+    m_store->updateProblems(document, {});
+    QCOMPARE(insertSpy.count(), 0);
+    QCOMPARE(removeSpy.count(), 2);
+    QCOMPARE(m_store->count(), ProblemsCount - 1);
+    QVERIFY(m_store->problems(document).isEmpty());
+
+    // filtered problems are stored, but don't show up
+    removeSpy.clear();
+    m_store->setSeverities(IProblem::Error);
+    m_store->updateProblems(document, {same});
+    QCOMPARE(insertSpy.count(), 0);
+    QCOMPARE(m_store->count(), ErrorCount);
+    QCOMPARE(m_store->problems(document).size(), 1);
+    m_store->setSeverities(IProblem::Error | IProblem::Warning | IProblem::Hint);
+    QCOMPARE(m_store->count(), ProblemsCount);
+
+    // path grouping inserts and removes whole groups
+    m_store->setGrouping(PathGrouping);
+    m_store->updateProblems(document, {});
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(m_store->count(), ProblemsCount - 1);
+
+    m_store->updateProblems(document, {same, added});
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(m_store->count(), ProblemsCount);
+    {
+        const ProblemStoreNode *node = m_store->findNode(ProblemsCount - 1);
+        QVERIFY(checkNodeLabel(node, document.str()));
+        QCOMPARE(node->count(), 2);
+    }
+
+    // severity grouping updates the children of the groups
+    m_store->setGrouping(SeverityGrouping);
+    QVERIFY(checkCounts(ErrorCount, WarningCount + 1, HintCount));
+    m_store->updateProblems(document, {added});
+    QVERIFY(checkCounts(ErrorCount, WarningCount, HintCount));
+    QVERIFY(checkNodeDescription(m_store->findNode(1)->child(WarningCount - 1), added->description()));
+
+    m_store->setGrouping(NoGrouping);
+    m_store->clear();
+}
+
+void TestFilteredProblemStore::testUpdateDiagnostics()
+{
+    m_store->clear();
+    m_store->setGrouping(NoGrouping);
+
+    const IndexedString document(QStringLiteral("/path/diagnostics.cpp"));
+    auto createProblem = [&](const QString& diagnosticDescription) {
+        DocumentRange range;
+        range.document = document;
+
+        IProblem::Ptr diagnostic(new DetectedProblem());
+        diagnostic->setDescription(diagnosticDescription);
+        diagnostic->setFinalLocation(range);
+
+        IProblem::Ptr problem(new DetectedProblem());
+        problem->setDescription(QStringLiteral("PROBLEM"));
+        problem->setSeverity(IProblem::Error);
+        problem->setFinalLocation(range);
+        problem->addDiagnostic(diagnostic);
+        return problem;
+    };
+
+    m_store->setProblems({createProblem(QStringLiteral("DIAGNOSTIC"))});
+    QCOMPARE(m_store->count(), 1);
+
+    QSignalSpy insertSpy(m_store.data(), &FilteredProblemStore::beginInsertNodes);
+    QSignalSpy removeSpy(m_store.data(), &FilteredProblemStore::beginRemoveNodes);
+    QSignalSpy changedSpy(m_store.data(), &FilteredProblemStore::nodesChanged);
+
+    // a reparse with the same diagnostics keeps the nodes, which show the new instances
+    const IProblem::Ptr same = createProblem(QStringLiteral("DIAGNOSTIC"));
+    m_store->updateProblems(document, {same});
+    QCOMPARE(insertSpy.count(), 0);
+    QCOMPARE(removeSpy.count(), 0);
+    QCOMPARE(changedSpy.count(), 2);
+    const ProblemStoreNode *node = m_store->findNode(0);
+    QCOMPARE(node->problem(), same);
+    QCOMPARE(node->count(), 1);
+    QCOMPARE(node->child(0)->problem(), same->diagnostics().at(0));
+    // first the diagnostic below the problem node, then the problem node itself
+    QCOMPARE(changedSpy.at(0).at(0).value<ProblemStoreNode*>(), const_cast<ProblemStoreNode*>(node));
+    QCOMPARE(changedSpy.at(1).at(1).toInt(), 0);
+    QCOMPARE(changedSpy.at(1).at(2).toInt(), 0);
+
+    // a changed diagnostic replaces the node
+    changedSpy.clear();
+    const IProblem::Ptr changed = createProblem(QStringLiteral("OTHER DIAGNOSTIC"));
+    m_store->updateProblems(document, {changed});
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(changedSpy.count(), 0);
+    node = m_store->findNode(0);
+    QCOMPARE(node->problem(), changed);
+    QVERIFY(checkNodeDescription(node->child(0), QStringLiteral("OTHER DIAGNOSTIC")));
+
+    m_store->clear();
+}
+
 bool TestFilteredProblemStore::checkCounts(int error, int warning, int hint)
 {
     const ProblemStoreNode *errorNode = m_store->findNode(0);
@@ -24,6 +24,7 @@
 
 #include <QSignalSpy>
 #include <QTest>
+#include <QtConcurrentMap>
 
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
@@ -89,6 +90,21 @@ void TestPluginController::loadFromExtension()
     QVERIFY( plugin->extension<ITestNonGuiInterface>());
 }
 
+void TestPluginController::concurrentLookups()
+{
+    QVERIFY(m_pluginCtrl->loadPlugin(QStringLiteral("test_nonguiinterface")));
+
+    // parse jobs look up language plugins from their threads, which records the first use
+    QVector<int> lookups(100);
+    QtConcurrent::blockingMap(lookups, [this](int& found) {
+        found = m_pluginCtrl->plugin(QStringLiteral("test_nonguiinterface")) ? 1 : 0;
+        found += m_pluginCtrl->allPluginsForExtension(QStringLiteral("org.kdevelop.ITestNonGuiInterface")).size();
+    });
+    for (int found : qAsConst(lookups)) {
+        QCOMPARE(found, 2);
+    }
+}
+
 void TestPluginController::benchPluginForExtension()
 {
     QBENCHMARK {
@@ -39,6 +39,7 @@ private Q_SLOTS:
     void loadUnloadPlugin();
     void loadFromExtension();
     void pluginInfo();
+    void concurrentLookups();
     void benchPluginForExtension();
 
 private:
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QPointer>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KConfigGroup>
+#include <KJob>
+
+#include <interfaces/icore.h>
+#include <interfaces/itestcontroller.h>
+#include <interfaces/itestsuite.h>
+#include <language/duchain/indexeddeclaration.h>
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+#include <tests/testproject.h>
+#include <util/projecttestjob.h>
+
+using namespace KDevelop;
+
+namespace {
+class FakeTestJob : public KJob
+{
+public:
+    FakeTestJob(const QString& name, QStringList* started)
+        : m_name(name)
+        , m_started(started)
+    {}
+
+    void start() override { m_started->append(m_name); }
+
+    void finish(int errorCode)
+    {
+        setError(errorCode);
+        emitResult();
+    }
+
+private:
+    QString m_name;
+    QStringList* m_started;
+};
+
+/// A suite whose runs are finished by the test
+class FakeTestSuite : public ITestSuite
+{
+public:
+    FakeTestSuite(const QString& name, IProject* project, QStringList* started,
+                  bool runsSerially = false, const QStringList& resourceLocks = {})
+        : m_name(name)
+        , m_project(project)
+        , m_started(started)
+        , m_runsSerially(runsSerially)
+        , m_resourceLocks(resourceLocks)
+    {}
+
+    QString name() const override { return m_name; }
+    QStringList cases() const override { return {}; }
+    IProject* project() const override { return m_project; }
+    IndexedDeclaration declaration() const override { return {}; }
+    IndexedDeclaration caseDeclaration(const QString&) const override { return {}; }
+    bool runsSerially() const override { return m_runsSerially; }
+    QStringList resourceLocks() const override { return m_resourceLocks; }
+
+    KJob* launchAllCases(TestJobVerbosity) override
+    {
+        m_job = new FakeTestJob(m_name, m_started);
+        return m_job;
+    }
+    KJob* launchCases(const QStringList&, TestJobVerbosity verbosity) override { return launchAllCases(verbosity); }
+    KJob* launchCase(const QString&, TestJobVerbosity verbosity) override { return launchAllCases(verbosity); }
+
+    /// Reports @p suiteResult the way the test run jobs do, then finishes the job
+    void finish(TestResult::TestCaseResult suiteResult)
+    {
+        TestResult result;
+        result.suiteResult = suiteResult;
+        ICore::self()->testController()->notifyTestRunFinished(this, result);
+        m_job->finish(KJob::NoError);
+    }
+
+    /// Finishes the job without reporting a result, like a job which failed to run the test
+    void fail()
+    {
+        m_job->finish(KJob::UserDefinedError);
+    }
+
+private:
+    QString m_name;
+    IProject* m_project;
+    QStringList* m_started;
+    bool m_runsSerially;
+    QStringList m_resourceLocks;
+    QPointer<FakeTestJob> m_job;
+};
+}
+
+class TestProjectTestJob : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void cleanupTestCase();
+
+    void testLongestFirst();
+    void testRunSerial();
+    void testResourceLock();
+    void testJobFinishedWithoutResult();
+
+private:
+    FakeTestSuite* addSuite(const QString& name, bool runsSerially = false, const QStringList& resourceLocks = {});
+
+    TestProject* m_project = nullptr;
+    QList<FakeTestSuite*> m_suites;
+    QStringList m_started;
+};
+
+FakeTestSuite* TestProjectTestJob::addSuite(const QString& name, bool runsSerially, const QStringList& resourceLocks)
+{
+    auto* suite = new FakeTestSuite(name, m_project, &m_started, runsSerially, resourceLocks);
+    m_suites.append(suite);
+    ICore::self()->testController()->addTestSuite(suite);
+    return suite;
+}
+
+void TestProjectTestJob::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    qRegisterMetaType<KDevelop::ITestSuite*>("KDevelop::ITestSuite*");
+    qRegisterMetaType<KDevelop::TestResult>("KDevelop::TestResult");
+
+    m_project = new TestProject(Path(), this);
+}
+
+void TestProjectTestJob::init()
+{
+    m_project->projectConfiguration()->deleteGroup("Test Durations");
+    m_started.clear();
+}
+
+void TestProjectTestJob::cleanup()
+{
+    for (FakeTestSuite* suite : qAsConst(m_suites)) {
+        ICore::self()->testController()->removeTestSuite(suite);
+    }
+    qDeleteAll(m_suites);
+    m_suites.clear();
+}
+
+void TestProjectTestJob::cleanupTestCase()
+{
+    delete m_project;
+    TestCore::shutdown();
+}
+
+void TestProjectTestJob::testLongestFirst()
+{
+    KConfigGroup durations(m_project->projectConfiguration(), "Test Durations");
+    durations.writeEntry("short", 10);
+    durations.writeEntry("long", 30);
+
+    auto* shortSuite = addSuite(QStringLiteral("short"));
+    auto* longSuite = addSuite(QStringLiteral("long"));
+    auto* newSuite = addSuite(QStringLiteral("new"));
+
+    auto* job = new ProjectTestJob(m_project);
+    job->setMaxParallelSuites(1);
+    QSignalSpy resultSpy(job, &KJob::result);
+    job->start();
+
+    // suites which never ran are assumed to be long
+    QCOMPARE(m_started, QStringList{QStringLiteral("new")});
+    newSuite->finish(TestResult::Passed);
+    QCOMPARE(m_started, (QStringList{QStringLiteral("new"), QStringLiteral("long")}));
+    longSuite->finish(TestResult::Failed);
+    QCOMPARE(m_started, (QStringList{QStringLiteral("new"), QStringLiteral("long"), QStringLiteral("short")}));
+    shortSuite->finish(TestResult::Passed);
+
+    QCOMPARE(resultSpy.count(), 1);
+    QCOMPARE(job->testResult().total, 3);
+    QCOMPARE(job->testResult().passed, 2);
+    QCOMPARE(job->testResult().failed, 1);
+    // the durations of this run are stored
+    QVERIFY(durations.hasKey("new"));
+}
+
+void TestProjectTestJob::testRunSerial()
+{
+    auto* serialSuite = addSuite(QStringLiteral("serial"), true);
+    auto* firstSuite = addSuite(QStringLiteral("first"));
+    auto* secondSuite = addSuite(QStringLiteral("second"));
+
+    auto* job = new ProjectTestJob(m_project);
+    job->setMaxParallelSuites(4);
+    QSignalSpy resultSpy(job, &KJob::result);
+    job->start();
+
+    // the serial suite waits until all others are done
+    QCOMPARE(m_started, (QStringList{QStringLiteral("first"), QStringLiteral("second")}));
+    firstSuite->finish(TestResult::Passed);
+    QCOMPARE(m_started.size(), 2);
+    secondSuite->finish(TestResult::Passed);
+    QCOMPARE(m_started, (QStringList{QStringLiteral("first"), QStringLiteral("second"), QStringLiteral("serial")}));
+    serialSuite->finish(TestResult::Passed);
+
+    QCOMPARE(resultSpy.count(), 1);
+    QCOMPARE(job->testResult().passed, 3);
+}
+
+void TestProjectTestJob::testResourceLock()
+{
+    auto* firstSuite = addSuite(QStringLiteral("first"), false, {QStringLiteral("database")});
+    auto* secondSuite = addSuite(QStringLiteral("second"), false, {QStringLiteral("database")});
+    auto* otherSuite = addSuite(QStringLiteral("other"), false, {QStringLiteral("network")});
+
+    auto* job = new ProjectTestJob(m_project);
+    job->setMaxParallelSuites(4);
+    QSignalSpy resultSpy(job, &KJob::result);
+    job->start();
+
+    QCOMPARE(m_started, (QStringList{QStringLiteral("first"), QStringLiteral("other")}));
+    otherSuite->finish(TestResult::Passed);
+    QCOMPARE(m_started.size(), 2);
+    firstSuite->finish(TestResult::Passed);
+    QCOMPARE(m_started, (QStringList{QStringLiteral("first"), QStringLiteral("other"), QStringLiteral("second")}));
+    secondSuite->finish(TestResult::Passed);
+
+    QCOMPARE(resultSpy.count(), 1);
+    QCOMPARE(job->testResult().passed, 3);
+}
+
+void TestProjectTestJob::testJobFinishedWithoutResult()
+{
+    auto* serialSuite = addSuite(QStringLiteral("serial"), true, {QStringLiteral("database")});
+    auto* otherSuite = addSuite(QStringLiteral("other"), false, {QStringLiteral("database")});
+
+    auto* job = new ProjectTestJob(m_project);
+    job->setMaxParallelSuites(1);
+    QSignalSpy resultSpy(job, &KJob::result);
+    job->start();
+
+    QCOMPARE(m_started, QStringList{QStringLiteral("other")});
+    // the slot and the lock are released anyway
+    otherSuite->fail();
+    QCOMPARE(m_started, (QStringList{QStringLiteral("other"), QStringLiteral("serial")}));
+    serialSuite->fail();
+
+    QCOMPARE(resultSpy.count(), 1);
+    QCOMPARE(job->testResult().total, 2);
+    QCOMPARE(job->testResult().error, 2);
+}
+
+QTEST_GUILESS_MAIN(TestProjectTestJob)
+
+#include "test_projecttestjob.moc"
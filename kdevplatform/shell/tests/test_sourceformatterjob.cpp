@@ -0,0 +1,192 @@
+/*
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QMimeDatabase>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtConcurrentRun>
+
+#include <interfaces/isourceformatter.h>
+#include <shell/sourceformatterjob.h>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+using namespace KDevelop;
+
+namespace {
+/// Formats by converting the text to upper case
+class UpperCaseFormatter : public ISourceFormatter
+{
+public:
+    QString name() const override { return QStringLiteral("uppercase"); }
+    QString caption() const override { return name(); }
+    QString description() const override { return name(); }
+    QString formatSource(const QString& text, const QUrl&, const QMimeType&, const QString&, const QString&) const override
+    {
+        return text.toUpper();
+    }
+    QString formatSourceWithStyle(SourceFormatterStyle, const QString& text, const QUrl& url, const QMimeType& mime,
+                                  const QString& leftContext, const QString& rightContext) const override
+    {
+        return formatSource(text, url, mime, leftContext, rightContext);
+    }
+    bool canFormatConcurrently() const override { return true; }
+    QVector<SourceFormatterStyle> predefinedStyles() const override { return {}; }
+    SettingsWidget* editStyleWidget(const QMimeType&) const override { return nullptr; }
+    QString previewText(const SourceFormatterStyle&, const QMimeType&) const override { return {}; }
+    Indentation indentation(const QUrl&) const override { return {}; }
+};
+
+void writeFile(const QString& path, const QByteArray& contents)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(contents), qint64(contents.size()));
+}
+
+QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+#ifdef Q_OS_UNIX
+/// A file replaced by QSaveFile gets a new inode
+ino_t inode(const QString& path)
+{
+    struct stat buf;
+    return stat(QFile::encodeName(path).constData(), &buf) == 0 ? buf.st_ino : 0;
+}
+#endif
+}
+
+class TestSourceFormatterJob : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testFormatConcurrently();
+    void testFormatCancelled();
+    void testFormatMissingFile();
+    void testWriteChanged();
+    void testWriteUnchanged();
+};
+
+void TestSourceFormatterJob::testFormatConcurrently()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QList<QUrl> urls;
+    for (int i = 0; i < 50; ++i) {
+        const QString path = dir.filePath(QStringLiteral("file%1.cpp").arg(i));
+        writeFile(path, "int i" + QByteArray::number(i) + ";\n");
+        urls.append(QUrl::fromLocalFile(path));
+    }
+
+    const UpperCaseFormatter formatter;
+    const QMimeType mime = QMimeDatabase().mimeTypeForName(QStringLiteral("text/x-c++src"));
+    // the same way the job runs them in its thread pool
+    QVector<QFuture<SourceFormatterFileResult>> futures;
+    for (const QUrl& url : qAsConst(urls)) {
+        futures.append(QtConcurrent::run(&SourceFormatterJob::formatLocalFile, url, mime,
+                                         static_cast<const ISourceFormatter*>(&formatter), SourceFormatterStyle(),
+                                         static_cast<const QAtomicInt*>(nullptr)));
+    }
+
+    for (int i = 0; i < futures.size(); ++i) {
+        const SourceFormatterFileResult result = futures[i].result();
+        QCOMPARE(result.url, urls.at(i));
+        QVERIFY(result.errorString.isEmpty());
+        QCOMPARE(result.originalText, QStringLiteral("int i%1;\n").arg(i));
+        QCOMPARE(result.formattedText, QStringLiteral("INT I%1;\n").arg(i));
+    }
+}
+
+void TestSourceFormatterJob::testFormatCancelled()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("file.cpp"));
+    writeFile(path, "int i;\n");
+
+    const UpperCaseFormatter formatter;
+    const QAtomicInt cancelled(1);
+    const auto result = SourceFormatterJob::formatLocalFile(QUrl::fromLocalFile(path), QMimeType(), &formatter,
+                                                            SourceFormatterStyle(), &cancelled);
+    QVERIFY(result.errorString.isEmpty());
+    QVERIFY(result.formattedText.isEmpty());
+}
+
+void TestSourceFormatterJob::testFormatMissingFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const UpperCaseFormatter formatter;
+    const auto result = SourceFormatterJob::formatLocalFile(QUrl::fromLocalFile(dir.filePath(QStringLiteral("missing.cpp"))),
+                                                            QMimeType(), &formatter, SourceFormatterStyle(), nullptr);
+    QVERIFY(!result.errorString.isEmpty());
+}
+
+void TestSourceFormatterJob::testWriteChanged()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("file.cpp"));
+    writeFile(path, "int i;\n");
+
+    QString errorString;
+    QVERIFY(SourceFormatterJob::writeLocalFileIfChanged(path, QStringLiteral("int i;\n"), QStringLiteral("INT I;\n"),
+                                                        &errorString));
+    QVERIFY(errorString.isEmpty());
+    QCOMPARE(readFile(path), QByteArray("INT I;\n"));
+
+    // no temporary files are left behind
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files), QStringList{QStringLiteral("file.cpp")});
+}
+
+void TestSourceFormatterJob::testWriteUnchanged()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("file.cpp"));
+    writeFile(path, "int i;\n");
+#ifdef Q_OS_UNIX
+    const auto inodeBefore = inode(path);
+    QVERIFY(inodeBefore);
+#endif
+
+    QString errorString;
+    QVERIFY(SourceFormatterJob::writeLocalFileIfChanged(path, QStringLiteral("int i;\n"), QStringLiteral("int i;\n"),
+                                                        &errorString));
+    QCOMPARE(readFile(path), QByteArray("int i;\n"));
+#ifdef Q_OS_UNIX
+    QCOMPARE(inode(path), inodeBefore);
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestSourceFormatterJob)
+
+#include "test_sourceformatterjob.moc"
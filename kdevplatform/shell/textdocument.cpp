@@ -26,6 +26,7 @@
 #include <QWidget>
 
 #include <KActionCollection>
+#include <KConfig>
 #include <KConfigGroup>
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -271,6 +272,8 @@ public:
     TextView* const q;
     QPointer<KTextEditor::View> view;
     KTextEditor::Range initialRange;
+    // session config read before the view was created
+    QMap<QString, QString> pendingSessionConfig;
 };
 
 TextDocument::TextDocument(const QUrl &url, ICore* core, const QString& encoding)
@@ -631,6 +634,20 @@ QWidget * KDevelop::TextView::createWidget(QWidget * parent)
     QWidget* widget = textDocument->createViewWidget(parent);
     d->view = qobject_cast<KTextEditor::View*>(widget);
     Q_ASSERT(d->view);
+
+    if (!d->pendingSessionConfig.isEmpty()) {
+        KConfig config(QString(), KConfig::SimpleConfig);
+        KConfigGroup group(&config, "View");
+        for (auto it = d->pendingSessionConfig.constBegin(); it != d->pendingSessionConfig.constEnd(); ++it) {
+            group.writeEntry(it.key(), it.value());
+        }
+        d->view->readSessionConfig(group);
+        d->pendingSessionConfig.clear();
+    }
+    if (d->initialRange.isValid()) {
+        selectAndReveal(d->view, d->initialRange);
+    }
+
     connect(d->view.data(), &KTextEditor::View::cursorPositionChanged, this, &KDevelop::TextView::sendStatusChanged);
     return widget;
 }
@@ -658,6 +675,8 @@ void KDevelop::TextView::readSessionConfig(KConfigGroup& config)
     Q_D(TextView);
 
     if (!d->view) {
+        // applied once the view is created, a restored view might not be looked at for a long time
+        d->pendingSessionConfig = config.entryMap();
         return;
     }
     d->view->readSessionConfig(config);
@@ -668,6 +687,9 @@ void KDevelop::TextView::writeSessionConfig(KConfigGroup& config)
     Q_D(TextView);
 
     if (!d->view) {
+        for (auto it = d->pendingSessionConfig.constBegin(); it != d->pendingSessionConfig.constEnd(); ++it) {
+            config.writeEntry(it.key(), it.value());
+        }
         return;
     }
     d->view->writeSessionConfig(config);
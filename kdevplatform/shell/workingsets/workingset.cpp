@@ -358,6 +358,8 @@ void WorkingSet::loadToArea(Sublime::Area* area, Sublime::AreaIndex* areaIndex,
             auto *document = dynamic_cast<Sublime::Document*>(doc);
             if (document) {
                 Sublime::View* view = document->createView();
+                // only load the document into the editor once its tab is looked at
+                view->setLazyWidget(true);
                 area->addView(view, areaIndex, previousView);
                 createdViews[i] = view;
             } else {
@@ -458,6 +458,7 @@ void Container::addWidget(View *view, int position)
     d->tabBar->setMinimumHeight(d->tabBar->sizeHint().height());
 
     connect(view, &View::statusChanged, this, &Container::statusChanged);
+    connect(view, &View::widgetReplaced, this, &Container::viewWidgetReplaced);
     connect(view->document(), &Document::statusIconChanged, this, &Container::statusIconChanged);
     connect(view->document(), &Document::titleChanged, this, &Container::documentTitleChanged);
 }
@@ -540,6 +541,12 @@ void Container::setCurrentWidget(QWidget* w)
     if (d->stack->currentWidget() == w) {
         return;
     }
+    if (View* view = viewForWidget(w)) {
+        if (view->hasPlaceholderWidget()) {
+            // viewWidgetReplaced() puts the real widget into the stack
+            w = view->ensureWidget();
+        }
+    }
     d->stack->setCurrentWidget(w);
     d->tabBar->setCurrentIndex(d->stack->indexOf(w));
     if (View* view = viewForWidget(w))
@@ -592,6 +599,7 @@ void Container::removeWidget(QWidget *w)
             disconnect(view->document(), &Document::titleChanged, this, &Container::documentTitleChanged);
             disconnect(view->document(), &Document::statusIconChanged, this, &Container::statusIconChanged);
             disconnect(view, &View::statusChanged, this, &Container::statusChanged);
+            disconnect(view, &View::widgetReplaced, this, &Container::viewWidgetReplaced);
 
             // Update document list context menu
             Q_ASSERT(d->documentListActionForView.contains(view));
@@ -600,6 +608,24 @@ void Container::removeWidget(QWidget *w)
     }
 }
 
+void Container::viewWidgetReplaced(Sublime::View* view, QWidget* placeholder, QWidget* widget)
+{
+    Q_D(Container);
+
+    const int idx = d->stack->indexOf(placeholder);
+    if (idx == -1)
+        return;
+
+    const bool wasCurrent = d->stack->currentWidget() == placeholder;
+    d->stack->insertWidget(idx, widget);
+    if (wasCurrent)
+        d->stack->setCurrentWidget(widget);
+    d->stack->removeWidget(placeholder);
+
+    d->viewForWidget.remove(placeholder);
+    d->viewForWidget[widget] = view;
+}
+
 bool Container::hasWidget(QWidget* w) const
 {
     Q_D(const Container);
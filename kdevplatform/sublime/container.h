@@ -107,6 +107,7 @@ private Q_SLOTS:
     void contextMenu(const QPoint&);
     void doubleClickTriggered(int tab);
     void documentListActionTriggered(QAction*);
+    void viewWidgetReplaced(Sublime::View* view, QWidget* placeholder, QWidget* widget);
 
 private:
     Sublime::View* currentView() const;
@@ -230,6 +230,10 @@ void MainWindow::setActiveView(View *view, bool focus)
 
     View* oldActiveView = d->activeView;
 
+    // the active view is shown and merged into the GUI, so it needs its real widget
+    if (view)
+        view->ensureWidget();
+
     d->activeView = view;
 
     if (focus && view && !view->widget()->hasFocus())
@@ -420,6 +420,8 @@ Area::WalkerMode MainWindowPrivate::ViewCreator::operator() (AreaIndex *index)
                     container->addWidget(view, position);
                     d->viewContainers[view] = container;
                     d->widgetToView[widget] = view;
+                    connect(view, &View::widgetReplaced, d, &MainWindowPrivate::viewWidgetReplaced,
+                            Qt::UniqueConnection);
                 }
                 if(activeView == view)
                 {
@@ -848,6 +850,12 @@ void MainWindowPrivate::messageDestroyed(Message* message)
     m_messageHash.remove(message);
 }
 
+void MainWindowPrivate::viewWidgetReplaced(Sublime::View* view, QWidget* placeholder, QWidget* widget)
+{
+    if (widgetToView.remove(placeholder))
+        widgetToView[widget] = view;
+}
+
 }
 
 #include "mainwindow_p.moc"
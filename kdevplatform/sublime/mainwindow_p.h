@@ -139,6 +139,7 @@ private Q_SLOTS:
     void selectPreviousDock();
 
     void messageDestroyed(Message* message);
+    void viewWidgetReplaced(Sublime::View* view, QWidget* placeholder, QWidget* widget);
 
 private:
     void restoreConcentrationMode();
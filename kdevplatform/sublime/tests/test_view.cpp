@@ -18,6 +18,7 @@
  ***************************************************************************/
 #include "test_view.h"
 
+#include <QSignalSpy>
 #include <QTextEdit>
 #include <QTest>
 
@@ -68,6 +69,36 @@ void TestView::viewReimplementation()
     QVERIFY(dynamic_cast<Test*>(view) != nullptr);
 }
 
+void TestView::lazyWidget()
+{
+    Controller controller;
+    Document *doc = new ToolDocument(QStringLiteral("tool"), &controller, new SimpleToolWidgetFactory<QTextEdit>(QStringLiteral("tool")));
+
+    View *view = doc->createView();
+    view->setLazyWidget(true);
+    QSignalSpy spy(view, &View::widgetReplaced);
+
+    //only a placeholder is created
+    QWidget* placeholder = view->widget();
+    QVERIFY(view->hasWidget());
+    QVERIFY(view->hasPlaceholderWidget());
+    QVERIFY(!qobject_cast<QTextEdit*>(placeholder));
+    QCOMPARE(view->widget(), placeholder);
+
+    //the real widget replaces it
+    QWidget* widget = view->ensureWidget();
+    QVERIFY(!view->hasPlaceholderWidget());
+    QCOMPARE(widget->metaObject()->className(), "QTextEdit");
+    QCOMPARE(view->widget(), widget);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(2).value<QWidget*>(), widget);
+
+    //deleting the placeholder did not reset the widget
+    QVERIFY(view->hasWidget());
+    QCOMPARE(view->ensureWidget(), widget);
+    QCOMPARE(spy.count(), 1);
+}
+
 QTEST_MAIN(TestView)
 
 #include "test_view.moc"
@@ -26,6 +26,7 @@ class TestView: public QObject {
 private Q_SLOTS:
     void widgetDeletion();
     void viewReimplementation();
+    void lazyWidget();
 };
 
 #endif
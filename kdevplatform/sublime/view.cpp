@@ -18,6 +18,8 @@
  ***************************************************************************/
 #include "view.h"
 
+#include <QPointer>
+#include <QTimer>
 #include <QWidget>
 
 #include "document.h"
@@ -38,8 +40,42 @@ public:
     QWidget* widget = nullptr;
     Document* const doc;
     const View::WidgetOwnership ws;
+    bool lazyWidget = false;
+    bool widgetIsPlaceholder = false;
 };
 
+namespace {
+/// Stands in for the widget of a lazy view until it is needed.
+class ViewPlaceholder : public QWidget
+{
+public:
+    ViewPlaceholder(View* view, QWidget* parent)
+        : QWidget(parent)
+        , m_view(view)
+    {
+    }
+
+protected:
+    void showEvent(QShowEvent* event) override
+    {
+        QWidget::showEvent(event);
+
+        // Only create the real widget if we are still visible once the event loop runs again,
+        // while restoring views the tab that is current at first usually is not for long
+        View* view = m_view;
+        QPointer<QWidget> placeholder(this);
+        QTimer::singleShot(0, view, [view, placeholder]() {
+            if (placeholder && placeholder->isVisible() && view->hasPlaceholderWidget()) {
+                view->ensureWidget();
+            }
+        });
+    }
+
+private:
+    View* const m_view;
+};
+}
+
 ViewPrivate::ViewPrivate(Document* doc, View::WidgetOwnership ws)
     : doc(doc)
     , ws(ws)
@@ -61,7 +97,7 @@ View::~View()
 {
     Q_D(View);
 
-    if (d->widget && d->ws == View::TakeOwnership ) {
+    if (d->widget && (d->ws == View::TakeOwnership || d->widgetIsPlaceholder)) {
         d->widget->hide();
         d->widget->setParent(nullptr);
         delete d->widget;
@@ -81,18 +117,60 @@ QWidget *View::widget(QWidget *parent)
 
     if (!d->widget)
     {
-        d->widget = createWidget(parent);
+        if (d->lazyWidget) {
+            d->widget = new ViewPlaceholder(this, parent);
+            d->widgetIsPlaceholder = true;
+        } else {
+            d->widget = createWidget(parent);
+        }
         // if we own this widget, we will also delete it and ideally would disconnect
         // the following connect before doing that. For that though we would need to store
         // a reference to the connection.
         // As the d object still exists in the destructor when we delete the widget
         // this lambda method though can be still safely executed, so we spare ourselves such disconnect.
+        // The widget is compared, as a replaced placeholder is only destroyed after the real widget is set.
         connect(d->widget, &QWidget::destroyed,
-                this, [this] { Q_D(View); d->unsetWidget(); });
+                this, [this](QObject* widget) {
+                    Q_D(View);
+                    if (d->widget == widget)
+                        d->unsetWidget();
+                });
     }
     return d->widget;
 }
 
+void View::setLazyWidget(bool lazy)
+{
+    Q_D(View);
+
+    d->lazyWidget = lazy;
+}
+
+bool View::hasPlaceholderWidget() const
+{
+    Q_D(const View);
+
+    return d->widgetIsPlaceholder;
+}
+
+QWidget* View::ensureWidget()
+{
+    Q_D(View);
+
+    if (!d->widgetIsPlaceholder)
+        return widget();
+
+    QWidget* placeholder = d->widget;
+    d->widget = nullptr;
+    d->widgetIsPlaceholder = false;
+    d->lazyWidget = false;
+
+    QWidget* realWidget = widget(placeholder->parentWidget());
+    emit widgetReplaced(this, placeholder, realWidget);
+    delete placeholder;
+    return realWidget;
+}
+
 QWidget *View::createWidget(QWidget *parent)
 {
     Q_D(View);
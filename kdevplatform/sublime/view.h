@@ -68,6 +68,23 @@ public:
     /**@return true if this view has an initialized widget.*/
     bool hasWidget() const;
 
+    /**
+     * Let widget() return a lightweight placeholder instead of creating the real widget.
+     * The real widget is created by ensureWidget(), which the main window calls once
+     * the view is activated or its placeholder gets visible.
+     * Used for restored views, as most of them are not looked at right away.
+     * Has no effect once the widget is created.
+     */
+    void setLazyWidget(bool lazy);
+    /**@return true if widget() returns a placeholder for the real widget.*/
+    bool hasPlaceholderWidget() const;
+    /**
+     * Creates the real widget if widget() returns a placeholder. The placeholder is
+     * deleted right after widgetReplaced() has been emitted.
+     * @return the real widget for this view
+     */
+    QWidget* ensureWidget();
+
     /// Retrieve information to be placed in the status bar.
     virtual QString viewStatus() const;
 
@@ -95,6 +112,8 @@ Q_SIGNALS:
     /// Notify that the status for this document has changed
     void statusChanged(Sublime::View*);
     void positionChanged(Sublime::View*, int);
+    /// Notify that the real widget replaced the @p placeholder returned by widget() so far
+    void widgetReplaced(Sublime::View* view, QWidget* placeholder, QWidget* widget);
 
 public Q_SLOTS:
     void requestRaise();
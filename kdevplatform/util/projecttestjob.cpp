@@ -24,66 +24,190 @@
 #include <interfaces/itestcontroller.h>
 #include <interfaces/iproject.h>
 #include <interfaces/itestsuite.h>
+#include <KConfigGroup>
 #include <KLocalizedString>
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+#include <limits>
+
 using namespace KDevelop;
 
+namespace {
+const char testRunnerGroup[] = "Test Runner";
+const char maxParallelSuitesEntry[] = "Max Parallel Suites";
+const char durationsGroup[] = "Test Durations";
+}
+
 class KDevelop::ProjectTestJobPrivate
 {
 public:
     explicit ProjectTestJobPrivate(ProjectTestJob* q)
         : q(q)
-        , m_currentJob(nullptr)
-        , m_currentSuite(nullptr)
     {}
 
+    void sortSuites();
+    bool canStart(ITestSuite* suite) const;
     void runNext();
     void gotResult(ITestSuite* suite, const TestResult& result);
+    void jobFinished(ITestSuite* suite, KJob* job);
+
+    struct RunningSuite
+    {
+        KJob* job;
+        QElapsedTimer timer;
+    };
 
     ProjectTestJob* q;
 
+    IProject* m_project = nullptr;
+    int m_maxParallelSuites = 1;
+    bool m_serialRunning = false;
+    bool m_finished = false;
+
+    /// The suites which did not run yet, in the order they are started.
     QList<ITestSuite*> m_suites;
-    KJob* m_currentJob;
-    ITestSuite* m_currentSuite;
+    QHash<ITestSuite*, RunningSuite> m_running;
+    /// The resource locks of the running suites.
+    QSet<QString> m_lockedResources;
+    int m_suiteCount = 0;
     ProjectTestResult m_result;
 };
 
-void ProjectTestJobPrivate::runNext()
+void ProjectTestJobPrivate::sortSuites()
 {
-    m_currentSuite = m_suites.takeFirst();
-    m_currentJob = m_currentSuite->launchAllCases(ITestSuite::Silent);
-    m_currentJob->start();
+    // Starting the longest suites first keeps the slots busy until the end,
+    // suites which never ran are assumed to be long.
+    const KConfigGroup durations(m_project->projectConfiguration(), durationsGroup);
+    QHash<ITestSuite*, qint64> suiteDurations;
+    suiteDurations.reserve(m_suites.size());
+    for (ITestSuite* suite : qAsConst(m_suites)) {
+        suiteDurations.insert(suite, durations.readEntry(suite->name(), std::numeric_limits<qint64>::max()));
+    }
+
+    // Serial suites run alone after all others, so they don't block the parallel ones
+    std::stable_sort(m_suites.begin(), m_suites.end(), [&suiteDurations](ITestSuite* a, ITestSuite* b) {
+        if (a->runsSerially() != b->runsSerially()) {
+            return b->runsSerially();
+        }
+        return suiteDurations.value(a) > suiteDurations.value(b);
+    });
 }
 
-void ProjectTestJobPrivate::gotResult(ITestSuite* suite, const TestResult& result)
+bool ProjectTestJobPrivate::canStart(ITestSuite* suite) const
 {
-    if (suite == m_currentSuite) {
-        m_result.total++;
-        q->emitPercent(m_result.total, m_result.total + m_suites.size());
+    if (m_serialRunning) {
+        return false;
+    }
+    if (suite->runsSerially()) {
+        return m_running.isEmpty();
+    }
 
-        switch (result.suiteResult) {
-        case TestResult::Passed:
-            m_result.passed++;
-            break;
+    const auto locks = suite->resourceLocks();
+    return std::none_of(locks.begin(), locks.end(), [this](const QString& lock) {
+        return m_lockedResources.contains(lock);
+    });
+}
 
-        case TestResult::Failed:
-            m_result.failed++;
+void ProjectTestJobPrivate::runNext()
+{
+    // Suites may report their result while being started, so look for the next one from scratch each time
+    while (!m_finished && m_running.size() < m_maxParallelSuites) {
+        const auto it = std::find_if(m_suites.begin(), m_suites.end(), [this](ITestSuite* suite) {
+            return canStart(suite);
+        });
+        if (it == m_suites.end()) {
             break;
+        }
+        ITestSuite* suite = *it;
+        m_suites.erase(it);
 
-        case TestResult::Error:
+        KJob* job = suite->launchAllCases(ITestSuite::Silent);
+        if (!job) {
+            m_result.total++;
             m_result.error++;
-            break;
-
-        default:
-            break;
+            continue;
         }
 
-        if (m_suites.isEmpty()) {
-            q->emitResult();
-        } else {
-            runNext();
+        RunningSuite& running = m_running[suite];
+        running.job = job;
+        running.timer.start();
+        const auto locks = suite->resourceLocks();
+        for (const QString& lock : locks) {
+            m_lockedResources.insert(lock);
         }
+        m_serialRunning = suite->runsSerially();
+
+        // a job which fails or gets killed might not report a result, don't keep its slot and locks then
+        QObject::connect(job, &KJob::finished, q, [this, suite](KJob* job) {
+            jobFinished(suite, job);
+        });
+        job->start();
+    }
+
+    if (!m_finished && m_running.isEmpty() && m_suites.isEmpty()) {
+        m_finished = true;
+        m_project->projectConfiguration()->sync();
+        q->emitResult();
+    }
+}
+
+void ProjectTestJobPrivate::gotResult(ITestSuite* suite, const TestResult& result)
+{
+    const auto it = m_running.find(suite);
+    if (m_finished || it == m_running.end()) {
+        return;
+    }
+
+    if (result.suiteResult != TestResult::Error) {
+        KConfigGroup durations(m_project->projectConfiguration(), durationsGroup);
+        durations.writeEntry(suite->name(), it->timer.elapsed());
+    }
+
+    const auto locks = suite->resourceLocks();
+    for (const QString& lock : locks) {
+        m_lockedResources.remove(lock);
+    }
+    m_running.erase(it);
+    m_serialRunning = false;
+
+    m_result.total++;
+    q->emitPercent(m_result.total, m_suiteCount);
+
+    switch (result.suiteResult) {
+    case TestResult::Passed:
+        m_result.passed++;
+        break;
+
+    case TestResult::Failed:
+        m_result.failed++;
+        break;
+
+    case TestResult::Error:
+        m_result.error++;
+        break;
+
+    default:
+        break;
+    }
+
+    runNext();
+}
+
+void ProjectTestJobPrivate::jobFinished(ITestSuite* suite, KJob* job)
+{
+    const auto it = m_running.constFind(suite);
+    if (m_finished || it == m_running.constEnd() || it->job != job) {
+        return;
     }
+
+    TestResult result;
+    result.suiteResult = TestResult::Error;
+    gotResult(suite, result);
 }
 
 ProjectTestJob::ProjectTestJob(IProject* project, QObject* parent)
@@ -95,7 +219,13 @@ ProjectTestJob::ProjectTestJob(IProject* project, QObject* parent)
     setCapabilities(Killable);
     setObjectName(i18n("Run all tests in %1", project->name()));
 
+    d->m_project = project;
     d->m_suites = ICore::self()->testController()->testSuitesForProject(project);
+    d->m_suiteCount = d->m_suites.size();
+
+    const KConfigGroup group(project->projectConfiguration(), testRunnerGroup);
+    setMaxParallelSuites(group.readEntry(maxParallelSuitesEntry, QThread::idealThreadCount()));
+
     connect(ICore::self()->testController(), &ITestController::testRunFinished,
             this, [this](ITestSuite* suite, const TestResult& result) {
         Q_D(ProjectTestJob);
@@ -108,19 +238,34 @@ ProjectTestJob::~ProjectTestJob()
 
 }
 
+void ProjectTestJob::setMaxParallelSuites(int count)
+{
+    Q_D(ProjectTestJob);
+    d->m_maxParallelSuites = qMax(1, count);
+}
+
+int ProjectTestJob::maxParallelSuites() const
+{
+    Q_D(const ProjectTestJob);
+    return d->m_maxParallelSuites;
+}
+
 void ProjectTestJob::start()
 {
     Q_D(ProjectTestJob);
+    d->sortSuites();
     d->runNext();
 }
 
 bool ProjectTestJob::doKill()
 {
     Q_D(ProjectTestJob);
-    if (d->m_currentJob) {
-        d->m_currentJob->kill();
-    } else {
-        d->m_suites.clear();
+    d->m_finished = true;
+    d->m_suites.clear();
+    const auto running = d->m_running;
+    d->m_running.clear();
+    for (const auto& suite : running) {
+        suite.job->kill();
     }
     return true;
 }
@@ -65,6 +65,13 @@ struct KDEVPLATFORMUTIL_EXPORT ProjectTestResult
  * Launches all test suites in the specified project without raising the output window.
  * Instead of providing individual test results, it combines and simplifies them.
  *
+ * Up to maxParallelSuites() suites run at the same time. The suites which took longest
+ * in previous runs are started first, the durations are stored in the project configuration.
+ * Suites which ITestSuite::runsSerially() run alone after all others, and suites sharing
+ * one of their ITestSuite::resourceLocks() never run at the same time.
+ * A suite whose job finishes without reporting a result through ITestController::testRunFinished
+ * counts as an error.
+ *
  **/
 class KDEVPLATFORMUTIL_EXPORT ProjectTestJob : public KJob
 {
@@ -91,6 +98,15 @@ public:
      **/
     void start() override;
 
+    /**
+     * Set how many test suites may run at the same time.
+     *
+     * Defaults to the "Max Parallel Suites" entry of the "Test Runner" group in the
+     * project configuration, or the number of processor cores if it isn't set.
+     **/
+    void setMaxParallelSuites(int count);
+    int maxParallelSuites() const;
+
     /**
      * @brief The result of this job
      *
@@ -23,11 +23,23 @@
 #include <QTest>
 
 #include <vcs/models/vcsfilechangesmodel.h>
+#include <vcs/models/vcseventmodel.h>
+#include <vcs/vcsevent.h>
+#include <vcs/vcsrevision.h>
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
 
 using namespace KDevelop;
 
+namespace {
+class TestEventModel : public VcsBasicEventModel
+{
+public:
+    TestEventModel() : VcsBasicEventModel(nullptr) {}
+    using VcsBasicEventModel::addEvents;
+};
+}
+
 void TestModels::initTestCase()
 {
     AutoTestShell::init({QStringLiteral("dummy")});
@@ -139,4 +151,43 @@ void TestModels::testVcsFileChangesModel()
     QCOMPARE(model->rowCount(), 2);
 }
 
+void TestModels::testVcsBasicEventModel()
+{
+    TestEventModel model;
+    QCOMPARE(model.rowCount(), 0);
+
+    QList<VcsEvent> events;
+    for (int i = 0; i < 3; ++i) {
+        VcsEvent event;
+        VcsRevision revision;
+        revision.setRevisionValue(QStringLiteral("rev%1").arg(i), VcsRevision::GlobalNumber);
+        event.setRevision(revision);
+        event.setAuthor(QStringLiteral("author%1").arg(i % 2));
+        event.setDate(QDateTime::fromSecsSinceEpoch(1000 * i));
+        event.setMessage(QStringLiteral("summary %1\n\ndetails").arg(i));
+        VcsItemEvent item;
+        item.setRepositoryLocation(QStringLiteral("file%1").arg(i));
+        item.setActions(VcsItemEvent::Modified);
+        event.addItem(item);
+        events << event;
+    }
+    model.addEvents(events.mid(0, 2));
+    model.addEvents(events.mid(2));
+    QCOMPARE(model.rowCount(), 3);
+
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(model.data(model.index(i, VcsBasicEventModel::RevisionColumn)).toString(), QStringLiteral("rev%1").arg(i));
+        QCOMPARE(model.data(model.index(i, VcsBasicEventModel::SummaryColumn)).toString(), QStringLiteral("summary %1").arg(i));
+        QCOMPARE(model.data(model.index(i, VcsBasicEventModel::AuthorColumn)).toString(), QStringLiteral("author%1").arg(i % 2));
+
+        const VcsEvent event = model.eventForIndex(model.index(i, 0));
+        QCOMPARE(event.revision(), events.at(i).revision());
+        QCOMPARE(event.author(), events.at(i).author());
+        QCOMPARE(event.date(), events.at(i).date());
+        QCOMPARE(event.message(), events.at(i).message());
+        QCOMPARE(event.items().size(), 1);
+        QCOMPARE(event.items().first().repositoryLocation(), QStringLiteral("file%1").arg(i));
+    }
+}
+
 QTEST_MAIN(TestModels)
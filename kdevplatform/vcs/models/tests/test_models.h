@@ -32,6 +32,7 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void testVcsFileChangesModel();
+    void testVcsBasicEventModel();
 };
 
 #endif // KDEVPLATFORM_TEST_MODELS_H
@@ -23,8 +23,10 @@
 #include <QModelIndex>
 #include <QVariant>
 #include <QDateTime>
+#include <QHash>
 #include <QList>
 #include <QLocale>
+#include <QVector>
 
 #include <KLocalizedString>
 
@@ -38,10 +40,51 @@
 namespace KDevelop
 {
 
+/**
+ * Logs of large repositories contain hundreds of thousands of events, hence they are
+ * stored column-wise instead of as a list of VcsEvent objects, and the author names
+ * are shared between all events of the same author.
+ */
 class VcsBasicEventModelPrivate
 {
 public:
-    QList<KDevelop::VcsEvent> m_events;
+    QVector<VcsRevision> m_revisions;
+    QVector<QString> m_authors;
+    QVector<QDateTime> m_dates;
+    QVector<QString> m_messages;
+    QVector<QList<VcsItemEvent>> m_items;
+    QHash<QString, QString> m_authorNames;
+
+    int count() const
+    {
+        return m_revisions.size();
+    }
+
+    void append(const VcsEvent& event)
+    {
+        const QString author = event.author();
+        auto authorIt = m_authorNames.constFind(author);
+        if (authorIt == m_authorNames.constEnd()) {
+            authorIt = m_authorNames.insert(author, author);
+        }
+
+        m_revisions.append(event.revision());
+        m_authors.append(*authorIt);
+        m_dates.append(event.date());
+        m_messages.append(event.message());
+        m_items.append(event.items());
+    }
+
+    VcsEvent event(int row) const
+    {
+        VcsEvent event;
+        event.setRevision(m_revisions.at(row));
+        event.setAuthor(m_authors.at(row));
+        event.setDate(m_dates.at(row));
+        event.setMessage(m_messages.at(row));
+        event.setItems(m_items.at(row));
+        return event;
+    }
 };
 
 VcsBasicEventModel::VcsBasicEventModel(QObject* parent)
@@ -56,7 +99,7 @@ int VcsBasicEventModel::rowCount(const QModelIndex& parent) const
 {
     Q_D(const VcsBasicEventModel);
 
-    return parent.isValid() ? 0 : d->m_events.count();
+    return parent.isValid() ? 0 : d->count();
 }
 
 int VcsBasicEventModel::columnCount(const QModelIndex& parent) const
@@ -74,18 +117,18 @@ QVariant VcsBasicEventModel::data(const QModelIndex& idx, int role) const
     if( idx.row() < 0 || idx.row() >= rowCount() || idx.column() < 0 || idx.column() >= columnCount() )
         return QVariant();
 
-    KDevelop::VcsEvent ev = d->m_events.at( idx.row() );
+    const int row = idx.row();
     switch( idx.column() )
     {
         case RevisionColumn:
-            return QVariant( ev.revision().revisionValue() );
+            return QVariant( d->m_revisions.at(row).revisionValue() );
         case SummaryColumn:
             // show the first line only
-            return QVariant( ev.message().section(QLatin1Char('\n'), 0, 0) );
+            return QVariant( d->m_messages.at(row).section(QLatin1Char('\n'), 0, 0) );
         case AuthorColumn:
-            return QVariant( ev.author() );
+            return QVariant( d->m_authors.at(row) );
         case DateColumn:
-            return QVariant( QLocale().toString( ev.date() ) );
+            return QVariant( QLocale().toString( d->m_dates.at(row) ) );
         default:
             break;
     }
@@ -120,7 +163,15 @@ void VcsBasicEventModel::addEvents(const QList<KDevelop::VcsEvent>& list)
         return;
 
     beginInsertRows( QModelIndex(), rowCount(), rowCount()+list.count()-1 );
-    d->m_events += list;
+    const int newCount = d->count() + list.count();
+    d->m_revisions.reserve(newCount);
+    d->m_authors.reserve(newCount);
+    d->m_dates.reserve(newCount);
+    d->m_messages.reserve(newCount);
+    d->m_items.reserve(newCount);
+    for (const VcsEvent& event : list) {
+        d->append(event);
+    }
     endInsertRows();
 }
 
@@ -132,9 +183,12 @@ KDevelop::VcsEvent VcsBasicEventModel::eventForIndex(const QModelIndex& idx) con
     {
         return KDevelop::VcsEvent();
     }
-    return d->m_events.at( idx.row() );
+    return d->event( idx.row() );
 }
 
+/// number of events requested at once, the log is continued from the last event of the previous page
+static const int logPageSize = 100;
+
 class VcsEventLogModelPrivate
 {
 public:
@@ -143,6 +197,12 @@ public:
     QUrl m_url;
     bool done;
     bool fetching;
+    /// the view asked for more events which are not available yet
+    bool insertOnArrival = false;
+    /// whether any event was received yet, following pages start with the last event of the previous one
+    bool hasEvents = false;
+    /// the next page, fetched in the background before the view asks for it
+    QList<KDevelop::VcsEvent> prefetched;
 };
 
 VcsEventLogModel::VcsEventLogModel(KDevelop::IBasicVersionControl* iface, const VcsRevision& rev, const QUrl& url, QObject* parent)
@@ -164,17 +224,44 @@ bool VcsEventLogModel::canFetchMore(const QModelIndex& parent) const
 {
     Q_D(const VcsEventLogModel);
 
-    return !d->done && !d->fetching && !parent.isValid();
+    if (parent.isValid() || d->insertOnArrival) {
+        return false;
+    }
+    return !d->prefetched.isEmpty() || (!d->done && !d->fetching);
 }
 
 void VcsEventLogModel::fetchMore(const QModelIndex& parent)
 {
     Q_D(VcsEventLogModel);
 
-    d->fetching = true;
     Q_ASSERT(!parent.isValid());
     Q_UNUSED(parent);
-    VcsJob* job = d->m_iface->log(d->m_url, d->m_rev, qMax(rowCount(), 100));
+
+    if (!d->prefetched.isEmpty()) {
+        addEvents(d->prefetched);
+        d->prefetched.clear();
+        // stay one page ahead of the view
+        startFetching();
+        return;
+    }
+
+    d->insertOnArrival = true;
+    if (!d->fetching) {
+        startFetching();
+    }
+}
+
+void VcsEventLogModel::startFetching()
+{
+    Q_D(VcsEventLogModel);
+
+    if (d->done || d->fetching) {
+        return;
+    }
+
+    d->fetching = true;
+    // the first event of every following page is the last one we already know about
+    VcsJob* job = d->m_iface->log(d->m_url, d->m_rev, d->hasEvents ? logPageSize + 1 : logPageSize);
     connect(this, &VcsEventLogModel::destroyed, job, [job] { job->kill(); });
     connect(job, &VcsJob::finished, this, &VcsEventLogModel::jobReceivedResults);
     ICore::self()->runController()->registerJob( job );
@@ -184,25 +271,41 @@ void VcsEventLogModel::jobReceivedResults(KJob* job)
 {
     Q_D(VcsEventLogModel);
 
+    d->fetching = false;
+
     const QList<QVariant> l = qobject_cast<KDevelop::VcsJob *>(job)->fetchResults().toList();
     if(l.isEmpty() || job->error()!=0) {
         d->done = true;
+        d->insertOnArrival = false;
         return;
     }
     QList<KDevelop::VcsEvent> newevents;
+    newevents.reserve(l.size());
     for (const QVariant& v : l) {
         if( v.canConvert<KDevelop::VcsEvent>() )
         {
             newevents << v.value<KDevelop::VcsEvent>();
         }
     }
+    if (newevents.isEmpty()) {
+        d->done = true;
+        d->insertOnArrival = false;
+        return;
+    }
     d->m_rev = newevents.last().revision();
-    if (rowCount()) {
+    if (d->hasEvents) {
         newevents.removeFirst();
     }
+    d->hasEvents = true;
     d->done = newevents.isEmpty();
-    addEvents( newevents );
-    d->fetching = false;
+
+    if (d->insertOnArrival) {
+        d->insertOnArrival = false;
+        addEvents( newevents );
+        startFetching();
+    } else {
+        d->prefetched = newevents;
+    }
 }
 
 }
@@ -73,7 +73,8 @@ private:
 /**
  * This model stores a list of VcsEvents corresponding to the log obtained
  * via IBasicVersionControl::log for a given revision. The model is populated
- * lazily via @c fetchMore.
+ * lazily via @c fetchMore in pages of fixed size, the next page is fetched in the
+ * background while the current one is displayed.
  */
 class KDEVPLATFORMVCS_EXPORT VcsEventLogModel : public VcsBasicEventModel
 {
@@ -91,6 +92,8 @@ private Q_SLOTS:
     void jobReceivedResults( KJob* job );
 
 private:
+    void startFetching();
+
     const QScopedPointer<class VcsEventLogModelPrivate> d_ptr;
     Q_DECLARE_PRIVATE(VcsEventLogModel)
 };
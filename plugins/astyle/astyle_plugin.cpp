@@ -245,24 +245,38 @@ QString AStylePlugin::description() const
         "Home Page: <a href=\"http://astyle.sourceforge.net/\">http://astyle.sourceforge.net</a>");
 }
 
-QString AStylePlugin::formatSourceWithStyle( SourceFormatterStyle s, const QString& text, const QUrl& /*url*/, const QMimeType& mime, const QString& leftContext, const QString& rightContext ) const
+static void loadStyle(AStyleFormatter& formatter, const SourceFormatterStyle& s, const QMimeType& mime)
 {
     if(mime.inherits(QStringLiteral("text/x-java")))
-        m_formatter->setJavaStyle();
+        formatter.setJavaStyle();
     else if(mime.inherits(QStringLiteral("text/x-csharp")))
-        m_formatter->setSharpStyle();
+        formatter.setSharpStyle();
     else
-        m_formatter->setCStyle();
+        formatter.setCStyle();
 
     if( s.content().isEmpty() )
     {
-        m_formatter->predefinedStyle( s.name() );
+        formatter.predefinedStyle( s.name() );
     } else
     {
-        m_formatter->loadStyle( s.content() );
+        formatter.loadStyle( s.content() );
     }
-    
-    return m_formatter->formatSource(text, leftContext, rightContext);
+}
+
+QString AStylePlugin::formatSourceWithStyle( SourceFormatterStyle s, const QString& text, const QUrl& /*url*/, const QMimeType& mime, const QString& leftContext, const QString& rightContext ) const
+{
+    // use a formatter of our own, so formatting with another style does not change the current one
+    AStyleFormatter formatter;
+    loadStyle(formatter, s, mime);
+
+    QMutexLocker lock(&m_formatMutex);
+    return formatter.formatSource(text, leftContext, rightContext);
+}
+
+bool AStylePlugin::canFormatConcurrently() const
+{
+    // the calls are serialized, but don't block the UI thread when formatting many files
+    return true;
 }
 
 QString AStylePlugin::formatSource(const QString& text, const QUrl &url, const QMimeType& mime, const QString& leftContext, const QString& rightContext) const
@@ -348,8 +362,9 @@ QString AStylePlugin::previewText(const SourceFormatterStyle& /*style*/, const Q
 
 AStylePlugin::Indentation AStylePlugin::indentation(const QUrl& url) const
 {
-    // Call formatSource first, to initialize the m_formatter data structures according to the URL
-    formatSource(QString(), url, QMimeDatabase().mimeTypeForUrl(url), QString(), QString());
+    // Load the style of the URL, to initialize the m_formatter data structures according to it
+    const QMimeType mime = QMimeDatabase().mimeTypeForUrl(url);
+    loadStyle(*m_formatter, ICore::self()->sourceFormatterController()->styleForUrl(url, mime), mime);
 
     Indentation ret;
 
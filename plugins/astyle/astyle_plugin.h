@@ -27,6 +27,8 @@ Copyright (C) 2001 Matthias Hölzer-Klüpfel <mhk@caldera.de>
 #include <interfaces/iplugin.h>
 #include <interfaces/isourceformatter.h>
 
+#include <QMutex>
+
 class AStyleFormatter;
 
 class AStylePlugin : public KDevelop::IPlugin, public KDevelop::ISourceFormatter
@@ -60,6 +62,8 @@ public:
                                             const QString& leftContext = QString(),
                                             const QString& rightContext = QString()) const override;
 
+    bool canFormatConcurrently() const override;
+
     /** \return The text used in the config dialog to preview the current style.
     */
     QString previewText(const KDevelop::SourceFormatterStyle& style, const QMimeType& mime) const override;
@@ -73,6 +77,8 @@ public:
 
 private:
     QScopedPointer<AStyleFormatter> m_formatter;
+    /// libastyle keeps process-wide state, so only one text is formatted at a time
+    mutable QMutex m_formatMutex;
 };
 
 #endif // ASTYLEPLUGIN_H
@@ -162,33 +162,32 @@ DocumentChangeTracker* trackerForUrl(const IndexedString& url)
 
 }
 
-ClangParseJob::ClangParseJob(const IndexedString& url, ILanguageSupport* languageSupport)
-    : ParseJob(url, languageSupport)
-    , m_options(ParseSessionData::NoOption)
+ClangParsingEnvironment ClangParseJob::createEnvironment(const IndexedString& url, ClangSupport* clang)
 {
-    const auto tuUrl = clang()->index()->translationUnitForUrl(url);
+    ClangParsingEnvironment environment;
+    const auto tuUrl = clang->index()->translationUnitForUrl(url);
     bool hasBuildSystemInfo;
     if (auto file = findProjectFileItem(tuUrl, &hasBuildSystemInfo)) {
-        m_environment.addIncludes(IDefinesAndIncludesManager::manager()->includes(file));
-        m_environment.addFrameworkDirectories(IDefinesAndIncludesManager::manager()->frameworkDirectories(file));
-        m_environment.addDefines(IDefinesAndIncludesManager::manager()->defines(file));
-        m_environment.setParserSettings(ClangSettingsManager::self()->parserSettings(file));
+        environment.addIncludes(IDefinesAndIncludesManager::manager()->includes(file));
+        environment.addFrameworkDirectories(IDefinesAndIncludesManager::manager()->frameworkDirectories(file));
+        environment.addDefines(IDefinesAndIncludesManager::manager()->defines(file));
+        environment.setParserSettings(ClangSettingsManager::self()->parserSettings(file));
         if (hasBuildSystemInfo) {
             // Assume the builder invokes the compiler in the build directory.
-            m_environment.setWorkingDirectory(file->project()->buildSystemManager()->buildDirectory(file));
+            environment.setWorkingDirectory(file->project()->buildSystemManager()->buildDirectory(file));
         }
     } else {
-        m_environment.addIncludes(IDefinesAndIncludesManager::manager()->includes(tuUrl.str()));
-        m_environment.addFrameworkDirectories(IDefinesAndIncludesManager::manager()->frameworkDirectories(tuUrl.str()));
-        m_environment.addDefines(IDefinesAndIncludesManager::manager()->defines(tuUrl.str()));
-        m_environment.setParserSettings(ClangSettingsManager::self()->parserSettings(tuUrl.str()));
+        environment.addIncludes(IDefinesAndIncludesManager::manager()->includes(tuUrl.str()));
+        environment.addFrameworkDirectories(IDefinesAndIncludesManager::manager()->frameworkDirectories(tuUrl.str()));
+        environment.addDefines(IDefinesAndIncludesManager::manager()->defines(tuUrl.str()));
+        environment.setParserSettings(ClangSettingsManager::self()->parserSettings(tuUrl.str()));
     }
     const bool isSource = ClangHelpers::isSource(tuUrl.str());
-    m_environment.setQuality(
+    environment.setQuality(
         isSource ? (hasBuildSystemInfo ? ClangParsingEnvironment::BuildSystem : ClangParsingEnvironment::Source)
         : ClangParsingEnvironment::Unknown
     );
-    m_environment.setTranslationUnitUrl(tuUrl);
+    environment.setTranslationUnitUrl(tuUrl);
 
     Path::List projectPaths;
     const auto& projects = ICore::self()->projectController()->projects();
@@ -196,7 +195,26 @@ ClangParseJob::ClangParseJob(const IndexedString& url, ILanguageSupport* languag
     for (auto project : projects) {
         projectPaths.append(project->path());
     }
-    m_environment.setProjectPaths(projectPaths);
+    environment.setProjectPaths(projectPaths);
+    return environment;
+}
+
+void ClangParseJob::completeEnvironment(ClangParsingEnvironment* environment)
+{
+    const auto tuUrlStr = environment->translationUnitUrl().str();
+    environment->addIncludes(IDefinesAndIncludesManager::manager()->includesInBackground(tuUrlStr));
+    environment->addFrameworkDirectories(IDefinesAndIncludesManager::manager()->frameworkDirectoriesInBackground(tuUrlStr));
+    environment->addDefines(IDefinesAndIncludesManager::manager()->definesInBackground(tuUrlStr));
+    environment->addParserArguments(IDefinesAndIncludesManager::manager()->parserArgumentsInBackground(tuUrlStr));
+    environment->setPchInclude(userDefinedPchIncludeForFile(tuUrlStr));
+}
+
+ClangParseJob::ClangParseJob(const IndexedString& url, ILanguageSupport* languageSupport)
+    : ParseJob(url, languageSupport)
+    , m_options(ParseSessionData::NoOption)
+{
+    m_environment = createEnvironment(url, clang());
+    const auto tuUrl = m_environment.translationUnitUrl();
 
     m_unsavedFiles = ClangUtils::unsavedFiles();
 
@@ -243,11 +261,7 @@ void ClangParseJob::run(ThreadWeaver::JobPointer /*self*/, ThreadWeaver::Thread*
             return;
         }
 
-        m_environment.addIncludes(IDefinesAndIncludesManager::manager()->includesInBackground(tuUrlStr));
-        m_environment.addFrameworkDirectories(IDefinesAndIncludesManager::manager()->frameworkDirectoriesInBackground(tuUrlStr));
-        m_environment.addDefines(IDefinesAndIncludesManager::manager()->definesInBackground(tuUrlStr));
-        m_environment.addParserArguments(IDefinesAndIncludesManager::manager()->parserArgumentsInBackground(tuUrlStr));
-        m_environment.setPchInclude(userDefinedPchIncludeForFile(tuUrlStr));
+        completeEnvironment(&m_environment);
     }
 
     if (abortRequested()) {
@@ -41,6 +41,16 @@ public:
 
     ClangSupport* clang() const;
 
+    /**
+     * @return the environment parsing @p url starts with, on the foreground thread
+     *
+     * The parts determined in the background are added by completeEnvironment().
+     */
+    static ClangParsingEnvironment createEnvironment(const KDevelop::IndexedString& url, ClangSupport* clang);
+
+    /// Add the include paths, defines and arguments which are determined in the background
+    static void completeEnvironment(ClangParsingEnvironment* environment);
+
     enum CustomFeatures {
         Rescheduled = (KDevelop::TopDUContext::LastFeature << 1),
         AttachASTWithoutUpdating = (Rescheduled << 1), ///< Used when context is up to date, but has no AST attached.
@@ -245,6 +245,17 @@ ParseJob* ClangSupport::createParseJob(const IndexedString& url)
     return new ClangParseJob(url, this);
 }
 
+ParsingEnvironment* ClangSupport::createParsingEnvironment(const IndexedString& url)
+{
+    return new ClangParsingEnvironment(ClangParseJob::createEnvironment(url, this));
+}
+
+void ClangSupport::completeParsingEnvironment(ParsingEnvironment* environment) const
+{
+    Q_ASSERT(dynamic_cast<ClangParsingEnvironment*>(environment));
+    ClangParseJob::completeEnvironment(static_cast<ClangParsingEnvironment*>(environment));
+}
+
 QString ClangSupport::name() const
 {
     return QStringLiteral("clang");
@@ -58,6 +58,9 @@ public:
     /** Parsejob used by background parser to parse given url */
     KDevelop::ParseJob *createParseJob(const KDevelop::IndexedString &url) override;
 
+    KDevelop::ParsingEnvironment* createParsingEnvironment(const KDevelop::IndexedString& url) override;
+    void completeParsingEnvironment(KDevelop::ParsingEnvironment* environment) const override;
+
     /** the code highlighter */
     KDevelop::ICodeHighlighting* codeHighlighting() const override;
     KDevelop::BasicRefactoring* refactoring() const override;
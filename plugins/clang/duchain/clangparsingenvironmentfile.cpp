@@ -100,6 +100,12 @@ bool ClangParsingEnvironmentFile::needsUpdate(const ParsingEnvironment* environm
     return ret;
 }
 
+bool ClangParsingEnvironmentFile::needsUpdateDependsOnEnvironment() const
+{
+    // the quality and the hash of the include paths and defines are compared as well
+    return true;
+}
+
 void ClangParsingEnvironmentFile::setEnvironment(const ClangParsingEnvironment& environment)
 {
     d_func_dynamic()->tuUrl = environment.translationUnitUrl();
@@ -40,6 +40,7 @@ public:
     ~ClangParsingEnvironmentFile() override;
 
     bool needsUpdate(const KDevelop::ParsingEnvironment* environment = nullptr) const override;
+    bool needsUpdateDependsOnEnvironment() const override;
     int type() const override;
 
     bool matchEnvironment(const KDevelop::ParsingEnvironment* environment) const override;
@@ -0,0 +1,396 @@
+/* KDevelop CMake Support
+
+    Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "cmakecompilecommands.h"
+
+#include "cmakeprojectdata.h"
+#include "cmakeutils.h"
+
+#include <makefileresolver/makefileresolver.h>
+
+#include <util/path.h>
+
+#include <QFile>
+#include <QFuture>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentRun>
+
+#include <debug.h>
+
+using namespace KDevelop;
+
+namespace {
+/// number of entries handed to a worker thread at once
+const int BatchSize = 256;
+
+struct ParsedEntry
+{
+    QString file;
+    CMakeFile settings;
+};
+
+struct ParsedBatch
+{
+    QVector<ParsedEntry> entries;
+    bool isValid = true;
+};
+
+ParsedBatch parseBatch(const QVector<QByteArray>& rawEntries)
+{
+    const QString KEY_COMMAND = QStringLiteral("command");
+    const QString KEY_DIRECTORY = QStringLiteral("directory");
+    const QString KEY_FILE = QStringLiteral("file");
+
+    ParsedBatch ret;
+    ret.entries.reserve(rawEntries.size());
+
+    // the resolver caches interned strings and paths, hence it must not be shared between threads
+    MakeFileResolver resolver;
+    for (const auto& rawEntry : rawEntries) {
+        if (!rawEntry.startsWith('{')) {
+            qCWarning(CMAKE) << "JSON command file entry is not an object:" << rawEntry;
+            continue;
+        }
+
+        QJsonParseError error;
+        const auto document = QJsonDocument::fromJson(rawEntry, &error);
+        if (error.error) {
+            qCWarning(CMAKE) << "Failed to parse JSON in commands file entry:" << error.errorString() << error.offset;
+            ret.isValid = false;
+            return ret;
+        }
+
+        const QJsonObject entry = document.object();
+        if (!entry.contains(KEY_FILE) || !entry.contains(KEY_COMMAND) || !entry.contains(KEY_DIRECTORY)) {
+            qCWarning(CMAKE) << "JSON command file entry does not contain required keys:" << entry;
+            continue;
+        }
+
+        const auto result = resolver.processOutput(entry[KEY_COMMAND].toString(), entry[KEY_DIRECTORY].toString());
+
+        ParsedEntry parsed;
+        parsed.file = entry[KEY_FILE].toString();
+        parsed.settings.includes = result.paths;
+        parsed.settings.frameworkDirectories = result.frameworkDirectories;
+        parsed.settings.defines = result.defines;
+        ret.entries.append(parsed);
+    }
+    return ret;
+}
+
+/**
+ * Maps compile settings as found in the commands file to their host equivalent,
+ * sharing the result between all files which are compiled with the same settings.
+ */
+class SettingsInterner
+{
+public:
+    explicit SettingsInterner(const CMake::CompileCommands::PathConverter& toHost)
+        : m_toHost(toHost)
+    {
+    }
+
+    Path toHostPath(const QString& path) const
+    {
+        return m_toHost ? m_toHost(Path(path)) : Path(path);
+    }
+
+    CMakeFile internSettings(const CMakeFile& settings)
+    {
+        auto it = m_hostSettings.constFind(settings);
+        if (it != m_hostSettings.constEnd()) {
+            return *it;
+        }
+
+        CMakeFile hostSettings = settings;
+        if (m_toHost) {
+            hostSettings.includes = kTransform<Path::List>(settings.includes, m_toHost);
+            hostSettings.frameworkDirectories = kTransform<Path::List>(settings.frameworkDirectories, m_toHost);
+        }
+        m_hostSettings.insert(settings, hostSettings);
+        return hostSettings;
+    }
+
+    int distinctSettings() const
+    {
+        return m_hostSettings.size();
+    }
+
+private:
+    CMake::CompileCommands::PathConverter m_toHost;
+    QHash<CMakeFile, CMakeFile> m_hostSettings;
+};
+}
+
+namespace CMake {
+namespace CompileCommands {
+JsonArrayReader::JsonArrayReader(QIODevice* device, int chunkSize)
+    : m_device(device)
+    , m_chunkSize(chunkSize)
+{
+}
+
+bool JsonArrayReader::hasError() const
+{
+    return !m_error.isEmpty();
+}
+
+QString JsonArrayReader::errorString() const
+{
+    return m_error;
+}
+
+void JsonArrayReader::setError(const QString& error)
+{
+    m_error = error;
+    m_finished = true;
+}
+
+bool JsonArrayReader::fillBuffer()
+{
+    // drop everything that was consumed already, only the current element is kept around
+    m_buffer.remove(0, m_pos);
+    m_pos = 0;
+
+    const auto data = m_device->read(m_chunkSize);
+    if (data.isEmpty()) {
+        return false;
+    }
+    m_buffer.append(data);
+    return true;
+}
+
+bool JsonArrayReader::skipWhitespace()
+{
+    while (true) {
+        while (m_pos < m_buffer.size()) {
+            switch (m_buffer.at(m_pos)) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                ++m_pos;
+                continue;
+            default:
+                return true;
+            }
+        }
+        if (!fillBuffer()) {
+            return false;
+        }
+    }
+}
+
+bool JsonArrayReader::readNext(QByteArray* element)
+{
+    if (m_finished) {
+        return false;
+    }
+
+    if (!m_started) {
+        if (!skipWhitespace() || m_buffer.at(m_pos) != '[') {
+            setError(QStringLiteral("JSON document is not an array"));
+            return false;
+        }
+        ++m_pos;
+        m_started = true;
+
+        if (!skipWhitespace()) {
+            setError(QStringLiteral("unterminated array"));
+            return false;
+        }
+    } else {
+        // the previous element must be followed by either a separator or the end of the array
+        if (!skipWhitespace()) {
+            setError(QStringLiteral("unterminated array"));
+            return false;
+        }
+        if (m_buffer.at(m_pos) == ',') {
+            ++m_pos;
+            if (!skipWhitespace()) {
+                setError(QStringLiteral("unterminated array"));
+                return false;
+            }
+        } else if (m_buffer.at(m_pos) != ']') {
+            setError(QStringLiteral("missing value separator"));
+            return false;
+        }
+    }
+
+    if (m_buffer.at(m_pos) == ']') {
+        m_finished = true;
+        return false;
+    }
+
+    // scan for the end of the current element, the offset is relative to m_pos
+    // since the buffer gets compacted whenever more data is read
+    int offset = 0;
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    bool done = false;
+    while (!done) {
+        if (m_pos + offset >= m_buffer.size() && !fillBuffer()) {
+            setError(QStringLiteral("unterminated array element"));
+            return false;
+        }
+
+        const char c = m_buffer.at(m_pos + offset);
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+            ++offset;
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            inString = true;
+            break;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (depth == 0) {
+                // end of the surrounding array, don't consume it
+                done = true;
+                continue;
+            }
+            --depth;
+            done = (depth == 0);
+            break;
+        case ',':
+            if (depth == 0) {
+                done = true;
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        ++offset;
+    }
+
+    if (offset == 0) {
+        setError(QStringLiteral("empty array element"));
+        return false;
+    }
+
+    *element = m_buffer.mid(m_pos, offset);
+    m_pos += offset;
+    return true;
+}
+
+CMakeFilesCompilationData parse(QIODevice* device, const PathConverter& toHost)
+{
+    CMakeFilesCompilationData data;
+    SettingsInterner interner(toHost);
+    bool isValid = true;
+
+    auto mergeBatch = [&](const ParsedBatch& batch) {
+        if (!batch.isValid) {
+            isValid = false;
+            return;
+        }
+        for (const auto& entry : batch.entries) {
+            data.files[interner.toHostPath(entry.file)] = interner.internSettings(entry.settings);
+        }
+    };
+
+    // keep the number of batches in flight bounded, such that the memory consumption
+    // does not grow with the size of the file when the workers can't keep up with the reader
+    const int maxPendingBatches = qMax(1, QThread::idealThreadCount()) * 2;
+    QQueue<QFuture<ParsedBatch>> pendingBatches;
+
+    JsonArrayReader reader(device);
+    QVector<QByteArray> batch;
+    batch.reserve(BatchSize);
+    QByteArray element;
+    while (isValid) {
+        const bool hasElement = reader.readNext(&element);
+        if (hasElement) {
+            batch.append(element);
+        }
+        if (!batch.isEmpty() && (!hasElement || batch.size() == BatchSize)) {
+            if (pendingBatches.size() >= maxPendingBatches) {
+                mergeBatch(pendingBatches.dequeue().result());
+            }
+            pendingBatches.enqueue(QtConcurrent::run(parseBatch, batch));
+            batch.clear();
+            batch.reserve(BatchSize);
+        }
+        if (!hasElement) {
+            break;
+        }
+    }
+
+    while (!pendingBatches.isEmpty()) {
+        mergeBatch(pendingBatches.dequeue().result());
+    }
+
+    if (reader.hasError()) {
+        qCWarning(CMAKE) << "Failed to parse JSON in commands file:" << reader.errorString();
+        isValid = false;
+    }
+
+    if (!isValid) {
+        data.files.clear();
+        data.isValid = false;
+        return data;
+    }
+
+    qCDebug(CMAKE) << "Parsed" << data.files.size() << "entries with" << interner.distinctSettings() << "distinct compile settings";
+
+    data.isValid = true;
+    data.rebuildFileForFolderMapping();
+    return data;
+}
+
+CMakeFilesCompilationData parse(const Path& commandsFile, const PathConverter& toHost)
+{
+    // NOTE: to get compile_commands.json, you need -DCMAKE_EXPORT_COMPILE_COMMANDS=ON
+    QFile f(commandsFile.toLocalFile());
+    bool r = f.open(QFile::ReadOnly|QFile::Text);
+    if(!r) {
+        qCWarning(CMAKE) << "Couldn't open commands file" << commandsFile;
+        return {};
+    }
+
+    qCDebug(CMAKE) << "Found commands file" << commandsFile;
+
+    const auto data = parse(&f, toHost);
+    if (!data.isValid) {
+        qCWarning(CMAKE) << "Failed to import commands file" << commandsFile;
+    }
+    return data;
+}
+}
+}
@@ -0,0 +1,100 @@
+/* KDevelop CMake Support
+
+    Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+#include <cmakecommonexport.h>
+
+class QIODevice;
+
+struct CMakeFilesCompilationData;
+
+namespace KDevelop
+{
+class Path;
+}
+
+/// see: https://clang.llvm.org/docs/JSONCompilationDatabase.html
+namespace CMake {
+namespace CompileCommands {
+/**
+ * Splits a top-level JSON array read from a device into its elements without
+ * ever holding the complete document in memory.
+ *
+ * Only the bytes of the current element are buffered, each of which can then be
+ * handed to QJsonDocument::fromJson individually.
+ */
+class KDEVCMAKECOMMON_EXPORT JsonArrayReader
+{
+public:
+    explicit JsonArrayReader(QIODevice* device, int chunkSize = 1024 * 1024);
+
+    /**
+     * Read the next element of the array into @p element.
+     *
+     * @returns false when the end of the array was reached or an error occurred,
+     *          use hasError() to distinguish the two cases.
+     */
+    bool readNext(QByteArray* element);
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    bool fillBuffer();
+    bool skipWhitespace();
+    void setError(const QString& error);
+
+    QIODevice* m_device;
+    int m_chunkSize;
+    QByteArray m_buffer;
+    int m_pos = 0;
+    bool m_started = false;
+    bool m_finished = false;
+    QString m_error;
+};
+
+/**
+ * Converts a path as found in the compilation database into a path on the host.
+ */
+using PathConverter = std::function<KDevelop::Path(const KDevelop::Path&)>;
+
+/**
+ * Stream the compilation database from @p device and extract the include paths and defines
+ * for every entry.
+ *
+ * Entries are handed to worker threads in batches while the file is still being read.
+ * Identical compile settings are only stored once and shared between all files using them,
+ * such that the memory consumption depends on the number of distinct settings rather than
+ * the size of the file.
+ */
+KDEVCMAKECOMMON_EXPORT CMakeFilesCompilationData parse(QIODevice* device, const PathConverter& toHost = {});
+
+/**
+ * Convenience overload of the above, reading the compilation database at @p commandsFile.
+ */
+KDEVCMAKECOMMON_EXPORT CMakeFilesCompilationData parse(const KDevelop::Path& commandsFile, const PathConverter& toHost = {});
+}
+}
@@ -26,7 +26,9 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QThread>
 #include <QVersionNumber>
+#include <QtConcurrentMap>
 
 #include <makefileresolver/makefileresolver.h>
 
@@ -198,28 +200,51 @@ static CMakeProjectData parseCodeModel(const QJsonObject& codeModel, const QDir&
     const auto configuration = codeModel.value(QLatin1String("configurations")).toArray().at(0).toObject();
     const auto targets = configuration.value(QLatin1String("targets")).toArray();
     const auto directories = configuration.value(QLatin1String("directories")).toArray();
+
+    struct TargetFile
+    {
+        Path dirSourcePath;
+        QString jsonFilePath;
+    };
+    QVector<TargetFile> targetFiles;
     for (const auto& directoryValue : directories) {
         const auto directory = directoryValue.toObject();
         if (!directory.contains(QLatin1String("targetIndexes"))) {
             continue;
         }
         const auto dirSourcePath = sourcePathInterner.internPath(directory.value(QLatin1String("source")).toString());
-        auto& dirTargets = ret.targets[dirSourcePath];
+        // ensure we also report directories without any valid targets
+        ret.targets[dirSourcePath];
         for (const auto& targetIndex : directory.value(QLatin1String("targetIndexes")).toArray()) {
             const auto jsonTarget = targets.at(targetIndex.toInt(-1)).toObject();
             if (jsonTarget.isEmpty()) {
                 continue;
             }
             const auto targetFile = jsonTarget.value(QLatin1String("jsonFile")).toString();
-            const auto target = parseTarget(parseFile(replyDir.absoluteFilePath(targetFile)),
-                                            stringInterner, sourcePathInterner, buildPathInterner,
+            targetFiles.append({dirSourcePath, replyDir.absoluteFilePath(targetFile)});
+        }
+    }
+
+    // the JSON parsing of the target files dominates the import time for large projects,
+    // do it in parallel but only for a bounded number of files at once to keep the memory
+    // consumption in check. The interners are not thread safe, so the parsed targets are
+    // processed sequentially afterwards.
+    const int windowSize = qMax(1, QThread::idealThreadCount()) * 4;
+    for (int windowStart = 0; windowStart < targetFiles.size(); windowStart += windowSize) {
+        const auto window = targetFiles.mid(windowStart, windowSize);
+        const auto jsonTargets = QtConcurrent::blockingMapped<QVector<QJsonObject>>(window, [](const TargetFile& targetFile) {
+            return parseFile(targetFile.jsonFilePath);
+        });
+        for (int i = 0; i < window.size(); ++i) {
+            const auto target = parseTarget(jsonTargets.at(i), stringInterner, sourcePathInterner, buildPathInterner,
                                             ret.compilationData);
             if (target.name.isEmpty()) {
                 continue;
             }
-            dirTargets.append(target);
+            ret.targets[window.at(i).dirSourcePath].append(target);
         }
     }
+
     ret.compilationData.isValid = !codeModel.isEmpty();
     ret.compilationData.rebuildFileForFolderMapping();
     if (!ret.compilationData.isValid) {
@@ -20,12 +20,12 @@
 
 #include "cmakeimportjsonjob.h"
 
+#include "cmakecompilecommands.h"
 #include "cmakeutils.h"
 #include "cmakeprojectdata.h"
 #include "cmakemodelitems.h"
 #include "debug.h"
 
-#include <makefileresolver/makefileresolver.h>
 #include <language/duchain/duchain.h>
 #include <language/duchain/duchainlock.h>
 #include <interfaces/iproject.h>
@@ -33,11 +33,8 @@
 #include <interfaces/iruntime.h>
 #include <interfaces/iruntimecontroller.h>
 
-#include <KShell>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QtConcurrentRun>
+#include <QFileInfo>
 #include <QFutureWatcher>
 #include <QRegularExpression>
 
@@ -47,62 +44,8 @@ namespace {
 
 CMakeFilesCompilationData importCommands(const Path& commandsFile)
 {
-    // NOTE: to get compile_commands.json, you need -DCMAKE_EXPORT_COMPILE_COMMANDS=ON
-    QFile f(commandsFile.toLocalFile());
-    bool r = f.open(QFile::ReadOnly|QFile::Text);
-    if(!r) {
-        qCWarning(CMAKE) << "Couldn't open commands file" << commandsFile;
-        return {};
-    }
-
-    qCDebug(CMAKE) << "Found commands file" << commandsFile;
-
-    CMakeFilesCompilationData data;
-    QJsonParseError error;
-    const QJsonDocument document = QJsonDocument::fromJson(f.readAll(), &error);
-    if (error.error) {
-        qCWarning(CMAKE) << "Failed to parse JSON in commands file:" << error.errorString() << commandsFile;
-        data.isValid = false;
-        return data;
-    } else if (!document.isArray()) {
-        qCWarning(CMAKE) << "JSON document in commands file is not an array: " << commandsFile;
-        data.isValid = false;
-        return data;
-    }
-
-    MakeFileResolver resolver;
-    const QString KEY_COMMAND = QStringLiteral("command");
-    const QString KEY_DIRECTORY = QStringLiteral("directory");
-    const QString KEY_FILE = QStringLiteral("file");
     auto rt = ICore::self()->runtimeController()->currentRuntime();
-    const auto values = document.array();
-    for (const QJsonValue& value : values) {
-        if (!value.isObject()) {
-            qCWarning(CMAKE) << "JSON command file entry is not an object:" << value;
-            continue;
-        }
-        const QJsonObject entry = value.toObject();
-        if (!entry.contains(KEY_FILE) || !entry.contains(KEY_COMMAND) || !entry.contains(KEY_DIRECTORY)) {
-            qCWarning(CMAKE) << "JSON command file entry does not contain required keys:" << entry;
-            continue;
-        }
-
-        PathResolutionResult result = resolver.processOutput(entry[KEY_COMMAND].toString(), entry[KEY_DIRECTORY].toString());
-
-        auto convert = [rt](const Path &path) { return rt->pathInHost(path); };
-
-        CMakeFile ret;
-        ret.includes = kTransform<Path::List>(result.paths, convert);
-        ret.frameworkDirectories = kTransform<Path::List>(result.frameworkDirectories, convert);
-        ret.defines = result.defines;
-        const Path path(rt->pathInHost(Path(entry[KEY_FILE].toString())));
-        qCDebug(CMAKE) << "entering..." << path << entry[KEY_FILE];
-        data.files[path] = ret;
-    }
-
-    data.isValid = true;
-    data.rebuildFileForFolderMapping();
-    return data;
+    return CMake::CompileCommands::parse(commandsFile, [rt](const Path& path) { return rt->pathInHost(path); });
 }
 
 ImportData import(const Path& commandsFile, const Path &targetsFilePath, const QString &sourceDir, const KDevelop::Path &buildPath)
@@ -33,6 +33,29 @@ void CMakeFile::addDefine(const QString& define)
     }
 }
 
+uint qHash(const CMakeFile& file, uint seed)
+{
+    uint hash = seed;
+    auto combine = [&hash](uint value) {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    for (const auto& include : file.includes) {
+        combine(qHash(include));
+    }
+    for (const auto& directory : file.frameworkDirectories) {
+        combine(qHash(directory));
+    }
+    combine(qHash(file.compileFlags));
+    combine(qHash(file.language));
+    // QHash iteration order is unspecified, so combine the defines in an order-independent way
+    uint definesHash = 0;
+    for (auto it = file.defines.constBegin(), end = file.defines.constEnd(); it != end; ++it) {
+        definesHash += qHash(it.key()) ^ (qHash(it.value()) * 31);
+    }
+    combine(definesHash);
+    return hash;
+}
+
 void CMakeFilesCompilationData::rebuildFileForFolderMapping()
 {
     fileForFolder.clear();
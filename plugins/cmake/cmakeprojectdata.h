@@ -55,6 +55,17 @@ struct KDEVCMAKECOMMON_EXPORT CMakeFile
 };
 Q_DECLARE_TYPEINFO(CMakeFile, Q_MOVABLE_TYPE);
 
+inline bool operator==(const CMakeFile& lhs, const CMakeFile& rhs)
+{
+    return lhs.includes == rhs.includes
+        && lhs.frameworkDirectories == rhs.frameworkDirectories
+        && lhs.compileFlags == rhs.compileFlags
+        && lhs.language == rhs.language
+        && lhs.defines == rhs.defines;
+}
+
+KDEVCMAKECOMMON_EXPORT uint qHash(const CMakeFile& file, uint seed = 0);
+
 inline QDebug &operator<<(QDebug debug, const CMakeFile& file)
 {
     debug << "CMakeFile(-I" << file.includes << ", -F" << file.frameworkDirectories << ", -D" << file.defines << ", " << file.language << ")";
@@ -22,13 +22,54 @@
 #include <debug.h>
 
 #include <interfaces/icore.h>
+#include <interfaces/iproject.h>
 #include <interfaces/itestcontroller.h>
 #include <interfaces/ilanguagecontroller.h>
+#include <interfaces/iruntime.h>
+#include <interfaces/iruntimecontroller.h>
 #include <language/duchain/duchain.h>
 #include <language/backgroundparser/backgroundparser.h>
 
+#include <KConfigGroup>
 #include <KLocalizedString>
 
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+
+namespace {
+const char casesCacheGroup[] = "CTest Cases";
+/// Listing the functions of a QTest takes a few milliseconds, don't let a broken test block the discovery.
+const int listFunctionsTimeout = 10000;
+
+KConfigGroup casesCache(CTestSuite* suite)
+{
+    return KConfigGroup(suite->project()->projectConfiguration(), casesCacheGroup).group(suite->name());
+}
+
+/**
+ * Checks whether @p executable links QTest, so it understands the -functions argument.
+ * Other tests could ignore the argument and run all their tests instead.
+ */
+bool isQTestExecutable(const QFileInfo& executable)
+{
+    QFile file(executable.filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // The names of the linked libraries are stored close to the start of the executable,
+    // the test function names of statically linked tests in the symbol tables at the end.
+    const qint64 chunkSize = 1024 * 1024;
+    QByteArray data = file.read(chunkSize);
+    if (file.size() > chunkSize) {
+        file.seek(qMax(chunkSize, file.size() - chunkSize));
+        data += file.read(chunkSize);
+    }
+    return data.contains("Qt5Test") || data.contains("Qt6Test") || data.contains("QtTest") || data.contains("QTest");
+}
+}
+
 CTestFindJob::CTestFindJob(CTestSuite* suite, QObject* parent)
 : KJob(parent)
 , m_suite(suite)
@@ -48,11 +89,123 @@ void CTestFindJob::findTestCases()
 {
     if (!m_suite->arguments().isEmpty())
     {
-        KDevelop::ICore::self()->testController()->addTestSuite(m_suite);
-        emitResult();
+        finish();
         return;
     }
 
+    const QFileInfo executable(m_suite->executable().toLocalFile());
+    if (executable.isFile() && executable.isExecutable())
+    {
+        if (useCachedFunctions(executable))
+        {
+            m_suite->loadDeclarationsWhenParsed();
+            finish();
+            return;
+        }
+        if (isQTestExecutable(executable))
+        {
+            listFunctions(executable);
+            return;
+        }
+    }
+
+    parseSourceFiles();
+}
+
+bool CTestFindJob::useCachedFunctions(const QFileInfo& executable)
+{
+    const KConfigGroup cache = casesCache(m_suite);
+    if (cache.readEntry("Executable", QString()) != executable.filePath()
+        || cache.readEntry("Modified", qint64(-1)) != executable.lastModified().toMSecsSinceEpoch()
+        || cache.readEntry("Size", qint64(-1)) != executable.size())
+    {
+        return false;
+    }
+
+    m_suite->setTestCases(cache.readEntry("Cases", QStringList()));
+    qCDebug(CMAKE) << "Using cached test cases of" << m_suite->name() << m_suite->cases();
+    return true;
+}
+
+void CTestFindJob::listFunctions(const QFileInfo& executable)
+{
+    // run it in the runtime of the project, like the test runs started by CTestRunJob
+    KDevelop::IRuntime* runtime = KDevelop::ICore::self()->runtimeController()->currentRuntime();
+    const QString workingDirectory = m_suite->properties().value(QStringLiteral("WORKING_DIRECTORY"));
+    const KDevelop::Path workingDirectoryPath(workingDirectory.isEmpty() ? executable.path() : workingDirectory);
+
+    m_process = new QProcess(this);
+    m_process->setProgram(runtime->pathInRuntime(KDevelop::Path(executable.filePath())).toLocalFile());
+    m_process->setArguments({QStringLiteral("-functions")});
+    m_process->setWorkingDirectory(runtime->pathInRuntime(workingDirectoryPath).toLocalFile());
+    m_process->setProcessChannelMode(QProcess::SeparateChannels);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &CTestFindJob::functionsListed);
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            qCDebug(CMAKE) << "Failed to list the functions of" << m_suite->name();
+            m_process->deleteLater();
+            m_process = nullptr;
+            parseSourceFiles();
+        }
+    });
+
+    QProcess* process = m_process;
+    QTimer::singleShot(listFunctionsTimeout, process, [process]() {
+        process->kill();
+    });
+
+    qCDebug(CMAKE) << "Listing the functions of" << m_suite->name();
+    runtime->startProcess(m_process);
+}
+
+void CTestFindJob::functionsListed(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const QByteArray output = m_process->readAllStandardOutput();
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    QStringList cases;
+    const bool valid = exitStatus == QProcess::NormalExit && exitCode == 0 && parseFunctions(output, &cases);
+    if (!valid)
+    {
+        qCDebug(CMAKE) << "Could not list the functions of" << m_suite->name() << exitStatus << exitCode;
+        parseSourceFiles();
+        return;
+    }
+
+    const QFileInfo executable(m_suite->executable().toLocalFile());
+    KConfigGroup cache = casesCache(m_suite);
+    cache.writeEntry("Executable", executable.filePath());
+    cache.writeEntry("Modified", executable.lastModified().toMSecsSinceEpoch());
+    cache.writeEntry("Size", executable.size());
+    cache.writeEntry("Cases", cases);
+
+    m_suite->setTestCases(cases);
+    m_suite->loadDeclarationsWhenParsed();
+    finish();
+}
+
+bool CTestFindJob::parseFunctions(const QByteArray& output, QStringList* cases)
+{
+    // QTest prints one "function()" per line
+    cases->clear();
+    const auto lines = output.split('\n');
+    for (const QByteArray& line : lines) {
+        const QByteArray function = line.trimmed();
+        if (function.isEmpty())
+            continue;
+        if (!function.endsWith("()") || function.size() == 2 || function.contains(' ')) {
+            cases->clear();
+            return false;
+        }
+        *cases << QString::fromUtf8(function.left(function.size() - 2));
+    }
+    return true;
+}
+
+void CTestFindJob::parseSourceFiles()
+{
     m_pendingFiles.clear();
     const auto& sourceFiles = m_suite->sourceFiles();
     for (const auto& file : sourceFiles) {
@@ -65,8 +218,7 @@ void CTestFindJob::findTestCases()
 
     if (m_pendingFiles.isEmpty())
     {
-        KDevelop::ICore::self()->testController()->addTestSuite(m_suite);
-        emitResult();
+        finish();
         return;
     }
 
@@ -84,13 +236,23 @@ void CTestFindJob::updateReady(const KDevelop::IndexedString& document, const KD
 
     if (m_pendingFiles.isEmpty())
     {
-        KDevelop::ICore::self()->testController()->addTestSuite(m_suite);
-        emitResult();
+        finish();
     }
 }
 
+void CTestFindJob::finish()
+{
+    KDevelop::ICore::self()->testController()->addTestSuite(m_suite);
+    emitResult();
+}
+
 bool CTestFindJob::doKill()
 {
+    if (m_process)
+    {
+        m_process->disconnect(this);
+        m_process->kill();
+    }
     KDevelop::ICore::self()->languageController()->backgroundParser()->revertAllRequests(this);
     return true;
 }
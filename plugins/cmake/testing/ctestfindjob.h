@@ -23,6 +23,10 @@
 #include <KJob>
 #include <util/path.h>
 
+#include <QProcess>
+
+class QFileInfo;
+
 namespace KDevelop {
 class IndexedString;
 class ReferencedTopDUContext;
@@ -30,6 +34,14 @@ class ReferencedTopDUContext;
 
 class CTestSuite;
 
+/**
+ * Finds the test cases of a CTestSuite.
+ *
+ * If the test executable was built and uses QTest, its test functions are listed
+ * by running it with -functions, and cached in the project configuration until the
+ * executable changes. Otherwise the sources of the test are parsed and the test
+ * class is looked up in the DUChain, which may have to wait for the background parser.
+ */
 class CTestFindJob : public KJob
 {
     Q_OBJECT
@@ -37,16 +49,29 @@ class CTestFindJob : public KJob
 public:
     explicit CTestFindJob(CTestSuite* suite, QObject* parent = nullptr);
     void start() override;
+
+    /**
+     * Parses the output of a QTest executable run with -functions into @p cases.
+     * @return false if the output does not look like a list of test functions
+     */
+    static bool parseFunctions(const QByteArray& output, QStringList* cases);
     
 private Q_SLOTS:
     void findTestCases();
     void updateReady(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
+    void functionsListed(int exitCode, QProcess::ExitStatus exitStatus);
 
 protected:
     bool doKill() override;
 private:
+    bool useCachedFunctions(const QFileInfo& executable);
+    void listFunctions(const QFileInfo& executable);
+    void parseSourceFiles();
+    void finish();
+
     CTestSuite* m_suite;
     QList<KDevelop::Path> m_pendingFiles;
+    QProcess* m_process = nullptr;
 };
 
 #endif // CTESTFINDJOB_H
@@ -100,6 +100,65 @@ void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop:
         return;
     }
 
+    const auto cases = readDeclarations(topContext);
+    for (const QString& testCase : cases) {
+        if (!m_cases.contains(testCase))
+        {
+            m_cases << testCase;
+        }
+    }
+}
+
+void CTestSuite::loadDeclarationsWhenParsed()
+{
+    {
+        DUChainReadLocker locker(DUChain::lock());
+        for (const Path& file : qAsConst(m_files)) {
+            if (TopDUContext* topContext = DUChainUtils::contentContextFromProxyContext(DUChain::self()->chainForDocument(file.toUrl())))
+            {
+                readDeclarations(topContext);
+            }
+        }
+    }
+
+    if (m_suiteDeclaration.isValid())
+    {
+        return;
+    }
+
+    // the context object drops pending notifications when the suite is deleted
+    m_parsedFilesReceiver.reset(new QObject);
+    QObject::connect(DUChain::self(), &DUChain::updateReady, m_parsedFilesReceiver.data(),
+                     [this](const IndexedString& document, const ReferencedTopDUContext& context) {
+        sourceFileParsed(document, context);
+    });
+}
+
+void CTestSuite::sourceFileParsed(const IndexedString& document, const ReferencedTopDUContext& context)
+{
+    if (!m_files.contains(Path(document.toUrl())))
+    {
+        return;
+    }
+
+    {
+        DUChainReadLocker locker(DUChain::lock());
+        if (TopDUContext* topContext = DUChainUtils::contentContextFromProxyContext(context.data()))
+        {
+            readDeclarations(topContext);
+        }
+    }
+
+    if (m_suiteDeclaration.isValid())
+    {
+        // called from a signal of the receiver
+        m_parsedFilesReceiver.take()->deleteLater();
+    }
+}
+
+QStringList CTestSuite::readDeclarations(TopDUContext* topContext)
+{
+    QStringList cases;
     Declaration* testClass = nullptr;
 
     const auto mainId = Identifier(QStringLiteral("main"));
@@ -161,8 +220,8 @@ void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop:
 
     if (!testClass || !testClass->internalContext())
     {
-        qCDebug(CMAKE) << "No test class found or internal context missing in " << document.str();
-        return;
+        qCDebug(CMAKE) << "No test class found or internal context missing in " << topContext->url().str();
+        return cases;
     }
 
     if (!m_suiteDeclaration.data())
@@ -188,7 +247,7 @@ void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop:
                 if (name != QLatin1String("initTestCase") && name != QLatin1String("cleanupTestCase")
                     && name != QLatin1String("init") && name != QLatin1String("cleanup"))
                 {
-                    m_cases << name;
+                    cases << name;
                 }
                 qCDebug(CMAKE) << "Found test case function declaration" << function->identifier().toString();
 
@@ -197,6 +256,7 @@ void CTestSuite::loadDeclarations(const IndexedString& document, const KDevelop:
             }
         }
     }
+    return cases;
 }
 
 KJob* CTestSuite::launchCase(const QString& testCase, TestJobVerbosity verbosity)
@@ -266,3 +326,17 @@ QHash<QString, QString> CTestSuite::properties() const
 {
     return m_properties;
 }
+
+bool CTestSuite::runsSerially() const
+{
+    // CMake treats all of these as true, see if()
+    static const QStringList trueValues{
+        QStringLiteral("1"), QStringLiteral("ON"), QStringLiteral("YES"), QStringLiteral("TRUE"), QStringLiteral("Y")
+    };
+    return trueValues.contains(m_properties.value(QStringLiteral("RUN_SERIAL")), Qt::CaseInsensitive);
+}
+
+QStringList CTestSuite::resourceLocks() const
+{
+    return m_properties.value(QStringLiteral("RESOURCE_LOCK")).split(QLatin1Char(';'), QString::SkipEmptyParts);
+}
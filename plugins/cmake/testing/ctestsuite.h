@@ -24,9 +24,13 @@
 #include <language/duchain/indexeddeclaration.h>
 #include <util/path.h>
 #include <QHash>
+#include <QScopedPointer>
+
+class QObject;
 
 namespace KDevelop {
 class ReferencedTopDUContext;
+class TopDUContext;
 }
 
 class CTestSuite : public KDevelop::ITestSuite
@@ -47,14 +51,26 @@ public:
     KDevelop::IndexedDeclaration declaration() const override;
     KDevelop::IndexedDeclaration caseDeclaration(const QString& testCase) const override;
 
+    bool runsSerially() const override;
+    QStringList resourceLocks() const override;
+
     virtual QHash<QString, QString> properties() const;
 
     QStringList arguments() const;
     void setTestCases(const QStringList& cases);
     QList<KDevelop::Path> sourceFiles() const;
     void loadDeclarations(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
+    /// Reads the declarations from the already parsed source files, and from the source files
+    /// once they get parsed, when the test cases were found without the DUChain.
+    void loadDeclarationsWhenParsed();
 
 private:
+    /// Reads the declarations of the test class in @p topContext.
+    /// @return the names of the test cases
+    /// @note DU CHAIN MUST BE LOCKED FOR READ
+    QStringList readDeclarations(KDevelop::TopDUContext* topContext);
+    void sourceFileParsed(const KDevelop::IndexedString& document, const KDevelop::ReferencedTopDUContext& context);
+
     KDevelop::Path m_executable;
     QString m_name;
     QStringList m_cases;
@@ -65,6 +81,8 @@ private:
     QHash<QString, KDevelop::IndexedDeclaration> m_declarations;
     QHash<QString, QString> m_properties;
     KDevelop::IndexedDeclaration m_suiteDeclaration;
+    /// Receives the parsed source files while the declarations are not found yet
+    QScopedPointer<QObject> m_parsedFilesReceiver;
 };
 
 #endif // CTESTSUITE_H
@@ -0,0 +1,124 @@
+/* This file is part of KDevelop
+
+    Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include <QTest>
+#include <QObject>
+#include <QBuffer>
+
+#include <cmakecompilecommands.h>
+#include <cmakeprojectdata.h>
+
+using namespace KDevelop;
+
+class TestCMakeCompileCommands : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testReader_data()
+    {
+        QTest::addColumn<QByteArray>("document");
+        QTest::addColumn<QList<QByteArray>>("elements");
+        QTest::addColumn<bool>("hasError");
+
+        QTest::newRow("empty") << QByteArray("[]") << QList<QByteArray>() << false;
+        QTest::newRow("whitespace") << QByteArray(" \n[ \t]\n") << QList<QByteArray>() << false;
+        QTest::newRow("objects") << QByteArray("[{\"a\": 1},\n {\"b\": [1, 2]}]")
+                                 << QList<QByteArray>{"{\"a\": 1}", "{\"b\": [1, 2]}"} << false;
+        QTest::newRow("strings") << QByteArray(R"([{"a": "}],{[\""}, {"b": "\\"}])")
+                                 << QList<QByteArray>{R"({"a": "}],{[\""})", R"({"b": "\\"})"} << false;
+        QTest::newRow("scalars") << QByteArray("[1, \"x\"]") << QList<QByteArray>{"1", "\"x\""} << false;
+        QTest::newRow("no-array") << QByteArray("{}") << QList<QByteArray>() << true;
+        QTest::newRow("unterminated") << QByteArray("[{\"a\": 1}") << QList<QByteArray>{"{\"a\": 1}"} << true;
+        QTest::newRow("unterminated-element") << QByteArray("[{\"a\": 1") << QList<QByteArray>() << true;
+        QTest::newRow("missing-separator") << QByteArray("[{} {}]") << QList<QByteArray>{"{}"} << true;
+    }
+
+    void testReader()
+    {
+        QFETCH(QByteArray, document);
+        QFETCH(QList<QByteArray>, elements);
+        QFETCH(bool, hasError);
+
+        // use tiny chunks to exercise the buffer refilling in every possible position
+        for (int chunkSize : {1, 2, 3, 1024}) {
+            QBuffer buffer(&document);
+            QVERIFY(buffer.open(QIODevice::ReadOnly));
+            CMake::CompileCommands::JsonArrayReader reader(&buffer, chunkSize);
+
+            QList<QByteArray> readElements;
+            QByteArray element;
+            while (reader.readNext(&element)) {
+                readElements.append(element);
+            }
+            QCOMPARE(readElements, elements);
+            QCOMPARE(reader.hasError(), hasError);
+        }
+    }
+
+    void testParse()
+    {
+        QByteArray document = "[";
+        const int numFiles = 1000;
+        for (int i = 0; i < numFiles; ++i) {
+            if (i > 0) {
+                document += ",\n";
+            }
+            // two distinct sets of compile settings
+            const QByteArray define = (i % 2) ? "-DODD" : "-DEVEN=1";
+            document += "{\"directory\": \"/build\", \"command\": \"/usr/bin/c++ -I/src/include -Irelative "
+                      + define + " -o foo" + QByteArray::number(i) + ".o -c /src/foo" + QByteArray::number(i)
+                      + ".cpp\", \"file\": \"/src/foo" + QByteArray::number(i) + ".cpp\"}";
+        }
+        document += "]";
+
+        QBuffer buffer(&document);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        const auto data = CMake::CompileCommands::parse(&buffer);
+        QVERIFY(data.isValid);
+        QCOMPARE(data.files.size(), numFiles);
+
+        const auto even = data.files.value(Path(QStringLiteral("/src/foo0.cpp")));
+        QCOMPARE(even.includes, (Path::List{Path(QStringLiteral("/src/include")), Path(QStringLiteral("/build/relative"))}));
+        QCOMPARE(even.defines.value(QStringLiteral("EVEN")), QStringLiteral("1"));
+        QVERIFY(!even.defines.contains(QStringLiteral("ODD")));
+
+        const auto odd = data.files.value(Path(QStringLiteral("/src/foo1.cpp")));
+        QVERIFY(odd.defines.contains(QStringLiteral("ODD")));
+
+        // identical settings are shared between the files
+        const auto otherEven = data.files.value(Path(QStringLiteral("/src/foo998.cpp")));
+        QCOMPARE(otherEven, even);
+        QCOMPARE(otherEven.includes.constData(), even.includes.constData());
+    }
+
+    void testParseInvalid()
+    {
+        QByteArray document = "[{\"directory\": \"/build\", \"command\": \"c++\", \"file\": \"/src/foo.cpp\"}, {\"broken\"}]";
+        QBuffer buffer(&document);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        const auto data = CMake::CompileCommands::parse(&buffer);
+        QVERIFY(!data.isValid);
+        QVERIFY(data.files.isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestCMakeCompileCommands)
+#include "test_cmakecompilecommands.moc"
@@ -34,6 +34,7 @@
 #include <interfaces/iproject.h>
 #include <interfaces/ibuildsystemmanager.h>
 #include <interfaces/iprojectbuilder.h>
+#include <testing/ctestfindjob.h>
 #include <testing/ctestsuite.h>
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
@@ -158,4 +159,60 @@ void TestCTestFindSuites::testQtTestCases()
     }
 }
 
+void TestCTestFindSuites::testDeclarationsOfListedCases()
+{
+    IProject* project = loadProject( "unit_tests_kde" );
+    QVERIFY2(project, "Project was not opened");
+
+    QSignalSpy spy(ICore::self()->testController(), &ITestController::testSuiteAdded);
+    QVERIFY(spy.isValid());
+    QVERIFY(spy.wait(30 * 1000));
+
+    const QList<ITestSuite*> suites = ICore::self()->testController()->testSuitesForProject(project);
+    QCOMPARE(suites.size(), 1);
+    const auto* parsedSuite = static_cast<CTestSuite*>(suites.first());
+
+    // the cases of a suite listed by its executable, the sources are parsed already
+    CTestSuite suite(parsedSuite->name(), parsedSuite->executable(), parsedSuite->sourceFiles(), project,
+                     parsedSuite->arguments(), parsedSuite->properties());
+    suite.setTestCases(parsedSuite->cases());
+    QVERIFY(!suite.declaration().isValid());
+    QVERIFY(!suite.caseDeclaration(QStringLiteral("passingTestCase")).isValid());
+
+    suite.loadDeclarationsWhenParsed();
+
+    DUChainReadLocker locker(DUChain::lock());
+    QCOMPARE(suite.declaration(), parsedSuite->declaration());
+    const auto caseNames = suite.cases();
+    for (const auto& caseName : caseNames) {
+        QCOMPARE(suite.caseDeclaration(caseName), parsedSuite->caseDeclaration(caseName));
+    }
+}
+
+void TestCTestFindSuites::testParseFunctions_data()
+{
+    QTest::addColumn<QByteArray>("output");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<QStringList>("cases");
+
+    QTest::newRow("functions") << QByteArray("passingTestCase()\nfailingTestCase()\n") << true
+                               << QStringList{QStringLiteral("passingTestCase"), QStringLiteral("failingTestCase")};
+    QTest::newRow("whitespace") << QByteArray("  first()\r\n\nsecond()") << true
+                                << QStringList{QStringLiteral("first"), QStringLiteral("second")};
+    QTest::newRow("empty") << QByteArray() << true << QStringList();
+    QTest::newRow("test output") << QByteArray("********* Start testing of TestFoo *********\nPASS   : TestFoo::first()\n") << false << QStringList();
+    QTest::newRow("no name") << QByteArray("()\n") << false << QStringList();
+}
+
+void TestCTestFindSuites::testParseFunctions()
+{
+    QFETCH(QByteArray, output);
+    QFETCH(bool, valid);
+    QFETCH(QStringList, cases);
+
+    QStringList parsed;
+    QCOMPARE(CTestFindJob::parseFunctions(output, &parsed), valid);
+    QCOMPARE(parsed, cases);
+}
+
 QTEST_MAIN(TestCTestFindSuites)
@@ -36,6 +36,9 @@ private Q_SLOTS:
 
     void testCTestSuite();
     void testQtTestCases();
+    void testDeclarationsOfListedCases();
+    void testParseFunctions_data();
+    void testParseFunctions();
 };
 
 #endif
@@ -29,11 +29,13 @@
 
 #include <QAction>
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QLayout>
 #include <QMenu>
 #include <QTimer>
 #include <QToolButton>
 #include <QWidgetAction>
+#include <QtConcurrentRun>
 
 #include <KActionCollection>
 #include <KLocalizedString>
@@ -98,6 +100,9 @@ namespace {
 const unsigned int highlightingTimeout = 150;
 const float highlightingZDepth = -5000;
 const int maxHistoryLength = 30;
+// how long tool tips wait for the DUChain lock at once, before checking whether they are still wanted
+const unsigned int toolTipLockTimeout = 50;
+const int toolTipRetryDelay = 100;
 
 // Helper that determines the context to use for highlighting at a specific position
 DUContext* contextForHighlightingAt(const KTextEditor::Cursor& position, TopDUContext* topContext)
@@ -318,6 +323,9 @@ ContextBrowserPlugin::ContextBrowserPlugin(QObject* parent, const QVariantList&)
     connect(DUChain::self(), &DUChain::declarationSelected,
             this, &ContextBrowserPlugin::declarationSelectedInUI);
 
+    m_toolTipLookupPool.setMaxThreadCount(1);
+    m_toolTipRequest.reset(new QAtomicInt(0));
+
     m_updateTimer = new QTimer(this);
     m_updateTimer->setSingleShot(true);
     connect(m_updateTimer, &QTimer::timeout, this, &ContextBrowserPlugin::updateViews);
@@ -334,6 +342,9 @@ ContextBrowserPlugin::ContextBrowserPlugin(QObject* parent, const QVariantList&)
 
 ContextBrowserPlugin::~ContextBrowserPlugin()
 {
+    m_toolTipRequest->fetchAndAddOrdered(1);
+    m_toolTipLookupPool.waitForDone();
+
     for (auto* view : qAsConst(m_textHintProvidedViews)) {
         auto* iface = qobject_cast<KTextEditor::TextHintInterface*>(view);
         iface->unregisterTextHintProvider(&m_textHintProvider);
@@ -461,6 +472,9 @@ void ContextBrowserPlugin::startDelayedBrowsing(KTextEditor::View* view)
 
 void ContextBrowserPlugin::hideToolTip()
 {
+    // cancel pending lookups
+    m_toolTipRequest->fetchAndAddOrdered(1);
+
     if (m_currentToolTip) {
         m_currentToolTip->deleteLater();
         m_currentToolTip = nullptr;
@@ -470,7 +484,7 @@ void ContextBrowserPlugin::hideToolTip()
     }
 }
 
-static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(TopDUContext* topContext, KTextEditor::Cursor position,
+static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(const IndexedString& url, KTextEditor::Cursor position,
                                                                 KTextEditor::Range& handleRange)
 {
     QVector<KDevelop::IProblem::Ptr> problems;
@@ -478,7 +492,7 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(TopDUContext* to
 
     const auto modelsData = ICore::self()->languageController()->problemModelSet()->models();
     for (const auto& modelData : modelsData) {
-        const auto modelProblems = modelData.model->problems(topContext->url());
+        const auto modelProblems = modelData.model->problems(url);
         for (const auto& problem : modelProblems) {
             DocumentRange problemRange = problem->finalLocation();
             if (problemRange.contains(position) ||
@@ -497,7 +511,7 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(TopDUContext* to
     return problems;
 }
 
-static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const TopDUContext* topContext,
+static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const IndexedString& url,
                                                                   KTextEditor::Cursor position,
                                                                   KTextEditor::Range& handleRange)
 {
@@ -506,7 +520,7 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const TopDUCon
     QVector<KDevelop::IProblem::Ptr> allProblems;
     const auto modelsData = ICore::self()->languageController()->problemModelSet()->models();
     for (const auto& modelData : modelsData) {
-        const auto problems = modelData.model->problems(topContext->url());
+        const auto problems = modelData.model->problems(url);
         allProblems.reserve(allProblems.size() + problems.size());
         for (const auto& problem : problems) {
             allProblems += problem;
@@ -560,14 +574,55 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const TopDUCon
     return closestProblems;
 }
 
-QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* view, KTextEditor::Cursor position,
-                                                           KTextEditor::Range& itemRange)
+ContextBrowserPlugin::ToolTipLookup ContextBrowserPlugin::lookupToolTip(const QUrl& url, KTextEditor::Cursor position,
+                                                                     int request,
+                                                                     const QSharedPointer<QAtomicInt>& latestRequest)
+{
+    ToolTipLookup lookup;
+    lookup.request = request;
+
+    auto isCancelled = [&]() {
+        return latestRequest->loadAcquire() != request;
+    };
+
+    DUChainReadLocker lock(DUChain::lock(), toolTipLockTimeout);
+    while (!lock.locked() && !isCancelled()) {
+        lock.lock();
+    }
+    if (!lock.locked() || isCancelled()) {
+        lookup.cancelled = true;
+        return lookup;
+    }
+
+    TopDUContext* topContext = DUChainUtils::standardContextForUrl(url);
+    if (topContext) {
+        lookup.url = topContext->url();
+        lookup.topContext = IndexedTopDUContext(topContext);
+    }
+
+    // Find decl (declaration) under the cursor
+    const auto itemUnderCursor = DUChainUtils::itemUnderCursor(url, position);
+    auto declUnderCursor = itemUnderCursor.declaration;
+    Declaration* decl = DUChainUtils::declarationForDefinition(declUnderCursor);
+    if (decl && decl->kind() == Declaration::Alias) {
+        auto* alias = dynamic_cast<AliasDeclaration*>(decl);
+        Q_ASSERT(alias);
+        decl = alias->aliasedDeclaration().declaration();
+    }
+    if (decl) {
+        lookup.declaration = IndexedDeclaration(decl);
+        lookup.declarationRange = itemUnderCursor.range;
+    }
+
+    return lookup;
+}
+
+QWidget* ContextBrowserPlugin::navigationWidgetForLookup(KTextEditor::View* view, KTextEditor::Cursor position,
+                                                         const ToolTipLookup& lookup, KTextEditor::Range& itemRange)
 {
     QUrl viewUrl = view->document()->url();
     const auto languages = ICore::self()->languageController()->languagesForUrl(viewUrl);
 
-    DUChainReadLocker lock(DUChain::lock());
-
     for (const auto language : languages) {
         auto widget = language->specialLanguageObjectNavigationWidget(viewUrl, position);
         auto navigationWidget = qobject_cast<AbstractNavigationWidget*>(widget.first);
@@ -578,26 +633,19 @@ QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* vi
     }
 
     // Find problems under the cursor (first pass)
-    TopDUContext* topContext = DUChainUtils::standardContextForUrl(view->document()->url());
+    TopDUContext* topContext = lookup.topContext.data();
     QVector<KDevelop::IProblem::Ptr> problems;
     if (topContext) {
-        problems = findProblemsUnderCursor(topContext, position, itemRange);
+        problems = findProblemsUnderCursor(lookup.url, position, itemRange);
     }
 
-    // Find decl (declaration) under the cursor
-    const auto itemUnderCursor = DUChainUtils::itemUnderCursor(viewUrl, position);
-    auto declUnderCursor = itemUnderCursor.declaration;
-    Declaration* decl = DUChainUtils::declarationForDefinition(declUnderCursor);
-    if (decl && decl->kind() == Declaration::Alias) {
-        auto* alias = dynamic_cast<AliasDeclaration*>(decl);
-        Q_ASSERT(alias);
-        decl = alias->aliasedDeclaration().declaration();
-    }
+    // The declaration may have been deleted since it was looked up
+    Declaration* decl = lookup.declaration.data();
 
     // Return nullptr if the found problems / decl are already being shown in the tool tip currently.
     if (m_currentToolTip &&
         problems == m_currentToolTipProblems &&
-        IndexedDeclaration(decl) == m_currentToolTipDeclaration) {
+        lookup.declaration == m_currentToolTipDeclaration) {
         return nullptr;
     }
 
@@ -615,11 +663,11 @@ QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* vi
     AbstractNavigationWidget* declWidget = nullptr;
     if (decl) {
         if (itemRange.isValid()) {
-            itemRange.expandToRange(itemUnderCursor.range);
+            itemRange.expandToRange(lookup.declarationRange);
         } else {
-            itemRange = itemUnderCursor.range;
+            itemRange = lookup.declarationRange;
         }
-        declWidget = decl->context()->createNavigationWidget(decl, DUChainUtils::standardContextForUrl(viewUrl));
+        declWidget = decl->context()->createNavigationWidget(decl, topContext);
     }
 
     // If at least one widget was created for problems or decl, show it.
@@ -644,7 +692,7 @@ QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* vi
     // Nothing has been found so far which created a widget.
     // Thus, find the closest problem to the cursor in a second pass.
     if (topContext) {
-        problems = findProblemsCloseToCursor(topContext, position, itemRange);
+        problems = findProblemsCloseToCursor(lookup.url, position, itemRange);
         if (!problems.isEmpty()) {
             // Return nullptr if the correct contents are already being shown in the tool tip currently.
             if (m_currentToolTip &&
@@ -677,49 +725,92 @@ void ContextBrowserPlugin::showToolTip(KTextEditor::View* view, KTextEditor::Cur
     if (contextView && contextView->isVisible() && !contextView->isLocked())
         return; // If the context-browser view is visible, it will care about updating by itself
 
+    // Starting a new lookup makes all pending ones stale, only the latest position is of interest
+    const int request = m_toolTipRequest->fetchAndAddOrdered(1) + 1;
+    m_toolTipView = view;
+    m_toolTipPosition = position;
+
+    auto* watcher = new QFutureWatcher<ToolTipLookup>(this);
+    connect(watcher, &QFutureWatcher<ToolTipLookup>::finished, this, [this, watcher]() {
+        toolTipLookupFinished(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&m_toolTipLookupPool, &ContextBrowserPlugin::lookupToolTip,
+                                         view->document()->url(), position, request, m_toolTipRequest));
+}
+
+void ContextBrowserPlugin::toolTipLookupFinished(const ToolTipLookup& lookup)
+{
+    if (lookup.cancelled || lookup.request != m_toolTipRequest->loadAcquire() || !m_toolTipView)
+        return;
+
+    KTextEditor::View* view = m_toolTipView;
+    const KTextEditor::Cursor position = m_toolTipPosition;
+
+    // Creating the widgets needs the lock as well, rather look up again later than blocking the UI
+    DUChainReadLocker lock(DUChain::lock(), toolTipLockTimeout);
+    if (!lock.locked()) {
+        const int request = lookup.request;
+        QTimer::singleShot(toolTipRetryDelay, this, [this, request]() {
+            if (m_toolTipView && m_toolTipRequest->loadAcquire() == request) {
+                showToolTip(m_toolTipView, m_toolTipPosition);
+            }
+        });
+        return;
+    }
+
     KTextEditor::Range itemRange = KTextEditor::Range::invalid();
-    auto navigationWidget = navigationWidgetForPosition(view, position, itemRange);
+    auto navigationWidget = navigationWidgetForLookup(view, position, lookup, itemRange);
+    lock.unlock();
+
     if (navigationWidget) {
-        // If we have an invisible context-view, assign the tooltip navigation-widget to it.
-        // If the user makes the context-view visible, it will instantly contain the correct widget.
-        if (contextView && !contextView->isLocked())
-            contextView->setNavigationWidget(navigationWidget);
-
-        if (m_currentToolTip) {
-            m_currentToolTip->deleteLater();
-            m_currentToolTip = nullptr;
-            m_currentNavigationWidget = nullptr;
-        }
+        showNavigationToolTip(view, position, navigationWidget, itemRange);
+    } else {
+        qCDebug(PLUGIN_CONTEXTBROWSER) << "not showing tooltip, no navigation-widget";
+    }
+}
 
-        auto* tooltip =
-            new KDevelop::NavigationToolTip(view, view->mapToGlobal(view->cursorToCoordinate(position)) + QPoint(20,
-                                                                                                                 40),
-                                            navigationWidget);
-        if (!itemRange.isValid()) {
-            qCWarning(PLUGIN_CONTEXTBROWSER) << "Got navigationwidget with invalid itemrange";
-            itemRange = KTextEditor::Range(position, 0);
-        }
+void ContextBrowserPlugin::showNavigationToolTip(KTextEditor::View* view, KTextEditor::Cursor position,
+                                                 QWidget* navigationWidget, KTextEditor::Range itemRange)
+{
+    // If we have an invisible context-view, assign the tooltip navigation-widget to it.
+    // If the user makes the context-view visible, it will instantly contain the correct widget.
+    ContextBrowserView* contextView = browserViewForWidget(view);
+    if (contextView && !contextView->isLocked())
+        contextView->setNavigationWidget(navigationWidget);
 
-        tooltip->setHandleRect(KTextEditorHelpers::itemBoundingRect(view, itemRange));
-        tooltip->resize(navigationWidget->sizeHint() + QSize(10, 10));
-        QObject::connect(view, &KTextEditor::View::verticalScrollPositionChanged,
-                         this, &ContextBrowserPlugin::hideToolTip);
-        QObject::connect(view, &KTextEditor::View::horizontalScrollPositionChanged,
-                         this, &ContextBrowserPlugin::hideToolTip);
-        qCDebug(PLUGIN_CONTEXTBROWSER) << "tooltip size" << tooltip->size();
-        m_currentToolTip = tooltip;
-        m_currentNavigationWidget = navigationWidget;
-        ActiveToolTip::showToolTip(tooltip);
-
-        if (!navigationWidget->property("DoNotCloseOnCursorMove").toBool()) {
-            connect(view, &View::cursorPositionChanged,
-                    this, &ContextBrowserPlugin::hideToolTip, Qt::UniqueConnection);
-        } else {
-            disconnect(view, &View::cursorPositionChanged,
-                       this, &ContextBrowserPlugin::hideToolTip);
-        }
+    if (m_currentToolTip) {
+        m_currentToolTip->deleteLater();
+        m_currentToolTip = nullptr;
+        m_currentNavigationWidget = nullptr;
+    }
+
+    auto* tooltip =
+        new KDevelop::NavigationToolTip(view, view->mapToGlobal(view->cursorToCoordinate(position)) + QPoint(20,
+                                                                                                             40),
+                                        navigationWidget);
+    if (!itemRange.isValid()) {
+        qCWarning(PLUGIN_CONTEXTBROWSER) << "Got navigationwidget with invalid itemrange";
+        itemRange = KTextEditor::Range(position, 0);
+    }
+
+    tooltip->setHandleRect(KTextEditorHelpers::itemBoundingRect(view, itemRange));
+    tooltip->resize(navigationWidget->sizeHint() + QSize(10, 10));
+    QObject::connect(view, &KTextEditor::View::verticalScrollPositionChanged,
+                     this, &ContextBrowserPlugin::hideToolTip);
+    QObject::connect(view, &KTextEditor::View::horizontalScrollPositionChanged,
+                     this, &ContextBrowserPlugin::hideToolTip);
+    qCDebug(PLUGIN_CONTEXTBROWSER) << "tooltip size" << tooltip->size();
+    m_currentToolTip = tooltip;
+    m_currentNavigationWidget = navigationWidget;
+    ActiveToolTip::showToolTip(tooltip);
+
+    if (!navigationWidget->property("DoNotCloseOnCursorMove").toBool()) {
+        connect(view, &View::cursorPositionChanged,
+                this, &ContextBrowserPlugin::hideToolTip, Qt::UniqueConnection);
     } else {
-        qCDebug(PLUGIN_CONTEXTBROWSER) << "not showing tooltip, no navigation-widget";
+        disconnect(view, &View::cursorPositionChanged,
+                   this, &ContextBrowserPlugin::hideToolTip);
     }
 }
 
@@ -822,7 +913,7 @@ ContextBrowserView* ContextBrowserPlugin::browserViewForWidget(QWidget* widget)
     return (it != m_views.end()) ? *it : nullptr;
 }
 
-void ContextBrowserPlugin::updateForView(View* view)
+bool ContextBrowserPlugin::updateForView(View* view)
 {
     bool allowHighlight = true;
     if (view->selection()) {
@@ -834,7 +925,7 @@ void ContextBrowserPlugin::updateForView(View* view)
 
     if (m_highlightedRanges[view].keep) {
         m_highlightedRanges[view].keep = false;
-        return;
+        return true;
     }
 
     // Clear all highlighting
@@ -863,7 +954,7 @@ void ContextBrowserPlugin::updateForView(View* view)
 
     if (ICore::self()->languageController()->languagesForUrl(url).isEmpty()) {
         qCDebug(PLUGIN_CONTEXTBROWSER) << "found no language for document" << url;
-        return;
+        return true;
     } else {
         language = ICore::self()->languageController()->languagesForUrl(url).front();
     }
@@ -888,15 +979,15 @@ void ContextBrowserPlugin::updateForView(View* view)
         KDevelop::DUChainReadLocker lock(DUChain::lock(), 100);
         if (!lock.locked()) {
             qCDebug(PLUGIN_CONTEXTBROWSER) << "Failed to lock du-chain in time";
-            return;
+            return false;
         }
 
         TopDUContext* topContext = DUChainUtils::standardContextForUrl(view->document()->url());
         if (!topContext)
-            return;
+            return true;
         DUContext* ctx = contextForHighlightingAt(highlightPosition, topContext);
         if (!ctx)
-            return;
+            return true;
 
         //Only update the history if this context is around the text cursor
         if (core()->documentController()->activeDocument() &&
@@ -919,16 +1010,25 @@ void ContextBrowserPlugin::updateForView(View* view)
                 updateBrowserView->setContext(ctx);
         }
     }
+    return true;
 }
 
 void ContextBrowserPlugin::updateViews()
 {
+    QSet<View*> pendingViews;
     for (View* view : qAsConst(m_updateViews)) {
-        updateForView(view);
+        if (!updateForView(view)) {
+            pendingViews.insert(view);
+        }
     }
 
-    m_updateViews.clear();
-    m_useDeclaration = IndexedDeclaration();
+    // Don't block the UI while parse jobs hold the DUChain, try again later instead
+    m_updateViews = pendingViews;
+    if (m_updateViews.isEmpty()) {
+        m_useDeclaration = IndexedDeclaration();
+    } else {
+        m_updateTimer->start(highlightingTimeout);
+    }
 }
 
 void ContextBrowserPlugin::declarationSelectedInUI(const DeclarationPointer& decl)
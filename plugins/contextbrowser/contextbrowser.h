@@ -29,12 +29,15 @@
 #include <QList>
 #include <QUrl>
 #include <QPointer>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 #include <KTextEditor/TextHintInterface>
 #include <interfaces/iplugin.h>
 #include <language/duchain/duchainpointer.h>
 #include <language/duchain/declaration.h>
 #include <language/duchain/indexedducontext.h>
+#include <language/duchain/indexedtopducontext.h>
 #include <language/duchain/problem.h>
 #include <language/editor/persistentmovingrange.h>
 #include <language/interfaces/iquickopen.h>
@@ -182,8 +185,26 @@ private:
     QWidget* toolbarWidgetForMainWindow(Sublime::MainWindow* window);
     void createActionsForMainWindow(Sublime::MainWindow* window, QString& xmlFile,
                                     KActionCollection& actions) override;
-    QWidget* navigationWidgetForPosition(KTextEditor::View* view, KTextEditor::Cursor position,
-                                         KTextEditor::Range& itemRange);
+
+    /// What is under the mouse, looked up in a background thread so hovering never waits for the DUChain lock
+    struct ToolTipLookup
+    {
+        int request = 0;
+        bool cancelled = false;
+        KDevelop::IndexedString url;
+        KDevelop::IndexedTopDUContext topContext;
+        KDevelop::IndexedDeclaration declaration;
+        KTextEditor::Range declarationRange = KTextEditor::Range::invalid();
+    };
+    /// Runs in the tool tip lookup thread, gives up as soon as @p request isn't the latest one anymore
+    static ToolTipLookup lookupToolTip(const QUrl& url, KTextEditor::Cursor position, int request,
+                                       const QSharedPointer<QAtomicInt>& latestRequest);
+    void toolTipLookupFinished(const ToolTipLookup& lookup);
+    /// @note DU CHAIN MUST BE LOCKED FOR READ
+    QWidget* navigationWidgetForLookup(KTextEditor::View* view, KTextEditor::Cursor position,
+                                       const ToolTipLookup& lookup, KTextEditor::Range& itemRange);
+    void showNavigationToolTip(KTextEditor::View* view, KTextEditor::Cursor position, QWidget* navigationWidget,
+                               KTextEditor::Range itemRange);
     void switchUse(bool forward);
     void clearMouseHover();
 
@@ -193,7 +214,8 @@ private:
      *  Tries to find a 'specialLanguageObject' (eg macro) in @p view under cursor @c.
      *  If found returns true and sets @p pickedLanguage to the language this object belongs to */
     KDevelop::Declaration* findDeclaration(KTextEditor::View* view, const KTextEditor::Cursor&, bool mouseHighlight);
-    void updateForView(KTextEditor::View* view);
+    /// @return false if the DUChain could not be locked in time and the view has to be updated later
+    bool updateForView(KTextEditor::View* view);
 
     // history browsing
     bool isPreviousEntry(KDevelop::DUContext*, const KTextEditor::Cursor& cursor) const;
@@ -241,6 +263,11 @@ private:
     QPointer<QWidget> m_currentNavigationWidget;
     KDevelop::IndexedDeclaration m_currentToolTipDeclaration;
     QVector<KDevelop::IProblem::Ptr> m_currentToolTipProblems;
+    // tool tip lookups, only the latest request is shown
+    QThreadPool m_toolTipLookupPool;
+    QSharedPointer<QAtomicInt> m_toolTipRequest;
+    QPointer<KTextEditor::View> m_toolTipView;
+    KTextEditor::Cursor m_toolTipPosition;
     QAction* m_findUses;
 
     QPointer<KTextEditor::Document> m_lastInsertionDocument;
@@ -0,0 +1,188 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "compilerprobecache.h"
+
+#include <interfaces/iruntime.h>
+#include <util/path.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <debug.h>
+
+using namespace KDevelop;
+
+namespace
+{
+/// Bump when the stored format changes, or the probes are run differently
+const quint32 cacheVersion = 1;
+
+/// The environment variables which change the builtin defines and include paths reported by GCC and Clang
+const char* const compilerEnvironmentVariables[] = {
+    "PATH", "CPATH", "C_INCLUDE_PATH", "CPLUS_INCLUDE_PATH", "OBJC_INCLUDE_PATH",
+    "GCC_EXEC_PREFIX", "COMPILER_PATH", "SDKROOT", "MACOSX_DEPLOYMENT_TARGET",
+};
+}
+
+CompilerProbeCache::CompilerProbeCache(const QString& directory)
+    : m_directory(directory)
+{
+}
+
+CompilerProbeCache* CompilerProbeCache::self()
+{
+    static CompilerProbeCache cache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                                    + QLatin1String("/compilerprobes"));
+    return &cache;
+}
+
+QString CompilerProbeCache::key(const IRuntime* runtime, const QString& executable, const QStringList& arguments)
+{
+    const QString runtimeExecutable = runtime->findExecutable(executable);
+    if (runtimeExecutable.isEmpty()) {
+        return {};
+    }
+
+    const QFileInfo binary(runtime->pathInHost(Path(runtimeExecutable)).toLocalFile());
+    const QString canonicalPath = binary.canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        return {};
+    }
+
+    // the path the compiler is run with matters as well, e.g. clang++ is a symlink to clang
+    QStringList parts{
+        runtime->name(),
+        executable,
+        runtimeExecutable,
+        canonicalPath,
+        QString::number(binary.size()),
+        QString::number(binary.lastModified().toMSecsSinceEpoch()),
+        arguments.join(QLatin1Char(' ')),
+    };
+    for (const char* variable : compilerEnvironmentVariables) {
+        parts << QString::fromLatin1(variable) + QLatin1Char('=') + QString::fromLocal8Bit(runtime->getenv(variable));
+    }
+    return parts.join(QLatin1Char('\n'));
+}
+
+bool CompilerProbeCache::output(const QString& key, const Probe& probe, QByteArray* output)
+{
+    if (key.isEmpty()) {
+        return probe(output);
+    }
+
+    QMutexLocker lock(&m_mutex);
+
+    bool waited = false;
+    while (m_runningProbes.contains(key)) {
+        m_probeFinished.wait(&m_mutex);
+        waited = true;
+    }
+
+    auto it = m_outputs.constFind(key);
+    if (it != m_outputs.constEnd()) {
+        *output = *it;
+        return true;
+    }
+    if (waited) {
+        // the probe we waited for failed, don't retry it over and over again
+        return false;
+    }
+
+    m_runningProbes.insert(key);
+    lock.unlock();
+
+    bool success = load(key, output);
+    if (!success) {
+        success = probe(output);
+        if (success) {
+            store(key, *output);
+        }
+    }
+
+    lock.relock();
+    if (success) {
+        m_outputs.insert(key, *output);
+    }
+    m_runningProbes.remove(key);
+    m_probeFinished.wakeAll();
+    return success;
+}
+
+void CompilerProbeCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_outputs.clear();
+    QDir(m_directory).removeRecursively();
+}
+
+QString CompilerProbeCache::fileName(const QString& key) const
+{
+    const auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(hash.toHex());
+}
+
+bool CompilerProbeCache::load(const QString& key, QByteArray* output) const
+{
+    QFile file(fileName(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    QString storedKey;
+    QByteArray storedOutput;
+    stream >> version >> storedKey >> storedOutput;
+    if (stream.status() != QDataStream::Ok || version != cacheVersion || storedKey != key) {
+        return false;
+    }
+
+    *output = storedOutput;
+    return true;
+}
+
+void CompilerProbeCache::store(const QString& key, const QByteArray& output) const
+{
+    if (!QDir().mkpath(m_directory)) {
+        qCWarning(DEFINESANDINCLUDES) << "failed to create compiler probe cache directory" << m_directory;
+        return;
+    }
+
+    QSaveFile file(fileName(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(DEFINESANDINCLUDES) << "failed to write compiler probe cache" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << cacheVersion << key << output;
+    file.commit();
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMPILERPROBECACHE_H
+#define COMPILERPROBECACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QWaitCondition>
+
+#include <functional>
+
+namespace KDevelop
+{
+class IRuntime;
+}
+
+/**
+ * Caches the output of probing a compiler for its builtin defines and include paths.
+ *
+ * Results are stored on disk, so they survive restarts, and are keyed on the identity of the
+ * compiler binary (its path, size and modification time), the path it is run with, the runtime
+ * it is run in, the environment variables affecting its search paths and the arguments passed
+ * to it. Replacing the compiler thus automatically invalidates its results.
+ *
+ * Concurrent requests for the same key share a single probe: the first caller runs it while
+ * all others wait for its result.
+ *
+ * This class is thread safe.
+ */
+class CompilerProbeCache
+{
+public:
+    /// Creates a cache storing its results in @p directory
+    explicit CompilerProbeCache(const QString& directory);
+
+    /// @return the cache shared by all compilers
+    static CompilerProbeCache* self();
+
+    /**
+     * @return the key for running @p executable with @p arguments in @p runtime,
+     *         or an empty string when the binary can't be found, in which case nothing is cached
+     */
+    static QString key(const KDevelop::IRuntime* runtime, const QString& executable, const QStringList& arguments);
+
+    /// Runs the probe and stores its output, returns false if it failed
+    using Probe = std::function<bool(QByteArray* output)>;
+
+    /**
+     * Retrieve the output for @p key, either from the cache or by running @p probe.
+     *
+     * Failed probes are not cached, but are reported to all callers waiting for them.
+     *
+     * @return false if the probe failed
+     */
+    bool output(const QString& key, const Probe& probe, QByteArray* output);
+
+    /// Drops all results, both in memory and on disk
+    void clear();
+
+private:
+    QString fileName(const QString& key) const;
+    bool load(const QString& key, QByteArray* output) const;
+    void store(const QString& key, const QByteArray& output) const;
+
+    const QString m_directory;
+
+    QMutex m_mutex;
+    QWaitCondition m_probeFinished;
+    QHash<QString, QByteArray> m_outputs;
+    QSet<QString> m_runningProbes;
+};
+
+#endif // COMPILERPROBECACHE_H
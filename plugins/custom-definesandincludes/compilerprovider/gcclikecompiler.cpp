@@ -23,10 +23,13 @@
 
 #include "gcclikecompiler.h"
 
+#include "compilerprobecache.h"
+
 #include <QFileInfo>
 #include <QProcess>
 #include <QRegularExpression>
 #include <QMap>
+#include <QMutexLocker>
 #include <interfaces/iruntime.h>
 #include <interfaces/iruntimecontroller.h>
 
@@ -86,9 +89,12 @@ QString languageStandard(const QString& arguments, Utils::LanguageType type)
 
 Defines GccLikeCompiler::defines(Utils::LanguageType type, const QString& arguments) const
 {
-    auto& data = m_definesIncludes[type][arguments];
-    if (!data.definedMacros.isEmpty() ) {
-        return data.definedMacros;
+    {
+        QMutexLocker lock(&m_mutex);
+        const auto& data = m_definesIncludes[type][arguments];
+        if (!data.definedMacros.isEmpty() ) {
+            return data.definedMacros;
+        }
     }
 
     // #define a 1
@@ -96,8 +102,6 @@ Defines GccLikeCompiler::defines(Utils::LanguageType type, const QString& argume
     QRegExp defineExpression(QStringLiteral("#define\\s+(\\S+)(?:\\s+(.*)\\s*)?"));
 
     const auto rt = ICore::self()->runtimeController()->currentRuntime();
-    QProcess proc;
-    proc.setProcessChannelMode( QProcess::MergedChannels );
 
     // TODO: what about -mXXX or -target= flags, some of these change search paths/defines
     const QStringList compilerArguments{
@@ -107,42 +111,58 @@ Defines GccLikeCompiler::defines(Utils::LanguageType type, const QString& argume
         QStringLiteral("-E"),
         QStringLiteral("-"),
     };
-    proc.setStandardInputFile(QProcess::nullDevice());
-    proc.setProgram(path());
-    proc.setArguments(compilerArguments);
-    rt->startProcess(&proc);
 
-    if ( !proc.waitForStarted( 2000 ) || !proc.waitForFinished( 2000 ) ) {
-        qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard macro definitions from "<< path() << compilerArguments;
-        return {};
-    }
+    QByteArray probeOutput;
+    const auto key = CompilerProbeCache::key(rt, path(), compilerArguments);
+    const bool success = CompilerProbeCache::self()->output(key, [&](QByteArray* output) {
+        QProcess proc;
+        proc.setProcessChannelMode( QProcess::MergedChannels );
+        proc.setStandardInputFile(QProcess::nullDevice());
+        proc.setProgram(path());
+        proc.setArguments(compilerArguments);
+        rt->startProcess(&proc);
+
+        if ( !proc.waitForStarted( 2000 ) || !proc.waitForFinished( 2000 ) ) {
+            qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard macro definitions from "<< path() << compilerArguments;
+            return false;
+        }
+
+        if (proc.exitCode() != 0) {
+            qCWarning(DEFINESANDINCLUDES) <<  "error while fetching defines for the compiler:" << path() << compilerArguments << proc.readAll();
+            return false;
+        }
 
-    if (proc.exitCode() != 0) {
-        qCWarning(DEFINESANDINCLUDES) <<  "error while fetching defines for the compiler:" << path() << compilerArguments << proc.readAll();
+        *output = proc.readAll();
+        return true;
+    }, &probeOutput);
+    if (!success) {
         return {};
     }
 
-    while ( proc.canReadLine() ) {
-        auto line = proc.readLine();
-
+    Defines definedMacros;
+    const auto lines = probeOutput.split('\n');
+    for (const auto& line : lines) {
         if ( defineExpression.indexIn(QString::fromUtf8(line)) != -1 ) {
-            data.definedMacros[defineExpression.cap( 1 )] = defineExpression.cap( 2 ).trimmed();
+            definedMacros[defineExpression.cap( 1 )] = defineExpression.cap( 2 ).trimmed();
         }
     }
 
-    return data.definedMacros;
+    QMutexLocker lock(&m_mutex);
+    m_definesIncludes[type][arguments].definedMacros = definedMacros;
+    return definedMacros;
 }
 
 Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& arguments) const
 {
-    auto& data = m_definesIncludes[type][arguments];
-    if ( !data.includePaths.isEmpty() ) {
-        return data.includePaths;
+    {
+        QMutexLocker lock(&m_mutex);
+        const auto& data = m_definesIncludes[type][arguments];
+        if ( !data.includePaths.isEmpty() ) {
+            return data.includePaths;
+        }
     }
 
     const auto rt = ICore::self()->runtimeController()->currentRuntime();
-    QProcess proc;
-    proc.setProcessChannelMode( QProcess::MergedChannels );
 
     // The following command will spit out a bunch of information we don't care
     // about before spitting out the include paths.  The parts we care about
@@ -165,18 +185,30 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
         QStringLiteral("-"),
     };
 
-    proc.setStandardInputFile(QProcess::nullDevice());
-    proc.setProgram(path());
-    proc.setArguments(compilerArguments);
-    rt->startProcess(&proc);
+    QByteArray probeOutput;
+    const auto key = CompilerProbeCache::key(rt, path(), compilerArguments);
+    const bool success = CompilerProbeCache::self()->output(key, [&](QByteArray* output) {
+        QProcess proc;
+        proc.setProcessChannelMode( QProcess::MergedChannels );
+        proc.setStandardInputFile(QProcess::nullDevice());
+        proc.setProgram(path());
+        proc.setArguments(compilerArguments);
+        rt->startProcess(&proc);
 
-    if ( !proc.waitForStarted( 2000 ) || !proc.waitForFinished( 2000 ) ) {
-        qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard include paths from " << path();
-        return {};
-    }
+        if ( !proc.waitForStarted( 2000 ) || !proc.waitForFinished( 2000 ) ) {
+            qCDebug(DEFINESANDINCLUDES) <<  "Unable to read standard include paths from " << path();
+            return false;
+        }
+
+        if (proc.exitCode() != 0) {
+            qCWarning(DEFINESANDINCLUDES) <<  "error while fetching includes for the compiler:" << path() << proc.readAll();
+            return false;
+        }
 
-    if (proc.exitCode() != 0) {
-        qCWarning(DEFINESANDINCLUDES) <<  "error while fetching includes for the compiler:" << path() << proc.readAll();
+        *output = proc.readAllStandardOutput();
+        return true;
+    }, &probeOutput);
+    if (!success) {
         return {};
     }
 
@@ -189,7 +221,8 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
     };
     Status mode = Initial;
 
-    const auto output = QString::fromLocal8Bit( proc.readAllStandardOutput() );
+    Path::List includePaths;
+    const auto output = QString::fromLocal8Bit(probeOutput);
     const auto lines = output.splitRef(QLatin1Char('\n'));
     for (const auto& line : lines) {
         switch ( mode ) {
@@ -213,7 +246,7 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
                     auto hostPath = rt->pathInHost(Path(QFileInfo(line.trimmed().toString()).canonicalFilePath()));
                     // but skip folders with compiler builtins, we cannot parse these with clang
                     if (!QFile::exists(hostPath.toLocalFile() + QLatin1String("/cpuid.h"))) {
-                        data.includePaths << Path(QFileInfo(hostPath.toLocalFile()).canonicalFilePath());
+                        includePaths << Path(QFileInfo(hostPath.toLocalFile()).canonicalFilePath());
                     }
                 }
                 break;
@@ -225,11 +258,14 @@ Path::List GccLikeCompiler::includes(Utils::LanguageType type, const QString& ar
         }
     }
 
-    return data.includePaths;
+    QMutexLocker lock(&m_mutex);
+    m_definesIncludes[type][arguments].includePaths = includePaths;
+    return includePaths;
 }
 
 void GccLikeCompiler::invalidateCache()
 {
+    QMutexLocker lock(&m_mutex);
     m_definesIncludes.clear();
 }
 
@@ -26,6 +26,8 @@
 
 #include "icompiler.h"
 
+#include <QMutex>
+
 class GccLikeCompiler : public QObject, public ICompiler
 {
     Q_OBJECT
@@ -46,6 +48,8 @@ private:
 
     /// List of defines/includes per arguments
     mutable QHash<Utils::LanguageType, QHash<QString, DefinesIncludes>> m_definesIncludes;
+    /// Protects m_definesIncludes, the compiler is queried from the background parser threads
+    mutable QMutex m_mutex;
 };
 
 #endif // GCCLIKECOMPILER_H
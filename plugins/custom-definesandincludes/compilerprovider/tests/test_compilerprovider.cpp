@@ -24,20 +24,25 @@
 #include "test_compilerprovider.h"
 
 #include <QTest>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QSignalBlocker>
+#include <QThread>
+#include <QtConcurrentRun>
 
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
 
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
+#include <interfaces/iruntimecontroller.h>
 #include <project/projectmodel.h>
 
 #include <serialization/indexedstring.h>
 
 #include <algorithm>
 
+#include "../compilerprobecache.h"
 #include "../compilerprovider.h"
 #include "../settingsmanager.h"
 #include "../tests/projectsgenerator.h"
@@ -254,4 +259,111 @@ void TestCompilerProvider::testCompilerIncludesAndDefinesForProject()
     ICore::self()->projectController()->closeProject(project);
 }
 
+void TestCompilerProvider::testProbeCache()
+{
+    QTemporaryDir cacheDir;
+    QTemporaryDir binDir;
+    QVERIFY(cacheDir.isValid());
+    QVERIFY(binDir.isValid());
+
+    // only the identity of the compiler binary matters, it is never run here
+    const QString compilerPath = binDir.path() + QLatin1String("/cc");
+    {
+        QFile compiler(compilerPath);
+        QVERIFY(compiler.open(QIODevice::WriteOnly));
+        compiler.write("#!/bin/sh\n");
+        compiler.setPermissions(compiler.permissions() | QFileDevice::ExeOwner);
+    }
+
+    const auto runtime = ICore::self()->runtimeController()->currentRuntime();
+    const QStringList arguments{QStringLiteral("-dM"), QStringLiteral("-E")};
+    const auto key = CompilerProbeCache::key(runtime, compilerPath, arguments);
+    QVERIFY(!key.isEmpty());
+    QVERIFY(CompilerProbeCache::key(runtime, compilerPath, {QStringLiteral("-v")}) != key);
+    QVERIFY(CompilerProbeCache::key(runtime, binDir.path() + QLatin1String("/missing"), arguments).isEmpty());
+
+    // the same binary run by another name can behave differently
+    const QString linkPath = binDir.path() + QLatin1String("/c++");
+    QVERIFY(QFile::link(compilerPath, linkPath));
+    QVERIFY(CompilerProbeCache::key(runtime, linkPath, arguments) != key);
+
+    // so does the environment
+    const QByteArray oldCpath = qgetenv("CPATH");
+    qputenv("CPATH", binDir.path().toLocal8Bit());
+    const auto environmentKey = CompilerProbeCache::key(runtime, compilerPath, arguments);
+    if (oldCpath.isNull()) {
+        qunsetenv("CPATH");
+    } else {
+        qputenv("CPATH", oldCpath);
+    }
+    QVERIFY(environmentKey != key);
+    QCOMPARE(CompilerProbeCache::key(runtime, compilerPath, arguments), key);
+
+    const QByteArray expectedOutput("#define FOO 1\n");
+    int probes = 0;
+    auto probe = [&](QByteArray* output) {
+        ++probes;
+        *output = expectedOutput;
+        return true;
+    };
+
+    {
+        CompilerProbeCache cache(cacheDir.path());
+        QByteArray output;
+        QVERIFY(cache.output(key, probe, &output));
+        QCOMPARE(output, expectedOutput);
+        QVERIFY(cache.output(key, probe, &output));
+        QCOMPARE(output, expectedOutput);
+        QCOMPARE(probes, 1);
+    }
+
+    {
+        // the result survives a restart
+        CompilerProbeCache cache(cacheDir.path());
+        QByteArray output;
+        QVERIFY(cache.output(key, probe, &output));
+        QCOMPARE(output, expectedOutput);
+        QCOMPARE(probes, 1);
+
+        // failures are not cached
+        const auto otherKey = CompilerProbeCache::key(runtime, compilerPath, {QStringLiteral("-v")});
+        auto failingProbe = [&](QByteArray*) {
+            ++probes;
+            return false;
+        };
+        QVERIFY(!cache.output(otherKey, failingProbe, &output));
+        QVERIFY(!cache.output(otherKey, failingProbe, &output));
+        QCOMPARE(probes, 3);
+
+        cache.clear();
+        QVERIFY(cache.output(key, probe, &output));
+        QCOMPARE(probes, 4);
+    }
+
+    {
+        // concurrent requests share a single probe
+        CompilerProbeCache cache(cacheDir.path() + QLatin1String("/concurrent"));
+        QAtomicInt concurrentProbes;
+        auto slowProbe = [&](QByteArray* output) {
+            concurrentProbes.ref();
+            QThread::msleep(100);
+            *output = expectedOutput;
+            return true;
+        };
+
+        QVector<QFuture<QByteArray>> futures;
+        for (int i = 0; i < 8; ++i) {
+            futures.append(QtConcurrent::run([&]() {
+                QByteArray output;
+                cache.output(key, slowProbe, &output);
+                return output;
+            }));
+        }
+        for (auto& future : futures) {
+            QCOMPARE(future.result(), expectedOutput);
+        }
+        QCOMPARE(concurrentProbes.load(), 1);
+    }
+}
+
 QTEST_MAIN(TestCompilerProvider)
@@ -37,6 +37,7 @@ private Q_SLOTS:
     void testStorageBackwardsCompatible();
     void testCompilerIncludesAndDefinesForProject();
     void testStorageNewSystem();
+    void testProbeCache();
 };
 
 #endif
@@ -30,8 +30,11 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QMutex>
 #include <QRegularExpression>
 #include <QRegExp>
+#include <QSet>
+#include <QWaitCondition>
 
 #include <KProcess>
 #include <KLocalizedString>
@@ -76,6 +79,24 @@ namespace {
 
   static Cache s_cache;
   static QMutex s_cacheMutex;
+  ///Directories for which make is currently being run, protected by s_cacheMutex
+  static QSet<QString> s_resolvingDirectories;
+  static QWaitCondition s_resolvingFinished;
+
+  ///Marks a directory as being resolved as long as it is alive, such that other threads wait for its result
+  struct ResolvingDirectoryGuard
+  {
+    ~ResolvingDirectoryGuard()
+    {
+      if (directory.isEmpty())
+        return;
+      QMutexLocker l(&s_cacheMutex);
+      s_resolvingDirectories.remove(directory);
+      s_resolvingFinished.wakeAll();
+    }
+
+    QString directory;
+  };
 }
 
   /**
@@ -296,8 +317,13 @@ PathResolutionResult MakeFileResolver::resolveIncludePath(const QString& file, c
   dependency.addModificationRevision(IndexedString(makeFile.filePath()), ModificationRevision::revisionForFile(IndexedString(makeFile.filePath())));
   dependency += resultOnFail.includePathDependency;
   Cache::iterator it;
+  ResolvingDirectoryGuard resolvingGuard;
   {
     QMutexLocker l(&s_cacheMutex);
+    //Running make for the same directory from several threads at once is just wasted time, wait for the running one instead
+    while (s_resolvingDirectories.contains(dir.path()))
+      s_resolvingFinished.wait(&s_cacheMutex);
+
     it = s_cache.find(dir.path());
     if (it != s_cache.end()) {
       cachedPaths = it->paths;
@@ -329,6 +355,9 @@ PathResolutionResult MakeFileResolver::resolveIncludePath(const QString& file, c
         }
       }
     }
+
+    s_resolvingDirectories.insert(dir.path());
+    resolvingGuard.directory = dir.path();
   }
 
   ///STEP 1: Prepare paths
@@ -390,6 +419,7 @@ PathResolutionResult MakeFileResolver::resolveIncludePath(const QString& file, c
     CacheEntry& ce(*it);
     ce.paths = res.paths;
     ce.frameworkDirectories = res.frameworkDirectories;
+    ce.defines = res.defines;
     ce.modificationTime = dependency;
 
     if (!res) {
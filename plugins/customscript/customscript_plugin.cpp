@@ -76,6 +76,11 @@ CustomScriptPlugin::CustomScriptPlugin(QObject* parent, const QVariantList&)
     : IPlugin(QStringLiteral("kdevcustomscript"), parent)
 {
     indentPluginSingleton = this;
+
+    auto projectController = ICore::self()->projectController();
+    connect(projectController, &IProjectController::projectOpened, this, &CustomScriptPlugin::updateProjectVariables);
+    connect(projectController, &IProjectController::projectClosed, this, &CustomScriptPlugin::updateProjectVariables);
+    updateProjectVariables();
 }
 
 CustomScriptPlugin::~CustomScriptPlugin()
@@ -122,16 +127,10 @@ QString CustomScriptPlugin::formatSourceWithStyle(SourceFormatterStyle style, co
     QString useText = text;
     useText = leftContext + useText + rightContext;
 
-    QMap<QString, QString> projectVariables;
-    const auto projects = ICore::self()->projectController()->projects();
-    for (IProject* project : projects) {
-        projectVariables[project->name()] = project->path().toUrl().toLocalFile();
-    }
-
     QString command = style.content();
 
     // Replace ${Project} with the project path
-    command = replaceVariables(command, projectVariables);
+    command = replaceVariables(command, projectVariables());
     command.replace(QLatin1String("$FILE"), url.toLocalFile());
 
     if (command.contains(QLatin1String("$TMPFILE"))) {
@@ -209,6 +208,30 @@ QString CustomScriptPlugin::formatSource(const QString& text, const QUrl& url, c
     return formatSourceWithStyle(style, text, url, mime, leftContext, rightContext);
 }
 
+bool CustomScriptPlugin::canFormatConcurrently() const
+{
+    // every call runs a process of its own
+    return true;
+}
+
+QMap<QString, QString> CustomScriptPlugin::projectVariables() const
+{
+    QMutexLocker lock(&m_projectVariablesMutex);
+    return m_projectVariables;
+}
+
+void CustomScriptPlugin::updateProjectVariables()
+{
+    QMap<QString, QString> projectVariables;
+    const auto projects = ICore::self()->projectController()->projects();
+    for (IProject* project : projects) {
+        projectVariables[project->name()] = project->path().toUrl().toLocalFile();
+    }
+
+    QMutexLocker lock(&m_projectVariablesMutex);
+    m_projectVariables = projectVariables;
+}
+
 static QVector<SourceFormatterStyle> stylesFromLanguagePlugins()
 {
     QVector<KDevelop::SourceFormatterStyle> styles;
@@ -28,6 +28,8 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QMap>
+#include <QMutex>
 
 class QTimer;
 
@@ -55,6 +57,8 @@ public:
                                   const QString& leftContext = QString(),
                                   const QString& rightContext = QString()) const override;
 
+    bool canFormatConcurrently() const override;
+
     /** \return A map of predefined styles (a key and a caption for each type)
      */
     QVector<KDevelop::SourceFormatterStyle> predefinedStyles() const override;
@@ -74,6 +78,13 @@ public:
 private:
     QStringList computeIndentationFromSample(const QUrl& url) const;
     KDevelop::SourceFormatterStyle predefinedStyle(const QString& name) const;
+    QMap<QString, QString> projectVariables() const;
+    void updateProjectVariables();
+
+    /// Paths of the open projects by name, for the ${Project} variables of the commands.
+    /// Kept up to date on the main thread, so the commands can be run from other threads.
+    mutable QMutex m_projectVariablesMutex;
+    QMap<QString, QString> m_projectVariables;
 };
 
 class CustomScriptPreferences
@@ -22,6 +22,7 @@
 
 #include "gitplugin.h"
 
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QProcess>
 #include <QDir>
@@ -33,7 +34,9 @@
 
 #include <interfaces/icore.h>
 #include <interfaces/iproject.h>
+#include <interfaces/iprojectcontroller.h>
 
+#include <project/abstractfilemanagerplugin.h>
 #include <util/path.h>
 
 #include <vcs/vcsjob.h>
@@ -177,6 +180,25 @@ QDir urlDir(const QUrl& url)
 }
 QDir urlDir(const QList<QUrl>& urls) { return urlDir(urls.first()); } //TODO: could be improved
 
+/**
+ * @return the id git would assign to the contents of @p file when adding it, or an empty byte array
+ *
+ * This is computed in-process to avoid the cost of spawning git just to identify the content.
+ */
+QByteArray blobId(const QString& file)
+{
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData("blob " + QByteArray::number(f.size()) + '\0');
+    if (!hash.addData(&f)) {
+        return {};
+    }
+    return hash.result().toHex();
+}
+
 }
 
 GitPlugin::GitPlugin( QObject *parent, const QVariantList & )
@@ -197,6 +219,17 @@ GitPlugin::GitPlugin( QObject *parent, const QVariantList & )
     m_watcher = new KDirWatch(this);
     connect(m_watcher, &KDirWatch::dirty, this, &GitPlugin::fileChanged);
     connect(m_watcher, &KDirWatch::created, this, &GitPlugin::fileChanged);
+
+    // cost is the number of annotated lines
+    m_blameCache.setMaxCost(200000);
+
+    auto* projectController = ICore::self()->projectController();
+    connect(projectController, &IProjectController::projectOpened, this, &GitPlugin::projectOpened);
+    connect(projectController, &IProjectController::projectClosing, this, &GitPlugin::projectClosing);
+    const auto projects = projectController->projects();
+    for (auto* project : projects) {
+        projectOpened(project);
+    }
 }
 
 GitPlugin::~GitPlugin()
@@ -382,18 +415,49 @@ KDevelop::VcsJob* GitPlugin::status(const QList<QUrl>& localLocations, KDevelop:
     if (localLocations.empty())
         return errorsFound(i18n("Did not specify the list of files"), OutputJob::Verbose);
 
-    DVcsJob* job = new GitJob(urlDir(localLocations), this, OutputJob::Silent);
-    job->setType(VcsJob::Status);
-
     if(m_oldVersion) {
+        DVcsJob* job = new GitJob(urlDir(localLocations), this, OutputJob::Silent);
+        job->setType(VcsJob::Status);
         *job << "git" << "ls-files" << "-t" << "-m" << "-c" << "-o" << "-d" << "-k" << "--directory";
         connect(job, &DVcsJob::readyForParsing, this, &GitPlugin::parseGitStatusOutput_old);
-    } else {
-        *job << "git" << "status" << "--porcelain";
-        job->setIgnoreError(true);
-        connect(job, &DVcsJob::readyForParsing, this, &GitPlugin::parseGitStatusOutput);
+        *job << "--" << (recursion == IBasicVersionControl::Recursive ? localLocations : preventRecursion(localLocations));
+        return job;
     }
-    *job << "--" << (recursion == IBasicVersionControl::Recursive ? localLocations : preventRecursion(localLocations));
+
+    // only ask git about the paths which changed since the last time we asked
+    const QDir repository = dotGitDirectory(localLocations.front());
+    const auto state = GitStatusCache::repositoryState(repository);
+    const auto lookup = m_statusCache.lookup(repository, state, localLocations, recursion);
+    if (lookup.covered && lookup.dirtyUrls.isEmpty()) {
+        return new CachedResultsJob(this, VcsJob::Status, m_statusCache.statuses(repository, localLocations, recursion));
+    }
+
+    const QList<QUrl> queriedUrls = lookup.covered ? lookup.dirtyUrls : localLocations;
+    const auto queriedRecursion = lookup.covered ? IBasicVersionControl::Recursive : recursion;
+
+    DVcsJob* job = new GitJob(urlDir(localLocations), this, OutputJob::Silent);
+    job->setType(VcsJob::Status);
+    *job << "git" << "status" << "--porcelain";
+    job->setIgnoreError(true);
+    // don't let git refresh the index in the background, that would invalidate our cache
+    job->process()->setEnv(QStringLiteral("GIT_OPTIONAL_LOCKS"), QStringLiteral("0"));
+    connect(job, &DVcsJob::readyForParsing, this, &GitPlugin::parseGitStatusOutput);
+
+    const qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+    connect(job, &DVcsJob::readyForParsing, this,
+            [this, repository, state, startTime, queriedUrls, queriedRecursion, localLocations, recursion, lookup](DVcsJob* job) {
+        if (job->status() != VcsJob::JobSucceeded) {
+            return;
+        }
+        const QList<Path> watchedRoots = m_watchedProjects.values();
+        m_statusCache.update(repository, state, startTime, queriedUrls, queriedRecursion,
+                             job->fetchResults().toList(), watchedRoots);
+        if (lookup.covered) {
+            // we only asked git about the changed paths, the rest comes from the cache
+            job->setResults(m_statusCache.statuses(repository, localLocations, recursion));
+        }
+    });
+    *job << "--" << (queriedRecursion == IBasicVersionControl::Recursive ? queriedUrls : preventRecursion(queriedUrls));
 
     return job;
 }
@@ -634,11 +698,39 @@ VcsJob* GitPlugin::log(const QUrl& localLocation, const KDevelop::VcsRevision& r
 
 KDevelop::VcsJob* GitPlugin::annotate(const QUrl &localLocation, const KDevelop::VcsRevision&)
 {
-    DVcsJob* job = new GitJob(dotGitDirectory(localLocation), this, KDevelop::OutputJob::Silent);
+    const QDir repository = dotGitDirectory(localLocation);
+
+    // the annotation only depends on the history up to HEAD and the current contents of the file
+    QString cacheKey;
+    const QByteArray head = GitStatusCache::headCommit(repository);
+    if (!head.isEmpty()) {
+        const QByteArray blob = blobId(localLocation.toLocalFile());
+        if (!blob.isEmpty()) {
+            cacheKey = localLocation.toLocalFile() + QLatin1Char('\n') + QString::fromLatin1(head)
+                     + QLatin1Char('\n') + QString::fromLatin1(blob);
+        }
+    }
+
+    if (!cacheKey.isEmpty()) {
+        if (const auto* annotation = m_blameCache.object(cacheKey)) {
+            return new CachedResultsJob(this, VcsJob::Annotate, *annotation);
+        }
+    }
+
+    DVcsJob* job = new GitJob(repository, this, KDevelop::OutputJob::Silent);
     job->setType(VcsJob::Annotate);
     *job << "git" << "blame" << "--porcelain" << "-w";
     *job << "--" << localLocation;
     connect(job, &DVcsJob::readyForParsing, this, &GitPlugin::parseGitBlameOutput);
+    if (!cacheKey.isEmpty()) {
+        connect(job, &DVcsJob::readyForParsing, this, [this, cacheKey](DVcsJob* job) {
+            if (job->status() != VcsJob::JobSucceeded) {
+                return;
+            }
+            const auto annotation = job->fetchResults().toList();
+            m_blameCache.insert(cacheKey, new QVariantList(annotation), annotation.size() + 1);
+        });
+    }
     return job;
 }
 
@@ -1231,7 +1323,7 @@ void GitPlugin::parseGitStatusOutput(DVcsJob* job)
     QDir dotGit = dotGitDirectory(QUrl::fromLocalFile(workingDir.absolutePath()));
 
     QVariantList statuses;
-    QList<QUrl> processedFiles;
+    QSet<QUrl> processedFiles;
 
     for (const QStringRef& line : outputLines) {
         //every line is 2 chars for the status, 1 space then the file desc
@@ -1244,7 +1336,7 @@ void GitPlugin::parseGitStatusOutput(DVcsJob* job)
             status.setUrl(QUrl::fromLocalFile(dotGit.absoluteFilePath(curr.toString().left(arrow))));
             status.setState(VcsStatusInfo::ItemDeleted);
             statuses.append(QVariant::fromValue<VcsStatusInfo>(status));
-            processedFiles += status.url();
+            processedFiles.insert(status.url());
 
             curr = curr.mid(arrow+4);
         }
@@ -1256,7 +1348,7 @@ void GitPlugin::parseGitStatusOutput(DVcsJob* job)
         VcsStatusInfo status;
         status.setUrl(QUrl::fromLocalFile(dotGit.absoluteFilePath(curr.toString())));
         status.setState(messageToState(state));
-        processedFiles.append(status.url());
+        processedFiles.insert(status.url());
 
         qCDebug(PLUGIN_GIT) << "Checking git status for " << line << curr << status.state();
 
@@ -1405,6 +1497,22 @@ void StandardJob::result(KJob* job)
     emitResult();
 }
 
+CachedResultsJob::CachedResultsJob(IPlugin* parent, VcsJob::JobType type, const QVariant& results)
+    : VcsJob(parent, OutputJob::Silent)
+    , m_plugin(parent)
+    , m_results(results)
+    , m_status(JobNotStarted)
+{
+    setType(type);
+}
+
+void CachedResultsJob::start()
+{
+    m_status = JobSucceeded;
+    emitResult();
+    emit resultsReady(this);
+}
+
 VcsJob* GitPlugin::copy(const QUrl& localLocationSrc, const QUrl& localLocationDstn)
 {
     //TODO: Probably we should "git add" after
@@ -1546,6 +1654,38 @@ void GitPlugin::delayedBranchChanged()
     emit repositoryBranchChanged(m_branchesChange.takeFirst());
 }
 
+void GitPlugin::projectOpened(IProject* project)
+{
+    if (project->versionControlPlugin() != this || m_watchedProjects.contains(project)) {
+        return;
+    }
+
+    // reuse the watcher of the project manager to learn about changes in the working tree
+    auto* manager = qobject_cast<AbstractFileManagerPlugin*>(project->managerPlugin());
+    KDirWatch* watcher = manager ? manager->projectWatcher(project) : nullptr;
+    if (!watcher) {
+        return;
+    }
+
+    auto markDirty = [this](const QString& path) {
+        m_statusCache.markDirty(Path(path));
+    };
+    connect(watcher, &KDirWatch::dirty, this, markDirty);
+    connect(watcher, &KDirWatch::created, this, markDirty);
+    connect(watcher, &KDirWatch::deleted, this, markDirty);
+    m_watchedProjects.insert(project, project->path());
+}
+
+void GitPlugin::projectClosing(IProject* project)
+{
+    const auto it = m_watchedProjects.find(project);
+    if (it == m_watchedProjects.end()) {
+        return;
+    }
+    m_statusCache.invalidate(*it);
+    m_watchedProjects.erase(it);
+}
+
 CheckInRepositoryJob* GitPlugin::isInRepository(KTextEditor::Document* document)
 {
     CheckInRepositoryJob* job = new GitPluginCheckInRepositoryJob(document, repositoryRoot(document->url()).path());
@@ -29,11 +29,16 @@
 #include <outputview/outputjob.h>
 #include <vcs/vcsjob.h>
 
+#include "gitstatuscache.h"
+
+#include <QCache>
+
 class KDirWatch;
 class QDir;
 
 namespace KDevelop
 {
+    class IProject;
     class VcsJob;
     class VcsRevision;
 }
@@ -58,6 +63,26 @@ class StandardJob : public KDevelop::VcsJob
         JobStatus m_status;
 };
 
+/**
+ * Delivers results which are already known, without running git.
+ */
+class CachedResultsJob : public KDevelop::VcsJob
+{
+    Q_OBJECT
+    public:
+        CachedResultsJob(KDevelop::IPlugin* parent, KDevelop::VcsJob::JobType type, const QVariant& results);
+
+        QVariant fetchResults() override { return m_results; }
+        void start() override;
+        JobStatus status() const override { return m_status; }
+        KDevelop::IPlugin* vcsPlugin() const override { return m_plugin; }
+
+    private:
+        KDevelop::IPlugin* m_plugin;
+        QVariant m_results;
+        JobStatus m_status;
+};
+
 /**
  * This is the main class of KDevelop's Git plugin.
  *
@@ -193,6 +218,9 @@ private Q_SLOTS:
     void fileChanged(const QString& file);
     void delayedBranchChanged();
 
+    void projectOpened(KDevelop::IProject* project);
+    void projectClosing(KDevelop::IProject* project);
+
 Q_SIGNALS:
     void repositoryBranchChanged(const QUrl& repository);
 
@@ -218,6 +246,12 @@ private:
     KDirWatch* m_watcher;
     QList<QUrl> m_branchesChange;
     bool m_usePrefix;
+
+    GitStatusCache m_statusCache;
+    /// roots of the projects whose working tree changes we get notified about
+    QHash<KDevelop::IProject*, KDevelop::Path> m_watchedProjects;
+    /// annotations keyed on the file path, the HEAD commit and the blob id of the file contents
+    QCache<QString, QVariantList> m_blameCache;
 };
 
 QVariant runSynchronously(KDevelop::VcsJob* job);
@@ -0,0 +1,398 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "gitstatuscache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#include <algorithm>
+
+using namespace KDevelop;
+
+namespace
+{
+
+bool matches(const Path& requested, IBasicVersionControl::RecursionMode mode, const Path& path)
+{
+    if (requested == path) {
+        return true;
+    }
+    return mode == IBasicVersionControl::Recursive ? requested.isParentOf(path) : requested.isDirectParentOf(path);
+}
+
+bool matchesAny(const QVector<Path>& requested, IBasicVersionControl::RecursionMode mode, const Path& path)
+{
+    return std::any_of(requested.begin(), requested.end(), [mode, &path](const Path& url) {
+        return matches(url, mode, path);
+    });
+}
+
+template<typename Hash, typename Predicate>
+void removeIf(Hash& hash, Predicate predicate)
+{
+    for (auto it = hash.begin(); it != hash.end();) {
+        if (predicate(it.key())) {
+            it = hash.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QVector<Path> toPaths(const QList<QUrl>& urls)
+{
+    QVector<Path> ret;
+    ret.reserve(urls.size());
+    for (const QUrl& url : urls) {
+        ret.append(Path(url));
+    }
+    return ret;
+}
+
+QByteArray readFirstLine(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return file.readLine().trimmed();
+}
+
+/// @return the .git directory of @p repository, following the indirection used by worktrees and submodules
+QString gitDirectory(const QDir& repository)
+{
+    const QString dotGit = repository.filePath(QStringLiteral(".git"));
+    const QFileInfo info(dotGit);
+    if (info.isDir()) {
+        return dotGit;
+    }
+    const QByteArray content = readFirstLine(dotGit);
+    if (!content.startsWith("gitdir: ")) {
+        return {};
+    }
+    return QDir::cleanPath(repository.absoluteFilePath(QString::fromLocal8Bit(content.mid(8))));
+}
+
+/// @return the directory shared between all worktrees, which contains the refs
+QString commonDirectory(const QString& gitDir)
+{
+    const QByteArray commonDir = readFirstLine(gitDir + QLatin1String("/commondir"));
+    if (commonDir.isEmpty()) {
+        return gitDir;
+    }
+    return QDir::cleanPath(QDir(gitDir).absoluteFilePath(QString::fromLocal8Bit(commonDir)));
+}
+
+QByteArray resolveRef(const QString& gitDir, const QByteArray& ref)
+{
+    const QString refName = QString::fromLocal8Bit(ref);
+    QByteArray id = readFirstLine(gitDir + QLatin1Char('/') + refName);
+    if (!id.isEmpty()) {
+        return id;
+    }
+
+    const QString commonDir = commonDirectory(gitDir);
+    if (commonDir != gitDir) {
+        id = readFirstLine(commonDir + QLatin1Char('/') + refName);
+        if (!id.isEmpty()) {
+            return id;
+        }
+    }
+
+    QFile packedRefs(commonDir + QLatin1String("/packed-refs"));
+    if (!packedRefs.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    while (!packedRefs.atEnd()) {
+        const QByteArray line = packedRefs.readLine().trimmed();
+        if (line.startsWith('#') || line.startsWith('^')) {
+            continue;
+        }
+        const int space = line.indexOf(' ');
+        if (space > 0 && line.mid(space + 1) == ref) {
+            return line.left(space);
+        }
+    }
+    return {};
+}
+
+}
+
+QByteArray GitStatusCache::headCommit(const QDir& repository)
+{
+    const QString gitDir = gitDirectory(repository);
+    if (gitDir.isEmpty()) {
+        return {};
+    }
+
+    const QByteArray head = readFirstLine(gitDir + QLatin1String("/HEAD"));
+    if (head.startsWith("ref: ")) {
+        return resolveRef(gitDir, head.mid(5));
+    }
+    // detached HEAD
+    return head;
+}
+
+GitStatusCache::RepositoryState GitStatusCache::repositoryState(const QDir& repository)
+{
+    RepositoryState state;
+    state.headCommit = headCommit(repository);
+
+    const QString gitDir = gitDirectory(repository);
+    if (!gitDir.isEmpty()) {
+        const QFileInfo index(gitDir + QLatin1String("/index"));
+        if (index.exists()) {
+            state.indexModified = index.lastModified().toMSecsSinceEpoch();
+            state.indexSize = index.size();
+        }
+    }
+    return state;
+}
+
+GitStatusCache::Repository* GitStatusCache::repository(const QDir& repository)
+{
+    auto it = m_repositories.find(repository.absolutePath());
+    return it == m_repositories.end() ? nullptr : &it.value();
+}
+
+const GitStatusCache::Repository* GitStatusCache::repository(const QDir& repository) const
+{
+    auto it = m_repositories.constFind(repository.absolutePath());
+    return it == m_repositories.constEnd() ? nullptr : &it.value();
+}
+
+GitStatusCache::Lookup GitStatusCache::lookup(const QDir& dir, const RepositoryState& state, const QList<QUrl>& urls,
+                                              IBasicVersionControl::RecursionMode mode)
+{
+    auto* repo = repository(dir);
+    if (!repo) {
+        return {};
+    }
+    if (!state.isValid() || !(repo->state == state)) {
+        // the index or HEAD changed, potentially affecting every file
+        m_repositories.remove(dir.absolutePath());
+        return {};
+    }
+
+    QSet<Path> dirty;
+    auto checkModified = [&](const Path& path, const QFileInfo& info, qint64 snapshotTime) {
+        const auto entry = repo->entries.constFind(path);
+        const qint64 checkedAt = entry == repo->entries.constEnd() ? snapshotTime : entry->checkedAt;
+        if (!info.exists()) {
+            if (entry != repo->entries.constEnd() && entry->state != VcsStatusInfo::ItemDeleted) {
+                dirty.insert(path);
+            }
+        } else if (info.lastModified().toMSecsSinceEpoch() >= checkedAt) {
+            dirty.insert(path);
+        }
+    };
+
+    for (const Path& path : toPaths(urls)) {
+        qint64 snapshotTime = -1;
+        for (auto it = repo->coveredRoots.constBegin(), end = repo->coveredRoots.constEnd(); it != end; ++it) {
+            if (it.key() == path || it.key().isParentOf(path)) {
+                snapshotTime = it.value();
+                break;
+            }
+        }
+        if (snapshotTime < 0) {
+            return {};
+        }
+
+        for (auto it = repo->dirty.constBegin(), end = repo->dirty.constEnd(); it != end; ++it) {
+            if (matches(path, mode, it.key())) {
+                dirty.insert(it.key());
+            }
+        }
+
+        // changes the watcher didn't notify us about yet, only checked for the directly requested files
+        // since stat'ing a whole tree would defeat the purpose of the cache
+        const QFileInfo info(path.toLocalFile());
+        if (info.isDir()) {
+            if (mode == IBasicVersionControl::NonRecursive) {
+                const auto children = QDir(info.filePath()).entryInfoList(QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot);
+                QSet<Path> listed;
+                for (const QFileInfo& child : children) {
+                    const Path childPath(path, child.fileName());
+                    listed.insert(childPath);
+                    checkModified(childPath, child, snapshotTime);
+                }
+                // cached files of the directory which are gone
+                const auto cachedChildren = repo->directoryEntries.value(path);
+                for (const Path& child : cachedChildren) {
+                    if (!listed.contains(child)) {
+                        checkModified(child, QFileInfo(child.toLocalFile()), snapshotTime);
+                    }
+                }
+            }
+        } else {
+            checkModified(path, info, snapshotTime);
+        }
+    }
+
+    Lookup ret;
+    ret.covered = true;
+    ret.dirtyUrls.reserve(dirty.size());
+    for (const Path& path : qAsConst(dirty)) {
+        ret.dirtyUrls.append(path.toUrl());
+    }
+    return ret;
+}
+
+QVariantList GitStatusCache::statuses(const QDir& dir, const QList<QUrl>& urls,
+                                      IBasicVersionControl::RecursionMode mode) const
+{
+    QVariantList ret;
+    const auto* repo = repository(dir);
+    if (!repo) {
+        return ret;
+    }
+
+    const auto paths = toPaths(urls);
+    for (auto it = repo->entries.constBegin(), end = repo->entries.constEnd(); it != end; ++it) {
+        if (!matchesAny(paths, mode, it.key())) {
+            continue;
+        }
+        VcsStatusInfo status;
+        status.setUrl(it.key().toUrl());
+        status.setState(it->state);
+        ret.append(QVariant::fromValue<VcsStatusInfo>(status));
+    }
+    return ret;
+}
+
+void GitStatusCache::update(const QDir& dir, const RepositoryState& state, qint64 startTime,
+                            const QList<QUrl>& urls, IBasicVersionControl::RecursionMode mode,
+                            const QVariantList& statuses, const QList<Path>& watchedRoots)
+{
+    const auto paths = toPaths(urls);
+    auto isWatched = [&watchedRoots](const Path& path) {
+        return std::any_of(watchedRoots.begin(), watchedRoots.end(), [&path](const Path& root) {
+            return root == path || root.isParentOf(path);
+        });
+    };
+    if (!state.isValid() || !std::any_of(paths.begin(), paths.end(), isWatched)) {
+        // we would never learn about changes in the working tree, so don't bother remembering anything
+        return;
+    }
+
+    auto& repo = m_repositories[dir.absolutePath()];
+    if (!(repo.state == state)) {
+        repo = Repository();
+        repo.state = state;
+    }
+
+    // git reported everything which is still of interest below the queried paths
+    removeIf(repo.entries, [&paths, mode, &repo](const Path& path) {
+        if (!matchesAny(paths, mode, path)) {
+            return false;
+        }
+        repo.removeFromDirectory(path);
+        return true;
+    });
+    for (const QVariant& value : statuses) {
+        const auto status = value.value<VcsStatusInfo>();
+        const Path path(status.url());
+        repo.entries.insert(path, {status.state(), startTime});
+        repo.directoryEntries[path.parent()].insert(path);
+    }
+
+    // paths reported while git was running might not be reflected in its output
+    for (auto it = repo.dirty.begin(); it != repo.dirty.end();) {
+        if (it.value() < startTime && matchesAny(paths, mode, it.key())) {
+            it = repo.dirty.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (mode != IBasicVersionControl::Recursive) {
+        return;
+    }
+
+    for (const Path& path : paths) {
+        if (!isWatched(path)) {
+            continue;
+        }
+
+        bool isCovered = false;
+        for (auto it = repo.coveredRoots.begin(); it != repo.coveredRoots.end();) {
+            if (it.key() == path || it.key().isParentOf(path)) {
+                isCovered = true;
+                break;
+            } else if (path.isParentOf(it.key())) {
+                it = repo.coveredRoots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!isCovered) {
+            repo.coveredRoots.insert(path, startTime);
+        }
+    }
+}
+
+void GitStatusCache::markDirty(const Path& path)
+{
+    if (path.segments().contains(QStringLiteral(".git"))) {
+        // changes to the repository itself are detected via the repository state
+        return;
+    }
+
+    for (auto& repo : m_repositories) {
+        for (auto it = repo.coveredRoots.constBegin(), end = repo.coveredRoots.constEnd(); it != end; ++it) {
+            if (it.key() == path || it.key().isParentOf(path)) {
+                repo.dirty.insert(path, QDateTime::currentMSecsSinceEpoch());
+                break;
+            }
+        }
+    }
+}
+
+void GitStatusCache::invalidate(const Path& root)
+{
+    for (auto it = m_repositories.begin(); it != m_repositories.end();) {
+        const Path repositoryRoot(it.key());
+        if (root == repositoryRoot || root.isParentOf(repositoryRoot)) {
+            it = m_repositories.erase(it);
+            continue;
+        }
+        if (repositoryRoot.isParentOf(root)) {
+            auto& repo = it.value();
+            auto isAffected = [&root](const Path& path) {
+                return root == path || root.isParentOf(path);
+            };
+            removeIf(repo.coveredRoots, isAffected);
+            removeIf(repo.entries, [&repo, &isAffected](const Path& path) {
+                if (!isAffected(path)) {
+                    return false;
+                }
+                repo.removeFromDirectory(path);
+                return true;
+            });
+            removeIf(repo.dirty, isAffected);
+        }
+        ++it;
+    }
+}
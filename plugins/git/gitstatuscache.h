@@ -0,0 +1,159 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_PLUGIN_GITSTATUSCACHE_H
+#define KDEVPLATFORM_PLUGIN_GITSTATUSCACHE_H
+
+#include <vcs/interfaces/ibasicversioncontrol.h>
+#include <vcs/vcsstatusinfo.h>
+#include <util/path.h>
+
+#include <QHash>
+#include <QSet>
+#include <QVariantList>
+
+class QDir;
+
+/**
+ * Remembers the results of previous `git status` runs per repository, such that
+ * subsequent status requests only need to ask git about paths which changed since.
+ *
+ * A snapshot is bound to the state of the index and of HEAD it was taken with, any
+ * change to those drops the snapshot. Changes in the working tree are reported via
+ * markDirty(), files which were modified or removed after the snapshot was taken are
+ * detected additionally by their modification time and existence when they or their
+ * directory are requested directly, i.e. not recursively.
+ */
+class GitStatusCache
+{
+public:
+    struct RepositoryState
+    {
+        QByteArray headCommit;
+        qint64 indexModified = -1;
+        qint64 indexSize = -1;
+
+        bool isValid() const
+        {
+            return !headCommit.isEmpty();
+        }
+
+        bool operator==(const RepositoryState& other) const
+        {
+            return headCommit == other.headCommit
+                && indexModified == other.indexModified
+                && indexSize == other.indexSize;
+        }
+    };
+
+    /**
+     * @return the current state of the repository at @p repository
+     *
+     * This only reads a few files below the .git directory and never runs git.
+     * The state is invalid for repositories without any commit.
+     */
+    static RepositoryState repositoryState(const QDir& repository);
+
+    /**
+     * @return the id of the commit HEAD currently points to in @p repository, or an empty byte array
+     */
+    static QByteArray headCommit(const QDir& repository);
+
+    struct Lookup
+    {
+        /// true when all requested urls are part of a snapshot
+        bool covered = false;
+        /// paths which changed since the snapshot was taken and need to be refreshed from git
+        QList<QUrl> dirtyUrls;
+    };
+
+    /**
+     * Check whether the status of @p urls can be answered from the cache.
+     *
+     * @p state is the current repository state, the snapshot of the repository is dropped when it doesn't match.
+     */
+    Lookup lookup(const QDir& repository, const RepositoryState& state, const QList<QUrl>& urls,
+                  KDevelop::IBasicVersionControl::RecursionMode mode);
+
+    /**
+     * @return the cached statuses for the given @p urls
+     */
+    QVariantList statuses(const QDir& repository, const QList<QUrl>& urls,
+                          KDevelop::IBasicVersionControl::RecursionMode mode) const;
+
+    /**
+     * Store the @p statuses git reported for @p urls.
+     *
+     * @p state and @p startTime (in ms since epoch) describe the repository when git was started.
+     * Recursive queries of directories within @p watchedRoots become part of the snapshot, i.e. later
+     * lookups for them are answered from the cache as long as they don't get dirty.
+     */
+    void update(const QDir& repository, const RepositoryState& state, qint64 startTime,
+                const QList<QUrl>& urls, KDevelop::IBasicVersionControl::RecursionMode mode,
+                const QVariantList& statuses, const QList<KDevelop::Path>& watchedRoots);
+
+    /**
+     * Notify the cache that @p path was changed, created or removed in the working tree.
+     */
+    void markDirty(const KDevelop::Path& path);
+
+    /**
+     * Drop all cached data below @p root.
+     */
+    void invalidate(const KDevelop::Path& root);
+
+private:
+    struct Entry
+    {
+        KDevelop::VcsStatusInfo::State state;
+        /// time in ms since epoch the state was determined
+        qint64 checkedAt;
+    };
+
+    struct Repository
+    {
+        RepositoryState state;
+        /// directories which were queried recursively and are kept up to date, with the time of the query
+        QHash<KDevelop::Path, qint64> coveredRoots;
+        QHash<KDevelop::Path, Entry> entries;
+        /// the paths of the entries by their parent directory, to find removed files of a listed directory
+        QHash<KDevelop::Path, QSet<KDevelop::Path>> directoryEntries;
+        /// paths reported as changed, with the time in ms since epoch they were reported
+        QHash<KDevelop::Path, qint64> dirty;
+
+        void removeFromDirectory(const KDevelop::Path& path)
+        {
+            auto it = directoryEntries.find(path.parent());
+            if (it != directoryEntries.end()) {
+                it->remove(path);
+                if (it->isEmpty()) {
+                    directoryEntries.erase(it);
+                }
+            }
+        }
+    };
+
+    Repository* repository(const QDir& repository);
+    const Repository* repository(const QDir& repository) const;
+
+    QHash<QString, Repository> m_repositories;
+};
+
+#endif // KDEVPLATFORM_PLUGIN_GITSTATUSCACHE_H
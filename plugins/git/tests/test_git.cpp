@@ -488,6 +488,19 @@ void GitInitTest::testAnnotation()
     annotation = results.at(1).value<VcsAnnotationLine>();
     QCOMPARE(annotation.lineNumber(), 1);
     QCOMPARE(annotation.commitMessage(), QStringLiteral("KDevelop's Test commit3"));
+
+    // unchanged file and HEAD, the annotation is served from the cache
+    j = m_plugin->annotate(QUrl::fromLocalFile(gitTest_BaseDir() + gitTest_FileName()), VcsRevision::createSpecialRevision(VcsRevision::Head));
+    QVERIFY(qobject_cast<CachedResultsJob*>(j));
+    VERIFYJOB(j);
+    QCOMPARE(j->fetchResults().toList().size(), 2);
+
+    // modified contents need a new annotation
+    QVERIFY(writeFile(gitTest_BaseDir() + gitTest_FileName(), QStringLiteral("Another appended line"), QIODevice::Append));
+    j = m_plugin->annotate(QUrl::fromLocalFile(gitTest_BaseDir() + gitTest_FileName()), VcsRevision::createSpecialRevision(VcsRevision::Head));
+    QVERIFY(!qobject_cast<CachedResultsJob*>(j));
+    VERIFYJOB(j);
+    QCOMPARE(j->fetchResults().toList().size(), 2);
 }
 
 void GitInitTest::testRemoveEmptyFolder()
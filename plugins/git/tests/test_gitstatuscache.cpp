@@ -0,0 +1,183 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "../gitstatuscache.h"
+
+using namespace KDevelop;
+
+namespace {
+void writeFile(const QString& path, const QByteArray& contents)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(contents), qint64(contents.size()));
+}
+
+QVariant status(const QString& path, VcsStatusInfo::State state)
+{
+    VcsStatusInfo info;
+    info.setUrl(QUrl::fromLocalFile(path));
+    info.setState(state);
+    return QVariant::fromValue<VcsStatusInfo>(info);
+}
+}
+
+class TestGitStatusCache : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+
+    void testCovered();
+    void testModified();
+    void testDeleted();
+    void testMarkDirty();
+    void testIndexChanged();
+
+private:
+    /// Remembers the two clean files as git would have reported them when it was started at @p startTime
+    void takeSnapshot(qint64 startTime);
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QDir m_repository;
+    GitStatusCache m_cache;
+    GitStatusCache::RepositoryState m_state;
+    QList<QUrl> m_root;
+};
+
+void TestGitStatusCache::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_repository = QDir(m_dir->path());
+    m_root = {QUrl::fromLocalFile(m_dir->path())};
+
+    // just enough of a repository to determine its state, git itself is not run
+    QVERIFY(m_repository.mkpath(QStringLiteral(".git/refs/heads")));
+    writeFile(m_dir->filePath(QStringLiteral(".git/HEAD")), "ref: refs/heads/master\n");
+    writeFile(m_dir->filePath(QStringLiteral(".git/refs/heads/master")), "0123456789012345678901234567890123456789\n");
+    writeFile(m_dir->filePath(QStringLiteral(".git/index")), "index");
+    writeFile(m_dir->filePath(QStringLiteral("a.txt")), "a\n");
+    writeFile(m_dir->filePath(QStringLiteral("b.txt")), "b\n");
+
+    m_state = GitStatusCache::repositoryState(m_repository);
+    QVERIFY(m_state.isValid());
+    m_cache = GitStatusCache();
+}
+
+void TestGitStatusCache::takeSnapshot(qint64 startTime)
+{
+    const QVariantList statuses{status(m_dir->filePath(QStringLiteral("a.txt")), VcsStatusInfo::ItemUpToDate),
+                                status(m_dir->filePath(QStringLiteral("b.txt")), VcsStatusInfo::ItemUpToDate)};
+    m_cache.update(m_repository, m_state, startTime, m_root, IBasicVersionControl::Recursive, statuses,
+                   {Path(m_dir->path())});
+}
+
+void TestGitStatusCache::testCovered()
+{
+    // nothing is known before git ran
+    QVERIFY(!m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive).covered);
+
+    // git ran after the files were written
+    takeSnapshot(QDateTime::currentMSecsSinceEpoch() + 10000);
+
+    const auto lookup = m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive);
+    QVERIFY(lookup.covered);
+    QVERIFY(lookup.dirtyUrls.isEmpty());
+    QCOMPARE(m_cache.statuses(m_repository, m_root, IBasicVersionControl::Recursive).size(), 2);
+}
+
+void TestGitStatusCache::testModified()
+{
+    // the files were written after git ran, as if they were changed meanwhile
+    takeSnapshot(QDateTime::currentMSecsSinceEpoch() - 10000);
+
+    const auto lookup = m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::NonRecursive);
+    QVERIFY(lookup.covered);
+    QCOMPARE(lookup.dirtyUrls.size(), 2);
+    const QList<QUrl> file{QUrl::fromLocalFile(m_dir->filePath(QStringLiteral("a.txt")))};
+    QCOMPARE(m_cache.lookup(m_repository, m_state, file, IBasicVersionControl::NonRecursive).dirtyUrls, file);
+}
+
+void TestGitStatusCache::testDeleted()
+{
+    takeSnapshot(QDateTime::currentMSecsSinceEpoch() + 10000);
+    QVERIFY(QFile::remove(m_dir->filePath(QStringLiteral("b.txt"))));
+
+    // a clean file which is gone needs to be refreshed when asking for it or its directory directly
+    const QList<QUrl> expected{QUrl::fromLocalFile(m_dir->filePath(QStringLiteral("b.txt")))};
+    auto lookup = m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::NonRecursive);
+    QVERIFY(lookup.covered);
+    QCOMPARE(lookup.dirtyUrls, expected);
+    QCOMPARE(m_cache.lookup(m_repository, m_state, expected, IBasicVersionControl::NonRecursive).dirtyUrls, expected);
+
+    // recursive queries don't stat the tree, they rely on the file watcher
+    lookup = m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive);
+    QVERIFY(lookup.covered);
+    QVERIFY(lookup.dirtyUrls.isEmpty());
+    m_cache.markDirty(Path(expected.first()));
+    QCOMPARE(m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive).dirtyUrls, expected);
+}
+
+void TestGitStatusCache::testMarkDirty()
+{
+    takeSnapshot(QDateTime::currentMSecsSinceEpoch() + 10000);
+
+    const Path path(m_dir->filePath(QStringLiteral("new.txt")));
+    m_cache.markDirty(path);
+    QCOMPARE(m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive).dirtyUrls,
+             QList<QUrl>{path.toUrl()});
+
+    // changes in the .git directory are detected via the repository state
+    m_cache.markDirty(Path(m_dir->filePath(QStringLiteral(".git/index"))));
+    QCOMPARE(m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive).dirtyUrls.size(), 1);
+}
+
+void TestGitStatusCache::testIndexChanged()
+{
+    takeSnapshot(QDateTime::currentMSecsSinceEpoch() + 10000);
+
+    writeFile(m_dir->filePath(QStringLiteral(".git/index")), "changed index");
+    const auto state = GitStatusCache::repositoryState(m_repository);
+    QVERIFY(!(state == m_state));
+
+    // the snapshot is dropped, not only ignored
+    QVERIFY(!m_cache.lookup(m_repository, state, m_root, IBasicVersionControl::Recursive).covered);
+    QVERIFY(!m_cache.lookup(m_repository, m_state, m_root, IBasicVersionControl::Recursive).covered);
+
+    // the same applies to a new HEAD
+    m_state = state;
+    takeSnapshot(QDateTime::currentMSecsSinceEpoch() + 10000);
+    writeFile(m_dir->filePath(QStringLiteral(".git/refs/heads/master")), "9876543210987654321098765432109876543210\n");
+    QVERIFY(!m_cache.lookup(m_repository, GitStatusCache::repositoryState(m_repository), m_root,
+                            IBasicVersionControl::Recursive).covered);
+}
+
+QTEST_GUILESS_MAIN(TestGitStatusCache)
+
+#include "test_gitstatuscache.moc"
@@ -28,6 +28,11 @@
 #include <interfaces/idocument.h>
 #include <interfaces/idocumentcontroller.h>
 
+#include <QHash>
+#include <QtConcurrentRun>
+
+#include <iterator>
+
 #include <debug.h>
 #include "outlinenode.h"
 
@@ -35,13 +40,15 @@ using namespace KDevelop;
 
 OutlineModel::OutlineModel(QObject* parent)
     : QAbstractItemModel(parent)
+    , m_rootNode(OutlineNode::dummyNode())
     , m_lastDoc(nullptr)
 {
+    connect(&m_buildWatcher, &QFutureWatcher<QSharedPointer<OutlineNode>>::finished,
+            this, &OutlineModel::outlineBuilt);
+
     auto docController = ICore::self()->documentController();
     // build the initial outline now
     rebuildOutline(docController->activeDocument());
-    // we must always have a valid root node
-    Q_ASSERT(m_rootNode);
 
     // we want to rebuild the outline whenever the current document has been reparsed
     connect(DUChain::self(), &DUChain::updateReady,
@@ -72,6 +79,7 @@ OutlineModel::OutlineModel(QObject* parent)
 
 OutlineModel::~OutlineModel()
 {
+    m_buildWatcher.waitForFinished();
 }
 
 Qt::ItemFlags OutlineModel::flags(const QModelIndex& index) const
@@ -174,27 +182,148 @@ QModelIndex OutlineModel::parent(const QModelIndex& index) const
 
 void OutlineModel::rebuildOutline(IDocument* doc)
 {
-    beginResetModel();
-    if (!doc) {
-        m_rootNode = OutlineNode::dummyNode();
-    } else {
-        // TODO: do this in a separate thread? Might take a while for large documents
-        // and we really shouldn't be blocking the GUI thread!
-        DUChainReadLocker lock;
-        TopDUContext* topContext = DUChainUtils::standardContextForUrl(doc->url());
-        if (topContext) {
-            m_rootNode = OutlineNode::fromTopContext(topContext);
-        } else {
-            m_rootNode = OutlineNode::dummyNode();
-        }
-    }
     if (doc != m_lastDoc) {
         m_lastUrl = doc ? IndexedString(doc->url()) : IndexedString();
         m_lastDoc = doc;
     }
+
+    if (!doc) {
+        beginResetModel();
+        m_rootNode = OutlineNode::dummyNode();
+        m_rootUrl = IndexedString();
+        endResetModel();
+        return;
+    }
+
+    if (m_buildWatcher.isRunning()) {
+        // only build the latest state once the running build is done
+        m_rebuildPending = true;
+        return;
+    }
+    startBuild();
+}
+
+QSharedPointer<OutlineNode> OutlineModel::buildOutline(const IndexedString& url)
+{
+    DUChainReadLocker lock;
+    TopDUContext* topContext = DUChainUtils::standardContextForUrl(url.toUrl());
+    if (!topContext) {
+        return {};
+    }
+    return QSharedPointer<OutlineNode>(OutlineNode::fromTopContext(topContext).release());
+}
+
+void OutlineModel::startBuild()
+{
+    // large documents take a while, so don't block the GUI thread
+    m_rebuildPending = false;
+    m_buildUrl = m_lastUrl;
+    m_buildWatcher.setFuture(QtConcurrent::run(&OutlineModel::buildOutline, m_buildUrl));
+}
+
+void OutlineModel::outlineBuilt()
+{
+    if (m_rebuildPending) {
+        startBuild();
+        return;
+    }
+    if (m_buildUrl != m_lastUrl) {
+        // the document was closed in the meantime
+        return;
+    }
+
+    QSharedPointer<OutlineNode> newRoot = m_buildWatcher.result();
+    if (!newRoot) {
+        newRoot = QSharedPointer<OutlineNode>(OutlineNode::dummyNode().release());
+    }
+
+    if (m_rootUrl == m_buildUrl) {
+        // keep the unchanged nodes, so the view keeps its expansion and selection state
+        mergeChildren(m_rootNode.get(), QModelIndex(), newRoot.get());
+        return;
+    }
+
+    beginResetModel();
+    m_rootNode = OutlineNode::dummyNode();
+    m_rootNode->m_children = std::move(newRoot->m_children);
+    for (auto& child : m_rootNode->m_children) {
+        child->m_parent = m_rootNode.get();
+    }
+    m_rootUrl = m_buildUrl;
     endResetModel();
 }
 
+void OutlineModel::mergeNode(OutlineNode* node, const QModelIndex& index, OutlineNode* newNode)
+{
+    const bool changed = node->m_cachedText != newNode->m_cachedText
+                         || node->m_properties != newNode->m_properties;
+    node->m_cachedText = std::move(newNode->m_cachedText);
+    node->m_properties = newNode->m_properties;
+    node->m_declOrContext = newNode->m_declOrContext;
+    if (changed) {
+        emit dataChanged(index, index);
+    }
+
+    mergeChildren(node, index, newNode);
+}
+
+void OutlineModel::mergeChildren(OutlineNode* node, const QModelIndex& index, OutlineNode* newNode)
+{
+    auto& children = node->m_children;
+    auto& newChildren = newNode->m_children;
+
+    // how often each id is still to come in the old children, to tell insertions from removals
+    QHash<DeclarationId, int> pendingOld;
+    for (const auto& child : children) {
+        ++pendingOld[child->id()];
+    }
+
+    int row = 0;
+    size_t next = 0;
+    while (row < static_cast<int>(children.size()) || next < newChildren.size()) {
+        if (row < static_cast<int>(children.size()) && next < newChildren.size()
+            && children[row]->id() == newChildren[next]->id()) {
+            --pendingOld[children[row]->id()];
+            OutlineNode* child = children[row].get();
+            mergeNode(child, createIndex(row, 0, child), newChildren[next].get());
+            ++row;
+            ++next;
+            continue;
+        }
+
+        // new nodes without any counterpart in the remaining old ones
+        size_t insertEnd = next;
+        while (insertEnd < newChildren.size() && pendingOld.value(newChildren[insertEnd]->id()) == 0) {
+            ++insertEnd;
+        }
+        if (insertEnd > next) {
+            const int count = static_cast<int>(insertEnd - next);
+            beginInsertRows(index, row, row + count - 1);
+            for (size_t i = next; i < insertEnd; ++i) {
+                newChildren[i]->m_parent = node;
+            }
+            children.insert(children.begin() + row,
+                            std::make_move_iterator(newChildren.begin() + next),
+                            std::make_move_iterator(newChildren.begin() + insertEnd));
+            endInsertRows();
+            row += count;
+            next = insertEnd;
+            continue;
+        }
+
+        // old nodes which are gone, or moved further down and get inserted again there
+        int removeEnd = row;
+        while (removeEnd < static_cast<int>(children.size())
+               && (next == newChildren.size() || children[removeEnd]->id() != newChildren[next]->id())) {
+            --pendingOld[children[removeEnd]->id()];
+            ++removeEnd;
+        }
+        beginRemoveRows(index, row, removeEnd - 1);
+        children.erase(children.begin() + row, children.begin() + removeEnd);
+        endRemoveRows();
+    }
+}
+
 void OutlineModel::activate(const QModelIndex& realIndex)
 {
     if (!realIndex.isValid()) {
@@ -210,6 +339,11 @@ void OutlineModel::activate(const QModelIndex& realIndex)
             qCDebug(PLUGIN_OUTLINE) << "No declaration exists for node:" << node->text();
             return;
         }
+        if (dcb->url() != m_lastUrl) {
+            // the outline of the previous document is still shown until the new one is built
+            qCDebug(PLUGIN_OUTLINE) << "Outline is outdated, not activating:" << node->text();
+            return;
+        }
         //foreground thread == GUI thread? if so then we are fine
         range = dcb->rangeInCurrentRevision();
         //outline view should ALWAYS correspond to currently active document
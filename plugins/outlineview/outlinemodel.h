@@ -21,6 +21,8 @@
 #include <serialization/indexedstring.h>
 
 #include <QAbstractItemModel>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 #include <vector>
 #include <memory>
 
@@ -53,8 +55,21 @@ public Q_SLOTS:
     void activate(const QModelIndex& realIndex);
 private Q_SLOTS:
     void rebuildOutline(KDevelop::IDocument* doc);
+    void outlineBuilt();
 private:
+    /// Runs in a background thread, returns null if there is no DUChain for @p url
+    static QSharedPointer<OutlineNode> buildOutline(const KDevelop::IndexedString& url);
+    void startBuild();
+    /// Update @p node and its children to match @p newNode, emitting the row changes
+    void mergeNode(OutlineNode* node, const QModelIndex& index, OutlineNode* newNode);
+    void mergeChildren(OutlineNode* node, const QModelIndex& index, OutlineNode* newNode);
+
     std::unique_ptr<OutlineNode> m_rootNode;
+    /// The document the nodes below m_rootNode were built for
+    KDevelop::IndexedString m_rootUrl;
+    QFutureWatcher<QSharedPointer<OutlineNode>> m_buildWatcher;
+    KDevelop::IndexedString m_buildUrl;
+    bool m_rebuildPending = false;
     KDevelop::IDocument* m_lastDoc;
     KDevelop::IndexedString m_lastUrl;
 };
@@ -30,8 +30,6 @@
 #include <language/duchain/classdeclaration.h>
 #include <language/duchain/forwarddeclaration.h>
 
-#include <KTextEditor/CodeCompletionModel>
-
 #include <debug.h>
 
 using namespace KDevelop;
@@ -44,6 +42,7 @@ OutlineNode::OutlineNode(const QString& text, OutlineNode* parent)
 
 OutlineNode::OutlineNode(DUContext* ctx, const QString& name, OutlineNode* parent)
     : m_cachedText(name)
+    , m_id(IndexedQualifiedIdentifier(ctx->scopeIdentifier(true)))
     , m_declOrContext(ctx)
     , m_parent(parent)
 {
@@ -67,20 +66,21 @@ OutlineNode::OutlineNode(DUContext* ctx, const QString& name, OutlineNode* paren
         default:
             break;
     }
-    m_cachedIcon = DUChainUtils::iconForProperties(prop);
+    m_properties = prop;
     appendContext(ctx, ctx->topContext());
 }
 
 
 OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
-    : m_declOrContext(decl)
+    : m_id(decl->id())
+    , m_declOrContext(decl)
     , m_parent(parent)
 {
     // qCDebug(PLUGIN_OUTLINE) << "Adding:" << decl->qualifiedIdentifier().toString() << ": " <<typeid(*decl).name();
 
     // TODO: properly qualified identifier for out of line function definitions
     m_cachedText = decl->identifier().toString();
-    m_cachedIcon = DUChainUtils::iconForDeclaration(decl);
+    m_properties = DUChainUtils::completionProperties(decl);
     if (auto* alias = dynamic_cast<NamespaceAliasDeclaration*>(decl)) {
         //e.g. C++ using namespace statement
         m_cachedText = alias->importIdentifier().toString();
@@ -200,7 +200,7 @@ void OutlineNode::appendContext(DUContext* ctx, TopDUContext* top)
     const auto childDecls = ctx->localDeclarations(top);
     for (Declaration* childDecl : childDecls) {
         if (childDecl) {
-            m_children.emplace_back(childDecl, this);
+            m_children.emplace_back(new OutlineNode(childDecl, this));
         }
     }
     bool certainlyRequiresSorting = false;
@@ -239,22 +239,23 @@ void OutlineNode::appendContext(DUContext* ctx, TopDUContext* top)
                 //  +-+- FooClass
                 //  | \-- method2()
                 //  \ OtherStuff
-                auto it = std::find_if(m_children.begin(), m_children.end(), [childContext](const OutlineNode& node) {
-                    if (auto* ctx = dynamic_cast<DUContext*>(node.duChainObject())) {
+                auto it = std::find_if(m_children.begin(), m_children.end(),
+                                       [childContext](const std::unique_ptr<OutlineNode>& node) {
+                    if (auto* ctx = dynamic_cast<DUContext*>(node->duChainObject())) {
                         return ctx->equalScopeIdentifier(childContext);
                     }
                     return false;
                 });
                 if (it != m_children.end()) {
-                    it->appendContext(childContext, top);
+                    (*it)->appendContext(childContext, top);
                 }
                 else {
                     // TODO: get the correct icon for the context
-                    m_children.emplace_back(childContext, ctxName, this);
+                    m_children.emplace_back(new OutlineNode(childContext, ctxName, this));
                 }
             } else {
                 // just add the context
-                m_children.emplace_back(childContext, ctxName, this);
+                m_children.emplace_back(new OutlineNode(childContext, ctxName, this));
             }
         }
     }
@@ -275,17 +276,17 @@ void OutlineNode::sortByLocation(bool requiresSorting)
     // TODO: does it make sense to cache m_declOrContext->range().start?
     // adds 8 bytes to each node, but save a lot of pointer lookups when sorting
     // qDebug("sorting children of %s (%p) by location", qPrintable(m_cachedText), this);
-    auto compare = [](const OutlineNode& n1, const OutlineNode& n2) -> bool {
+    auto compare = [](const std::unique_ptr<OutlineNode>& n1, const std::unique_ptr<OutlineNode>& n2) -> bool {
         // nodes without decl always go at the end
-        if (!n1.m_declOrContext) {
+        if (!n1->m_declOrContext) {
             return false;
-        } else if (!n2.m_declOrContext) {
+        } else if (!n2->m_declOrContext) {
             return true;
         }
-        return n1.m_declOrContext->range().start < n2.m_declOrContext->range().start;
+        return n1->m_declOrContext->range().start < n2->m_declOrContext->range().start;
     };
     // since most nodes will be correctly sorted we check that before calling std::sort().
-    // This saves a lot of move ctor/assignment calls in the common case.
+    // This saves a lot of pointless moves in the common case.
     // If we appended a context without a Declaration* we know that it will be unsorted
     // so we can pass requiresSorting = true to skip the useless std::is_sorted() call.
     // uncomment the following qDebug() lines to see whether this optimization really makes sense
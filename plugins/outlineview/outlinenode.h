@@ -21,11 +21,16 @@
 #include <QString>
 #include <QIcon>
 #include <memory>
+#include <vector>
 
+#include <KTextEditor/CodeCompletionModel>
+
+#include <language/duchain/declarationid.h>
 #include <language/duchain/duchain.h>
 #include <language/duchain/duchainbase.h>
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/duchainpointer.h>
+#include <language/duchain/duchainutils.h>
 
 
 namespace KDevelop {
@@ -33,6 +38,12 @@ class Declaration;
 class DUContext;
 }
 
+/**
+ * A node of the outline tree.
+ *
+ * The nodes are created with the DUChain locked, which may happen in a background thread,
+ * afterwards everything but duChainObject() can be used without holding the lock.
+ */
 class OutlineNode
 {
     Q_DISABLE_COPY(OutlineNode)
@@ -40,28 +51,33 @@ class OutlineNode
     void sortByLocation(bool requiresSorting);
 public:
     OutlineNode(const QString& text, OutlineNode* parent);
-    OutlineNode(OutlineNode&& other) Q_DECL_NOEXCEPT;
-    OutlineNode& operator=(OutlineNode&& other) Q_DECL_NOEXCEPT;
     OutlineNode(KDevelop::Declaration* decl, OutlineNode* parent);
     OutlineNode(KDevelop::DUContext* ctx, const QString& name, OutlineNode* parent);
     virtual ~OutlineNode();
+    /// Must only be called from the GUI thread
     QIcon icon() const;
     QString text() const;
+    /// Identifies the declaration or context across reparses of the document
+    const KDevelop::DeclarationId& id() const;
     const OutlineNode* parent() const;
-    const std::vector<OutlineNode>& children() const;
+    const std::vector<std::unique_ptr<OutlineNode>>& children() const;
     int childCount() const;
     const OutlineNode* childAt(int index) const;
     int indexOf(const OutlineNode* child) const;
     static std::unique_ptr<OutlineNode> fromTopContext(KDevelop::TopDUContext* ctx);
     static std::unique_ptr<OutlineNode> dummyNode();
     KDevelop::DUChainBase* duChainObject() const;
-    friend void swap(OutlineNode& n1, OutlineNode& n2);
 private:
+    // updates the nodes in place
+    friend class OutlineModel;
+
     QString m_cachedText;
-    QIcon m_cachedIcon;
+    KTextEditor::CodeCompletionModel::CompletionProperties m_properties;
+    KDevelop::DeclarationId m_id;
     KDevelop::DUChainBasePointer m_declOrContext;
     OutlineNode* m_parent;
-    std::vector<OutlineNode> m_children;
+    // nodes are referenced by model indexes, so they must not move in memory
+    std::vector<std::unique_ptr<OutlineNode>> m_children;
 };
 
 inline int OutlineNode::childCount() const
@@ -69,14 +85,14 @@ inline int OutlineNode::childCount() const
     return static_cast<int>(m_children.size());
 }
 
-inline const std::vector<OutlineNode>& OutlineNode::children() const
+inline const std::vector<std::unique_ptr<OutlineNode>>& OutlineNode::children() const
 {
     return m_children;
 }
 
 inline const OutlineNode* OutlineNode::childAt(int index) const
 {
-    return &m_children.at(index);
+    return m_children.at(index).get();
 }
 
 inline const OutlineNode* OutlineNode::parent() const
@@ -87,9 +103,8 @@ inline const OutlineNode* OutlineNode::parent() const
 inline int OutlineNode::indexOf(const OutlineNode* child) const
 {
     const auto max = m_children.size();
-    // Comparing the address here is only fine since we never modify the vector after initial creation
     for (size_t i = 0; i < max; i++) {
-        if (child == &m_children[i]) {
+        if (child == m_children[i].get()) {
             return static_cast<int>(i);
         }
     }
@@ -98,7 +113,7 @@ inline int OutlineNode::indexOf(const OutlineNode* child) const
 
 inline QIcon OutlineNode::icon() const
 {
-    return m_cachedIcon;
+    return KDevelop::DUChainUtils::iconForProperties(m_properties);
 }
 
 inline QString OutlineNode::text() const
@@ -106,57 +121,13 @@ inline QString OutlineNode::text() const
     return m_cachedText;
 }
 
-inline KDevelop::DUChainBase* OutlineNode::duChainObject() const
-{
-    ENSURE_CHAIN_READ_LOCKED
-    return m_declOrContext.data();
-}
-
-
-inline OutlineNode::OutlineNode(OutlineNode&& other) Q_DECL_NOEXCEPT
-    : m_cachedText(std::move(other.m_cachedText))
-    , m_cachedIcon(std::move(other.m_cachedIcon))
-    , m_declOrContext(std::move(other.m_declOrContext))
-    , m_parent(std::move(other.m_parent))
-    , m_children(std::move(other.m_children))
-{
-    // qDebug("Move ctor %p -> %p", &other, this);
-    other.m_parent = nullptr;
-    other.m_declOrContext = nullptr;
-    for (OutlineNode& child : m_children) {
-        // when we are moved the parent pointer has to be updated for the children!
-        child.m_parent = this;
-    }
-}
-
-inline OutlineNode& OutlineNode::operator=(OutlineNode&& other) Q_DECL_NOEXCEPT
+inline const KDevelop::DeclarationId& OutlineNode::id() const
 {
-    if (this == &other) {
-        return *this;
-    }
-    m_cachedText = std::move(other.m_cachedText);
-    m_cachedIcon = std::move(other.m_cachedIcon);
-    m_declOrContext = std::move(other.m_declOrContext);
-    m_parent = std::move(other.m_parent);
-    m_children = std::move(other.m_children);
-    // qDebug("Move assignment %p -> %p", &other, this);
-    other.m_parent = nullptr;
-    other.m_declOrContext = nullptr;
-    for (OutlineNode& child : m_children) {
-        // when we are moved the parent pointer has to be updated for the children!
-        child.m_parent = this;
-    }
-    return *this;
+    return m_id;
 }
 
-inline void swap(OutlineNode& n1, OutlineNode& n2)
+inline KDevelop::DUChainBase* OutlineNode::duChainObject() const
 {
-    // For some reason std::sort only sometimes calls swap and mostly uses move ctor + assign.
-    // Probably it uses different algorithms for different sequence sizes
-    // qDebug("Swapping %p and %p", &n1, &n2);
-    std::swap(n1.m_cachedText, n2.m_cachedText);
-    std::swap(n1.m_cachedIcon, n2.m_cachedIcon);
-    std::swap(n1.m_declOrContext, n2.m_declOrContext);
-    std::swap(n1.m_parent, n2.m_parent);
-    std::swap(n1.m_children, n2.m_children);
+    ENSURE_CHAIN_READ_LOCKED
+    return m_declOrContext.data();
 }
@@ -94,6 +94,15 @@ OutlineWidget::OutlineWidget(QWidget* parent, OutlineViewPlugin* plugin)
     setLayout(vbox);
     expandFirstLevel();
     connect(m_model, &QAbstractItemModel::modelReset, this, &OutlineWidget::expandFirstLevel);
+    // the outline of the current document is updated in place, expand new top level items as well
+    connect(m_proxy, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex& parent, int first, int last) {
+        if (parent.isValid()) {
+            return;
+        }
+        for (int i = first; i <= last; i++) {
+            m_tree->expand(m_proxy->index(i, 0));
+        }
+    });
 }
 
 void OutlineWidget::activated(const QModelIndex& index)
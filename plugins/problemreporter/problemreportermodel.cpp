@@ -29,9 +29,12 @@
 #include <language/duchain/duchainutils.h>
 #include <language/assistant/staticassistantsmanager.h>
 
+#include <QElapsedTimer>
 #include <QThread>
 #include <QTimer>
 
+#include <algorithm>
+
 #include <serialization/indexedstring.h>
 
 #include <shell/watcheddocumentset.h>
@@ -45,6 +48,8 @@ using namespace KDevelop;
 
 const int ProblemReporterModel::MinTimeout = 1000;
 const int ProblemReporterModel::MaxTimeout = 5000;
+/// Time in ms spent on updating the problems at once, small enough to not block the UI noticeably
+const int ProblemReporterModel::UpdateBudget = 16;
 
 ProblemReporterModel::ProblemReporterModel(QObject* parent)
     : ProblemModel(parent, new FilteredProblemStore())
@@ -59,6 +64,10 @@ ProblemReporterModel::ProblemReporterModel(QObject* parent)
     m_maxTimer->setInterval(MaxTimeout);
     m_maxTimer->setSingleShot(true);
     connect(m_maxTimer, &QTimer::timeout, this, &ProblemReporterModel::timerExpired);
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setInterval(0);
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, &QTimer::timeout, this, &ProblemReporterModel::updatePendingDocuments);
     connect(store(), &FilteredProblemStore::changed, this, &ProblemReporterModel::onProblemsChanged);
     connect(ICore::self()->languageController()->staticAssistantsManager(), &StaticAssistantsManager::problemsChanged,
             this, &ProblemReporterModel::onProblemsChanged);
@@ -122,7 +131,42 @@ void ProblemReporterModel::timerExpired()
 {
     m_minTimer->stop();
     m_maxTimer->stop();
-    rebuildProblemList();
+    updatePendingDocuments();
+}
+
+void ProblemReporterModel::updatePendingDocuments()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!m_pendingDocuments.isEmpty()) {
+        const auto it = m_pendingDocuments.begin();
+        const IndexedString document = *it;
+        m_pendingDocuments.erase(it);
+
+        // the scope might have changed meanwhile, which rebuilds the whole list anyway
+        if (!store()->documents()->get().contains(document) &&
+            !(showImports() && store()->documents()->imports().contains(document)))
+            continue;
+
+        const auto documentProblems = problems(QSet<IndexedString>{document});
+        const bool isLocal = std::all_of(documentProblems.begin(), documentProblems.end(), [&](const IProblem::Ptr& problem) {
+            return problem->finalLocation().document == document;
+        });
+        if (!isLocal) {
+            // the store replaces problems by their location, which can't be mapped back to the
+            // document reporting them, so take the slow path for these rare cases
+            rebuildProblemList();
+            return;
+        }
+
+        store()->updateProblems(document, documentProblems);
+
+        if (timer.elapsed() >= UpdateBudget && !m_pendingDocuments.isEmpty()) {
+            m_updateTimer->start();
+            return;
+        }
+    }
 }
 
 void ProblemReporterModel::setCurrentDocument(KDevelop::IDocument* doc)
@@ -145,6 +189,8 @@ void ProblemReporterModel::problemsUpdated(const KDevelop::IndexedString& url)
         !(showImports() && store()->documents()->imports().contains(url)))
         return;
 
+    m_pendingDocuments.insert(url);
+
     /// m_minTimer will expire in MinTimeout unless some other parsing job finishes in this period.
     m_minTimer->start();
     /// m_maxTimer will expire unconditionally in MaxTimeout
@@ -156,6 +202,9 @@ void ProblemReporterModel::problemsUpdated(const KDevelop::IndexedString& url)
 void ProblemReporterModel::rebuildProblemList()
 {
     /// No locking here, because it may be called from an already locked context
+    m_pendingDocuments.clear();
+    m_updateTimer->stop();
+
     beginResetModel();
 
     QVector<IProblem::Ptr> allProblems = problems(store()->documents()->get());
@@ -23,9 +23,12 @@
 
 #include <shell/problemmodel.h>
 
+#include <serialization/indexedstring.h>
+
+#include <QSet>
+
 namespace KDevelop
 {
-class IndexedString;
 class TopDUContext;
 }
 
@@ -64,14 +67,20 @@ protected Q_SLOTS:
 private Q_SLOTS:
     void timerExpired();
     void setCurrentDocument(KDevelop::IDocument* doc) override;
+    void updatePendingDocuments();
 
 private:
     void rebuildProblemList();
 
     QTimer* m_minTimer;
     QTimer* m_maxTimer;
+    /// Continues updating the pending documents once the event loop had a chance to run
+    QTimer* m_updateTimer;
+    /// Documents whose problems were updated since the problem list was last updated
+    QSet<KDevelop::IndexedString> m_pendingDocuments;
     const static int MinTimeout;
     const static int MaxTimeout;
+    const static int UpdateBudget;
 };
 
 #endif
@@ -24,6 +24,7 @@
 #include <QAction>
 #include <QHeaderView>
 #include <QKeyEvent>
+#include <QLineEdit>
 #include <QUrl>
 
 #include <KActionCollection>
@@ -128,6 +129,8 @@ ProjectManagerView::ProjectManagerView( ProjectManagerViewPlugin* plugin, QWidge
 
     m_ui->projectTreeView->setModel( m_overlayProxy );
 
+    connect(m_ui->filterEdit, &QLineEdit::textChanged, m_modelFilter, &ProjectProxyModel::setFilterString);
+
     connect( m_ui->projectTreeView->selectionModel(), &QItemSelectionModel::selectionChanged,
              this, &ProjectManagerView::selectionChanged );
     connect( KDevelop::ICore::self()->documentController(), &IDocumentController::documentClosed,
@@ -0,0 +1,297 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "projectitemindex.h"
+
+#include <language/duchain/codemodel.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/topducontext.h>
+#include <language/interfaces/abbreviations.h>
+
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+using namespace KDevelop;
+
+namespace {
+/// Number of strings matched by one job when filtering.
+const int filterChunkSize = 4096;
+
+struct Range
+{
+    int begin;
+    int end;
+};
+
+QVector<Range> chunks(int count)
+{
+    QVector<Range> ret;
+    ret.reserve(count / filterChunkSize + 1);
+    for (int begin = 0; begin < count; begin += filterChunkSize) {
+        ret.append({begin, std::min(begin + filterChunkSize, count)});
+    }
+    return ret;
+}
+
+/**
+ * @return how far @p string is from containing @p substring, lower is closer, or -1 if it doesn't match at all
+ */
+int matchDistance(const QString& string, const QString& substring)
+{
+    int result = string.lastIndexOf(substring, -1, Qt::CaseInsensitive);
+    if (result < 0 && !string.isEmpty() && !substring.isEmpty()) {
+        // no match; try abbreviations
+        result = matchesAbbreviation(string.midRef(0), substring) ? 0 : -1;
+    }
+
+    //here we shift the values if the matched string is bigger than the substring,
+    //so closer matches will appear first
+    if (result >= 0) {
+        result = result + (string.size() - substring.size());
+    }
+
+    return result;
+}
+
+struct ScoredItem
+{
+    int height;
+    uint idIndex;
+    int item;
+
+    bool operator<(const ScoredItem& other) const
+    {
+        if (height == other.height) {
+            // stable sorting for equal items based on index
+            return idIndex < other.idIndex;
+        }
+        return height < other.height;
+    }
+};
+}
+
+ProjectItemIndex::ProjectItemIndex(QObject* parent)
+    : QObject(parent)
+{
+    connect(DUChain::self(), &DUChain::updateReady, this, &ProjectItemIndex::updateReady);
+}
+
+void ProjectItemIndex::updateReady(const IndexedString& url, const ReferencedTopDUContext& topContext)
+{
+    Q_UNUSED(topContext);
+
+    if (m_files.contains(url)) {
+        m_dirtyFiles.insert(url);
+    }
+}
+
+void ProjectItemIndex::setFiles(const QSet<IndexedString>& files)
+{
+    bool changed = false;
+
+    for (auto it = m_files.begin(); it != m_files.end();) {
+        if (!files.contains(it.key())) {
+            m_dirtyFiles.remove(it.key());
+            it = m_files.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    QVector<IndexedString> outdated;
+    for (const IndexedString& file : files) {
+        if (!m_files.contains(file) || m_dirtyFiles.contains(file)) {
+            outdated.append(file);
+        }
+    }
+
+    if (!outdated.isEmpty()) {
+        DUChainReadLocker lock(DUChain::lock());
+        for (const IndexedString& file : qAsConst(outdated)) {
+            m_files.insert(file, readFile(file));
+        }
+        m_dirtyFiles.clear();
+        changed = true;
+    }
+
+    if (changed) {
+        m_itemsCache.clear();
+    }
+}
+
+QVector<CodeModelViewItem> ProjectItemIndex::readFile(const IndexedString& file)
+{
+    QVector<CodeModelViewItem> ret;
+
+    uint count;
+    const KDevelop::CodeModelItem* items;
+    CodeModel::self().items(file, count, items);
+
+    for (uint a = 0; a < count; ++a) {
+        if (!items[a].id.isValid() || items[a].kind & CodeModelItem::ForwardDeclaration) {
+            continue;
+        }
+        if (!(items[a].kind & (CodeModelItem::Class | CodeModelItem::Function))) {
+            continue;
+        }
+
+        QualifiedIdentifier id = items[a].id.identifier();
+
+        if (id.isEmpty() || id.at(0).identifier().isEmpty()) {
+            // id.isEmpty() not always hit when .toString() is actually empty...
+            // anyhow, this makes sure that we don't show duchain items without
+            // any name that could be searched for. This happens e.g. in the c++
+            // plugin for anonymous structs or sometimes for declarations in macro
+            // expressions
+            continue;
+        }
+
+        CodeModelViewItem item(file, id);
+        item.m_kind = items[a].uKind;
+        item.m_parts.reserve(id.count());
+        for (int i = 0; i < id.count(); ++i) {
+            item.m_parts.append(stringId(id.at(i)));
+        }
+        ret.append(item);
+    }
+
+    return ret;
+}
+
+int ProjectItemIndex::stringId(const Identifier& identifier)
+{
+    const uint index = identifier.index();
+    auto it = m_stringIds.constFind(index);
+    if (it != m_stringIds.constEnd()) {
+        return *it;
+    }
+
+    const int id = m_strings.size();
+    m_strings.append(identifier.identifier().str());
+    m_stringIds.insert(index, id);
+    return id;
+}
+
+QVector<CodeModelViewItem> ProjectItemIndex::items(uint kinds) const
+{
+    auto it = m_itemsCache.constFind(kinds);
+    if (it != m_itemsCache.constEnd()) {
+        return *it;
+    }
+
+    QVector<CodeModelViewItem> ret;
+    for (const auto& fileItems : m_files) {
+        for (const CodeModelViewItem& item : fileItems) {
+            if (item.m_kind & kinds) {
+                ret.append(item);
+            }
+        }
+    }
+
+    m_itemsCache.insert(kinds, ret);
+    return ret;
+}
+
+QVector<CodeModelViewItem> ProjectItemIndex::filter(const QVector<CodeModelViewItem>& items,
+                                                    const QStringList& search) const
+{
+    if (search.isEmpty()) {
+        return items;
+    }
+
+    // Only match the names which are actually used by the given items.
+    QVector<bool> used(m_strings.size(), false);
+    QVector<int> usedStrings;
+    for (const CodeModelViewItem& item : items) {
+        for (int part : item.m_parts) {
+            if (!used[part]) {
+                used[part] = true;
+                usedStrings.append(part);
+            }
+        }
+    }
+
+    // distances[searchPart][string]
+    QVector<QVector<int>> distances(search.size());
+    QVector<int*> rows;
+    for (auto& row : distances) {
+        row.fill(-1, m_strings.size());
+        rows.append(row.data());
+    }
+
+    QVector<Range> stringChunks = chunks(usedStrings.size());
+    QtConcurrent::blockingMap(stringChunks, [&](const Range& range) {
+        for (int b = 0; b < search.size(); ++b) {
+            const QString& searchPart = search[b];
+            // each string has one slot in each row, so the jobs never write to the same location
+            int* row = rows.at(b);
+            for (int i = range.begin; i < range.end; ++i) {
+                const int string = usedStrings.at(i);
+                row[string] = matchDistance(m_strings[string], searchPart);
+            }
+        }
+    });
+
+    QVector<ScoredItem> scored;
+    scored.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        const auto& parts = items[i].m_parts;
+
+        int last_pos = parts.size() - 1;
+        int current_height = 0;
+        int distance = 0;
+
+        //iter over each search item from last to first
+        //this makes easier to calculate the distance based on where we hit the result or nothing
+        //Iterating from the last item to the first is more efficient, as we want to match the
+        //class/function name, which is the last item on the search fields and on the identifier.
+        for (int b = search.size() - 1; b >= 0; --b) {
+            //iter over each id for the current identifier, from last to first
+            for (; last_pos >= 0; --last_pos, distance++) {
+                // the more distant we are from the class definition, the less priority it will have
+                current_height += distance * 10000;
+                const int result = rows[b][parts[last_pos]];
+                //if the current search item is contained on the current identifier
+                if (result >= 0) {
+                    //when we find a hit, whe add the distance to the searched word.
+                    //so the closest item will be displayed first
+                    current_height += result;
+
+                    if (b == 0) {
+                        scored.append({current_height, items[i].m_id.index(), i});
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    //then, for the last part, we use the computed heights to sort the items according with their distance
+    std::sort(scored.begin(), scored.end());
+
+    QVector<CodeModelViewItem> ret;
+    ret.reserve(scored.size());
+    for (const ScoredItem& item : qAsConst(scored)) {
+        ret.append(items[item.item]);
+    }
+    return ret;
+}
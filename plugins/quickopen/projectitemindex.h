@@ -0,0 +1,107 @@
+/*
+ * This file is part of KDevelop
+ * Copyright 2020 The KDevelop Team <kdevelop-devel@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef PROJECT_ITEM_INDEX
+#define PROJECT_ITEM_INDEX
+
+#include <serialization/indexedstring.h>
+#include <language/duchain/identifier.h>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+namespace KDevelop {
+class ReferencedTopDUContext;
+}
+
+struct CodeModelViewItem
+{
+    CodeModelViewItem()
+    {
+    }
+    CodeModelViewItem(const KDevelop::IndexedString& file, const KDevelop::QualifiedIdentifier& id)
+        : m_file(file)
+        , m_id(id)
+    {
+    }
+    KDevelop::IndexedString m_file;
+    KDevelop::QualifiedIdentifier m_id;
+    /// Positions of the names of the identifier parts in the string table of the ProjectItemIndex.
+    QVector<int> m_parts;
+    /// The CodeModelItem::Kind of the item.
+    uint m_kind = 0;
+};
+
+Q_DECLARE_TYPEINFO(CodeModelViewItem, Q_MOVABLE_TYPE);
+
+/**
+ * The classes and functions declared in a set of files, read from the code model.
+ *
+ * The index is kept across quick open invocations. Only files which were not indexed yet,
+ * or which got parsed again since they were indexed, are read from the code model again.
+ *
+ * The names of all identifier parts are stored once in a string table, so filtering
+ * only has to match each distinct name instead of each item, and can do so in parallel
+ * without touching the identifier repository.
+ */
+class ProjectItemIndex
+    : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProjectItemIndex(QObject* parent = nullptr);
+
+    /// Make the index cover exactly @p files.
+    void setFiles(const QSet<KDevelop::IndexedString>& files);
+
+    /// @return the items whose CodeModelItem::Kind matches any bit of @p kinds, in file order.
+    QVector<CodeModelViewItem> items(uint kinds) const;
+
+    /**
+     * @return the @p items which match all parts of @p search, the closest matches first.
+     *
+     * @p search contains the parts of a qualified identifier, each of them is matched
+     * against a part of the item identifiers, in the same order.
+     */
+    QVector<CodeModelViewItem> filter(const QVector<CodeModelViewItem>& items, const QStringList& search) const;
+
+private Q_SLOTS:
+    void updateReady(const KDevelop::IndexedString& url, const KDevelop::ReferencedTopDUContext& topContext);
+
+private:
+    /// Read the items of @p file from the code model.
+    /// @note DU CHAIN MUST BE LOCKED FOR READ
+    QVector<CodeModelViewItem> readFile(const KDevelop::IndexedString& file);
+
+    int stringId(const KDevelop::Identifier& identifier);
+
+    QHash<KDevelop::IndexedString, QVector<CodeModelViewItem>> m_files;
+    /// Indexed files which were parsed again since.
+    QSet<KDevelop::IndexedString> m_dirtyFiles;
+
+    /// The names of all identifier parts, with their position by identifier index.
+    QVector<QString> m_strings;
+    QHash<uint, int> m_stringIds;
+
+    mutable QHash<uint, QVector<CodeModelViewItem>> m_itemsCache;
+};
+
+#endif
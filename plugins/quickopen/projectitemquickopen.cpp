@@ -28,7 +28,6 @@
 #include <language/duchain/duchainutils.h>
 #include <language/duchain/codemodel.h>
 #include <language/interfaces/iquickopen.h>
-#include <language/interfaces/abbreviations.h>
 
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
@@ -41,78 +40,6 @@
 using namespace KDevelop;
 
 namespace {
-struct SubstringCache
-{
-    explicit SubstringCache(const QString& string = QString())
-        : substring(string)
-    {
-    }
-
-    inline int containedIn(const Identifier& id) const
-    {
-        int index = id.index();
-        QHash<int, int>::const_iterator it = cache.constFind(index);
-        if (it != cache.constEnd()) {
-            return *it;
-        }
-
-        const QString idStr = id.identifier().str();
-
-        int result = idStr.lastIndexOf(substring, -1, Qt::CaseInsensitive);
-        if (result < 0 && !idStr.isEmpty() && !substring.isEmpty()) {
-            // no match; try abbreviations
-            result = matchesAbbreviation(idStr.midRef(0), substring) ? 0 : -1;
-        }
-
-        //here we shift the values if the matched string is bigger than the substring,
-        //so closer matches will appear first
-        if (result >= 0) {
-            result = result + (idStr.size() - substring.size());
-        }
-
-        cache[index] = result;
-
-        return result;
-    }
-
-    QString substring;
-    mutable QHash<int, int> cache;
-};
-
-struct ClosestMatchToText
-{
-    explicit ClosestMatchToText(const QHash<int, int>& _cache)
-        : cache(_cache)
-    {
-    }
-
-    /** @brief Calculates the distance to two pre-filtered match items
-     *
-     *  @param a The CodeModelView witch represents the first item to be tested
-     *  @param b The CodeModelView witch represents the second item to be tested
-     *
-     *  @b
-     */
-    inline bool operator()(const CodeModelViewItem& a, const CodeModelViewItem& b) const
-    {
-        const int height_a = cache.value(a.m_id.index(), -1);
-        const int height_b = cache.value(b.m_id.index(), -1);
-
-        Q_ASSERT(height_a != -1);
-        Q_ASSERT(height_b != -1);
-
-        if (height_a == height_b) {
-            // stable sorting for equal items based on index
-            // TODO: fast string-based sorting in such cases?
-            return a.m_id.index() < b.m_id.index();
-        }
-
-        return height_a < height_b;
-    }
-private:
-    const QHash<int, int>& cache;
-};
-
 Path findProjectForForPath(const IndexedString& path)
 {
     const auto model = ICore::self()->projectController()->projectModel();
@@ -158,57 +85,13 @@ void ProjectItemDataProvider::setFilterText(const QString& text)
         return;
     }
 
-    KDevVarLengthArray<SubstringCache, 5> cache;
-    for (const QString& searchPart : qAsConst(search)) {
-        cache.append(SubstringCache(searchPart));
-    }
-
     if (!text.startsWith(m_currentFilter)) {
         m_filteredItems = m_currentItems;
     }
 
     m_currentFilter = text;
 
-    const QVector<CodeModelViewItem> oldFiltered = m_filteredItems;
-    QHash<int, int> heights;
-
-    m_filteredItems.clear();
-
-    for (const CodeModelViewItem& item : oldFiltered) {
-        const QualifiedIdentifier& currentId = item.m_id;
-
-        int last_pos = currentId.count() - 1;
-        int current_height = 0;
-        int distance = 0;
-
-        //iter over each search item from last to first
-        //this makes easier to calculate the distance based on where we hit the result or nothing
-        //Iterating from the last item to the first is more efficient, as we want to match the
-        //class/function name, which is the last item on the search fields and on the identifier.
-        for (int b = search.count() - 1; b >= 0; --b) {
-            //iter over each id for the current identifier, from last to first
-            for (; last_pos >= 0; --last_pos, distance++) {
-                // the more distant we are from the class definition, the less priority it will have
-                current_height += distance * 10000;
-                int result;
-                //if the current search item is contained on the current identifier
-                if ((result = cache[b].containedIn(currentId.at(last_pos))) >= 0) {
-                    //when we find a hit, whe add the distance to the searched word.
-                    //so the closest item will be displayed first
-                    current_height += result;
-
-                    if (b == 0) {
-                        heights[currentId.index()] = current_height;
-                        m_filteredItems << item;
-                    }
-                    break;
-                }
-            }
-        }
-    }
-
-    //then, for the last part, we use the already built cache to sort the items according with their distance
-    std::sort(m_filteredItems.begin(), m_filteredItems.end(), ClosestMatchToText(heights));
+    m_filteredItems = m_index.filter(m_filteredItems, search);
 }
 
 
@@ -309,32 +192,16 @@ void ProjectItemDataProvider::reset()
     m_addedItems.clear();
     m_addedItemsCountCache.markDirty();
 
-    KDevelop::DUChainReadLocker lock(DUChain::lock());
-    for (const IndexedString& u : qAsConst(m_files)) {
-        uint count;
-        const KDevelop::CodeModelItem* items;
-        CodeModel::self().items(u, count, items);
-
-        for (uint a = 0; a < count; ++a) {
-            if (!items[a].id.isValid() || items[a].kind & CodeModelItem::ForwardDeclaration) {
-                continue;
-            }
-            if (((m_itemTypes & Classes) && (items[a].kind & CodeModelItem::Class)) ||
-                ((m_itemTypes & Functions) && (items[a].kind & CodeModelItem::Function))) {
-                QualifiedIdentifier id = items[a].id.identifier();
-
-                if (id.isEmpty() || id.at(0).identifier().isEmpty()) {
-                    // id.isEmpty() not always hit when .toString() is actually empty...
-                    // anyhow, this makes sure that we don't show duchain items without
-                    // any name that could be searched for. This happens e.g. in the c++
-                    // plugin for anonymous structs or sometimes for declarations in macro
-                    // expressions
-                    continue;
-                }
-                m_currentItems << CodeModelViewItem(u, id);
-            }
-        }
+    m_index.setFiles(m_files);
+
+    uint kinds = 0;
+    if (m_itemTypes & Classes) {
+        kinds |= CodeModelItem::Class;
+    }
+    if (m_itemTypes & Functions) {
+        kinds |= CodeModelItem::Function;
     }
+    m_currentItems = m_index.items(kinds);
 
     m_filteredItems = m_currentItems;
     m_currentFilter.clear();
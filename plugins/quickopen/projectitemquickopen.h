@@ -19,6 +19,7 @@
 #define PROJECT_ITEM_QUICKOPEN
 
 #include "duchainitemquickopen.h"
+#include "projectitemindex.h"
 
 #include <serialization/indexedstring.h>
 #include <language/duchain/identifier.h>
@@ -61,22 +62,6 @@ private:
     mutable bool m_isDirty = true;
 };
 
-struct CodeModelViewItem
-{
-    CodeModelViewItem()
-    {
-    }
-    CodeModelViewItem(const KDevelop::IndexedString& file, const KDevelop::QualifiedIdentifier& id)
-        : m_file(file)
-        , m_id(id)
-    {
-    }
-    KDevelop::IndexedString m_file;
-    KDevelop::QualifiedIdentifier m_id;
-};
-
-Q_DECLARE_TYPEINFO(CodeModelViewItem, Q_MOVABLE_TYPE);
-
 using AddedItems = QMap<uint, QList<KDevelop::QuickOpenDataPointer>>;
 
 class ProjectItemDataProvider
@@ -109,6 +94,8 @@ private:
     ItemTypes m_itemTypes;
     KDevelop::IQuickOpen* m_quickopen;
     QSet<KDevelop::IndexedString> m_files;
+    /// Kept across invocations, only changed files are read again on reset()
+    ProjectItemIndex m_index;
     QVector<CodeModelViewItem> m_currentItems;
     QString m_currentFilter;
     QVector<CodeModelViewItem> m_filteredItems;
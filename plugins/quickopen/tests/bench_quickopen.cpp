@@ -20,8 +20,11 @@
 
 #include "bench_quickopen.h"
 
+#include "../projectitemindex.h"
+
 #include <interfaces/icore.h>
 #include <interfaces/iprojectcontroller.h>
+#include <language/duchain/codemodel.h>
 
 #include <QIcon>
 #include <QTest>
@@ -50,6 +53,126 @@ void BenchQuickOpen::getData()
     QTest::newRow("0500-f/b") << 500  << "f/b";
 }
 
+namespace {
+/// Add some namespaced classes and methods to the code model for each of @p files
+QSet<IndexedString> createCodeModel(int files)
+{
+    QSet<IndexedString> ret;
+    for (int i = 0; i < files; ++i) {
+        const IndexedString file(QStringLiteral("/home/user/project/file%1.cpp").arg(i));
+        for (int j = 0; j < 10; ++j) {
+            const QualifiedIdentifier classId(QStringLiteral("foo%1::Bar%2").arg(i % 10).arg(i * 10 + j));
+            CodeModel::self().addItem(file, classId, CodeModelItem::Class);
+            for (const auto& method : {QStringLiteral("bar"), QStringLiteral("findBest"), QStringLiteral("size")}) {
+                CodeModel::self().addItem(file, classId + QualifiedIdentifier(method), CodeModelItem::Function);
+            }
+        }
+        ret.insert(file);
+    }
+    return ret;
+}
+
+void removeCodeModel(const QSet<IndexedString>& files)
+{
+    for (const IndexedString& file : files) {
+        uint count;
+        const CodeModelItem* items;
+        CodeModel::self().items(file, count, items);
+        const QVector<CodeModelItem> copy(items, items + count);
+        for (const CodeModelItem& item : copy) {
+            CodeModel::self().removeItem(file, item.id);
+        }
+    }
+}
+}
+
+void BenchQuickOpen::getSymbolData()
+{
+    QTest::addColumn<int>("files");
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("0100-___") << 100  << "";
+    QTest::newRow("1000-___") << 1000 << "";
+    QTest::newRow("0100-bar") << 100  << "bar";
+    QTest::newRow("1000-bar") << 1000 << "bar";
+    QTest::newRow("0100-f:b") << 100  << "foo1::bar";
+    QTest::newRow("1000-f:b") << 1000 << "foo1::bar";
+    QTest::newRow("0100-fiB") << 100  << "fiB";
+    QTest::newRow("1000-fiB") << 1000 << "fiB";
+}
+
+void BenchQuickOpen::benchProjectItemIndex_build()
+{
+    QFETCH(int, files);
+
+    const auto fileSet = createCodeModel(files);
+
+    QBENCHMARK {
+        ProjectItemIndex index;
+        index.setFiles(fileSet);
+        index.items(CodeModelItem::Class | CodeModelItem::Function);
+    }
+
+    removeCodeModel(fileSet);
+}
+
+void BenchQuickOpen::benchProjectItemIndex_build_data()
+{
+    getSymbolData();
+}
+
+void BenchQuickOpen::benchProjectItemIndex_update()
+{
+    QFETCH(int, files);
+
+    const auto fileSet = createCodeModel(files);
+
+    // the common case for a quick open invocation: the index exists already and nothing changed
+    ProjectItemIndex index;
+    index.setFiles(fileSet);
+    QCOMPARE(index.items(CodeModelItem::Class).size(), files * 10);
+
+    QBENCHMARK {
+        index.setFiles(fileSet);
+        index.items(CodeModelItem::Class | CodeModelItem::Function);
+    }
+
+    removeCodeModel(fileSet);
+}
+
+void BenchQuickOpen::benchProjectItemIndex_update_data()
+{
+    getSymbolData();
+}
+
+void BenchQuickOpen::benchProjectItemIndex_filter()
+{
+    QFETCH(int, files);
+    QFETCH(QString, filter);
+
+    const auto fileSet = createCodeModel(files);
+
+    ProjectItemIndex index;
+    index.setFiles(fileSet);
+    const auto items = index.items(CodeModelItem::Class | CodeModelItem::Function);
+    QCOMPARE(items.size(), files * 40);
+
+    const QStringList search = filter.split(QStringLiteral("::"), QString::SkipEmptyParts);
+    QBENCHMARK {
+        index.filter(items, search);
+    }
+    if (!filter.isEmpty()) {
+        QVERIFY(!index.filter(items, search).isEmpty());
+    }
+
+    removeCodeModel(fileSet);
+}
+
+void BenchQuickOpen::benchProjectItemIndex_filter_data()
+{
+    getSymbolData();
+}
+
 void BenchQuickOpen::benchProjectFileFilter_addRemoveProject()
 {
     QFETCH(int, files);
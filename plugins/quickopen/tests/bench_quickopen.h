@@ -31,6 +31,7 @@ public:
     explicit BenchQuickOpen(QObject* parent = nullptr);
 private:
     void getData();
+    void getSymbolData();
 private Q_SLOTS:
     void benchProjectFileFilter_addRemoveProject();
     void benchProjectFileFilter_addRemoveProject_data();
@@ -42,6 +43,12 @@ private Q_SLOTS:
     void benchProjectFileFilter_providerData_data();
     void benchProjectFileFilter_providerDataIcon();
     void benchProjectFileFilter_providerDataIcon_data();
+    void benchProjectItemIndex_build();
+    void benchProjectItemIndex_build_data();
+    void benchProjectItemIndex_update();
+    void benchProjectItemIndex_update_data();
+    void benchProjectItemIndex_filter();
+    void benchProjectItemIndex_filter_data();
 };
 
 #endif // KDEVPLATFORM_PLUGIN_BENCH_QUICKOPEN_H
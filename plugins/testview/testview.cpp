@@ -31,6 +31,7 @@
 #include <interfaces/isession.h>
 
 #include <util/executecompositejob.h>
+#include <util/projecttestjob.h>
 
 #include <language/duchain/indexeddeclaration.h>
 #include <language/duchain/duchainlock.h>
@@ -288,9 +289,9 @@ void TestView::runSelectedTests()
         {
             // A project was selected
             IProject* project = ICore::self()->projectController()->findProjectByName(item->data(ProjectRole).toString());
-            const auto suites = tc->testSuitesForProject(project);
-            for (ITestSuite* suite : suites) {
-                jobs << suite->launchAllCases(ITestSuite::Silent);
+            if (!tc->testSuitesForProject(project).isEmpty())
+            {
+                jobs << new ProjectTestJob(project);
             }
         }
         else if (item->parent()->parent() == nullptr)
@@ -27,7 +27,7 @@
 #include <interfaces/iruncontroller.h>
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/iproject.h>
-#include <util/executecompositejob.h>
+#include <util/projecttestjob.h>
 
 #include <KPluginFactory>
 #include <KLocalizedString>
@@ -103,22 +103,14 @@ void TestViewPlugin::runAllTests()
     ITestController* tc = core()->testController();
     const auto projects = core()->projectController()->projects();
     for (IProject* project : projects) {
-        QList<KJob*> jobs;
-        const auto suites = tc->testSuitesForProject(project);
-        for (ITestSuite* suite : suites) {
-            if (KJob* job = suite->launchAllCases(ITestSuite::Silent))
-            {
-                jobs << job;
-            }
-        }
-        if (!jobs.isEmpty())
+        if (tc->testSuitesForProject(project).isEmpty())
         {
-            auto* compositeJob = new KDevelop::ExecuteCompositeJob(this, jobs);
-            compositeJob->setObjectName(i18np("Run 1 test in %2", "Run %1 tests in %2",
-                                              jobs.size(), project->name()));
-            compositeJob->setProperty("test_job", true);
-            core()->runController()->registerJob(compositeJob);
+            continue;
         }
+        // runs the suites in parallel
+        auto* job = new KDevelop::ProjectTestJob(project, this);
+        job->setProperty("test_job", true);
+        core()->runController()->registerJob(job);
     }
 }
 